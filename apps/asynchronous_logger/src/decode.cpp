@@ -0,0 +1,167 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <expected>
+#include <fcntl.h>
+#include <optional>
+#include <print>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "unix/error_code.hpp"
+#include "unix/fs/posix/file.hpp"
+
+#include "async/binary_reader.hpp"
+
+namespace
+{
+    std::expected<std::vector<std::byte>, unix::error_code> read_file(const std::string &path) noexcept
+    {
+        const auto opened = unix::fs::posix::file::open(path, O_RDONLY | O_CLOEXEC);
+
+        if (!opened)
+        {
+            return std::unexpected{opened.error()};
+        }
+        constexpr std::size_t chunk_size{1'024 * 1'024};
+        std::vector<std::byte> bytes;
+
+        while (true)
+        {
+            const auto size = bytes.size();
+            bytes.resize(size + chunk_size);
+            const auto read = opened.value().read(bytes.data() + size, chunk_size);
+
+            if (!read)
+            {
+                return std::unexpected{read.error()};
+            }
+            bytes.resize(size + read.value());
+
+            if (read.value() == 0)
+            {
+                return bytes;
+            }
+        }
+    }
+
+    void print_time(std::int64_t system_time) noexcept
+    {
+        constexpr std::int64_t nanoseconds_per_second{1'000'000'000};
+        const std::time_t seconds = system_time / nanoseconds_per_second;
+        std::tm time;
+        gmtime_r(&seconds, &time);
+        char text[32];
+        std::strftime(text, sizeof(text), "%Y-%m-%dT%H:%M:%S", &time);
+        std::printf("[%s.%09lldZ] ", text, static_cast<long long>(system_time % nanoseconds_per_second));
+    }
+
+    // the next record of each file, the files are merged by their timestamps
+    struct pending_record
+    {
+        async::binary_reader *reader;
+        std::optional<async::decoded_record> record;
+    };
+
+    bool advance(pending_record &pending, std::string_view path) noexcept
+    {
+        const auto next = pending.reader->next();
+
+        if (!next)
+        {
+            std::println(stderr, "failed to decode {} due to: {}", path,
+                         unix::to_string(next.error()).data());
+            return false;
+        }
+        pending.record = next.value();
+        return true;
+    }
+}
+
+// renders the binary files written by the async logger as text,
+// the records of all the files are merged in the order they were logged
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        std::println(stderr, "usage: {} <log file>...", argv[0]);
+        return EXIT_FAILURE;
+    }
+    const auto paths = std::span<char *const>{argv + 1, static_cast<std::size_t>(argc - 1)};
+    std::vector<std::vector<std::byte>> contents;
+    std::vector<async::binary_reader> readers;
+    contents.reserve(paths.size());
+    readers.reserve(paths.size());
+
+    for (const auto *path : paths)
+    {
+        auto read = read_file(path);
+
+        if (!read)
+        {
+            std::println(stderr, "failed to read {} due to: {}", path,
+                         unix::to_string(read.error()).data());
+            return EXIT_FAILURE;
+        }
+        contents.push_back(std::move(read.value()));
+        auto opened = async::binary_reader::open(contents.back());
+
+        if (!opened)
+        {
+            std::println(stderr, "{} is not a binary log file", path);
+            return EXIT_FAILURE;
+        }
+        readers.push_back(std::move(opened.value()));
+    }
+    std::vector<pending_record> pending;
+
+    for (std::size_t index{0}; index < readers.size(); ++index)
+    {
+        pending.push_back(pending_record{&readers[index], std::nullopt});
+
+        if (!advance(pending.back(), paths[index]))
+        {
+            return EXIT_FAILURE;
+        }
+    }
+    while (true)
+    {
+        std::optional<std::size_t> earliest;
+
+        for (std::size_t index{0}; index < pending.size(); ++index)
+        {
+            const auto &record = pending[index].record;
+
+            if (record && (!earliest || pending[*earliest].reader->to_system_time(pending[*earliest].record->timestamp) >
+                                            pending[index].reader->to_system_time(record->timestamp)))
+            {
+                earliest = index;
+            }
+        }
+        if (!earliest)
+        {
+            return EXIT_SUCCESS;
+        }
+        auto &next = pending[earliest.value()];
+        const auto rendered = async::render(next.record.value());
+
+        if (!rendered)
+        {
+            std::println(stderr, "failed to render a record of {} due to: {}", paths[earliest.value()],
+                         unix::to_string(rendered.error()).data());
+            return EXIT_FAILURE;
+        }
+        print_time(next.reader->to_system_time(next.record->timestamp));
+        std::fwrite(rendered.value().data(), sizeof(char), rendered.value().size(), stdout);
+
+        if (!advance(next, paths[earliest.value()]))
+        {
+            return EXIT_FAILURE;
+        }
+    }
+}
@@ -0,0 +1,283 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <fcntl.h>
+#include <new>
+#include <print>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include "lock_free/ring_buffer.hpp"
+#include "unix/error_code.hpp"
+#include "unix/ipc/posix/memory_mapping.hpp"
+#include "unix/ipc/posix/message_queue.hpp"
+#include "unix/ipc/system_v/message_queue.hpp"
+#include "unix/process.hpp"
+
+namespace
+{
+    constexpr std::size_t small_message_size{64}, large_message_size{4'096},
+        round_trip_count{100'000}, message_count{1'000'000},
+        posix_queue_capacity{10}, ring_capacity{64};
+
+    // sends and receives blocking till the message gets through
+    bool send(const unix::ipc::posix::message_queue &queue,
+              std::span<const char> message) noexcept
+    {
+        return queue.send(message).has_value();
+    }
+
+    bool receive(const unix::ipc::posix::message_queue &queue,
+                 std::span<char> buffer) noexcept
+    {
+        return queue.receive(buffer).has_value();
+    }
+
+    template <std::size_t MessageSize>
+    bool send(const unix::ipc::system_v::message_channel<MessageSize> &channel,
+              std::span<const char> message) noexcept
+    {
+        return channel.send(message).has_value();
+    }
+
+    template <std::size_t MessageSize>
+    bool receive(const unix::ipc::system_v::message_channel<MessageSize> &channel,
+                 std::span<char> buffer) noexcept
+    {
+        return channel.receive(buffer).has_value();
+    }
+
+    template <std::size_t MessageSize>
+    using ring_message_t = std::array<char, MessageSize>;
+
+    template <std::size_t MessageSize>
+    using ring_t = lock_free::ring_buffer<ring_message_t<MessageSize>, ring_capacity>;
+
+    template <std::size_t MessageSize>
+    bool send(ring_t<MessageSize> &ring, std::span<const char> message) noexcept
+    {
+        ring_message_t<MessageSize> slot;
+        std::copy_n(message.data(), std::min(message.size(), slot.size()), slot.data());
+
+        while (!ring.try_push(slot))
+        {
+            std::this_thread::yield();
+        }
+        return true;
+    }
+
+    template <std::size_t MessageSize>
+    bool receive(ring_t<MessageSize> &ring, std::span<char> buffer) noexcept
+    {
+        while (true)
+        {
+            const auto slot = ring.try_pop();
+
+            if (slot)
+            {
+                std::copy_n(slot->data(), std::min(buffer.size(), slot->size()), buffer.data());
+                return true;
+            }
+            std::this_thread::yield();
+        }
+    }
+
+    bool wait_for_child() noexcept
+    {
+        int status;
+
+        if (!unix::wait_till_child_terminates(&status) || !WIFEXITED(status) ||
+            WEXITSTATUS(status) != EXIT_SUCCESS)
+        {
+            std::println("child failed");
+            return false;
+        }
+        return true;
+    }
+
+    // half of the round trip between the parent and the child
+    template <std::size_t MessageSize, class Channel>
+    bool measure_latency(std::string_view transport, Channel &to_child,
+                         Channel &to_parent) noexcept
+    {
+        std::array<char, MessageSize> message{};
+        const auto process_created = unix::create_process();
+
+        if (!process_created)
+        {
+            std::println("failed to create process due to: {}",
+                         unix::to_string(process_created.error()).data());
+            return false;
+        }
+        if (unix::is_child_process(process_created.value()))
+        {
+            for (std::size_t i{0}; i < round_trip_count; ++i)
+            {
+                if (!receive(to_child, message) || !send(to_parent, message))
+                {
+                    _exit(EXIT_FAILURE);
+                }
+            }
+            _exit(EXIT_SUCCESS);
+        }
+        const auto start = std::chrono::steady_clock::now();
+
+        for (std::size_t i{0}; i < round_trip_count; ++i)
+        {
+            if (!send(to_child, message) || !receive(to_parent, message))
+            {
+                std::println("{}: round trip failed", transport.data());
+                return false;
+            }
+        }
+        const auto duration = std::chrono::duration<double, std::nano>(
+            std::chrono::steady_clock::now() - start);
+
+        if (!wait_for_child())
+        {
+            return false;
+        }
+        std::println("{} latency, {} B messages: {:.0f} ns one way", transport.data(),
+                     MessageSize, duration.count() / (2.0 * round_trip_count));
+        return true;
+    }
+
+    template <std::size_t MessageSize, class Channel>
+    bool measure_throughput(std::string_view transport, Channel &to_child) noexcept
+    {
+        std::array<char, MessageSize> message{};
+        const auto start = std::chrono::steady_clock::now();
+        const auto process_created = unix::create_process();
+
+        if (!process_created)
+        {
+            std::println("failed to create process due to: {}",
+                         unix::to_string(process_created.error()).data());
+            return false;
+        }
+        if (unix::is_child_process(process_created.value()))
+        {
+            for (std::size_t i{0}; i < message_count; ++i)
+            {
+                if (!receive(to_child, message))
+                {
+                    _exit(EXIT_FAILURE);
+                }
+            }
+            _exit(EXIT_SUCCESS);
+        }
+        for (std::size_t i{0}; i < message_count; ++i)
+        {
+            if (!send(to_child, message))
+            {
+                std::println("{}: send failed", transport.data());
+                return false;
+            }
+        }
+        if (!wait_for_child())
+        {
+            return false;
+        }
+        const auto duration = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start);
+        const auto messages_per_second = message_count / duration.count();
+        std::println("{} throughput, {} B messages: {:.0f} messages/s, {:.1f} MiB/s",
+                     transport.data(), MessageSize, messages_per_second,
+                     messages_per_second * MessageSize / (1'024.0 * 1'024.0));
+        return true;
+    }
+
+    template <std::size_t MessageSize, class Channel>
+    bool measure(std::string_view transport, Channel &to_child, Channel &to_parent) noexcept
+    {
+        return measure_latency<MessageSize>(transport, to_child, to_parent) &&
+               measure_throughput<MessageSize>(transport, to_child);
+    }
+
+    template <std::size_t MessageSize>
+    bool benchmark_posix_queue() noexcept
+    {
+        using unix::ipc::posix::message_queue;
+        const auto suffix = std::to_string(unix::get_process_id());
+        auto to_child_created = message_queue::create_exclusively(
+            "/benchmark_to_child_" + suffix, O_RDWR, 0600, posix_queue_capacity, MessageSize);
+        auto to_parent_created = message_queue::create_exclusively(
+            "/benchmark_to_parent_" + suffix, O_RDWR, 0600, posix_queue_capacity, MessageSize);
+
+        if (!to_child_created || !to_parent_created)
+        {
+            std::println("failed to create posix message queues");
+            return false;
+        }
+        auto &to_child = to_child_created.value();
+        auto &to_parent = to_parent_created.value();
+
+        // the open descriptors keep the queues alive
+        to_child.unlink();
+        to_parent.unlink();
+        return measure<MessageSize>("posix message queue", to_child, to_parent);
+    }
+
+    // both directions share a single queue, multiplexed by the message type
+    template <std::size_t MessageSize>
+    bool benchmark_system_v_queue() noexcept
+    {
+        using namespace unix::ipc::system_v;
+        const auto queue_created = message_queue::create_private(0600);
+
+        if (!queue_created)
+        {
+            std::println("failed to create system v message queue due to: {}",
+                         unix::to_string(queue_created.error()).data());
+            return false;
+        }
+        const auto &queue = queue_created.value();
+        message_channel<MessageSize> to_child{queue, message_type_t{1}};
+        message_channel<MessageSize> to_parent{queue, message_type_t{2}};
+        const auto measured = measure<MessageSize>("system v message queue", to_child, to_parent);
+        queue.remove();
+        return measured;
+    }
+
+    template <std::size_t MessageSize>
+    bool benchmark_ring_buffer() noexcept
+    {
+        using namespace unix::ipc::posix;
+        using ring_type = ring_t<MessageSize>;
+        auto memory_mapped = memory_mapping::create_anonymous(
+            2 * sizeof(ring_type), read_write_protection, mapping_flags_builder{}.populate().get());
+
+        if (!memory_mapped)
+        {
+            std::println("failed to map shared memory due to: {}",
+                         unix::to_string(memory_mapped.error()).data());
+            return false;
+        }
+        auto *rings = static_cast<ring_type *>(memory_mapped.value().data());
+        auto *to_child = new (rings) ring_type{};
+        auto *to_parent = new (rings + 1) ring_type{};
+        const auto measured =
+            measure<MessageSize>("shared memory ring buffer", *to_child, *to_parent);
+        to_child->~ring_type();
+        to_parent->~ring_type();
+        return measured;
+    }
+} // namespace
+
+int main(int, char **)
+{
+    if (!benchmark_posix_queue<small_message_size>() ||
+        !benchmark_posix_queue<large_message_size>() ||
+        !benchmark_system_v_queue<small_message_size>() ||
+        !benchmark_system_v_queue<large_message_size>() ||
+        !benchmark_ring_buffer<small_message_size>() ||
+        !benchmark_ring_buffer<large_message_size>())
+    {
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,196 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <print>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "lock_free/ring_buffer.hpp"
+#include "unix/error_code.hpp"
+#include "unix/ipc/posix/memory_mapping.hpp"
+#include "unix/ipc/system_v/shared_memory.hpp"
+#include "unix/numa.hpp"
+#include "unix/process.hpp"
+
+namespace
+{
+    constexpr std::size_t message_size{64}, ring_capacity{1'024}, message_count{10'000'000};
+
+    using message_t = std::array<char, message_size>;
+    using ring_t = lock_free::ring_buffer<message_t, ring_capacity>;
+
+    // where the producer, the consumer and the ring live
+    struct placement
+    {
+        std::string_view name;
+        unix::numa::node_t producer_node, consumer_node;
+        unix::numa::memory_policy policy;
+        unix::numa::node_mask memory_nodes;
+    };
+
+    bool run_on_node(unix::numa::node_t node) noexcept
+    {
+        const auto placed = unix::numa::run_on_node(node);
+
+        if (!placed)
+        {
+            std::println("failed to run on node {} due to: {}", node,
+                         unix::to_string(placed.error()).data());
+            return false;
+        }
+        return true;
+    }
+
+    bool wait_for_child() noexcept
+    {
+        int status;
+
+        if (!unix::wait_till_child_terminates(&status) || unix::terminated_abnormally(status))
+        {
+            std::println("child failed");
+            return false;
+        }
+        return true;
+    }
+
+    void consume(ring_t &ring) noexcept
+    {
+        for (std::size_t i{0}; i < message_count; ++i)
+        {
+            while (!ring.try_pop())
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    bool produce(ring_t &ring) noexcept
+    {
+        const message_t message{};
+
+        for (std::size_t i{0}; i < message_count; ++i)
+        {
+            while (!ring.try_push(message))
+            {
+                std::this_thread::yield();
+            }
+        }
+        return wait_for_child();
+    }
+
+    // the policy has to be set before the ring gets constructed,
+    // the pages are placed by the first touch
+    bool measure(const placement &setup) noexcept
+    {
+        using unix::ipc::system_v::shared_memory;
+        const auto size = (sizeof(ring_t) + unix::ipc::posix::page_size() - 1) /
+                          unix::ipc::posix::page_size() * unix::ipc::posix::page_size();
+        const auto memory_created = shared_memory::create_private(size, 0600);
+
+        if (!memory_created)
+        {
+            std::println("failed to create shared memory due to: {}",
+                         unix::to_string(memory_created.error()).data());
+            return false;
+        }
+        const auto &memory = memory_created.value();
+        auto memory_attached = memory.attach_anywhere(0);
+        memory.remove(); // destroyed once detached by both processes
+
+        if (!memory_attached)
+        {
+            std::println("failed to attach shared memory due to: {}",
+                         unix::to_string(memory_attached.error()).data());
+            return false;
+        }
+        auto *address = memory_attached.value().get();
+        const auto bound = unix::numa::bind_memory(address, size, setup.policy, setup.memory_nodes);
+
+        if (!bound)
+        {
+            std::println("failed to bind memory due to: {}", unix::to_string(bound.error()).data());
+            return false;
+        }
+        auto *ring = new (address) ring_t{};
+        const auto ring_node = unix::numa::node_of(ring);
+
+        if (!run_on_node(setup.producer_node))
+        {
+            return false;
+        }
+        const auto start = std::chrono::steady_clock::now();
+        const auto process_created = unix::create_process();
+
+        if (!process_created)
+        {
+            std::println("failed to create process due to: {}",
+                         unix::to_string(process_created.error()).data());
+            return false;
+        }
+        if (unix::is_child_process(process_created.value()))
+        {
+            if (!run_on_node(setup.consumer_node))
+            {
+                _exit(EXIT_FAILURE);
+            }
+            consume(*ring);
+            _exit(EXIT_SUCCESS);
+        }
+        if (!produce(*ring))
+        {
+            return false;
+        }
+        const auto duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+        std::println("{}: producer on node {}, consumer on node {}, ring on node {}: {:.0f} messages/s",
+                     setup.name.data(), setup.producer_node, setup.consumer_node,
+                     ring_node ? ring_node.value() : -1, message_count / duration.count());
+        ring->~ring_t();
+        return true;
+    }
+} // namespace
+
+int main(int, char **)
+{
+    using unix::numa::memory_policy;
+    using unix::numa::node_mask;
+    const auto nodes_found = unix::numa::online_nodes();
+
+    if (!nodes_found)
+    {
+        std::println("failed to read the numa topology due to: {}",
+                     unix::to_string(nodes_found.error()).data());
+        return EXIT_FAILURE;
+    }
+    std::vector<unix::numa::node_t> nodes;
+
+    for (unix::numa::node_t node{0}; static_cast<std::size_t>(node) < unix::numa::max_node_count; ++node)
+    {
+        if (nodes_found.value().contains(node))
+        {
+            nodes.push_back(node);
+        }
+    }
+    const auto local = nodes.front();
+    const auto remote = nodes.back();
+    std::vector<placement> placements{
+        {"all local", local, local, memory_policy::bind, node_mask{}.add(local)},
+        {"first touch", local, local, memory_policy::default_policy, node_mask{}}};
+
+    if (local == remote)
+    {
+        std::println("single numa node, only the local placements are measured");
+    }
+    else
+    {
+        placements.push_back({"remote memory", local, local, memory_policy::bind, node_mask{}.add(remote)});
+        placements.push_back({"remote consumer", local, remote, memory_policy::bind, node_mask{}.add(local)});
+        placements.push_back({"interleaved", local, remote, memory_policy::interleave,
+                              node_mask{}.add(local).add(remote)});
+    }
+    const auto all_measured = std::ranges::all_of(placements, measure);
+    return all_measured ? EXIT_SUCCESS : EXIT_FAILURE;
+}
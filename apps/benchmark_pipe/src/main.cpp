@@ -0,0 +1,171 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <fcntl.h>
+#include <print>
+#include <string_view>
+#include <vector>
+
+#include "unix/error_code.hpp"
+#include "unix/ipc/posix/pipe.hpp"
+#include "unix/process.hpp"
+
+namespace
+{
+    constexpr std::size_t chunk_size{256 * 1'024}, pipe_capacity{1'024 * 1'024},
+        transferred_size{std::size_t{4} * 1'024 * 1'024 * 1'024};
+    static_assert(transferred_size % chunk_size == 0);
+
+    enum class transfer_mode
+    {
+        copy,            // write + read
+        vmsplice_read,   // vmsplice + read
+        vmsplice_splice, // vmsplice + splice into /dev/null
+    };
+
+    std::string_view to_string(transfer_mode mode) noexcept
+    {
+        constexpr std::array<std::string_view, 3> names{
+            {{"write + read"}, {"vmsplice + read"}, {"vmsplice + splice"}}};
+        return names[static_cast<std::size_t>(mode)];
+    }
+
+    bool receive(const unix::ipc::posix::pipe &pipe, transfer_mode mode) noexcept
+    {
+        std::size_t remaining{transferred_size};
+
+        if (mode == transfer_mode::vmsplice_splice)
+        {
+            const auto sink = open("/dev/null", O_WRONLY);
+
+            if (unix::operation_failed(sink))
+            {
+                std::println("failed to open /dev/null due to: {}",
+                             unix::to_string(unix::error_code{errno}).data());
+                return false;
+            }
+            while (remaining > 0)
+            {
+                const auto spliced =
+                    pipe.splice_to(sink, nullptr, std::min(remaining, pipe_capacity));
+
+                if (!spliced || spliced.value() == 0)
+                {
+                    std::println("failed to splice data into /dev/null");
+                    close(sink);
+                    return false;
+                }
+                remaining -= spliced.value();
+            }
+            close(sink);
+            return true;
+        }
+        std::vector<std::byte> buffer(chunk_size);
+
+        while (remaining > 0)
+        {
+            const auto bytes_read = pipe.read(buffer.data(), buffer.size());
+
+            if (!bytes_read || bytes_read.value() == 0)
+            {
+                std::println("failed to read data from the pipe");
+                return false;
+            }
+            remaining -= bytes_read.value();
+        }
+        return true;
+    }
+
+    bool send(const unix::ipc::posix::pipe &pipe, transfer_mode mode) noexcept
+    {
+        // the chunk is never modified, so its pages can be spliced repeatedly
+        const std::vector<std::byte> chunk(chunk_size, std::byte{42});
+
+        for (std::size_t sent{0}; sent < transferred_size; sent += chunk.size())
+        {
+            const auto written = (mode == transfer_mode::copy)
+                                     ? pipe.write(chunk.data(), chunk.size())
+                                     : pipe.vmsplice(chunk.data(), chunk.size());
+
+            if (!written)
+            {
+                std::println("failed to write data into the pipe due to: {}",
+                             unix::to_string(written.error()).data());
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool measure_throughput(transfer_mode mode) noexcept
+    {
+        auto pipe_created = unix::ipc::posix::pipe::create();
+
+        if (!pipe_created)
+        {
+            std::println("failed to create pipe due to: {}",
+                         unix::to_string(pipe_created.error()).data());
+            return false;
+        }
+        auto &pipe = pipe_created.value();
+        const auto capacity_set = pipe.set_capacity(pipe_capacity);
+
+        if (!capacity_set)
+        {
+            std::println("failed to set pipe capacity due to: {}",
+                         unix::to_string(capacity_set.error()).data());
+            return false;
+        }
+        const auto start = std::chrono::steady_clock::now();
+        const auto process_created = unix::create_process();
+
+        if (!process_created)
+        {
+            std::println("failed to create process due to: {}",
+                         unix::to_string(process_created.error()).data());
+            return false;
+        }
+        if (unix::is_child_process(process_created.value()))
+        {
+            pipe.close_write_end();
+            _exit(receive(pipe, mode) ? EXIT_SUCCESS : EXIT_FAILURE);
+        }
+        pipe.close_read_end();
+
+        if (!send(pipe, mode))
+        {
+            return false;
+        }
+        pipe.close_write_end();
+        int status;
+
+        if (!unix::wait_till_child_terminates(&status) || !WIFEXITED(status) ||
+            WEXITSTATUS(status) != EXIT_SUCCESS)
+        {
+            std::println("receiver failed");
+            return false;
+        }
+        const auto duration = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start);
+        const auto gibibytes =
+            static_cast<double>(transferred_size) / (1'024.0 * 1'024.0 * 1'024.0);
+        std::println("{}: {} GiB in {:.3f} s, {:.2f} GiB/s", to_string(mode).data(),
+                     gibibytes, duration.count(), gibibytes / duration.count());
+        return true;
+    }
+} // namespace
+
+int main(int, char **)
+{
+    for (const auto mode : {transfer_mode::copy, transfer_mode::vmsplice_read,
+                            transfer_mode::vmsplice_splice})
+    {
+        if (!measure_throughput(mode))
+        {
+            return EXIT_FAILURE;
+        }
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,147 @@
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <print>
+#include <string_view>
+#include <unistd.h>
+#include <vector>
+
+#include "common/worker_pool.hpp"
+#include "unix/error_code.hpp"
+#include "unix/ipc/posix/pipe.hpp"
+#include "unix/process.hpp"
+#include "unix/spawn.hpp"
+
+namespace
+{
+    constexpr std::size_t mebibyte{1'024 * 1'024}, iteration_count{200}, worker_count{4};
+    constexpr std::array<std::size_t, 4> resident_sizes{0, 64 * mebibyte, 512 * mebibyte, 2'048 * mebibyte};
+    constexpr std::chrono::seconds termination_grace_period{5};
+    constexpr std::string_view program{"/bin/true"};
+
+    using job_t = std::size_t;
+    using result_t = std::size_t;
+
+    char *const program_args[]{const_cast<char *>(program.data()), nullptr};
+
+    bool child_succeeded(const std::expected<unix::process_id_t, unix::error_code> &created) noexcept
+    {
+        if (!created)
+        {
+            std::println("failed to create process due to: {}", unix::to_string(created.error()).data());
+            return false;
+        }
+        const auto status = unix::wait_till_child_terminates(created.value());
+        return status && !unix::terminated_abnormally(status.value());
+    }
+
+    bool fork_and_exit() noexcept
+    {
+        const auto created = unix::create_process();
+
+        if (created && unix::is_child_process(created.value()))
+        {
+            _exit(EXIT_SUCCESS);
+        }
+        return child_succeeded(created);
+    }
+
+    bool fork_and_exec() noexcept
+    {
+        const auto created = unix::create_process();
+
+        if (created && unix::is_child_process(created.value()))
+        {
+            execv(program.data(), program_args);
+            _exit(EXIT_FAILURE);
+        }
+        return child_succeeded(created);
+    }
+
+    bool vfork_and_exec() noexcept
+    {
+        return child_succeeded(unix::create_process_sharing_memory(
+            []() noexcept
+            {
+                execv(program.data(), program_args);
+                return EXIT_FAILURE;
+            }));
+    }
+
+    bool spawn_and_exec() noexcept
+    {
+        return child_succeeded(unix::spawn(program, program_args));
+    }
+
+    // a job handed to a worker forked before the parent grew
+    bool pool_round_trip(const common::worker_pool<job_t, result_t> &pool) noexcept
+    {
+        constexpr job_t job{42};
+        if (!pool.submit(job))
+        {
+            return false;
+        }
+        const auto result = pool.receive();
+        return result && result.value() == job + 1;
+    }
+
+    template <class Create>
+    bool measure(std::string_view method, std::size_t resident_size, const Create &create) noexcept
+    {
+        const auto start = std::chrono::steady_clock::now();
+
+        for (std::size_t i{0}; i < iteration_count; ++i)
+        {
+            if (!create())
+            {
+                std::println("{} failed", method.data());
+                return false;
+            }
+        }
+        const auto duration = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start);
+        std::println("{} MiB resident, {}: {:.1f} us per process", resident_size / mebibyte, method.data(),
+                     duration.count() / iteration_count);
+        return true;
+    }
+} // namespace
+
+int main(int, char **)
+{
+    auto jobs_created = unix::ipc::posix::pipe::create();
+    auto results_created = unix::ipc::posix::pipe::create();
+
+    if (!jobs_created || !results_created)
+    {
+        std::println("failed to create pipes for the worker pool");
+        return EXIT_FAILURE;
+    }
+    common::worker_pool<job_t, result_t> pool{jobs_created.value(), results_created.value()};
+
+    if (!pool.start(worker_count, [](job_t job) noexcept { return result_t{job + 1}; }))
+    {
+        pool.shut_down(termination_grace_period);
+        return EXIT_FAILURE;
+    }
+    bool all_measured{true};
+
+    for (const auto resident_size : resident_sizes)
+    {
+        // touched, so the pages are mapped and have to be copied by fork
+        std::vector<std::byte> resident(resident_size);
+        std::memset(resident.data(), 1, resident.size());
+
+        all_measured = all_measured && measure("fork + exit", resident_size, fork_and_exit) &&
+                       measure("fork + exec", resident_size, fork_and_exec) &&
+                       measure("vfork + exec", resident_size, vfork_and_exec) &&
+                       measure("posix_spawn", resident_size, spawn_and_exec) &&
+                       measure("pre-forked worker", resident_size,
+                               [&pool]() { return pool_round_trip(pool); });
+    }
+    if (!pool.shut_down(termination_grace_period) || !all_measured)
+    {
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,84 @@
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <ctime>
+#include <print>
+#include <string_view>
+#include <thread>
+
+#include "core/tsc_clock.hpp"
+
+namespace
+{
+    constexpr std::size_t stamp_count{10'000'000};
+    constexpr std::array<std::chrono::milliseconds, 3> calibration_periods{std::chrono::milliseconds{1},
+                                                                           std::chrono::milliseconds{10},
+                                                                           std::chrono::milliseconds{100}};
+    constexpr std::chrono::seconds drift_period{1};
+
+    std::uint64_t clock_nanoseconds(clockid_t clock) noexcept
+    {
+        timespec time;
+        clock_gettime(clock, &time);
+        return static_cast<std::uint64_t>(time.tv_sec) * 1'000'000'000 + static_cast<std::uint64_t>(time.tv_nsec);
+    }
+
+    // the stamps get summed so the reads are not optimized away
+    template <class Stamp>
+    void measure(std::string_view name, Stamp stamp) noexcept
+    {
+        std::uint64_t sum{0};
+        const auto start = std::chrono::steady_clock::now();
+
+        for (std::size_t index{0}; index < stamp_count; ++index)
+        {
+            sum += stamp();
+        }
+        const auto duration = std::chrono::steady_clock::now() - start;
+        const auto nanoseconds = std::chrono::duration<double, std::nano>{duration}.count();
+        std::println("{:<28} {:6.2f} ns per stamp (checksum {})", name, nanoseconds / stamp_count, sum % 10);
+    }
+
+    // how far the converted ticks are off the monotonic clock a while after the calibration
+    void measure_drift(std::chrono::milliseconds period) noexcept
+    {
+        const auto clock = core::tsc_clock::calibrate(period);
+        std::this_thread::sleep_for(drift_period);
+        const auto sample = core::tsc_clock::take_sample();
+        const auto error = clock.to_monotonic(sample.ticks) - sample.monotonic;
+        std::println("calibrated over {:>4} ms: {:.6f} ns per tick, off by {} ns after {} s", period.count(),
+                     clock.nanoseconds_per_tick(), error, drift_period.count());
+    }
+}
+
+int main(int, char **)
+{
+    std::println("invariant time stamp counter: {}", core::tsc_clock::is_invariant() ? "yes" : "no");
+
+    measure("rdtsc", [] { return core::tsc_clock::now(); });
+    measure("rdtscp", [] { return core::tsc_clock::now_ordered(); });
+    measure("CLOCK_MONOTONIC", [] { return clock_nanoseconds(CLOCK_MONOTONIC); });
+    measure("CLOCK_MONOTONIC_COARSE", [] { return clock_nanoseconds(CLOCK_MONOTONIC_COARSE); });
+    measure("CLOCK_REALTIME", [] { return clock_nanoseconds(CLOCK_REALTIME); });
+    measure("steady_clock::now", []
+    {
+        return static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+    });
+    measure("system_clock::now", []
+    {
+        return static_cast<std::uint64_t>(std::chrono::system_clock::now().time_since_epoch().count());
+    });
+    const auto &clock = core::tsc_clock::process_clock();
+    measure("rdtsc converted", [&clock]
+    {
+        return static_cast<std::uint64_t>(clock.to_monotonic(core::tsc_clock::now()));
+    });
+
+    for (const auto period : calibration_periods)
+    {
+        measure_drift(period);
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,20 @@
+#ifndef BUFFERING_LOG_HPP
+#define BUFFERING_LOG_HPP
+
+#include <cstddef>
+
+#include "async/shared_logger.hpp"
+#include "async/stdout_logger.hpp"
+
+namespace buffering
+{
+    constexpr std::size_t log_lane_capacity{16 * 1'024};
+    // one lane per process, the parent and the children log every message
+#ifdef __linux__
+    using log_t = async::shared_logger<log_lane_capacity>;
+#else
+    using log_t = async::stdout_logger;
+#endif
+} // namespace buffering
+
+#endif // BUFFERING_LOG_HPP
@@ -7,6 +7,7 @@
 #include "unix/ipc/system_v/group_notifier.hpp"
 #include "unix/process.hpp"
 
+#include "buffering/log.hpp"
 #include "buffering/process_info.hpp"
 #include "buffering/message_queue.hpp" 
 
@@ -18,11 +19,11 @@ namespace buffering::occupation
         const unix::ipc::system_v::group_notifier &message_read_notifier,
         message_queue_t &message_queue, const unix::process_id_t &process_id,
         const std::atomic<bool> &done_flag,
-        std::atomic<std::int32_t> &consumed_message_count) noexcept
+        std::atomic<std::int32_t> &consumed_message_count, log_t &log) noexcept
     {
         while (true)
         {
-            std::println("wait for message");
+            log.log<"wait for message\n">();
             const auto message_written = message_written_notifier.wait_for_one();
 
             if (done_flag.load())
@@ -39,8 +40,7 @@ namespace buffering::occupation
             }
             const auto message = message_queue.pop();
             consumed_message_count++;
-            std::println("received message: {} by child with id: {}", message.data(),
-                         process_id);
+            log.log<"received message: %s by child with id: %d\n">(message.data(), process_id);
             const auto message_read = message_read_notifier.notify_one();
 
             if (!message_read)
@@ -58,13 +58,13 @@ namespace buffering::occupation
         const unix::ipc::system_v::group_notifier &message_read_notifier,
         const unix::ipc::system_v::group_notifier &message_written_notifier,
         message_queue_t &message_queue, std::atomic<bool> &done_flag,
-        std::atomic<std::int32_t> &consumed_message_count)
+        std::atomic<std::int32_t> &consumed_message_count, log_t &log)
     {
         std::println("consume messages");
 
         if (!consume_messages(info, message_written_notifier, message_read_notifier,
                               message_queue, process_id, done_flag,
-                              consumed_message_count))
+                              consumed_message_count, log))
         {
             return false;
         }
@@ -80,18 +80,18 @@ namespace buffering::occupation
             const unix::ipc::system_v::group_notifier &message_read_notifier,
             const unix::ipc::system_v::group_notifier &message_written_notifier,
             message_queue_t &message_queue, std::atomic<bool> &done_flag,
-            std::atomic<std::int32_t> &consumed_message_count) noexcept
+            std::atomic<std::int32_t> &consumed_message_count, log_t &log) noexcept
             : info_{info}, process_id_{process_id},
               message_read_notifier_{message_read_notifier},
               message_written_notifier_{message_written_notifier},
               message_queue_{message_queue}, done_flag_{done_flag},
-              consumed_message_count_{consumed_message_count} {}
+              consumed_message_count_{consumed_message_count}, log_{log} {}
 
         bool run() noexcept
         {
             return run_consumer(info_, process_id_, message_read_notifier_,
                                 message_written_notifier_, message_queue_, done_flag_,
-                                consumed_message_count_);
+                                consumed_message_count_, log_);
         }
 
     private:
@@ -104,6 +104,7 @@ namespace buffering::occupation
         std::reference_wrapper<message_queue_t> message_queue_;
         std::reference_wrapper<std::atomic<bool>> done_flag_;
         std::reference_wrapper<std::atomic<std::int32_t>> consumed_message_count_;
+        std::reference_wrapper<log_t> log_;
     };
 }
 
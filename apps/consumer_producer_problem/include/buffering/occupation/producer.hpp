@@ -7,8 +7,10 @@
 #include "unix/ipc/system_v/group_notifier.hpp"
 #include "unix/process.hpp"
 
+#include "buffering/log.hpp"
 #include "buffering/process_info.hpp"
 #include "buffering/message_queue.hpp"
+#include "buffering/stall_detection.hpp"
 
 namespace buffering::occupation
 {
@@ -30,7 +32,7 @@ namespace buffering::occupation
         const unix::ipc::system_v::group_notifier &message_read_notifier,
         const unix::ipc::system_v::group_notifier &message_written_notifier,
         message_queue_t &message_queue,
-        std::atomic<std::int32_t> &produced_message_count) noexcept
+        std::atomic<std::int32_t> &produced_message_count, log_t &log) noexcept
     {
         message_t message;
 
@@ -48,36 +50,35 @@ namespace buffering::occupation
             message_queue.push(message);
             produced_message_count++;
 
-            std::println("message written into shared memeory by producer: {}",
-                         info.group_id);
-            const auto message_written = message_written_notifier.notify_one();
+            log.log<"message written into shared memory by producer: %zu\n">(info.group_id);
+            // the consumers are woken up only once a slot for the next message is free,
+            // no slot getting free till the timeout means the consumers stalled
+            const auto message_written_and_read =
+                message_written_notifier.notify_one_and_wait_for_one_for(message_read_notifier,
+                                                                         stall_timeout);
 
-            if (!message_written)
+            if (!message_written_and_read)
             {
                 std::println(
-                    "failed to send signal about message being written due to: {}",
-                    unix::to_string(message_written.error()).data());
-                return false;
-            }
-            const auto message_read = message_read_notifier.wait_for_one();
-
-            if (!message_read)
-            {
-                std::println(
-                    "failed to receive signal about message being read due to: {}",
-                    unix::to_string(message_read.error()).data());
+                    "failed to signal message being written and wait for message being read due to: {}",
+                    unix::to_string(message_written_and_read.error()).data());
                 return false;
             }
         }
         return true;
     }
 
+    // the producers start one after another as the previous ones complete
     bool wait_till_production_start(
-        const unix::ipc::system_v::group_notifier &producers_notifier) noexcept
+        const unix::ipc::system_v::group_notifier &producers_notifier,
+        const std::atomic<std::int32_t> &produced_message_count) noexcept
     {
-        const auto start_production = producers_notifier.wait_for_one();
+        const auto start_production = [&producers_notifier](const auto &timeout)
+        {
+            return producers_notifier.wait_for_one_for(timeout);
+        };
 
-        if (!start_production)
+        if (!wait_while_progressing(start_production, produced_message_count))
         {
             std::println("failed to receive starting signal from the parent");
             return false;
@@ -91,20 +92,20 @@ namespace buffering::occupation
         const unix::ipc::system_v::group_notifier &message_read_notifier,
         const unix::ipc::system_v::group_notifier &message_written_notifier,
         message_queue_t &message_queue,
-        std::atomic<std::int32_t> &produced_message_count) noexcept
+        std::atomic<std::int32_t> &produced_message_count, log_t &log) noexcept
     {
         std::println("wait till production start");
 
-        if (!wait_till_production_start(producers_notifier))
+        if (!wait_till_production_start(producers_notifier, produced_message_count))
         {
-            return EXIT_FAILURE;
+            return false;
         }
         std::println("production started");
         std::println("produce messages");
 
         if (!produce_messages(info, message_count, message_read_notifier,
                               message_written_notifier, message_queue,
-                              produced_message_count))
+                              produced_message_count, log))
         {
             return false;
         }
@@ -128,19 +129,19 @@ namespace buffering::occupation
             const unix::ipc::system_v::group_notifier &message_read_notifier,
             const unix::ipc::system_v::group_notifier &message_written_notifier,
             message_queue_t &message_queue,
-            std::atomic<std::int32_t> &produced_message_count) noexcept
+            std::atomic<std::int32_t> &produced_message_count, log_t &log) noexcept
             : info_{info}, message_count_{message_count},
               producers_notifier_{producers_notifier},
               message_read_notifier_{message_read_notifier},
               message_written_notifier_{message_written_notifier},
               message_queue_{message_queue},
-              produced_message_count_{produced_message_count} {}
+              produced_message_count_{produced_message_count}, log_{log} {}
 
         bool run() noexcept
         {
             return run_producer(info_, message_count_, producers_notifier_,
                                 message_read_notifier_, message_written_notifier_,
-                                message_queue_, produced_message_count_);
+                                message_queue_, produced_message_count_, log_);
         }
 
     private:
@@ -154,6 +155,7 @@ namespace buffering::occupation
             message_written_notifier_;
         std::reference_wrapper<message_queue_t> message_queue_;
         std::reference_wrapper<std::atomic<std::int32_t>> produced_message_count_;
+        std::reference_wrapper<log_t> log_;
     };
 }
 
@@ -47,6 +47,12 @@ namespace buffering
                 {
                     std::println("created child process with id: {}",
                                  process_created.value());
+                    info.child_ids.push_back(process_created.value());
+
+                    if (info.is_producer)
+                    {
+                        info.producer_ids.push_back(process_created.value());
+                    }
                 }
                 else
                 {
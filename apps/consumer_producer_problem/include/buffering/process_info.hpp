@@ -2,6 +2,9 @@
 #define BUFFERING_PROCESS_INFO_HPP
 
 #include <cstddef>
+#include <vector>
+
+#include "unix/process.hpp"
 
 namespace buffering
 {
@@ -11,6 +14,9 @@ namespace buffering
         bool is_child{false};
         bool is_producer{false};
         std::size_t group_id{0};
+        std::vector<unix::process_id_t> child_ids;
+        // the children among child_ids which produce
+        std::vector<unix::process_id_t> producer_ids;
     };
 }
 
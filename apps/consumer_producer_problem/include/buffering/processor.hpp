@@ -5,6 +5,7 @@
 
 #include "unix/process.hpp"
 
+#include "buffering/log.hpp"
 #include "buffering/occupation.hpp"
 #include "buffering/process_info.hpp"
 #include "buffering/role.hpp"
@@ -20,7 +21,7 @@ namespace buffering
 
         bool process() noexcept
         {
-            if (!std::visit([](const auto &r)
+            if (!std::visit([](auto &r)
                             { return r.setup(); }, role_))
             {
                 return false;
@@ -28,6 +29,8 @@ namespace buffering
             if (!std::visit([](auto &o)
                             { return o.run(); }, occupation_))
             {
+                std::visit([](auto &r)
+                           { return r.abort(); }, role_);
                 return false;
             }
             if (!std::visit([](auto &r)
@@ -50,10 +53,11 @@ namespace buffering
         const unix::ipc::system_v::group_notifier &message_read_notifier,
         const unix::ipc::system_v::group_notifier &children_readiness_notifier,
         const unix::ipc::system_v::group_notifier &producers_notifier,
+        const unix::ipc::system_v::group_notifier &producer_token_notifier,
         std::atomic<bool> &done_flag,
         std::atomic<std::int32_t> &produced_message_count,
         std::atomic<std::int32_t> &consumed_message_count,
-        buffering::message_queue_t &message_queue) noexcept
+        buffering::message_queue_t &message_queue, log_t &log) noexcept
     {
         buffering::role_t role;
 
@@ -67,6 +71,7 @@ namespace buffering
                                            children_readiness_notifier,
                                            producers_notifier,
                                            message_written_notifier,
+                                           message_read_notifier,
                                            consumed_message_count,
                                            produced_message_count,
                                            done_flag};
@@ -77,11 +82,12 @@ namespace buffering
         {
             occupation = buffering::occupation::producer{info,
                                                          message_count,
-                                                         producers_notifier,
+                                                         producer_token_notifier,
                                                          message_read_notifier,
                                                          message_written_notifier,
                                                          message_queue,
-                                                         produced_message_count};
+                                                         produced_message_count,
+                                                         log};
         }
         else
         {
@@ -91,7 +97,8 @@ namespace buffering
                                                          message_written_notifier,
                                                          message_queue,
                                                          done_flag,
-                                                         consumed_message_count};
+                                                         consumed_message_count,
+                                                         log};
         }
         return processor{role, occupation};
     }
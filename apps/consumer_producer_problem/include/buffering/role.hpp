@@ -12,6 +12,7 @@ namespace buffering
     {
         bool setup() const noexcept { return true; }
         bool finalize() noexcept { return true; }
+        bool abort() const noexcept { return true; }
     };
 
     using role_t = std::variant<no_role, role::child, role::parent>;
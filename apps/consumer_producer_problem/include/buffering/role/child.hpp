@@ -39,6 +39,8 @@ namespace buffering::role
 
         bool finalize() const noexcept { return true; }
 
+        bool abort() const noexcept { return true; }
+
     private:
         unix::process_id_t process_id_;
         std::reference_wrapper<const unix::ipc::system_v::group_notifier>
@@ -4,6 +4,8 @@
 #include <atomic>
 #include <functional>
 #include <print>
+#include <span>
+#include <vector>
 
 #include "unix/ipc/system_v/group_notifier.hpp"
 #include "unix/signal.hpp"
@@ -12,7 +14,9 @@
 
 #include "common/process.hpp"
 
+#include "buffering/message_queue.hpp"
 #include "buffering/process_info.hpp"
+#include "buffering/stall_detection.hpp"
 
 namespace buffering::role
 {
@@ -32,54 +36,116 @@ namespace buffering::role
         return true;
     }
 
-    bool wait_till_all_messages_consumed(const unix::ipc::system_v::group_notifier
-                                             &message_written_notifier) noexcept
+    // a child terminating abnormally will never do its share of the protocol
+    bool children_healthy() noexcept
     {
-        const auto all_consumed = message_written_notifier.wait_till_none();
+        if (common::reap_terminated_children() != 0)
+        {
+            std::println("child terminated abnormally");
+            return false;
+        }
+        return true;
+    }
 
-        if (!all_consumed)
+    // every read notification follows the consumed message being counted,
+    // so all the slots are free again once all the messages got consumed
+    bool wait_till_all_messages_consumed(
+        const unix::ipc::system_v::group_notifier &message_read_notifier,
+        const std::atomic<std::int32_t> &consumed_message_count) noexcept
+    {
+        const auto all_consumed = [&message_read_notifier](const auto &timeout)
         {
-            std::println("failed waiting for all messages to be consumed due to: {}",
-                         unix::to_string(all_consumed.error()).data());
+            return message_read_notifier.wait_till_at_least_for(
+                static_cast<unix::ipc::system_v::semaphore_value_t>(message_queue_t::capacity()),
+                timeout);
+        };
+
+        if (!wait_while_progressing(all_consumed, consumed_message_count, children_healthy))
+        {
+            std::println("failed waiting for all messages to be consumed");
             return false;
         }
         return true;
     }
 
-    bool wait_till_production_complete(
-        const unix::ipc::system_v::group_notifier &producers_notifier) noexcept
+    // the kernel gives back the token of a crashed producer as well, so the
+    // producers terminating right after their production have to exit cleanly
+    bool producers_succeeded(std::span<const unix::process_id_t> producer_ids) noexcept
     {
-        const auto production_stopped = producers_notifier.wait_for_all();
+        std::vector<unix::process_id_t> running{producer_ids.begin(), producer_ids.end()};
+        std::size_t abnormal_count{0};
 
-        if (!production_stopped)
+        if (!common::wait_till_children_terminate_for(running, abnormal_count, stall_timeout))
         {
-            std::println(
-                "failed to receive confirmation that production has stopped: {}",
-                unix::to_string(production_stopped.error()).data());
+            std::println("producers still running after their production completed");
+            return false;
+        }
+        if (abnormal_count != 0)
+        {
+            std::println("{} producers terminated abnormally", abnormal_count);
             return false;
         }
         return true;
     }
 
+    bool wait_till_production_complete(
+        const unix::ipc::system_v::group_notifier &producers_notifier,
+        const std::atomic<std::int32_t> &produced_message_count,
+        std::span<const unix::process_id_t> producer_ids) noexcept
+    {
+        const auto production_stopped = [&producers_notifier](const auto &timeout)
+        {
+            return producers_notifier.wait_for_all_for(timeout);
+        };
+
+        if (!wait_while_progressing(production_stopped, produced_message_count,
+                                    children_healthy))
+        {
+            std::println("failed to receive confirmation that production has stopped");
+            return false;
+        }
+        return producers_succeeded(producer_ids);
+    }
+
+    // the consumers observe the done flag once woken up, the producers give up
+    // after the stall timeout, whoever is left after the grace period gets killed
+    bool shut_down_children(
+        const process_info &info,
+        const unix::ipc::system_v::group_notifier &message_written_notifier,
+        std::atomic<bool> &done_flag) noexcept
+    {
+        const auto wake_survivors = [&message_written_notifier, &done_flag]()
+        {
+            stop_consumption(message_written_notifier, done_flag);
+        };
+        return common::shut_down_children(info.child_ids, wake_survivors,
+                                          termination_grace_period);
+    }
+
     bool finalize_parent_process(
+        const process_info &info,
         const unix::ipc::system_v::group_notifier &producers_notifier,
         const unix::ipc::system_v::group_notifier &message_written_notifier,
+        const unix::ipc::system_v::group_notifier &message_read_notifier,
         const std::atomic<std::int32_t> &consumed_message_count,
         const std::atomic<std::int32_t> &produced_message_count,
         std::atomic<bool> &done_flag) noexcept
     {
         std::println("wait for all production to complete");
 
-        if (!wait_till_production_complete(producers_notifier))
+        if (!wait_till_production_complete(producers_notifier, produced_message_count,
+                                           info.producer_ids))
         {
-            return EXIT_FAILURE;
+            shut_down_children(info, message_written_notifier, done_flag);
+            return false;
         }
         std::println("all producers done");
         std::println("wait till all messages consumed");
 
-        if (!wait_till_all_messages_consumed(message_written_notifier))
+        if (!wait_till_all_messages_consumed(message_read_notifier, consumed_message_count))
         {
-            return EXIT_FAILURE;
+            shut_down_children(info, message_written_notifier, done_flag);
+            return false;
         }
         std::println("all messages consumed");
         std::println("consumed message count: {}",
@@ -91,13 +157,15 @@ namespace buffering::role
 
         if (!stop_consumption(message_written_notifier, done_flag))
         {
+            shut_down_children(info, message_written_notifier, done_flag);
             return false;
         }
         std::println("message consumption stopped");
         std::println("wait for all children to terminate");
 
-        if (!common::wait_till_all_children_termninate())
+        if (!common::wait_till_all_children_terminate_for(stall_timeout))
         {
+            shut_down_children(info, message_written_notifier, done_flag);
             return false;
         }
         std::println("all done");
@@ -121,12 +189,16 @@ namespace buffering::role
     bool setup_parent_process(
         const process_info &info,
         const unix::ipc::system_v::group_notifier &children_readiness_notifier,
-        const unix::ipc::system_v::group_notifier &producers_notifier) noexcept
+        const unix::ipc::system_v::group_notifier &producers_notifier,
+        const unix::ipc::system_v::group_notifier &message_written_notifier,
+        std::atomic<bool> &done_flag) noexcept
     {
         std::println("wait till all children process are ready");
 
-        if (!common::wait_till_all_children_ready(children_readiness_notifier))
+        if (!common::wait_till_all_children_ready(children_readiness_notifier,
+                                                  stall_timeout))
         {
+            shut_down_children(info, message_written_notifier, done_flag);
             return false;
         }
         std::println("all child processes are ready");
@@ -134,6 +206,7 @@ namespace buffering::role
 
         if (!start_production(producers_notifier))
         {
+            shut_down_children(info, message_written_notifier, done_flag);
             return false;
         }
         std::println("message production started");
@@ -148,6 +221,7 @@ namespace buffering::role
             const unix::ipc::system_v::group_notifier &children_readiness_notifier,
             const unix::ipc::system_v::group_notifier &producers_notifier,
             const unix::ipc::system_v::group_notifier &message_written_notifier,
+            const unix::ipc::system_v::group_notifier &message_read_notifier,
             const std::atomic<std::int32_t> &consumed_message_count,
             const std::atomic<std::int32_t> &produced_message_count,
             std::atomic<bool> &done_flag) noexcept
@@ -155,23 +229,32 @@ namespace buffering::role
               children_readiness_notifier_{std::cref(children_readiness_notifier)},
               producers_notifier_{std::cref(producers_notifier)},
               message_written_notifier_{std::cref(message_written_notifier)},
+              message_read_notifier_{std::cref(message_read_notifier)},
               consumed_message_count_{std::cref(consumed_message_count)},
               produced_message_count_{std::cref(produced_message_count)},
               done_flag_{std::ref(done_flag)} {}
 
-        bool setup() const noexcept
+        bool setup() noexcept
         {
             return setup_parent_process(info_, children_readiness_notifier_,
-                                        producers_notifier_);
+                                        producers_notifier_, message_written_notifier_,
+                                        done_flag_);
         }
 
         bool finalize() noexcept
         {
             return finalize_parent_process(
-                producers_notifier_, message_written_notifier_, consumed_message_count_,
+                info_, producers_notifier_, message_written_notifier_, message_read_notifier_,
+                consumed_message_count_,
                 produced_message_count_, done_flag_);
         }
 
+        // the parent's own occupation failed, the children would wait for it forever
+        bool abort() noexcept
+        {
+            return shut_down_children(info_, message_written_notifier_, done_flag_);
+        }
+
     private:
         process_info info_;
         std::reference_wrapper<const unix::ipc::system_v::group_notifier>
@@ -180,6 +263,8 @@ namespace buffering::role
             producers_notifier_;
         std::reference_wrapper<const unix::ipc::system_v::group_notifier>
             message_written_notifier_;
+        std::reference_wrapper<const unix::ipc::system_v::group_notifier>
+            message_read_notifier_;
         std::reference_wrapper<const std::atomic<std::int32_t>>
             consumed_message_count_;
         std::reference_wrapper<const std::atomic<std::int32_t>>
@@ -0,0 +1,76 @@
+#ifndef BUFFERING_STALL_DETECTION_HPP
+#define BUFFERING_STALL_DETECTION_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <errno.h>
+#include <print>
+
+#include "unix/error_code.hpp"
+
+namespace buffering
+{
+    // no progress for this long is treated as a stall
+    constexpr std::chrono::seconds stall_timeout{10};
+    // how often the health of the other processes gets checked while waiting
+    constexpr std::chrono::milliseconds health_check_interval{100};
+    // time for the children to terminate on their own before being killed
+    constexpr std::chrono::seconds termination_grace_period{5};
+
+    // keeps waiting as long as the progress counter changes within the stall timeout
+    // and the health check passes
+    template <class TimedWait, class HealthCheck>
+    bool wait_while_progressing(const TimedWait &timed_wait,
+                                const std::atomic<std::int32_t> &progress,
+                                const HealthCheck &healthy,
+                                std::chrono::milliseconds timeout = stall_timeout) noexcept
+    {
+        auto last_progress = progress.load(std::memory_order_relaxed);
+        auto last_progress_time = std::chrono::steady_clock::now();
+
+        while (true)
+        {
+            const auto waited = timed_wait(health_check_interval);
+
+            if (waited)
+            {
+                return true;
+            }
+            if (waited.error().code != EAGAIN)
+            {
+                std::println("failed waiting due to: {}",
+                             unix::to_string(waited.error()).data());
+                return false;
+            }
+            if (!healthy())
+            {
+                return false;
+            }
+            const auto current_progress = progress.load(std::memory_order_relaxed);
+            const auto now = std::chrono::steady_clock::now();
+
+            if (current_progress != last_progress)
+            {
+                last_progress = current_progress;
+                last_progress_time = now;
+            }
+            else if (now - last_progress_time >= timeout)
+            {
+                std::println("no progress for {} ms, stalled at: {}", timeout.count(),
+                             current_progress);
+                return false;
+            }
+        }
+    }
+
+    template <class TimedWait>
+    bool wait_while_progressing(const TimedWait &timed_wait,
+                                const std::atomic<std::int32_t> &progress) noexcept
+    {
+        return wait_while_progressing(timed_wait, progress, []()
+                                      { return true; });
+    }
+} // namespace buffering
+
+#endif // BUFFERING_STALL_DETECTION_HPP
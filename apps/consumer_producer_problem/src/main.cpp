@@ -7,6 +7,8 @@
 #include <span>
 #include <variant>
 
+#include "common/placement.hpp"
+
 #include "lock_free/ring_buffer.hpp"
 #include "core/string_literal.hpp"
 #include "unix/error_code.hpp"
@@ -18,6 +20,7 @@
 #include "unix/resource_remover.hpp"
 #include "unix/resource_destroyer.hpp"
 
+#include "buffering/log.hpp"
 #include "buffering/message_queue.hpp"
 #include "buffering/occupation.hpp"
 #include "buffering/process_creation.hpp"
@@ -26,9 +29,10 @@
 #include "buffering/role.hpp"
 #include "buffering/shared_data.hpp"
 
-int main(int, char **)
+int main(int argc, char **argv)
 {
     using namespace unix::ipc;
+    const auto args = std::span<char *const>{argv, static_cast<std::size_t>(argc)};
 
     constexpr std::size_t semaphore_count{4}, readiness_sem_index{0},
         written_message_sem_index{1}, read_message_sem_index{2},
@@ -89,6 +93,10 @@ int main(int, char **)
         semaphores, readiness_sem_index, children_count};
     const auto producers_notifier = unix::ipc::system_v::group_notifier{
         semaphores, producer_sem_index, producer_count};
+    // a producer holds a token while producing, the kernel gives it back
+    // when the producer crashes, so the waiting parent is not skewed
+    const auto producer_token_notifier =
+        producers_notifier.with_undo_policy(system_v::undo_policy::undo_on_exit);
 
     std::array<unsigned short, semaphore_count> init_values = {
         0, 0, buffering::message_queue_t::capacity(), 0};
@@ -100,6 +108,16 @@ int main(int, char **)
         return EXIT_FAILURE;
     }
     std::println("semaphores initialized");
+    // created before the children, so they share the lanes and the formats
+    auto log_created = buffering::log_t::create();
+
+    if (!log_created)
+    {
+        std::println("failed to create the log due to: {}",
+                     unix::to_string(log_created.error()).data());
+        return EXIT_FAILURE;
+    }
+    auto &log = log_created.value();
     const auto info = buffering::create_child_processes(child_producer_count,
                                                         child_consumer_count);
 
@@ -121,6 +139,12 @@ int main(int, char **)
         shared_memory_remover.release();
         semaphore_remover.release();
     }
+
+    // the parent produces as well
+    if (!common::place_by_role(args, info.is_producer ? "producer" : "consumer"))
+    {
+        return EXIT_FAILURE;
+    }
     auto memory_attached = shared_memory.attach_anywhere(0);
 
     if (!memory_attached)
@@ -146,8 +170,9 @@ int main(int, char **)
     auto processor = buffering::create_processor(
         info, process_id, message_count, message_written_notifier,
         message_read_notifier, children_readiness_notifier, producers_notifier,
+        producer_token_notifier,
         data->done_flag, data->produced_message_count,
-        data->consumed_message_count, data->message_queue);
+        data->consumed_message_count, data->message_queue, log);
 
     if (!processor.process())
     {
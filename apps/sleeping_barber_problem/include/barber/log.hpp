@@ -0,0 +1,20 @@
+#ifndef BARBER_LOG_HPP
+#define BARBER_LOG_HPP
+
+#include <cstddef>
+
+#include "async/shared_logger.hpp"
+#include "async/stdout_logger.hpp"
+
+namespace barber
+{
+    constexpr std::size_t log_lane_capacity{4 * 1'024};
+    // the barber and the customer generators log every customer
+#ifdef __linux__
+    using log_t = async::shared_logger<log_lane_capacity>;
+#else
+    using log_t = async::stdout_logger;
+#endif
+} // namespace barber
+
+#endif // BARBER_LOG_HPP
@@ -9,13 +9,14 @@
 #include "unix/ipc/system_v/group_notifier.hpp"
 
 #include "barber/customer_queue.hpp"
+#include "barber/log.hpp"
 
 namespace barber::occupation
 {
     void trim_hair(customer_t customer, std::chrono::milliseconds trimming_duration,
-                   std::atomic<std::int32_t> &served_customers) noexcept
+                   std::atomic<std::int32_t> &served_customers, log_t &log) noexcept
     {
-        std::println("trimming customer: {} hair", customer);
+        log.log<"trimming customer: %d hair\n">(customer);
         std::this_thread::sleep_for(trimming_duration);
         served_customers.fetch_add(1, std::memory_order_relaxed);
     }
@@ -26,11 +27,11 @@ namespace barber::occupation
         const unix::ipc::system_v::group_notifier &empty_chair_notifier,
         customer_queue_t &customer_queue, const std::atomic<bool> &shop_closed,
         std::atomic<std::int32_t> &served_customers,
-        GetSleepingDuration &get_haircut_duration) noexcept
+        GetSleepingDuration &get_haircut_duration, log_t &log) noexcept
     {
         while (true)
         {
-            std::println("waiting for customer");
+            log.log<"waiting for customer\n">();
             const auto customer_waiting = customer_waiting_notifier.wait_for_one();
 
             if (shop_closed.load(std::memory_order_relaxed))
@@ -45,7 +46,7 @@ namespace barber::occupation
                     {
                         trim_hair(possible_customer.value(),
                                   std::chrono::milliseconds{get_haircut_duration()},
-                                  served_customers);
+                                  served_customers, log);
                     }
                 }
                 break;
@@ -58,7 +59,7 @@ namespace barber::occupation
             }
             const auto customer = customer_queue.pop();
             trim_hair(customer, std::chrono::milliseconds{get_haircut_duration()},
-                      served_customers);
+                      served_customers, log);
             const auto &empty_chair = empty_chair_notifier.notify_one();
 
             if (!empty_chair)
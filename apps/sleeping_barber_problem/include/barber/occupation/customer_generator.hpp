@@ -10,6 +10,7 @@
 #include "unix/ipc/system_v/group_notifier.hpp"
 
 #include "barber/customer_queue.hpp"
+#include "barber/log.hpp"
 
 namespace barber::occupation
 {
@@ -20,7 +21,7 @@ namespace barber::occupation
         customer_queue_t &customer_queue, std::atomic<customer_t> &next_customer_id,
         const std::atomic<bool> &shop_closed,
         std::atomic<std::int32_t> &refused_customers,
-        GetSleepingDuration &get_customer_arrival_duration) noexcept
+        GetSleepingDuration &get_customer_arrival_duration, log_t &log) noexcept
     {
         while (true)
         {
@@ -44,12 +45,12 @@ namespace barber::occupation
                                  unix::to_string(empty_chair.error()).data());
                     return false;
                 }
-                std::println("all chairs occupied, refusing customer: {}", customer);
+                log.log<"all chairs occupied, refusing customer: %d\n">(customer);
                 refused_customers.fetch_add(1, std::memory_order_relaxed);
             }
             else
             {
-                std::println("adding customer: {}", customer);
+                log.log<"adding customer: %d\n">(customer);
                 customer_queue.push(customer);
                 const auto customer_waiting = customer_waiting_notifier.notify_one();
 
@@ -2,6 +2,9 @@
 #define BARBER_PROCESS_INFO_HPP
 
 #include <cstddef>
+#include <vector>
+
+#include "unix/process.hpp"
 
 namespace barber
 {
@@ -11,6 +14,7 @@ namespace barber
         bool is_barber{false};
         std::size_t created_process_count{0};
         std::size_t group_id{0};
+        std::vector<unix::process_id_t> child_ids;
     };
 } // namespace barber
 
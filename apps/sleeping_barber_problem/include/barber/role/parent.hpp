@@ -48,6 +48,7 @@ namespace barber::role
                 {
                     std::println("created child process with id: {}",
                                  process_created.value());
+                    info.child_ids.push_back(process_created.value());
                 }
                 else
                 {
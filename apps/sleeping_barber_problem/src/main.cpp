@@ -2,8 +2,10 @@
 #include <cstdint>
 #include <optional>
 #include <print>
+#include <span>
 #include <thread>
 
+#include "common/placement.hpp"
 #include "common/process.hpp"
 
 #include "core/random_integer_generator.hpp"
@@ -20,14 +22,16 @@
 #include "unix/ipc/system_v/shared_memory.hpp"
 
 #include "barber/customer_queue.hpp"
+#include "barber/log.hpp"
 #include "barber/occupation/barber.hpp"
 #include "barber/occupation/customer_generator.hpp"
 #include "barber/role/parent.hpp"
 #include "barber/shared_data.hpp"
 
-int main(int, char **)
+int main(int argc, char **argv)
 {
     std::println("sleeping barber problem");
+    const auto args = std::span<char *const>{argv, static_cast<std::size_t>(argc)};
 
     constexpr std::size_t barber_count{1}, customer_generator_count{5},
         children_count{barber_count + customer_generator_count}, sem_count{3},
@@ -37,6 +41,9 @@ int main(int, char **)
         min_customer_arrival_duration{200},
         max_customer_arrival_duration{min_customer_arrival_duration * 10};
     constexpr std::chrono::milliseconds shop_open_duration{60'000};
+    // bounds how long the parent waits for the children before shutting them down
+    constexpr std::chrono::seconds stall_timeout{10}, termination_grace_period{5};
+    constexpr std::chrono::milliseconds health_check_interval{100};
 
     constexpr auto perms = unix::permissions_builder{}
                                .owner_can_read()
@@ -98,6 +105,17 @@ int main(int, char **)
                              unix::ipc::system_v::shared_memory>
         shared_memory_remover{&shared_memory};
 
+    // created before the children, so they share the lanes and the formats
+    auto log_created = barber::log_t::create();
+
+    if (!log_created)
+    {
+        std::println("failed to create the log due to: {}",
+                     unix::to_string(log_created.error()).data());
+        return EXIT_FAILURE;
+    }
+    auto &log = log_created.value();
+
     const auto info = barber::role::create_child_processes(
         barber_count, customer_generator_count);
 
@@ -115,6 +133,12 @@ int main(int, char **)
         shared_memory_remover.release();
         semaphores_remover.release();
     }
+    const auto role = !info.is_child ? "parent" : info.is_barber ? "barber" : "customer";
+
+    if (!common::place_by_role(args, role))
+    {
+        return EXIT_FAILURE;
+    }
     auto memory_attached = shared_memory.attach_anywhere(0);
 
     if (!memory_attached)
@@ -139,8 +163,10 @@ int main(int, char **)
     }
     else
     {
-        if (!common::wait_till_all_children_ready(children_readiness_notifier))
+        if (!common::wait_till_all_children_ready(children_readiness_notifier,
+                                                  stall_timeout))
         {
+            common::terminate_children(info.child_ids, termination_grace_period);
             return EXIT_FAILURE;
         }
     }
@@ -161,7 +187,7 @@ int main(int, char **)
             if (!barber::occupation::serve_customer(
                     customer_waiting_notifier, empty_chair_notifier,
                     data->customer_queue, data->shop_closed, data->served_customers,
-                    get_haircut_duration))
+                    get_haircut_duration, log))
             {
                 return EXIT_FAILURE;
             }
@@ -175,7 +201,7 @@ int main(int, char **)
             if (!barber::occupation::generate_customers(
                     customer_waiting_notifier, empty_chair_notifier,
                     data->customer_queue, data->next_customer_id, data->shop_closed,
-                    data->refused_customers, get_customer_arrival_duration))
+                    data->refused_customers, get_customer_arrival_duration, log))
             {
                 return EXIT_FAILURE;
             }
@@ -183,15 +209,32 @@ int main(int, char **)
     }
     else
     {
-        std::this_thread::sleep_for(shop_open_duration);
+        const auto closing_time = std::chrono::steady_clock::now() + shop_open_duration;
+        bool child_crashed{false};
+
+        // a crashed barber would leave the customers waiting forever
+        while (!child_crashed && std::chrono::steady_clock::now() < closing_time)
+        {
+            std::this_thread::sleep_for(health_check_interval);
+            child_crashed = common::reap_terminated_children() != 0;
+        }
+        if (child_crashed)
+        {
+            std::println("child terminated abnormally, closing the shop early");
+        }
         std::println("barber shop closing");
 
-        data->shop_closed.store(true);
-        empty_chair_notifier.notify_all();
-        customer_waiting_notifier.notify_all();
+        const auto close_shop = [&]()
+        {
+            data->shop_closed.store(true);
+            empty_chair_notifier.notify_all();
+            customer_waiting_notifier.notify_all();
+        };
         std::println("waiting for all children to terminate");
 
-        if (!common::wait_till_all_children_termninate())
+        // the barber finishes the waiting customers first
+        if (!common::shut_down_children(info.child_ids, close_shop, stall_timeout) ||
+            child_crashed)
         {
             return EXIT_FAILURE;
         }
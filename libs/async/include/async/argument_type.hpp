@@ -0,0 +1,133 @@
+#ifndef ASYNC_ARGUMENT_TYPE_HPP
+#define ASYNC_ARGUMENT_TYPE_HPP
+
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace async
+{
+    // enough for the decoder to interpret the argument bytes
+    // without knowing the types they were logged with
+    enum class argument_type : std::uint8_t
+    {
+        boolean,
+        character,
+        signed_integer,
+        unsigned_integer,
+        floating_point,
+        pointer,
+        // the characters themselves, not their address
+        string,
+        // serialized by the argument_traits of a user type
+        custom
+    };
+
+    // the strings and the custom arguments are prefixed by their length
+    using argument_length_t = std::uint32_t;
+
+    struct argument_descriptor
+    {
+        argument_type type;
+        // zero for the length prefixed arguments
+        std::uint8_t size;
+        // the name of the custom type, it picks the decoder of the arguments
+        std::string_view name{};
+    };
+
+    // specialized by the user types that get logged, the decoder renders them with %s:
+    //
+    // template <>
+    // struct async::argument_traits<point>
+    // {
+    //     static constexpr std::string_view name{"point"};
+    //     static std::size_t size(const point &value) noexcept;
+    //     static void encode(const point &value, std::span<std::byte> bytes) noexcept;
+    //     static void decode(std::span<const std::byte> bytes, std::string &output) noexcept;
+    // };
+    //
+    // encode fills exactly size bytes, decode appends the text to the output,
+    // it runs in the decoder, which has to be built with the specialization
+    template <class Value>
+    struct argument_traits;
+
+    template <class Value>
+    concept custom_argument = requires(const Value &value, std::span<std::byte> bytes,
+                                       std::span<const std::byte> encoded, std::string &output) {
+        { argument_traits<Value>::name } -> std::convertible_to<std::string_view>;
+        { argument_traits<Value>::size(value) } -> std::same_as<std::size_t>;
+        argument_traits<Value>::encode(value, bytes);
+        argument_traits<Value>::decode(encoded, output);
+    };
+
+    // the character pointers are taken for null terminated strings
+    template <class Value>
+    concept string_argument = std::same_as<Value, std::string> || std::same_as<Value, std::string_view> ||
+                              std::same_as<Value, const char *> || std::same_as<Value, char *>;
+
+    template <class Value>
+    constexpr argument_descriptor describe_argument() noexcept
+    {
+        using value_type = std::remove_cvref_t<Value>;
+
+        if constexpr (string_argument<value_type>)
+        {
+            return {argument_type::string, 0};
+        }
+        else if constexpr (custom_argument<value_type>)
+        {
+            static_assert(std::string_view{argument_traits<value_type>::name}.size() <= UINT8_MAX);
+            return {argument_type::custom, 0, argument_traits<value_type>::name};
+        }
+        else
+        {
+            static_assert(sizeof(value_type) <= UINT8_MAX);
+            constexpr auto size = static_cast<std::uint8_t>(sizeof(value_type));
+
+            if constexpr (std::is_same_v<value_type, bool>)
+            {
+                return {argument_type::boolean, size};
+            }
+            else if constexpr (std::is_same_v<value_type, char>)
+            {
+                return {argument_type::character, size};
+            }
+            else if constexpr (std::is_integral_v<value_type>)
+            {
+                return {std::is_signed_v<value_type> ? argument_type::signed_integer
+                                                     : argument_type::unsigned_integer,
+                        size};
+            }
+            else if constexpr (std::is_floating_point_v<value_type>)
+            {
+                return {argument_type::floating_point, size};
+            }
+            else
+            {
+                static_assert(std::is_pointer_v<value_type>,
+                              "the argument needs an async::argument_traits specialization to be logged");
+                return {argument_type::pointer, size};
+            }
+        }
+    }
+
+    // one per argument list, its address tells the lists apart at run time
+    struct format_signature
+    {
+        std::span<const argument_descriptor> arguments;
+    };
+
+    template <class... Args>
+    inline constexpr std::array<argument_descriptor, sizeof...(Args)> argument_descriptors{
+        describe_argument<Args>()...};
+
+    template <class... Args>
+    inline constexpr format_signature signature_of{argument_descriptors<Args...>};
+} // namespace async
+
+#endif // ASYNC_ARGUMENT_TYPE_HPP
@@ -0,0 +1,170 @@
+#ifndef ASYNC_BINARY_FORMAT_HPP
+#define ASYNC_BINARY_FORMAT_HPP
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include "core/tsc_clock.hpp"
+
+#include "async/argument_type.hpp"
+
+// layout of a binary log file, all the fields are stored in the byte order
+// of the host that wrote them, without any padding:
+//
+// header: magic "ALOG", u16 version, u64 time stamp counter reference (ticks),
+//         i64 system clock reference (ns), the same instant on both clocks,
+//         f64 nanoseconds per tick
+// format: u8 tag 'F', u32 format id, u8 argument count,
+//         argument count * (u8 argument type, u8 argument size,
+//                           for the custom arguments u8 name size, name characters),
+//         u32 format size, format characters
+// record: u8 tag 'R', u32 format id, u64 timestamp (ticks),
+//         u32 arguments size, argument bytes
+//
+// the arguments of size zero, the strings and the custom ones,
+// are stored as u32 length followed by their bytes
+//
+// a format entry always precedes the first record referring to it,
+// so each file can be decoded on its own
+namespace async::binary
+{
+    using format_id_t = std::uint32_t;
+    using timestamp_t = std::uint64_t;
+
+    constexpr std::array<char, 4> magic{'A', 'L', 'O', 'G'};
+    constexpr std::uint16_t version{3};
+
+    enum class entry_tag : std::uint8_t
+    {
+        format = 'F',
+        record = 'R'
+    };
+
+    struct file_header
+    {
+        timestamp_t tick_reference;
+        std::int64_t system_reference;
+        double nanoseconds_per_tick;
+    };
+
+    // the records are stamped with the ticks of the time stamp counter,
+    // the producers never pay for a clock_gettime call
+    timestamp_t current_timestamp() noexcept
+    {
+        return core::tsc_clock::now();
+    }
+
+    // lets the decoder turn the ticks into wall clock time, captured by every
+    // new file, so the error of the calibrated rate adds up only over one file
+    file_header capture_clock_references() noexcept
+    {
+        const auto &clock = core::tsc_clock::process_clock();
+        const auto before = core::tsc_clock::now_ordered();
+        const auto system = std::chrono::system_clock::now().time_since_epoch();
+        const auto after = core::tsc_clock::now_ordered();
+        return file_header{before + (after - before) / 2,
+                           std::chrono::duration_cast<std::chrono::nanoseconds>(system).count(),
+                           clock.nanoseconds_per_tick()};
+    }
+
+    // appends the fields to a growing byte buffer
+    class encoder
+    {
+    public:
+        explicit encoder(std::vector<std::byte> &bytes) noexcept : bytes_{bytes} {}
+
+        template <class Value>
+            requires std::is_trivially_copyable_v<Value>
+        encoder &put(const Value &value) noexcept
+        {
+            return put(std::span<const std::byte>{reinterpret_cast<const std::byte *>(&value), sizeof(Value)});
+        }
+
+        encoder &put(std::span<const std::byte> values) noexcept
+        {
+            bytes_.insert(bytes_.end(), values.begin(), values.end());
+            return *this;
+        }
+
+    private:
+        std::vector<std::byte> &bytes_;
+    };
+
+    // reads the fields back, fails once the bytes run out
+    class decoder
+    {
+    public:
+        explicit decoder(std::span<const std::byte> bytes) noexcept : bytes_{bytes} {}
+
+        template <class Value>
+            requires std::is_trivially_copyable_v<Value>
+        bool get(Value &value) noexcept
+        {
+            if (bytes_.size() < sizeof(Value))
+            {
+                return false;
+            }
+            std::memcpy(&value, bytes_.data(), sizeof(Value));
+            bytes_ = bytes_.subspan(sizeof(Value));
+            return true;
+        }
+
+        bool get(std::size_t size, std::span<const std::byte> &values) noexcept
+        {
+            if (bytes_.size() < size)
+            {
+                return false;
+            }
+            values = bytes_.first(size);
+            bytes_ = bytes_.subspan(size);
+            return true;
+        }
+
+        bool empty() const noexcept
+        {
+            return bytes_.empty();
+        }
+
+    private:
+        std::span<const std::byte> bytes_;
+    };
+
+    void encode_header(encoder &output, const file_header &header) noexcept
+    {
+        output.put(magic).put(version).put(header.tick_reference).put(header.system_reference);
+        output.put(header.nanoseconds_per_tick);
+    }
+
+    void encode_format(encoder &output, format_id_t id, const format_signature &signature,
+                       std::span<const char> format) noexcept
+    {
+        output.put(entry_tag::format).put(id).put(static_cast<std::uint8_t>(signature.arguments.size()));
+
+        for (const auto &argument : signature.arguments)
+        {
+            output.put(argument.type).put(argument.size);
+
+            if (argument.type == argument_type::custom)
+            {
+                output.put(static_cast<std::uint8_t>(argument.name.size()))
+                    .put(std::as_bytes(std::span<const char>{argument.name.data(), argument.name.size()}));
+            }
+        }
+        output.put(static_cast<std::uint32_t>(format.size())).put(std::as_bytes(format));
+    }
+
+    void encode_record(encoder &output, format_id_t id, timestamp_t timestamp,
+                       std::span<const std::byte> arguments) noexcept
+    {
+        output.put(entry_tag::record).put(id).put(timestamp);
+        output.put(static_cast<std::uint32_t>(arguments.size())).put(arguments);
+    }
+} // namespace async::binary
+
+#endif // ASYNC_BINARY_FORMAT_HPP
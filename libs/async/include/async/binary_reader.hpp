@@ -0,0 +1,582 @@
+#ifndef ASYNC_BINARY_READER_HPP
+#define ASYNC_BINARY_READER_HPP
+
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <errno.h>
+#include <expected>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "unix/error_code.hpp"
+
+#include "async/argument_type.hpp"
+#include "async/binary_format.hpp"
+#include "async/format_string.hpp"
+
+namespace async
+{
+    // the names of the custom arguments refer to the bytes of the file
+    struct decoded_format
+    {
+        std::vector<argument_descriptor> arguments;
+        std::string text;
+    };
+
+    struct decoded_record
+    {
+        binary::timestamp_t timestamp;
+        const decoded_format *format;
+        std::span<const std::byte> arguments;
+    };
+
+    namespace detail
+    {
+        // the sizes the logger writes for each type, render loads exactly these
+        constexpr bool is_valid_descriptor(const argument_descriptor &argument) noexcept
+        {
+            switch (argument.type)
+            {
+            case argument_type::boolean:
+                return argument.size == sizeof(bool);
+            case argument_type::character:
+                return argument.size == sizeof(char);
+            case argument_type::signed_integer:
+            case argument_type::unsigned_integer:
+                return argument.size == 1 || argument.size == 2 || argument.size == 4 || argument.size == 8;
+            case argument_type::floating_point:
+                return argument.size == sizeof(float) || argument.size == sizeof(double) ||
+                       argument.size == sizeof(long double);
+            case argument_type::pointer:
+                return argument.size == sizeof(const void *);
+            case argument_type::string:
+            case argument_type::custom:
+                return argument.size == 0;
+            default:
+                return false;
+            }
+        }
+    } // namespace detail
+
+    // walks the entries of a binary log file kept in memory,
+    // the format entries are collected on the way, corrupted files fail with EBADMSG
+    class binary_reader
+    {
+    public:
+        explicit binary_reader(std::span<const std::byte> bytes) noexcept
+            : input_{bytes} {}
+
+        binary_reader(const binary_reader &other) = delete;
+        binary_reader &operator=(const binary_reader &other) = delete;
+
+        binary_reader(binary_reader &&other) noexcept = default;
+        binary_reader &operator=(binary_reader &&other) noexcept = default;
+
+        static std::expected<binary_reader, unix::error_code> open(std::span<const std::byte> bytes) noexcept
+        {
+            binary_reader reader{bytes};
+            std::array<char, binary::magic.size()> magic;
+            std::uint16_t version;
+
+            if (!reader.input_.get(magic) || magic != binary::magic ||
+                !reader.input_.get(version) || version != binary::version ||
+                !reader.input_.get(reader.header_.tick_reference) ||
+                !reader.input_.get(reader.header_.system_reference) ||
+                !reader.input_.get(reader.header_.nanoseconds_per_tick))
+            {
+                return std::unexpected{unix::error_code{EBADMSG}};
+            }
+            return reader;
+        }
+
+        // returns nullopt once all the records got read
+        std::expected<std::optional<decoded_record>, unix::error_code> next() noexcept
+        {
+            while (!input_.empty())
+            {
+                binary::entry_tag tag;
+                input_.get(tag);
+
+                if (tag == binary::entry_tag::format)
+                {
+                    if (!read_format())
+                    {
+                        return std::unexpected{unix::error_code{EBADMSG}};
+                    }
+                    continue;
+                }
+                if (tag != binary::entry_tag::record)
+                {
+                    return std::unexpected{unix::error_code{EBADMSG}};
+                }
+                return read_record();
+            }
+            return std::nullopt;
+        }
+
+        const binary::file_header &header() const noexcept
+        {
+            return header_;
+        }
+
+        // nanoseconds since the unix epoch, the records may precede the reference
+        std::int64_t to_system_time(binary::timestamp_t timestamp) const noexcept
+        {
+            const auto ticks = static_cast<std::int64_t>(timestamp - header_.tick_reference);
+            return header_.system_reference +
+                   static_cast<std::int64_t>(static_cast<double>(ticks) * header_.nanoseconds_per_tick);
+        }
+
+    private:
+        binary::decoder input_;
+        binary::file_header header_{};
+        std::unordered_map<binary::format_id_t, decoded_format> formats_;
+
+        bool read_format() noexcept
+        {
+            binary::format_id_t id;
+            std::uint8_t argument_count;
+
+            if (!input_.get(id) || !input_.get(argument_count))
+            {
+                return false;
+            }
+            decoded_format format;
+            format.arguments.resize(argument_count);
+
+            for (auto &argument : format.arguments)
+            {
+                if (!input_.get(argument.type) || !input_.get(argument.size) ||
+                    !detail::is_valid_descriptor(argument))
+                {
+                    return false;
+                }
+                if (argument.type == argument_type::custom)
+                {
+                    std::uint8_t name_size;
+                    std::span<const std::byte> name;
+
+                    if (!input_.get(name_size) || !input_.get(name_size, name))
+                    {
+                        return false;
+                    }
+                    argument.name = std::string_view{reinterpret_cast<const char *>(name.data()), name.size()};
+                }
+            }
+            std::uint32_t text_size;
+            std::span<const std::byte> text;
+
+            if (!input_.get(text_size) || !input_.get(text_size, text))
+            {
+                return false;
+            }
+            format.text.assign(reinterpret_cast<const char *>(text.data()), text.size());
+            formats_.insert_or_assign(id, std::move(format));
+            return true;
+        }
+
+        std::expected<std::optional<decoded_record>, unix::error_code> read_record() noexcept
+        {
+            binary::format_id_t id;
+            decoded_record record;
+            std::uint32_t arguments_size;
+
+            if (!input_.get(id) || !input_.get(record.timestamp) || !input_.get(arguments_size) ||
+                !input_.get(arguments_size, record.arguments))
+            {
+                return std::unexpected{unix::error_code{EBADMSG}};
+            }
+            const auto found = formats_.find(id);
+
+            if (found == formats_.end())
+            {
+                return std::unexpected{unix::error_code{EBADMSG}};
+            }
+            record.format = &found->second;
+            return record;
+        }
+    };
+
+    namespace detail
+    {
+        template <class Value>
+        Value load(std::span<const std::byte> bytes) noexcept
+        {
+            Value value;
+            std::memcpy(&value, bytes.data(), sizeof(Value));
+            return value;
+        }
+
+        // the sizes got checked by is_valid_descriptor, any other one loads zero
+        long long load_signed(std::span<const std::byte> bytes) noexcept
+        {
+            switch (bytes.size())
+            {
+            case 1:
+                return load<std::int8_t>(bytes);
+            case 2:
+                return load<std::int16_t>(bytes);
+            case 4:
+                return load<std::int32_t>(bytes);
+            case 8:
+                return load<std::int64_t>(bytes);
+            default:
+                return 0;
+            }
+        }
+
+        unsigned long long load_unsigned(std::span<const std::byte> bytes) noexcept
+        {
+            switch (bytes.size())
+            {
+            case 1:
+                return load<std::uint8_t>(bytes);
+            case 2:
+                return load<std::uint16_t>(bytes);
+            case 4:
+                return load<std::uint32_t>(bytes);
+            case 8:
+                return load<std::uint64_t>(bytes);
+            default:
+                return 0;
+            }
+        }
+
+        // the long outputs get formatted a second time right into the output
+        template <class... Values>
+        void append_formatted(std::string &output, const std::string &specification, Values... values) noexcept
+        {
+            std::array<char, 512> text;
+            const auto size = std::snprintf(text.data(), text.size(), specification.c_str(), values...);
+
+            if (size <= 0)
+            {
+                return;
+            }
+            if (static_cast<std::size_t>(size) < text.size())
+            {
+                output.append(text.data(), static_cast<std::size_t>(size));
+                return;
+            }
+            const auto offset = output.size();
+            output.resize(offset + static_cast<std::size_t>(size) + 1);
+            std::snprintf(output.data() + offset, static_cast<std::size_t>(size) + 1, specification.c_str(),
+                          values...);
+            output.resize(offset + static_cast<std::size_t>(size));
+        }
+
+        // the characters are not null terminated, the precision bounds the ones printed
+        void append_string(std::string &output, std::string specification, std::string_view value) noexcept
+        {
+            if (specification == "%")
+            {
+                output += value;
+                return;
+            }
+            auto precision = value.size();
+            const auto dot = specification.find('.');
+
+            if (dot != std::string::npos)
+            {
+                precision = std::min(precision, static_cast<std::size_t>(std::atoll(specification.c_str() + dot + 1)));
+                specification.erase(dot);
+            }
+            append_formatted(output, specification + ".*s", static_cast<int>(precision), value.data());
+        }
+
+        // the end of the conversion starting at the %, only the flags, width, precision
+        // and length modifiers printf takes may precede it, nothing else of an untrusted
+        // format reaches snprintf
+        std::optional<std::size_t> find_conversion(std::string_view text, std::size_t index) noexcept
+        {
+            constexpr std::string_view conversions{"diouxXeEfFgGaAcsp"};
+            constexpr std::string_view digits{"0123456789"};
+            constexpr std::array<std::string_view, 9> length_modifiers{"hh", "ll", "h", "l", "L", "q", "j", "z", "t"};
+
+            const auto skip = [&](std::string_view accepted)
+            {
+                while (index < text.size() && accepted.find(text[index]) != std::string_view::npos)
+                {
+                    ++index;
+                }
+            };
+            const auto skip_number = [&]()
+            {
+                if (index < text.size() && text[index] == '*')
+                {
+                    ++index;
+                    return;
+                }
+                skip(digits);
+            };
+
+            ++index;
+            skip("-+ #0");
+            skip_number();
+
+            if (index < text.size() && text[index] == '.')
+            {
+                ++index;
+                skip_number();
+            }
+            for (const auto modifier : length_modifiers)
+            {
+                if (text.substr(index).starts_with(modifier))
+                {
+                    index += modifier.size();
+                    break;
+                }
+            }
+            if (index == text.size() || conversions.find(text[index]) == std::string_view::npos)
+            {
+                return std::nullopt;
+            }
+            return index;
+        }
+
+        // the length modifiers of the logged format describe the logged types,
+        // they get replaced by the ones of the types the values are widened to
+        std::string strip_length_modifiers(std::string_view specification) noexcept
+        {
+            std::string stripped;
+
+            for (const auto character : specification)
+            {
+                if (std::string_view{"hlLqjzt"}.find(character) == std::string_view::npos)
+                {
+                    stripped += character;
+                }
+            }
+            return stripped;
+        }
+    } // namespace detail
+
+    // renders the custom arguments, see argument_traits
+    class argument_decoders
+    {
+    public:
+        using decode_t = void (*)(std::span<const std::byte> bytes, std::string &output);
+
+        template <custom_argument Value>
+        argument_decoders &add() noexcept
+        {
+            decoders_.insert_or_assign(std::string_view{argument_traits<Value>::name},
+                                       &argument_traits<Value>::decode);
+            return *this;
+        }
+
+        decode_t find(std::string_view name) const noexcept
+        {
+            const auto found = decoders_.find(name);
+            return found != decoders_.end() ? found->second : nullptr;
+        }
+
+    private:
+        std::unordered_map<std::string_view, decode_t> decoders_;
+    };
+
+    // renders the record the way printf would have rendered the format with the arguments,
+    // the custom arguments without a decoder are rendered as <name>,
+    // fails with EBADMSG when the conversions do not match the arguments
+    std::expected<std::string, unix::error_code> render(const decoded_record &record,
+                                                        const argument_decoders &decoders = {}) noexcept
+    {
+        const auto &format = *record.format;
+        const std::string_view text{format.text};
+        auto arguments = record.arguments;
+        std::size_t argument_index{0};
+        std::string output;
+        // the text of the custom arguments, reused by all of them
+        std::string decoded;
+
+        const auto next_argument = [&]() -> std::optional<std::pair<argument_descriptor, std::span<const std::byte>>>
+        {
+            if (argument_index == format.arguments.size())
+            {
+                return std::nullopt;
+            }
+            const auto argument = format.arguments[argument_index++];
+            std::size_t size{argument.size};
+
+            if (size == 0)
+            {
+                argument_length_t length;
+
+                if (arguments.size() < sizeof(length))
+                {
+                    return std::nullopt;
+                }
+                std::memcpy(&length, arguments.data(), sizeof(length));
+                arguments = arguments.subspan(sizeof(length));
+                size = length;
+            }
+            if (arguments.size() < size)
+            {
+                return std::nullopt;
+            }
+            const auto bytes = arguments.first(size);
+            arguments = arguments.subspan(size);
+            return std::make_pair(argument, bytes);
+        };
+
+        for (std::size_t index{0}; index < text.size(); ++index)
+        {
+            if (text[index] != '%')
+            {
+                output += text[index];
+                continue;
+            }
+            if ((index + 1) < text.size() && text[index + 1] == '%')
+            {
+                output += '%';
+                ++index;
+                continue;
+            }
+            const auto conversion = detail::find_conversion(text, index);
+
+            if (!conversion)
+            {
+                return std::unexpected{unix::error_code{EBADMSG}};
+            }
+            const auto end = conversion.value();
+            auto specification = detail::strip_length_modifiers(text.substr(index, end - index));
+            index = end;
+
+            // the width or precision passed as an argument, of any integer type
+            // check_format accepts, but within the range printf takes
+            for (auto star = specification.find('*'); star != std::string::npos; star = specification.find('*'))
+            {
+                const auto width = next_argument();
+
+                if (!width)
+                {
+                    return std::unexpected{unix::error_code{EBADMSG}};
+                }
+                std::string value;
+
+                if (width->first.type == argument_type::signed_integer)
+                {
+                    const auto signed_width = detail::load_signed(width->second);
+
+                    if (signed_width < INT_MIN || signed_width > INT_MAX)
+                    {
+                        return std::unexpected{unix::error_code{EBADMSG}};
+                    }
+                    value = std::to_string(signed_width);
+                }
+                else if (width->first.type == argument_type::unsigned_integer)
+                {
+                    const auto unsigned_width = detail::load_unsigned(width->second);
+
+                    if (unsigned_width > INT_MAX)
+                    {
+                        return std::unexpected{unix::error_code{EBADMSG}};
+                    }
+                    value = std::to_string(unsigned_width);
+                }
+                else
+                {
+                    return std::unexpected{unix::error_code{EBADMSG}};
+                }
+                specification.replace(star, 1, value);
+            }
+            const auto argument = next_argument();
+
+            if (!argument)
+            {
+                return std::unexpected{unix::error_code{EBADMSG}};
+            }
+            const auto &[descriptor, bytes] = argument.value();
+
+            if (detail::check_conversion(text[end], descriptor.type) != format_check::ok)
+            {
+                return std::unexpected{unix::error_code{EBADMSG}};
+            }
+            if (text[end] == 's')
+            {
+                if (descriptor.type == argument_type::string)
+                {
+                    detail::append_string(output, specification,
+                                          std::string_view{reinterpret_cast<const char *>(bytes.data()), bytes.size()});
+                    continue;
+                }
+                const auto decode = decoders.find(descriptor.name);
+                decoded.clear();
+
+                if (decode != nullptr)
+                {
+                    decode(bytes, decoded);
+                }
+                else
+                {
+                    decoded.append("<").append(descriptor.name).append(">");
+                }
+                detail::append_string(output, specification, decoded);
+                continue;
+            }
+            if (text[end] == 'c')
+            {
+                const auto character = descriptor.type == argument_type::unsigned_integer
+                                           ? static_cast<int>(detail::load_unsigned(bytes))
+                                           : static_cast<int>(detail::load_signed(bytes));
+                detail::append_formatted(output, specification + text[end], character);
+                continue;
+            }
+            switch (descriptor.type)
+            {
+            case argument_type::boolean:
+                detail::append_formatted(output, specification + text[end],
+                                         static_cast<int>(detail::load<std::uint8_t>(bytes) != 0));
+                break;
+            case argument_type::character:
+                detail::append_formatted(output, specification + text[end], static_cast<int>(detail::load<char>(bytes)));
+                break;
+            case argument_type::signed_integer:
+                detail::append_formatted(output, specification + "ll" + text[end], detail::load_signed(bytes));
+                break;
+            case argument_type::unsigned_integer:
+                detail::append_formatted(output, specification + "ll" + text[end], detail::load_unsigned(bytes));
+                break;
+            case argument_type::floating_point:
+                if (descriptor.size == sizeof(float))
+                {
+                    detail::append_formatted(output, specification + text[end],
+                                             static_cast<double>(detail::load<float>(bytes)));
+                }
+                else if (descriptor.size == sizeof(double))
+                {
+                    detail::append_formatted(output, specification + text[end], detail::load<double>(bytes));
+                }
+                else
+                {
+                    detail::append_formatted(output, specification + "L" + text[end], detail::load<long double>(bytes));
+                }
+                break;
+            case argument_type::pointer:
+                detail::append_formatted(output, specification + text[end], detail::load<const void *>(bytes));
+                break;
+            default:
+                // the strings and the custom arguments go with %s only
+                return std::unexpected{unix::error_code{EBADMSG}};
+            }
+        }
+        if (argument_index != format.arguments.size() || !arguments.empty())
+        {
+            return std::unexpected{unix::error_code{EBADMSG}};
+        }
+        return output;
+    }
+} // namespace async
+
+#endif // ASYNC_BINARY_READER_HPP
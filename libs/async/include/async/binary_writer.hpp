@@ -0,0 +1,132 @@
+#ifndef ASYNC_BINARY_WRITER_HPP
+#define ASYNC_BINARY_WRITER_HPP
+
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <expected>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include "unix/error_code.hpp"
+
+#include "async/argument_type.hpp"
+#include "async/binary_format.hpp"
+#include "async/file_sink.hpp"
+#include "async/format_string.hpp"
+
+namespace async
+{
+    // persists the records as the producers serialized them, the formatting
+    // is left to the offline decoder, so writing a record only copies bytes,
+    // each format gets an id when it is first seen, its text is written once,
+    // the entries are staged in small batches before moving to the sink
+    class binary_writer
+    {
+        static constexpr std::size_t hand_off_threshold{16 * 1'024};
+
+    public:
+        // the sink has to outlive the writer
+        explicit binary_writer(file_sink &sink) noexcept
+            : sink_{sink}
+        {
+            bytes_.reserve(2 * hand_off_threshold);
+            binary::encoder output{bytes_};
+            binary::encode_header(output, binary::capture_clock_references());
+        }
+
+        binary_writer(const binary_writer &other) = delete;
+        binary_writer &operator=(const binary_writer &other) = delete;
+
+        // the format has to outlive the writer
+        std::expected<void, unix::error_code> write(const log_format &format,
+                                                    binary::timestamp_t timestamp,
+                                                    std::span<const std::byte> arguments) noexcept
+        {
+            binary::encoder output{bytes_};
+            const auto id = find_or_add_format(output, format);
+            binary::encode_record(output, id, timestamp, arguments);
+
+            if (bytes_.size() >= hand_off_threshold)
+            {
+                return hand_off();
+            }
+            return std::expected<void, unix::error_code>{};
+        }
+
+        std::expected<void, unix::error_code> flush() noexcept
+        {
+            const auto handed_off = hand_off();
+
+            if (!handed_off)
+            {
+                return handed_off;
+            }
+            return sink_.get().flush();
+        }
+
+        // lets the sink apply its time thresholds
+        std::expected<void, unix::error_code> flush_if_due(std::chrono::steady_clock::time_point now) noexcept
+        {
+            const auto handed_off = hand_off();
+
+            if (!handed_off)
+            {
+                return handed_off;
+            }
+            return sink_.get().flush_if_due(now);
+        }
+
+        std::optional<std::chrono::steady_clock::duration>
+        time_till_due(std::chrono::steady_clock::time_point now) const noexcept
+        {
+            return sink_.get().time_till_due(now);
+        }
+
+        std::size_t format_count() const noexcept
+        {
+            return formats_.size();
+        }
+
+        ~binary_writer() noexcept
+        {
+            flush();
+        }
+
+    private:
+        std::reference_wrapper<file_sink> sink_;
+        std::vector<std::byte> bytes_;
+        // the same text may be logged with different argument types,
+        // each combination has a format object of its own
+        std::unordered_map<const log_format *, binary::format_id_t> formats_;
+
+        std::expected<void, unix::error_code> hand_off() noexcept
+        {
+            const auto appended = sink_.get().append(bytes_);
+            bytes_.clear();
+            return appended;
+        }
+
+        binary::format_id_t find_or_add_format(binary::encoder &output, const log_format &format) noexcept
+        {
+            const auto found = formats_.find(&format);
+
+            if (found != formats_.end())
+            {
+                return found->second;
+            }
+            assert(formats_.size() < std::numeric_limits<binary::format_id_t>::max());
+            const auto id = static_cast<binary::format_id_t>(formats_.size());
+            formats_.emplace(&format, id);
+            binary::encode_format(output, id, format.signature,
+                                  std::span<const char>{format.text.data(), format.text.size()});
+            return id;
+        }
+    };
+} // namespace async
+
+#endif // ASYNC_BINARY_WRITER_HPP
@@ -0,0 +1,354 @@
+#ifndef ASYNC_COLLECTOR_HPP
+#define ASYNC_COLLECTOR_HPP
+
+#ifdef __linux__ // probes the owners of the lanes by their kernel thread ids
+
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <optional>
+#include <print>
+#include <span>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "unix/error_code.hpp"
+#include "unix/process.hpp"
+
+#include "async/binary_reader.hpp"
+#include "async/file_sink.hpp"
+#include "async/format_string.hpp"
+#include "async/record.hpp"
+#include "async/segment_writer.hpp"
+#include "async/shared_log.hpp"
+
+namespace async
+{
+    struct collector_options
+    {
+        // writes <path prefix>.0.alog, with an empty prefix the records
+        // get rendered as text into the descriptor instead
+        std::string path_prefix{};
+        int text_descriptor{STDOUT_FILENO};
+        sink_options sink{};
+        // renders the custom arguments of the text output
+        argument_decoders decoders{};
+    };
+
+    // drains the lanes of all the producer processes in the timestamp order
+    // and writes the records, runs in a process of its own, forked before
+    // the producers so the format addresses of the records are valid in it
+    template <std::size_t LaneCapacity, std::size_t LaneCount>
+    class collector
+    {
+        using clock = std::chrono::steady_clock;
+        using log_type = shared_log<LaneCapacity, LaneCount>;
+        using lane_type = shared_lane<LaneCapacity>;
+
+        // records written before the lanes get notified of the freed space
+        static constexpr std::size_t batch_size{256};
+        // checks of the lanes before the idle collector goes to sleep
+        static constexpr std::size_t idle_poll_count{64};
+        // how often the idle collector looks for exited producers and creator
+        static constexpr std::chrono::milliseconds liveness_period{100};
+        // the rendered text gets written once it grows that large
+        static constexpr std::size_t text_threshold{64 * 1'024};
+
+        log_type &log_;
+        collector_options options_;
+        unix::process_id_t creator_;
+        std::optional<segment_writer> output_;
+        std::unordered_map<const log_format *, decoded_format> formats_;
+        std::string text_;
+        clock::time_point text_since_{};
+
+    public:
+        // the creator is the process the collector serves, it stops once the creator is gone
+        explicit collector(log_type &log, collector_options options, unix::process_id_t creator) noexcept
+            : log_{log}, options_{std::move(options)}, creator_{creator} {}
+
+        collector(const collector &other) = delete;
+        collector &operator=(const collector &other) = delete;
+
+        // returns once stopped and everything got written, false on a failure
+        bool run() noexcept
+        {
+            const auto opened = open();
+
+            if (!opened)
+            {
+                log_.collector_error.store(opened.error().code, std::memory_order_relaxed);
+                log_.change_state(collector_state::failed);
+                return false;
+            }
+            log_.change_state(collector_state::running);
+            const auto collected = collect();
+            const auto flushed = flush();
+
+            if (!flushed)
+            {
+                std::println("[collector] failed to flush messages due to: {}", unix::to_string(flushed.error()));
+            }
+            log_.change_state(collector_state::done);
+            return collected && flushed;
+        }
+
+    private:
+        std::expected<void, unix::error_code> open() noexcept
+        {
+            if (options_.path_prefix.empty())
+            {
+                return std::expected<void, unix::error_code>{};
+            }
+            // the rotation needs the compressor thread, the collector writes a single file
+            output_.emplace(options_.path_prefix, 0, options_.sink, rotation_options{}, nullptr);
+            return output_->open();
+        }
+
+        bool collect() noexcept
+        {
+            while (true)
+            {
+                // read before draining, the producers are done once it is set
+                const auto stopping = log_.stopping.load(std::memory_order_acquire);
+                const auto written = drain();
+
+                if (!written)
+                {
+                    std::println("[collector] failed to write message due to: {}", unix::to_string(written.error()));
+                    return false;
+                }
+                if (written.value() != 0)
+                {
+                    log_.popped_count.fetch_add(written.value(), std::memory_order_release);
+                }
+                else if (stopping)
+                {
+                    return true;
+                }
+                const auto now = clock::now();
+                const auto flushed = flush_if_due(now);
+
+                if (!flushed)
+                {
+                    std::println("[collector] failed to flush messages due to: {}", unix::to_string(flushed.error()));
+                    return false;
+                }
+                if (written.value() != 0 || poll_for_records())
+                {
+                    continue;
+                }
+                const auto epoch = log_.records_pushed.prepare_wait();
+
+                if (has_records() || log_.stopping.load(std::memory_order_acquire))
+                {
+                    log_.records_pushed.cancel_wait();
+                    continue;
+                }
+                // sleeps no longer than the buffered data may wait
+                const auto due = time_till_due(now);
+                const auto timeout = due && due.value() < liveness_period ? due.value() : clock::duration{liveness_period};
+
+                if (!log_.records_pushed.wait_for(epoch, timeout))
+                {
+                    release_exited_lanes();
+
+                    // nobody is left to stop the collector
+                    if (!unix::process_exists(creator_))
+                    {
+                        return true;
+                    }
+                }
+            }
+        }
+
+        bool poll_for_records() const noexcept
+        {
+            for (std::size_t poll{0}; poll < idle_poll_count; ++poll)
+            {
+                if (has_records())
+                {
+                    return true;
+                }
+                std::this_thread::yield();
+            }
+            return false;
+        }
+
+        bool has_records() const noexcept
+        {
+            for (const auto &lane : log_.lanes)
+            {
+                if (!lane.ring.empty())
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // the lanes of the exited threads get reused by the next producers,
+        // the thread ids are only recycled long after their exit
+        void release_exited_lanes() noexcept
+        {
+            for (auto &lane : log_.lanes)
+            {
+                const auto owner = lane.owner.load(std::memory_order_acquire);
+
+                if (owner != 0 && lane.ring.empty() && !unix::process_exists(owner))
+                {
+                    lane.release();
+                }
+            }
+        }
+
+        // the earliest front record first, as writer_group does with lane_order::timestamp
+        std::expected<std::size_t, unix::error_code> drain() noexcept
+        {
+            std::size_t written{0};
+
+            for (; written < batch_size; ++written)
+            {
+                lane_type *earliest{nullptr};
+                std::span<const std::byte> earliest_record;
+                binary::timestamp_t earliest_timestamp{0};
+
+                for (auto &lane : log_.lanes)
+                {
+                    const auto record = lane.ring.front();
+
+                    if (!record)
+                    {
+                        continue;
+                    }
+                    const auto timestamp = timestamp_of(record.value());
+
+                    if (earliest == nullptr || timestamp < earliest_timestamp)
+                    {
+                        earliest = &lane;
+                        earliest_record = record.value();
+                        earliest_timestamp = timestamp;
+                    }
+                }
+                if (earliest == nullptr)
+                {
+                    break;
+                }
+                const auto record_written = write(earliest_record);
+
+                if (!record_written)
+                {
+                    return std::unexpected{record_written.error()};
+                }
+                earliest->ring.pop();
+            }
+            if (written != 0)
+            {
+                for (auto &lane : log_.lanes)
+                {
+                    lane.space_freed.notify_all();
+                }
+            }
+            return written;
+        }
+
+        std::expected<void, unix::error_code> write(std::span<const std::byte> record) noexcept
+        {
+            const auto [format, timestamp, arguments] = read_record(record);
+
+            if (output_)
+            {
+                return output_->write(format, timestamp, arguments);
+            }
+            auto found = formats_.find(&format);
+
+            if (found == formats_.end())
+            {
+                const auto descriptors = format.signature.arguments;
+                found = formats_.emplace(&format, decoded_format{{descriptors.begin(), descriptors.end()},
+                                                                 std::string{format.text}}).first;
+            }
+            const auto rendered = render(decoded_record{timestamp, &found->second, arguments}, options_.decoders);
+
+            if (!rendered)
+            {
+                return std::unexpected{rendered.error()};
+            }
+            if (text_.empty())
+            {
+                text_since_ = clock::now();
+            }
+            text_ += rendered.value();
+
+            if (text_.size() >= text_threshold)
+            {
+                return write_text();
+            }
+            return std::expected<void, unix::error_code>{};
+        }
+
+        std::expected<void, unix::error_code> write_text() noexcept
+        {
+            std::size_t offset{0};
+
+            while (offset < text_.size())
+            {
+                const auto ret = ::write(options_.text_descriptor, text_.data() + offset, text_.size() - offset);
+
+                if (unix::operation_failed(static_cast<int>(ret)))
+                {
+                    if (errno == EINTR)
+                    {
+                        continue;
+                    }
+                    return std::unexpected{unix::error_code{errno}};
+                }
+                offset += static_cast<std::size_t>(ret);
+            }
+            text_.clear();
+            return std::expected<void, unix::error_code>{};
+        }
+
+        std::expected<void, unix::error_code> flush() noexcept
+        {
+            return output_ ? output_->flush() : write_text();
+        }
+
+        std::expected<void, unix::error_code> flush_if_due(clock::time_point now) noexcept
+        {
+            if (output_)
+            {
+                return output_->flush_if_due(now);
+            }
+            if (!text_.empty() && now - text_since_ >= options_.sink.flush_interval)
+            {
+                return write_text();
+            }
+            return std::expected<void, unix::error_code>{};
+        }
+
+        std::optional<clock::duration> time_till_due(clock::time_point now) const noexcept
+        {
+            if (output_)
+            {
+                return output_->time_till_due(now);
+            }
+            if (text_.empty())
+            {
+                return std::nullopt;
+            }
+            const auto due = text_since_ + options_.sink.flush_interval;
+            return due > now ? due - now : clock::duration::zero();
+        }
+    };
+} // namespace async
+
+#endif
+
+#endif // ASYNC_COLLECTOR_HPP
@@ -0,0 +1,289 @@
+#ifndef ASYNC_FILE_SINK_HPP
+#define ASYNC_FILE_SINK_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <expected>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <span>
+#include <sys/types.h>
+
+#include "unix/error_code.hpp"
+#include "unix/fs/posix/file.hpp"
+
+namespace async
+{
+    // when the written data gets forced to the disk
+    enum class sync_policy
+    {
+        // left to the kernel
+        none,
+        // at most once per sync interval
+        periodic,
+        // after every write
+        per_batch,
+    };
+
+    struct sink_options
+    {
+        // the data is written once the buffer fills up or the flush interval expires
+        std::size_t buffer_size{1'024 * 1'024};
+        std::chrono::milliseconds flush_interval{100};
+        sync_policy sync{sync_policy::none};
+        std::chrono::milliseconds sync_interval{1'000};
+        // the file has to be opened with file_open_flags_builder::direct, Linux only
+        bool direct_io{false};
+        // blocks reserved ahead of the writes, zero reserves none
+        std::size_t preallocation_size{0};
+    };
+
+    // gathers the bytes in a large block aligned buffer and writes them
+    // with a few large positional writes from the start of the file,
+    // with direct io the partial last block is padded, written and the
+    // file truncated to its real size, the block is written again once
+    // it gets filled
+    class file_sink
+    {
+        using clock = std::chrono::steady_clock;
+
+        static constexpr std::size_t block_size{4'096};
+
+        struct buffer_deleter
+        {
+            void operator()(std::byte *buffer) const noexcept { std::free(buffer); }
+        };
+
+    public:
+        static std::expected<file_sink, unix::error_code> create(const unix::fs::posix::file &file,
+                                                                 const sink_options &options) noexcept
+        {
+            const auto capacity = round_up(std::max(options.buffer_size, block_size), block_size);
+            auto *buffer = static_cast<std::byte *>(std::aligned_alloc(block_size, capacity));
+
+            if (buffer == nullptr)
+            {
+                return std::unexpected{unix::error_code{ENOMEM}};
+            }
+            return std::expected<file_sink, unix::error_code>{std::in_place, file, options, buffer, capacity};
+        }
+
+        // the file has to outlive the sink
+        explicit file_sink(const unix::fs::posix::file &file, const sink_options &options,
+                           std::byte *buffer, std::size_t capacity) noexcept
+            : file_{file}, options_{options}, buffer_{buffer}, capacity_{capacity},
+              last_sync_{clock::now()} {}
+
+        file_sink(const file_sink &other) = delete;
+        file_sink &operator=(const file_sink &other) = delete;
+
+        file_sink(file_sink &&other) noexcept = default;
+        file_sink &operator=(file_sink &&other) noexcept = default;
+
+        ~file_sink() noexcept
+        {
+            if (buffer_)
+            {
+                flush();
+
+                if (options_.sync != sync_policy::none && unsynced_)
+                {
+                    sync();
+                }
+            }
+        }
+
+        std::expected<void, unix::error_code> append(std::span<const std::byte> bytes) noexcept
+        {
+            if (!bytes.empty() && !pending())
+            {
+                first_pending_ = clock::now();
+            }
+            while (!bytes.empty())
+            {
+                const auto count = std::min(capacity_ - size_, bytes.size());
+                std::memcpy(buffer_.get() + size_, bytes.data(), count);
+                size_ += count;
+                bytes = bytes.subspan(count);
+
+                if (size_ == capacity_)
+                {
+                    const auto written = write_out();
+
+                    if (!written)
+                    {
+                        return written;
+                    }
+                    if (!bytes.empty())
+                    {
+                        first_pending_ = clock::now();
+                    }
+                }
+            }
+            return std::expected<void, unix::error_code>{};
+        }
+
+        std::expected<void, unix::error_code> flush() noexcept
+        {
+            if (!pending())
+            {
+                return std::expected<void, unix::error_code>{};
+            }
+            return write_out();
+        }
+
+        // writes the data older than the flush interval, syncs when the sync interval expired
+        std::expected<void, unix::error_code> flush_if_due(clock::time_point now) noexcept
+        {
+            if (pending() && now - first_pending_ >= options_.flush_interval)
+            {
+                const auto written = write_out();
+
+                if (!written)
+                {
+                    return written;
+                }
+            }
+            if (options_.sync == sync_policy::periodic && unsynced_ && now - last_sync_ >= options_.sync_interval)
+            {
+                return sync();
+            }
+            return std::expected<void, unix::error_code>{};
+        }
+
+        // the time left till flush_if_due has something to do
+        std::optional<clock::duration> time_till_due(clock::time_point now) const noexcept
+        {
+            std::optional<clock::duration> due;
+
+            if (pending())
+            {
+                due = first_pending_ + options_.flush_interval - now;
+            }
+            if (options_.sync == sync_policy::periodic && unsynced_)
+            {
+                const auto sync_due = last_sync_ + options_.sync_interval - now;
+                due = due ? std::min(due.value(), sync_due) : sync_due;
+            }
+            return due;
+        }
+
+        std::expected<void, unix::error_code> sync() noexcept
+        {
+            last_sync_ = clock::now();
+            unsynced_ = false;
+            ++sync_count_;
+            return file_.get().data_sync();
+        }
+
+        bool pending() const noexcept { return size_ > written_size_; }
+
+        std::size_t write_count() const noexcept { return write_count_; }
+
+        std::size_t sync_count() const noexcept { return sync_count_; }
+
+        // the logical size of the file
+        std::uint64_t size() const noexcept { return static_cast<std::uint64_t>(offset_) + size_; }
+
+    private:
+        std::reference_wrapper<const unix::fs::posix::file> file_;
+        sink_options options_;
+        std::unique_ptr<std::byte, buffer_deleter> buffer_;
+        std::size_t capacity_;
+        // the bytes in the buffer and those of them already in the file
+        std::size_t size_{0};
+        std::size_t written_size_{0};
+        // the file offset of the start of the buffer
+        off_t offset_{0};
+        off_t allocated_{0};
+        clock::time_point first_pending_{};
+        clock::time_point last_sync_;
+        bool unsynced_{false};
+        bool preallocate_{true};
+        std::size_t write_count_{0};
+        std::size_t sync_count_{0};
+
+        static constexpr std::size_t round_up(std::size_t size, std::size_t alignment) noexcept
+        {
+            return (size + alignment - 1) / alignment * alignment;
+        }
+
+        std::expected<void, unix::error_code> write_out() noexcept
+        {
+            const auto length = options_.direct_io ? round_up(size_, block_size) : size_;
+            std::memset(buffer_.get() + size_, 0, length - size_);
+            const auto reserved = reserve(offset_ + static_cast<off_t>(length));
+
+            if (!reserved)
+            {
+                return reserved;
+            }
+            const auto written = file_.get().write_at(buffer_.get(), length, offset_);
+
+            if (!written)
+            {
+                return written;
+            }
+            ++write_count_;
+            unsynced_ = true;
+
+            if (length != size_)
+            {
+                // drops the padding, the zeros are no valid entries
+                const auto truncated = file_.get().truncate(offset_ + static_cast<off_t>(size_));
+
+                if (!truncated)
+                {
+                    return truncated;
+                }
+                // the truncation releases the blocks reserved past the end
+                allocated_ = std::min(allocated_, offset_ + static_cast<off_t>(size_));
+            }
+            // a partial last block stays in the buffer till it gets filled
+            const auto whole_blocks = options_.direct_io ? size_ / block_size * block_size : size_;
+            std::memmove(buffer_.get(), buffer_.get() + whole_blocks, size_ - whole_blocks);
+            offset_ += static_cast<off_t>(whole_blocks);
+            size_ -= whole_blocks;
+            written_size_ = size_;
+
+            if (options_.sync == sync_policy::per_batch)
+            {
+                return sync();
+            }
+            return std::expected<void, unix::error_code>{};
+        }
+
+        std::expected<void, unix::error_code> reserve(off_t end) noexcept
+        {
+            if (options_.preallocation_size == 0 || !preallocate_ || end <= allocated_)
+            {
+                return std::expected<void, unix::error_code>{};
+            }
+            const auto length = static_cast<off_t>(round_up(static_cast<std::size_t>(end - allocated_),
+                                                            options_.preallocation_size));
+            const auto allocated = file_.get().allocate(allocated_, length);
+
+            if (!allocated)
+            {
+                // not every file system supports it, the writes go on without it
+                if (allocated.error().code == EOPNOTSUPP)
+                {
+                    preallocate_ = false;
+                    return std::expected<void, unix::error_code>{};
+                }
+                return allocated;
+            }
+            allocated_ += length;
+            return std::expected<void, unix::error_code>{};
+        }
+    };
+} // namespace async
+
+#endif // ASYNC_FILE_SINK_HPP
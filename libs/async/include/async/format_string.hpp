@@ -0,0 +1,142 @@
+#ifndef ASYNC_FORMAT_STRING_HPP
+#define ASYNC_FORMAT_STRING_HPP
+
+#include <array>
+#include <cstddef>
+#include <string_view>
+
+#include "core/string_literal.hpp"
+
+#include "async/argument_type.hpp"
+
+namespace async
+{
+    // a printf format with the types of its arguments, one static object per
+    // format and argument list, its address identifies it in the records
+    struct log_format
+    {
+        const format_signature &signature;
+        std::string_view text;
+    };
+
+    enum class format_check
+    {
+        ok,
+        too_few_arguments,
+        too_many_arguments,
+        mismatched_argument,
+        unsupported_conversion,
+        incomplete_conversion,
+    };
+
+    namespace detail
+    {
+        constexpr bool is_integer(argument_type type) noexcept
+        {
+            return type == argument_type::boolean || type == argument_type::character ||
+                   type == argument_type::signed_integer || type == argument_type::unsigned_integer;
+        }
+
+        // what the decoder accepts for a * width or precision, see render
+        constexpr bool is_width(argument_type type) noexcept
+        {
+            return type == argument_type::signed_integer || type == argument_type::unsigned_integer;
+        }
+
+        constexpr format_check check_conversion(char conversion, argument_type type) noexcept
+        {
+            switch (conversion)
+            {
+            case 'd':
+            case 'i':
+            case 'o':
+            case 'u':
+            case 'x':
+            case 'X':
+            case 'c':
+                return is_integer(type) ? format_check::ok : format_check::mismatched_argument;
+            case 'e':
+            case 'E':
+            case 'f':
+            case 'F':
+            case 'g':
+            case 'G':
+            case 'a':
+            case 'A':
+                return type == argument_type::floating_point ? format_check::ok
+                                                             : format_check::mismatched_argument;
+            case 'p':
+                return type == argument_type::pointer ? format_check::ok : format_check::mismatched_argument;
+            case 's':
+                // the custom arguments get rendered as text by their decoders
+                return type == argument_type::string || type == argument_type::custom
+                           ? format_check::ok
+                           : format_check::mismatched_argument;
+            default:
+                return format_check::unsupported_conversion;
+            }
+        }
+    } // namespace detail
+
+    // walks the conversions of the format the way printf does,
+    // each * and each conversion but %% takes the next argument
+    template <class... Args>
+    constexpr format_check check_format(std::string_view text) noexcept
+    {
+        constexpr std::array<argument_descriptor, sizeof...(Args)> arguments{describe_argument<Args>()...};
+        constexpr std::string_view skipped{"-+ #0123456789.hlLqjzt"};
+        std::size_t next{0};
+
+        for (std::size_t index{0}; index < text.size(); ++index)
+        {
+            if (text[index] != '%')
+            {
+                continue;
+            }
+            for (++index; index < text.size() && text[index] != '%'; ++index)
+            {
+                const auto character = text[index];
+
+                if (character == '*')
+                {
+                    if (next == arguments.size())
+                    {
+                        return format_check::too_few_arguments;
+                    }
+                    if (!detail::is_width(arguments[next++].type))
+                    {
+                        return format_check::mismatched_argument;
+                    }
+                }
+                else if (skipped.find(character) == std::string_view::npos)
+                {
+                    break;
+                }
+            }
+            if (index == text.size())
+            {
+                return format_check::incomplete_conversion;
+            }
+            if (text[index] == '%' && text[index - 1] == '%')
+            {
+                continue;
+            }
+            if (next == arguments.size())
+            {
+                return format_check::too_few_arguments;
+            }
+            const auto checked = detail::check_conversion(text[index], arguments[next++].type);
+
+            if (checked != format_check::ok)
+            {
+                return checked;
+            }
+        }
+        return next == arguments.size() ? format_check::ok : format_check::too_many_arguments;
+    }
+
+    template <core::string_literal Format, class... Args>
+    inline constexpr log_format log_format_of{signature_of<Args...>, Format.view()};
+} // namespace async
+
+#endif // ASYNC_FORMAT_STRING_HPP
@@ -0,0 +1,120 @@
+#ifndef ASYNC_LANE_HPP
+#define ASYNC_LANE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include "lock_free/event_count.hpp"
+#include "lock_free/spsc_message_ring.hpp"
+
+namespace async
+{
+    // what a producer does when its lane is full, the ring indices are the
+    // only flow control, nothing is paid until the ring actually fills up
+    enum class overflow_policy
+    {
+        // sleeps on a futex till the writer frees the lane
+        block,
+        // drops the record, the lane counts the dropped ones
+        drop_newest,
+        // moves the record to a queue guarded by a mutex, the following records
+        // go there too till the writer empties it, see logger_options::max_spilled_size
+        spill,
+    };
+
+    // the ring of a single producer thread, claimed on the first log of the
+    // thread and released once it exits, only its writer consumes it
+    template <std::size_t Capacity>
+    struct lane
+    {
+        lock_free::spsc_message_ring<Capacity> ring;
+        // the default id marks a free lane
+        std::atomic<std::thread::id> owner{};
+        // written by the owner only, read by anyone for the stats
+        std::atomic<std::uint64_t> pushed_count{0};
+        std::atomic<std::uint64_t> blocked_count{0};
+        std::atomic<std::uint64_t> dropped_count{0};
+        std::atomic<std::uint64_t> spilled_count{0};
+        // the writer notifies it after popping, the blocked owner waits on it
+        lock_free::event_count space_freed;
+        // set by the owner on the first spilled record, cleared by the writer
+        std::atomic<bool> spilling{false};
+        std::mutex overflow_mutex;
+        // the spilled records, each one preceded by its size
+        std::vector<std::byte> overflow;
+
+        bool try_claim(std::thread::id thread) noexcept
+        {
+            auto free = std::thread::id{};
+            return owner.compare_exchange_strong(free, thread, std::memory_order_acq_rel,
+                                                 std::memory_order_relaxed);
+        }
+
+        // owner only, its pushes happen before the next owner claims the lane
+        void release() noexcept
+        {
+            owner.store(std::thread::id{}, std::memory_order_release);
+        }
+
+        // owner only, false when the overflow would grow beyond the limit
+        bool spill(std::span<const std::byte> message, std::size_t max_size) noexcept
+        {
+            const std::size_t size{message.size()};
+            const std::lock_guard lock{overflow_mutex};
+            const auto offset = overflow.size();
+
+            if (offset + sizeof(size) + size > max_size)
+            {
+                return false;
+            }
+            overflow.resize(offset + sizeof(size) + size);
+            std::memcpy(overflow.data() + offset, &size, sizeof(size));
+            std::memcpy(overflow.data() + offset + sizeof(size), message.data(), size);
+            spilling.store(true, std::memory_order_release);
+            increment(spilled_count);
+            return true;
+        }
+
+        // writer only, the ring has to be drained first to keep the order,
+        // the owner pushes into the ring again once the flag is cleared
+        void take_overflow(std::vector<std::byte> &records) noexcept
+        {
+            records.clear();
+            const std::lock_guard lock{overflow_mutex};
+            records.swap(overflow);
+            spilling.store(false, std::memory_order_release);
+        }
+
+        // stops at the first record the consumer fails on
+        template <class Consumer>
+        static bool for_each_spilled(std::span<const std::byte> records, Consumer &&consumer) noexcept
+        {
+            for (std::size_t offset{0}; offset < records.size();)
+            {
+                std::size_t size;
+                std::memcpy(&size, records.data() + offset, sizeof(size));
+                offset += sizeof(size);
+
+                if (!consumer(records.subspan(offset, size)))
+                {
+                    return false;
+                }
+                offset += size;
+            }
+            return true;
+        }
+
+        static void increment(std::atomic<std::uint64_t> &counter) noexcept
+        {
+            counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+    };
+} // namespace async
+
+#endif // ASYNC_LANE_HPP
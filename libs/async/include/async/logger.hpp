@@ -0,0 +1,438 @@
+#ifndef ASYNC_LOGGER_HPP
+#define ASYNC_LOGGER_HPP
+
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <print>
+#include <span>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include "core/string_literal.hpp"
+#include "core/tsc_clock.hpp"
+
+#include "async/argument_type.hpp"
+#include "async/binary_format.hpp"
+#include "async/file_sink.hpp"
+#include "async/format_string.hpp"
+#include "async/lane.hpp"
+#include "async/message_buffer.hpp"
+#include "async/record.hpp"
+#include "async/segment_compressor.hpp"
+#include "async/writer_group.hpp"
+
+namespace async
+{
+    namespace detail
+    {
+        // tells the loggers apart in the lane cache of the producer threads
+        inline std::atomic<std::uint64_t> next_logger_id{1};
+
+        // an entry in the list of the loggers alive, an exiting thread gives
+        // its lane back only through a logger still in the list
+        class lane_registration
+        {
+        public:
+            using release_t = void (*)(void *lanes, std::size_t lane_index) noexcept;
+
+            explicit lane_registration(std::uint64_t logger_id, void *lanes, release_t release) noexcept
+                : logger_id_{logger_id}, lanes_{lanes}, release_{release}
+            {
+                const std::lock_guard lock{mutex_};
+                next_ = first_;
+                first_ = this;
+            }
+
+            lane_registration(const lane_registration &other) = delete;
+            lane_registration &operator=(const lane_registration &other) = delete;
+
+            ~lane_registration() noexcept
+            {
+                const std::lock_guard lock{mutex_};
+
+                for (auto **link = &first_; *link != nullptr; link = &(*link)->next_)
+                {
+                    if (*link == this)
+                    {
+                        *link = next_;
+                        break;
+                    }
+                }
+            }
+
+            // does nothing once the logger is gone, its lanes went with it
+            static void release(std::uint64_t logger_id, std::size_t lane_index) noexcept
+            {
+                const std::lock_guard lock{mutex_};
+
+                for (auto *registration = first_; registration != nullptr; registration = registration->next_)
+                {
+                    if (registration->logger_id_ == logger_id)
+                    {
+                        registration->release_(registration->lanes_, lane_index);
+                        return;
+                    }
+                }
+            }
+
+        private:
+            inline static std::mutex mutex_;
+            inline static lane_registration *first_{nullptr};
+
+            std::uint64_t logger_id_;
+            void *lanes_;
+            release_t release_;
+            lane_registration *next_{nullptr};
+        };
+
+        // the lane of the thread in the logger it logged through last, given
+        // back once the thread exits or logs through another logger
+        struct lane_cache
+        {
+            std::uint64_t logger_id{0};
+            std::size_t lane_index{0};
+
+            lane_cache() noexcept = default;
+            lane_cache(const lane_cache &other) = delete;
+            lane_cache &operator=(const lane_cache &other) = delete;
+
+            ~lane_cache() noexcept
+            {
+                release();
+            }
+
+            void release() noexcept
+            {
+                if (logger_id != 0)
+                {
+                    lane_registration::release(logger_id, lane_index);
+                    logger_id = 0;
+                }
+            }
+        };
+
+        inline thread_local lane_cache current_lane{};
+    } // namespace detail
+
+    struct logger_options
+    {
+        overflow_policy overflow{overflow_policy::block};
+        // the bytes a lane may spill, the records beyond get dropped
+        std::size_t max_spilled_size{16 * 1'024 * 1'024};
+        lane_order order{lane_order::arrival};
+        sink_options sink{};
+        rotation_options rotation{};
+        writer_placement placement{};
+    };
+
+    // the producers only serialize the arguments, the writers persist them
+    // in the binary log format, the text is rendered offline by the decoder,
+    // each producer thread pushes into a lane of its own so logging takes
+    // no lock, no read-modify-write and no syscall till its lane gets full,
+    // at most MaxProducerCount threads can log through one logger at once
+    template <std::size_t WriterCount, std::size_t LaneCapacity, std::size_t MaxProducerCount = 16>
+    class logger
+    {
+        static_assert(WriterCount > 0 && WriterCount <= MaxProducerCount);
+
+        using lane_type = lane<LaneCapacity>;
+        using lanes_type = std::array<lane_type, MaxProducerCount>;
+        using writers_type = writer_group<LaneCapacity, MaxProducerCount, WriterCount>;
+
+        // bounds the wait for the queued messages when the writers got stuck
+        static constexpr std::chrono::seconds drain_timeout{10};
+        static constexpr std::chrono::milliseconds drain_poll_period{1};
+
+        std::array<std::thread, WriterCount> threads_;
+        std::unique_ptr<lanes_type> lanes_;
+        // outlives the writers, which hand it their finished segments
+        std::unique_ptr<segment_compressor> compressor_;
+        writers_type writers_;
+        overflow_policy overflow_policy_;
+        std::size_t max_spilled_size_;
+        std::uint64_t id_{detail::next_logger_id.fetch_add(1, std::memory_order_relaxed)};
+        // dropped before the lanes, so no exiting thread touches them afterwards
+        detail::lane_registration registration_{id_, lanes_.get(), &release_lane};
+        std::atomic<std::size_t> claimed_count_{0};
+
+    public:
+        explicit logger(std::unique_ptr<lanes_type> lanes, std::unique_ptr<segment_compressor> compressor,
+                        std::string path_prefix, const logger_options &options) noexcept
+            : lanes_{std::move(lanes)}, compressor_{std::move(compressor)},
+              writers_{*lanes_, std::move(path_prefix), options.order, options.sink, options.rotation,
+                       compressor_.get(), options.placement},
+              overflow_policy_{options.overflow}, max_spilled_size_{options.max_spilled_size}
+        {
+            for (std::size_t index{0}; index < threads_.size(); ++index)
+            {
+                threads_[index] =
+                    std::move(std::thread{&writers_type::start, &writers_, index});
+            }
+        }
+
+        logger(const logger &other) = delete;
+        logger &operator=(const logger &other) = delete;
+
+        logger(logger &&other) noexcept = delete;
+        logger &operator=(logger &&other) noexcept = delete;
+
+        // the writers write <path prefix>.<writer id>.alog
+        // with the rotation enabled <path prefix>.<writer id>.<segment>.alog
+        static std::optional<logger> create(std::string path_prefix,
+                                            const logger_options &options = logger_options{}) noexcept
+        {
+            if (!core::tsc_clock::is_invariant())
+            {
+                std::println("the time stamp counter is not invariant, the timestamps of the threads may disagree");
+            }
+            // calibrated here rather than by the first writer opening its file
+            core::tsc_clock::process_clock();
+            auto lanes = std::unique_ptr<lanes_type>{new (std::nothrow) lanes_type{}};
+
+            if (!lanes)
+            {
+                std::println("failed to allocate {} lanes of {} bytes", MaxProducerCount, LaneCapacity);
+                return std::nullopt;
+            }
+            std::unique_ptr<segment_compressor> compressor;
+
+            if (options.rotation.enabled())
+            {
+                compressor.reset(new (std::nothrow) segment_compressor{options.rotation});
+
+                if (!compressor)
+                {
+                    std::println("failed to allocate the segment compressor");
+                    return std::nullopt;
+                }
+            }
+            return std::optional<logger>{std::in_place, std::move(lanes), std::move(compressor),
+                                         std::move(path_prefix), options};
+        }
+
+        // the messages still queued get written before the writers stop,
+        // no thread may log anymore
+        ~logger() noexcept
+        {
+            wait_till_all_popped_for(drain_timeout);
+            writers_.stop();
+
+            for (auto &thread : threads_)
+            {
+                thread.join();
+            }
+        }
+
+        // the format is parsed at compile time and checked against the arguments,
+        // the records carry the address of a static format object instead of its text,
+        // the strings get copied into the record, see argument_traits for the user types,
+        // false when the message got dropped, see overflow_policy::drop_newest,
+        // when it does not fit in a lane or when the writer of the lane failed
+        template <core::string_literal Format, class... Args>
+        bool log(Args &&...args) noexcept
+        {
+            require_valid_format<Format, logged_type<Args>...>();
+            const auto lane_index = current_lane_index();
+
+            if (!lane_index)
+            {
+                std::println("no lane left for the thread, at most {} threads can log",
+                             MaxProducerCount);
+                return false;
+            }
+            auto &lane = (*lanes_)[lane_index.value()];
+            const auto size = record_size(args...);
+            record_storage storage;
+
+            if (size > lock_free::spsc_message_ring<LaneCapacity>::max_message_size() || !storage.reserve(size))
+            {
+                lane_type::increment(lane.dropped_count);
+                return false;
+            }
+            const auto bytes = build_record<Format>(storage, args...);
+
+            // the spilled messages keep their order only when the following ones get spilled too
+            if (overflow_policy_ == overflow_policy::spill && lane.spilling.load(std::memory_order_acquire))
+            {
+                if (!spill(lane_index.value(), bytes))
+                {
+                    return false;
+                }
+            }
+            else if (!lane.ring.try_push(bytes) && !push_to_full_lane(lane_index.value(), bytes))
+            {
+                return false;
+            }
+            lane_type::increment(lane.pushed_count);
+            writers_.notify(lane_index.value());
+            return true;
+        }
+
+        // waits for the messages logged before the call,
+        // false once a writer failed, its messages will never be written
+        bool wait_till_all_popped() noexcept
+        {
+            const auto target = pushed_count();
+
+            for (auto popped = writers_.popped_count(); popped < target; popped = writers_.popped_count())
+            {
+                if (writers_.any_writer_failed())
+                {
+                    std::println("a writer failed, {} messages left", target - popped);
+                    return false;
+                }
+                writers_.wait_for_popped_count_change(popped);
+            }
+            return true;
+        }
+
+        template <class Rep, class Period>
+        bool wait_till_all_popped_for(const std::chrono::duration<Rep, Period> &timeout) noexcept
+        {
+            const auto target = pushed_count();
+            const auto deadline = std::chrono::steady_clock::now() + timeout;
+
+            while (writers_.popped_count() < target)
+            {
+                if (writers_.any_writer_failed())
+                {
+                    std::println("a writer failed, {} messages left", target - writers_.popped_count());
+                    return false;
+                }
+                if (std::chrono::steady_clock::now() >= deadline)
+                {
+                    std::println("failed waiting for all messages being read, {} left",
+                                 target - writers_.popped_count());
+                    return false;
+                }
+                std::this_thread::sleep_for(drain_poll_period);
+            }
+            return true;
+        }
+
+        // messages that found their lane full
+        std::size_t blocked_count() const noexcept { return sum_of(&lane_type::blocked_count); }
+
+        // including the messages too large for a lane
+        std::size_t dropped_count() const noexcept { return sum_of(&lane_type::dropped_count); }
+
+        std::size_t spilled_count() const noexcept { return sum_of(&lane_type::spilled_count); }
+
+        std::size_t pushed_count() const noexcept { return sum_of(&lane_type::pushed_count); }
+
+        std::size_t popped_count() const noexcept { return writers_.popped_count(); }
+
+        // threads that got a lane so far, the lanes of the exited ones get reused
+        std::size_t producer_count() const noexcept
+        {
+            return claimed_count_.load(std::memory_order_relaxed);
+        }
+
+    private:
+        // the only path that may sleep or allocate, false when the message got dropped
+        bool push_to_full_lane(std::size_t lane_index, std::span<const std::byte> message) noexcept
+        {
+            auto &lane = (*lanes_)[lane_index];
+
+            switch (overflow_policy_)
+            {
+            case overflow_policy::block:
+                lane_type::increment(lane.blocked_count);
+
+                while (true)
+                {
+                    // a lane with messages keeps its writer awake, no need to notify it
+                    const auto epoch = lane.space_freed.prepare_wait();
+
+                    if (lane.ring.try_push(message))
+                    {
+                        lane.space_freed.cancel_wait();
+                        return true;
+                    }
+                    // checked after preparing the wait, the failing writer wakes the lane up
+                    if (writers_.writer_failed(lane_index))
+                    {
+                        lane.space_freed.cancel_wait();
+                        lane_type::increment(lane.dropped_count);
+                        return false;
+                    }
+                    lane.space_freed.wait(epoch);
+                }
+            case overflow_policy::drop_newest:
+                lane_type::increment(lane.dropped_count);
+                return false;
+            case overflow_policy::spill:
+                return spill(lane_index, message);
+            }
+            return false;
+        }
+
+        // a failed writer never takes the overflow, it would grow till the memory runs out
+        bool spill(std::size_t lane_index, std::span<const std::byte> message) noexcept
+        {
+            auto &lane = (*lanes_)[lane_index];
+
+            if (writers_.writer_failed(lane_index) || !lane.spill(message, max_spilled_size_))
+            {
+                lane_type::increment(lane.dropped_count);
+                return false;
+            }
+            return true;
+        }
+
+        // the cache spares the scan of the lanes but on the first log of the thread
+        std::optional<std::size_t> current_lane_index() noexcept
+        {
+            auto &cache = detail::current_lane;
+
+            if (cache.logger_id == id_)
+            {
+                return cache.lane_index;
+            }
+            // the thread logged through another logger meanwhile
+            cache.release();
+            const auto thread = std::this_thread::get_id();
+
+            for (std::size_t index{0}; index < MaxProducerCount; ++index)
+            {
+                if ((*lanes_)[index].try_claim(thread))
+                {
+                    claimed_count_.fetch_add(1, std::memory_order_relaxed);
+                    cache.logger_id = id_;
+                    cache.lane_index = index;
+                    return index;
+                }
+            }
+            return std::nullopt;
+        }
+
+        // the records left in the lane still get written, the next owner appends to them
+        static void release_lane(void *lanes, std::size_t lane_index) noexcept
+        {
+            (*static_cast<lanes_type *>(lanes))[lane_index].release();
+        }
+
+        std::size_t sum_of(std::atomic<std::uint64_t> lane_type::*counter) const noexcept
+        {
+            std::size_t sum{0};
+
+            for (const auto &lane : *lanes_)
+            {
+                sum += (lane.*counter).load(std::memory_order_relaxed);
+            }
+            return sum;
+        }
+    };
+} // namespace async
+
+#endif // ASYNC_LOGGER_HPP
@@ -0,0 +1,168 @@
+#ifndef ASYNC_MESSAGE_BUFFER_HPP
+#define ASYNC_MESSAGE_BUFFER_HPP
+
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <span>
+#include <string_view>
+#include <type_traits>
+
+#include "async/argument_type.hpp"
+
+namespace async
+{
+    // reads the fields of a message in place
+    class output_message_buffer
+    {
+        std::span<const std::byte> buffer_;
+        std::size_t read_count_{0};
+
+    public:
+        // the fields are not aligned within the message
+        template <class Value>
+            requires std::is_trivially_copyable_v<Value>
+        Value read() noexcept
+        {
+            assert((buffer_.size() - read_count_) >= sizeof(Value));
+            Value value;
+            std::memcpy(&value, buffer_.data() + read_count_, sizeof(Value));
+            read_count_ += sizeof(Value);
+            return value;
+        }
+
+        template <class Value>
+        std::span<const Value> read(std::size_t size) noexcept
+        {
+            const auto total_size = sizeof(Value) * size;
+            assert((buffer_.size() - read_count_) >= total_size);
+            const void *data = buffer_.data() + read_count_;
+            const auto array = std::span<const Value>{reinterpret_cast<const Value *>(data), size};
+            read_count_ += total_size;
+            return array;
+        }
+
+        std::size_t size() const noexcept { return buffer_.size(); }
+
+        bool all_read() const noexcept { return read_count_ == buffer_.size(); }
+
+        std::size_t remaining() const noexcept
+        {
+            assert(read_count_ <= buffer_.size());
+            return buffer_.size() - read_count_;
+        }
+
+        void reset(std::span<const std::byte> buffer) noexcept
+        {
+            buffer_ = buffer;
+            read_count_ = 0;
+        }
+    };
+
+    namespace detail
+    {
+        template <class Value>
+        std::string_view characters_of(const Value &value) noexcept
+        {
+            if constexpr (std::is_pointer_v<Value>)
+            {
+                return value != nullptr ? std::string_view{value} : std::string_view{"(null)"};
+            }
+            else
+            {
+                return std::string_view{value};
+            }
+        }
+    } // namespace detail
+
+    // the bytes an argument takes in a message, the strings and the custom
+    // arguments take their length prefix too
+    template <class Value>
+    std::size_t encoded_size(const Value &value) noexcept
+    {
+        if constexpr (string_argument<Value>)
+        {
+            return sizeof(argument_length_t) + detail::characters_of(value).size();
+        }
+        else if constexpr (custom_argument<Value>)
+        {
+            return sizeof(argument_length_t) + argument_traits<Value>::size(value);
+        }
+        else
+        {
+            return sizeof(Value);
+        }
+    }
+
+    // writes the fields of a message into the storage it got, which has
+    // to be large enough, see encoded_size, nothing gets initialized upfront
+    class input_message_buffer
+    {
+        std::span<std::byte> buffer_;
+        std::size_t size_{0};
+
+        std::span<std::byte> reserve(std::size_t size) noexcept
+        {
+            assert((buffer_.size() - size_) >= size);
+            const auto reserved = buffer_.subspan(size_, size);
+            size_ += size;
+            return reserved;
+        }
+
+        void write_length(std::size_t length) noexcept
+        {
+            assert(length <= UINT32_MAX);
+            write(static_cast<argument_length_t>(length));
+        }
+
+    public:
+        explicit input_message_buffer(std::span<std::byte> buffer) noexcept
+            : buffer_{buffer} {}
+
+        template <class Value>
+            requires std::is_trivially_copyable_v<Value>
+        void write(const Value &value) noexcept
+        {
+            std::memcpy(reserve(sizeof(Value)).data(), &value, sizeof(Value));
+        }
+
+        // serializes the argument the way describe_argument tells the decoder
+        template <class Value>
+        void write_argument(const Value &value) noexcept
+        {
+            if constexpr (string_argument<Value>)
+            {
+                const auto characters = detail::characters_of(value);
+                write_length(characters.size());
+                std::memcpy(reserve(characters.size()).data(), characters.data(), characters.size());
+            }
+            else if constexpr (custom_argument<Value>)
+            {
+                const auto size = argument_traits<Value>::size(value);
+                write_length(size);
+                argument_traits<Value>::encode(value, reserve(size));
+            }
+            else
+            {
+                write(value);
+            }
+        }
+
+        std::size_t size() const noexcept { return size_; }
+
+        std::span<const std::byte> bytes() const noexcept
+        {
+            return buffer_.first(size_);
+        }
+
+        bool full() const noexcept { return size_ == buffer_.size(); }
+    };
+
+    template <class... Args>
+    void fill_buffer(input_message_buffer &buffer, const Args &...args) noexcept
+    {
+        (buffer.write_argument(args), ...);
+    }
+} // namespace async
+
+#endif // ASYNC_MESSAGE_BUFFER_HPP
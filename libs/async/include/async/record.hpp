@@ -0,0 +1,126 @@
+#ifndef ASYNC_RECORD_HPP
+#define ASYNC_RECORD_HPP
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <span>
+#include <type_traits>
+
+#include "core/string_literal.hpp"
+
+#include "async/binary_format.hpp"
+#include "async/format_string.hpp"
+#include "async/message_buffer.hpp"
+
+// a record is the address of its format object, the timestamp
+// and the arguments taking the rest of it, the address is only
+// meaningful within the process image the record was built in
+namespace async
+{
+    // the parsed format and the arguments are checked at compile time
+    template <core::string_literal Format, class... Args>
+    constexpr void require_valid_format() noexcept
+    {
+        static_assert(sizeof...(Args) <= UINT8_MAX);
+        constexpr auto checked = check_format<Args...>(Format.view());
+        static_assert(checked != format_check::too_few_arguments, "the format needs more arguments");
+        static_assert(checked != format_check::too_many_arguments, "the format needs fewer arguments");
+        static_assert(checked != format_check::mismatched_argument, "an argument does not match its conversion");
+        static_assert(checked != format_check::unsupported_conversion,
+                      "only the integer, floating point, character, string and pointer conversions are supported");
+        static_assert(checked != format_check::incomplete_conversion, "the format ends within a conversion");
+    }
+
+    // the type an argument gets logged as, the character arrays as strings
+    template <class Value>
+    using logged_type = std::decay_t<const Value>;
+
+    template <class... Args>
+    std::size_t record_size(const Args &...args) noexcept
+    {
+        return sizeof(std::uintptr_t) + sizeof(binary::timestamp_t) +
+               (std::size_t{0} + ... + encoded_size<logged_type<Args>>(args));
+    }
+
+    // the storage of a record being built, the usual records fit
+    // on the stack, only the long strings take an allocation
+    class record_storage
+    {
+        static constexpr std::size_t inline_capacity{256};
+
+        std::array<std::byte, inline_capacity> inline_bytes_;
+        std::unique_ptr<std::byte[]> allocated_bytes_;
+        std::span<std::byte> bytes_;
+
+    public:
+        record_storage() noexcept = default;
+
+        record_storage(const record_storage &other) = delete;
+        record_storage &operator=(const record_storage &other) = delete;
+
+        // false when the allocation failed, nothing gets initialized
+        bool reserve(std::size_t size) noexcept
+        {
+            if (size <= inline_bytes_.size())
+            {
+                bytes_ = std::span<std::byte>{inline_bytes_}.first(size);
+                return true;
+            }
+            allocated_bytes_.reset(new (std::nothrow) std::byte[size]);
+
+            if (!allocated_bytes_)
+            {
+                return false;
+            }
+            bytes_ = std::span<std::byte>{allocated_bytes_.get(), size};
+            return true;
+        }
+
+        std::span<std::byte> bytes() const noexcept { return bytes_; }
+    };
+
+    // stamps the record and fills the reserved storage, see record_size
+    template <core::string_literal Format, class... Args>
+    std::span<const std::byte> build_record(const record_storage &storage, const Args &...args) noexcept
+    {
+        input_message_buffer message{storage.bytes()};
+        const auto &format = log_format_of<Format, logged_type<Args>...>;
+        fill_buffer<std::uintptr_t, binary::timestamp_t, logged_type<Args>...>(
+            message, reinterpret_cast<std::uintptr_t>(&format), binary::current_timestamp(), args...);
+        assert(message.full());
+        return message.bytes();
+    }
+
+    struct record_view
+    {
+        const log_format &format;
+        binary::timestamp_t timestamp;
+        std::span<const std::byte> arguments;
+    };
+
+    record_view read_record(std::span<const std::byte> record) noexcept
+    {
+        output_message_buffer message;
+        message.reset(record);
+        const auto format_address = message.read<std::uintptr_t>();
+        const auto timestamp = message.read<binary::timestamp_t>();
+        const auto arguments = message.read<std::byte>(message.remaining());
+        assert(message.all_read());
+        return record_view{*reinterpret_cast<const log_format *>(format_address), timestamp, arguments};
+    }
+
+    // spares parsing the whole record when only ordering it
+    binary::timestamp_t timestamp_of(std::span<const std::byte> record) noexcept
+    {
+        binary::timestamp_t timestamp;
+        std::memcpy(&timestamp, record.data() + sizeof(std::uintptr_t), sizeof(timestamp));
+        return timestamp;
+    }
+} // namespace async
+
+#endif // ASYNC_RECORD_HPP
@@ -0,0 +1,181 @@
+#ifndef ASYNC_SEGMENT_COMPRESSOR_HPP
+#define ASYNC_SEGMENT_COMPRESSOR_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <print>
+#include <string>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <utility>
+
+#include "unix/error_code.hpp"
+#include "unix/process.hpp"
+#include "unix/scheduling.hpp"
+#include "unix/spawn.hpp"
+
+namespace async
+{
+    // zero disables a limit
+    struct rotation_options
+    {
+        // a writer starts a new segment once its current one reaches a limit
+        std::uint64_t max_segment_size{0};
+        std::chrono::seconds max_segment_age{0};
+        // run as <command> -f <segment>, it has to replace the segment by the
+        // segment followed by the extension, the finished segments are not
+        // compressed by default, "gzip" matches the default extension
+        std::string compress_command{};
+        std::string compressed_extension{".gz"};
+        // the oldest finished segments get deleted beyond these, the segments
+        // still written are not counted, the ones left by earlier runs are
+        std::size_t max_segment_count{0};
+        std::uint64_t max_total_size{0};
+
+        bool enabled() const noexcept
+        {
+            return max_segment_size != 0 || max_segment_age != std::chrono::seconds::zero();
+        }
+    };
+
+    // compresses the finished segments and enforces the retention on a thread
+    // scheduled only when the cpu has nothing else to do, so neither the
+    // producers nor the writers ever wait for it
+    class segment_compressor
+    {
+        struct queued_segment
+        {
+            std::string path;
+            bool compressed;
+        };
+
+        struct finished_segment
+        {
+            std::string path;
+            std::uint64_t size;
+        };
+
+        rotation_options options_;
+        std::mutex mutex_;
+        std::condition_variable segment_added_;
+        std::deque<queued_segment> queued_;
+        bool stopping_{false};
+        // the retained segments, the oldest first
+        std::deque<finished_segment> finished_;
+        std::uint64_t total_size_{0};
+        std::thread thread_;
+
+    public:
+        explicit segment_compressor(const rotation_options &options) noexcept
+            : options_{options}, thread_{&segment_compressor::run, this} {}
+
+        segment_compressor(const segment_compressor &other) = delete;
+        segment_compressor &operator=(const segment_compressor &other) = delete;
+
+        // the queued segments get compressed before it returns
+        ~segment_compressor() noexcept
+        {
+            {
+                const std::lock_guard lock{mutex_};
+                stopping_ = true;
+            }
+            segment_added_.notify_one();
+            thread_.join();
+        }
+
+        // called by the writers, takes a lock but never waits for the compression,
+        // the compressed segments only count towards the retention
+        void submit(std::string path, bool compressed = false) noexcept
+        {
+            {
+                const std::lock_guard lock{mutex_};
+                queued_.push_back(queued_segment{std::move(path), compressed});
+            }
+            segment_added_.notify_one();
+        }
+
+    private:
+        void run() noexcept
+        {
+            unix::name_current_thread("log_compressor");
+            const auto lowered = unix::set_current_thread_scheduling(unix::scheduling_policy::idle, 0);
+
+            if (!lowered)
+            {
+                std::println("failed to lower the compressor priority due to: {}",
+                             unix::to_string(lowered.error()));
+            }
+            while (true)
+            {
+                queued_segment segment;
+                {
+                    std::unique_lock lock{mutex_};
+                    segment_added_.wait(lock, [this] { return stopping_ || !queued_.empty(); });
+
+                    if (queued_.empty())
+                    {
+                        return;
+                    }
+                    segment = std::move(queued_.front());
+                    queued_.pop_front();
+                }
+                if (!segment.compressed && !options_.compress_command.empty() && compress(segment.path))
+                {
+                    segment.path += options_.compressed_extension;
+                }
+                retain(std::move(segment.path));
+            }
+        }
+
+        bool compress(const std::string &path) noexcept
+        {
+            auto command = options_.compress_command;
+            std::string force{"-f"};
+            auto segment = path;
+            char *const arguments[]{command.data(), force.data(), segment.data(), nullptr};
+            const auto spawned = unix::spawn_searching_path(command, arguments);
+
+            if (!spawned)
+            {
+                std::println("failed to spawn {} due to: {}", command, unix::to_string(spawned.error()));
+                return false;
+            }
+            const auto status = unix::wait_till_child_terminates(spawned.value());
+
+            if (!status || !WIFEXITED(status.value()) || WEXITSTATUS(status.value()) != 0)
+            {
+                std::println("failed to compress {}", path);
+                return false;
+            }
+            // not every compressor removes its input
+            unlink(path.c_str());
+            return true;
+        }
+
+        void retain(std::string path) noexcept
+        {
+            struct stat status;
+            const auto size = stat(path.c_str(), &status) == 0 ? static_cast<std::uint64_t>(status.st_size)
+                                                                : std::uint64_t{0};
+            finished_.push_back(finished_segment{std::move(path), size});
+            total_size_ += size;
+
+            while (!finished_.empty() &&
+                   ((options_.max_segment_count != 0 && finished_.size() > options_.max_segment_count) ||
+                    (options_.max_total_size != 0 && total_size_ > options_.max_total_size)))
+            {
+                unlink(finished_.front().path.c_str());
+                total_size_ -= finished_.front().size;
+                finished_.pop_front();
+            }
+        }
+    };
+} // namespace async
+
+#endif // ASYNC_SEGMENT_COMPRESSOR_HPP
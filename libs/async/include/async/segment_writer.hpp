@@ -0,0 +1,246 @@
+#ifndef ASYNC_SEGMENT_WRITER_HPP
+#define ASYNC_SEGMENT_WRITER_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "unix/error_code.hpp"
+#include "unix/fs/posix/file.hpp"
+#include "unix/fs/posix/file_open_flags_builder.hpp"
+
+#include "async/argument_type.hpp"
+#include "async/binary_format.hpp"
+#include "async/binary_writer.hpp"
+#include "async/file_sink.hpp"
+#include "async/format_string.hpp"
+#include "async/segment_compressor.hpp"
+
+namespace async
+{
+    // the files of a single writer, <path prefix>.<writer id>.alog without
+    // rotation, <path prefix>.<writer id>.<segment>.alog with it, every
+    // segment starts with its own header and formats so it decodes on its own,
+    // the rotation happens on the writer thread between two batches, the
+    // producers keep filling their lanes meanwhile, the numbering continues
+    // after the segments of the earlier runs, which get handed to the
+    // compressor on the first open, so no run overwrites another one
+    class segment_writer
+    {
+        using clock = std::chrono::steady_clock;
+
+    public:
+        // the compressor is needed only with the rotation enabled
+        explicit segment_writer(std::string path_prefix, std::size_t writer_id, const sink_options &sink,
+                                const rotation_options &rotation, segment_compressor *compressor) noexcept
+            : path_prefix_{std::move(path_prefix)}, writer_id_{writer_id}, sink_options_{sink},
+              rotation_options_{rotation}, compressor_{compressor}
+        {
+            assert(!rotation_options_.enabled() || compressor_ != nullptr);
+        }
+
+        segment_writer(const segment_writer &other) = delete;
+        segment_writer &operator=(const segment_writer &other) = delete;
+
+        std::expected<void, unix::error_code> open() noexcept
+        {
+            if (rotation_options_.enabled() && !resumed_)
+            {
+                const auto resumed = resume();
+
+                if (!resumed)
+                {
+                    return resumed;
+                }
+                resumed_ = true;
+            }
+            path_ = path_prefix_ + "." + std::to_string(writer_id_);
+
+            if (rotation_options_.enabled())
+            {
+                path_ += "." + std::to_string(segment_);
+            }
+            path_ += ".alog";
+            auto flags = unix::fs::posix::file_open_flags_builder{unix::fs::posix::access_mode::write_only}
+                             .create_if_absent()
+                             .truncate()
+                             .close_on_exec();
+
+            if (sink_options_.direct_io)
+            {
+#ifdef __linux__
+                flags.direct();
+#else
+                return std::unexpected{unix::error_code{EINVAL}};
+#endif
+            }
+            auto opened = unix::fs::posix::file::open(path_, flags.get(), 0644);
+
+            if (!opened)
+            {
+                return std::unexpected{opened.error()};
+            }
+            file_.emplace(std::move(opened.value()));
+            auto created = file_sink::create(file_.value(), sink_options_);
+
+            if (!created)
+            {
+                file_.reset();
+                return std::unexpected{created.error()};
+            }
+            sink_.emplace(std::move(created.value()));
+            output_.emplace(sink_.value());
+            opened_at_ = clock::now();
+            return std::expected<void, unix::error_code>{};
+        }
+
+        // opens the next segment of a rotation, so no run ends with an empty one
+        std::expected<void, unix::error_code> write(const log_format &format, binary::timestamp_t timestamp,
+                                                    std::span<const std::byte> arguments) noexcept
+        {
+            if (!output_)
+            {
+                const auto opened = open();
+
+                if (!opened)
+                {
+                    return opened;
+                }
+            }
+            return output_->write(format, timestamp, arguments);
+        }
+
+        std::expected<void, unix::error_code> flush() noexcept
+        {
+            return output_ ? output_->flush() : std::expected<void, unix::error_code>{};
+        }
+
+        std::expected<void, unix::error_code> flush_if_due(clock::time_point now) noexcept
+        {
+            return output_ ? output_->flush_if_due(now) : std::expected<void, unix::error_code>{};
+        }
+
+        std::optional<clock::duration> time_till_due(clock::time_point now) const noexcept
+        {
+            return output_ ? output_->time_till_due(now) : std::nullopt;
+        }
+
+        // hands the full segment over to the compressor, the next one
+        // gets opened by the next write
+        std::expected<void, unix::error_code> rotate_if_due(clock::time_point now) noexcept
+        {
+            const auto &rotation = rotation_options_;
+
+            if (!rotation.enabled() || !output_ ||
+                !((rotation.max_segment_size != 0 && sink_->size() >= rotation.max_segment_size) ||
+                  (rotation.max_segment_age != std::chrono::seconds::zero() &&
+                   now - opened_at_ >= rotation.max_segment_age)))
+            {
+                return std::expected<void, unix::error_code>{};
+            }
+            const auto flushed = output_->flush();
+
+            if (!flushed)
+            {
+                return flushed;
+            }
+            output_.reset();
+            sink_.reset();
+            file_.reset();
+            compressor_->submit(path_);
+            ++segment_;
+            return std::expected<void, unix::error_code>{};
+        }
+
+        const std::string &path() const noexcept { return path_; }
+
+    private:
+        // the segments of the earlier runs, the oldest first, the uncompressed
+        // ones were still written when their run ended
+        std::expected<void, unix::error_code> resume() noexcept
+        {
+            const std::filesystem::path prefix{path_prefix_};
+            const auto directory = prefix.has_parent_path() ? prefix.parent_path() : std::filesystem::path{"."};
+            const auto stem = prefix.filename().string() + "." + std::to_string(writer_id_) + ".";
+            std::vector<std::pair<std::uint64_t, std::string>> earlier;
+            std::error_code error;
+
+            for (std::filesystem::directory_iterator entry{directory, error}, end; !error && entry != end;
+                 entry.increment(error))
+            {
+                const auto segment = segment_of(entry->path().filename().string(), stem);
+
+                if (segment)
+                {
+                    earlier.emplace_back(segment.value(), entry->path().string());
+                }
+            }
+            if (error)
+            {
+                return std::unexpected{unix::error_code{error.value()}};
+            }
+            std::ranges::sort(earlier);
+
+            for (auto &[segment, path] : earlier)
+            {
+                segment_ = std::max(segment_, segment + 1);
+                const auto compressed = !path.ends_with(".alog");
+                compressor_->submit(std::move(path), compressed);
+            }
+            return std::expected<void, unix::error_code>{};
+        }
+
+        // <stem><segment>.alog, optionally followed by the compressed extension
+        static std::optional<std::uint64_t> segment_of(std::string_view name, std::string_view stem) noexcept
+        {
+            if (!name.starts_with(stem))
+            {
+                return std::nullopt;
+            }
+            name.remove_prefix(stem.size());
+            std::uint64_t segment;
+            const auto [end, error] = std::from_chars(name.data(), name.data() + name.size(), segment);
+
+            if (error != std::errc{} || end == name.data())
+            {
+                return std::nullopt;
+            }
+            const std::string_view rest{end, static_cast<std::size_t>(name.data() + name.size() - end)};
+
+            if (rest != ".alog" && !rest.starts_with(".alog."))
+            {
+                return std::nullopt;
+            }
+            return segment;
+        }
+
+        std::string path_prefix_;
+        std::size_t writer_id_;
+        sink_options sink_options_;
+        rotation_options rotation_options_;
+        segment_compressor *compressor_;
+        std::string path_;
+        std::uint64_t segment_{0};
+        bool resumed_{false};
+        clock::time_point opened_at_{};
+        // destroyed in the reverse order, each one refers to the previous one
+        std::optional<unix::fs::posix::file> file_;
+        std::optional<file_sink> sink_;
+        std::optional<binary_writer> output_;
+    };
+} // namespace async
+
+#endif // ASYNC_SEGMENT_WRITER_HPP
@@ -0,0 +1,117 @@
+#ifndef ASYNC_SHARED_LOG_HPP
+#define ASYNC_SHARED_LOG_HPP
+
+#ifdef __linux__ // the lanes are owned by kernel thread ids, see unix::get_thread_id
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "lock_free/event_count.hpp"
+#include "lock_free/spsc_message_ring.hpp"
+#include "unix/process.hpp"
+
+namespace async
+{
+    // the ring of a single producer thread of any process, only the collector
+    // consumes it, nothing in it refers to the memory of a process
+    template <std::size_t Capacity>
+    struct shared_lane
+    {
+        lock_free::spsc_message_ring<Capacity> ring;
+        // the kernel thread id of the owner, zero marks a free lane
+        std::atomic<unix::process_id_t> owner{0};
+        // written by the owner only, read by anyone for the stats
+        std::atomic<std::uint64_t> pushed_count{0};
+        std::atomic<std::uint64_t> blocked_count{0};
+        std::atomic<std::uint64_t> dropped_count{0};
+        // the collector notifies it after popping, the blocked owner waits on it
+        lock_free::shared_event_count space_freed;
+
+        bool try_claim(unix::process_id_t thread) noexcept
+        {
+            unix::process_id_t free{0};
+            return owner.compare_exchange_strong(free, thread, std::memory_order_acq_rel,
+                                                 std::memory_order_relaxed);
+        }
+
+        // collector only, once the owner exited and the ring got drained
+        void release() noexcept
+        {
+            owner.store(0, std::memory_order_release);
+        }
+
+        static void increment(std::atomic<std::uint64_t> &counter) noexcept
+        {
+            counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+    };
+
+    enum class collector_state : std::uint32_t
+    {
+        starting,
+        // the output got opened, the records get written
+        running,
+        // the output could not be opened, see shared_log::collector_error
+        failed,
+        // everything got written, the collector is about to exit
+        done,
+    };
+
+    // the state the producer processes share with the collector, placed
+    // in memory mapped before they get forked, so they all see it
+    template <std::size_t LaneCapacity, std::size_t LaneCount>
+    struct shared_log
+    {
+        std::array<shared_lane<LaneCapacity>, LaneCount> lanes;
+        // the producers notify it after pushing, the idle collector waits on it
+        lock_free::shared_event_count records_pushed;
+        std::atomic<std::uint64_t> popped_count{0};
+        std::atomic<bool> stopping{false};
+        std::atomic<collector_state> state{collector_state::starting};
+        // set before the collector leaves the starting state, the state
+        // alone cannot tell a killed or crashed collector from a running one
+        std::atomic<unix::process_id_t> collector_process{0};
+        // the errno of the failed collector
+        std::atomic<int> collector_error{0};
+        lock_free::shared_event_count state_changed;
+
+        void change_state(collector_state next) noexcept
+        {
+            state.store(next, std::memory_order_release);
+            state_changed.wake_all();
+        }
+
+        // false when the timeout expired first
+        template <class Predicate>
+        bool wait_for_state(Predicate predicate, std::chrono::nanoseconds timeout) noexcept
+        {
+            const auto deadline = std::chrono::steady_clock::now() + timeout;
+
+            while (true)
+            {
+                const auto epoch = state_changed.prepare_wait();
+
+                if (predicate(state.load(std::memory_order_acquire)))
+                {
+                    state_changed.cancel_wait();
+                    return true;
+                }
+                const auto left = deadline - std::chrono::steady_clock::now();
+
+                if (left <= std::chrono::nanoseconds::zero())
+                {
+                    state_changed.cancel_wait();
+                    return false;
+                }
+                state_changed.wait_for(epoch, left);
+            }
+        }
+    };
+} // namespace async
+
+#endif
+
+#endif // ASYNC_SHARED_LOG_HPP
@@ -0,0 +1,431 @@
+#ifndef ASYNC_SHARED_LOGGER_HPP
+#define ASYNC_SHARED_LOGGER_HPP
+
+#ifdef __linux__ // the lanes are claimed by kernel thread ids, stdout_logger stands in elsewhere
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <expected>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <print>
+#include <pthread.h>
+#include <span>
+#include <thread>
+#include <unistd.h>
+#include <utility>
+
+#include "core/string_literal.hpp"
+#include "core/tsc_clock.hpp"
+#include "lock_free/spsc_message_ring.hpp"
+#include "unix/error_code.hpp"
+#include "unix/ipc/posix/memory_mapping.hpp"
+#include "unix/pidfd.hpp"
+#include "unix/process.hpp"
+
+#include "async/collector.hpp"
+#include "async/lane.hpp"
+#include "async/record.hpp"
+#include "async/shared_log.hpp"
+
+namespace async
+{
+    namespace detail
+    {
+        // the lane of the thread, a forked child is another thread and claims its own
+        struct shared_lane_cache
+        {
+            const void *log{nullptr};
+            std::size_t lane_index{0};
+        };
+
+        inline thread_local shared_lane_cache current_shared_lane{};
+
+        inline void forget_shared_lane() noexcept
+        {
+            current_shared_lane = shared_lane_cache{};
+        }
+    } // namespace detail
+
+    struct shared_logger_options
+    {
+        // overflow_policy::spill is not supported, the lanes cannot refer to the memory of a process
+        overflow_policy overflow{overflow_policy::block};
+        collector_options collector{};
+    };
+
+    // the logger of a process and the children it forks afterwards, each
+    // producer thread of any of them pushes into a lane of its own within
+    // shared memory, so logging is a copy instead of a locked write, the
+    // collector process drains the lanes in the timestamp order and writes
+    // the records, the records carry the addresses of the static formats,
+    // so the producers have to be forks of the creator which did not exec,
+    // at most MaxProducerCount threads can hold a lane at once
+    template <std::size_t LaneCapacity, std::size_t MaxProducerCount = 32>
+    class shared_logger
+    {
+        using log_type = shared_log<LaneCapacity, MaxProducerCount>;
+        using lane_type = shared_lane<LaneCapacity>;
+        using collector_type = collector<LaneCapacity, MaxProducerCount>;
+
+        // bounds the start and the drain of the collector when it got stuck
+        static constexpr std::chrono::seconds start_timeout{10};
+        static constexpr std::chrono::seconds drain_timeout{10};
+        static constexpr std::chrono::milliseconds drain_poll_period{1};
+        // how often a blocked producer checks the collector is still there
+        static constexpr std::chrono::milliseconds liveness_period{100};
+
+        unix::ipc::posix::memory_mapping memory_;
+        log_type *log_;
+        overflow_policy overflow_policy_;
+        unix::process_id_t creator_;
+        // inherited by the forked producers, so any of them notices a killed collector
+        unix::pidfd collector_;
+
+    public:
+        explicit shared_logger(unix::ipc::posix::memory_mapping memory, overflow_policy overflow,
+                               unix::process_id_t creator, unix::pidfd collector) noexcept
+            : memory_{std::move(memory)}, log_{static_cast<log_type *>(memory_.data())},
+              overflow_policy_{overflow}, creator_{creator}, collector_{std::move(collector)} {}
+
+        shared_logger(const shared_logger &other) = delete;
+        shared_logger &operator=(const shared_logger &other) = delete;
+
+        shared_logger(shared_logger &&other) noexcept
+            : memory_{std::move(other.memory_)}, log_{std::exchange(other.log_, nullptr)},
+              overflow_policy_{other.overflow_policy_}, creator_{other.creator_},
+              collector_{std::move(other.collector_)} {}
+
+        shared_logger &operator=(shared_logger &&other) noexcept = delete;
+
+        // maps the lanes and forks the collector, which is not a child of the
+        // caller, so waiting for any child never reaps it, fails with EINVAL for
+        // overflow_policy::spill and with the errno of the collector opening the output
+        static std::expected<shared_logger, unix::error_code> create(
+            const shared_logger_options &options = shared_logger_options{}) noexcept
+        {
+            if (options.overflow == overflow_policy::spill)
+            {
+                return std::unexpected{unix::error_code{EINVAL}};
+            }
+            if (!core::tsc_clock::is_invariant())
+            {
+                std::println("the time stamp counter is not invariant, the timestamps of the processes may disagree");
+            }
+            // calibrated once, the children inherit the rate
+            core::tsc_clock::process_clock();
+            register_fork_handler();
+            auto memory = unix::ipc::posix::memory_mapping::create_anonymous(
+                sizeof(log_type), unix::ipc::posix::read_write_protection,
+                unix::ipc::posix::mapping_flags_builder{}.get());
+
+            if (!memory)
+            {
+                return std::unexpected{memory.error()};
+            }
+            new (memory->data()) log_type{};
+            auto &log = *static_cast<log_type *>(memory->data());
+            const auto creator = unix::get_process_id();
+            const auto started = start_collector(log, options.collector, creator);
+
+            if (!started)
+            {
+                return std::unexpected{started.error()};
+            }
+            auto collector = unix::pidfd::open(log.collector_process.load(std::memory_order_acquire));
+
+            if (!collector)
+            {
+                log.stopping.store(true, std::memory_order_release);
+                log.records_pushed.wake_all();
+                return std::unexpected{collector.error()};
+            }
+            return std::expected<shared_logger, unix::error_code>{std::in_place, std::move(memory.value()),
+                                                                  options.overflow, creator,
+                                                                  std::move(collector.value())};
+        }
+
+        // in the creator the messages still queued get written before the collector
+        // stops, no process may log anymore, in the children it only unmaps the lanes
+        ~shared_logger() noexcept
+        {
+            if (log_ == nullptr || unix::get_process_id() != creator_)
+            {
+                return;
+            }
+            log_->stopping.store(true, std::memory_order_release);
+            log_->records_pushed.wake_all();
+            const auto deadline = std::chrono::steady_clock::now() + drain_timeout;
+
+            while (!log_->wait_for_state([](collector_state state) { return state == collector_state::done; },
+                                         liveness_period))
+            {
+                if (!collector_alive() || std::chrono::steady_clock::now() >= deadline)
+                {
+                    std::println("failed waiting for the collector, {} messages left",
+                                 pushed_count() - popped_count());
+                    return;
+                }
+            }
+        }
+
+        // the format is parsed at compile time and checked against the arguments,
+        // the strings get copied into the record, see argument_traits for the user types,
+        // false when the message got dropped, see overflow_policy::drop_newest,
+        // when it does not fit in a lane or when the collector is gone
+        template <core::string_literal Format, class... Args>
+        bool log(Args &&...args) noexcept
+        {
+            require_valid_format<Format, logged_type<Args>...>();
+            const auto lane_index = current_lane_index();
+
+            if (!lane_index)
+            {
+                std::println("no lane left for the thread, at most {} threads can log", MaxProducerCount);
+                return false;
+            }
+            auto &lane = log_->lanes[lane_index.value()];
+            const auto size = record_size(args...);
+            record_storage storage;
+
+            if (size > lock_free::spsc_message_ring<LaneCapacity>::max_message_size() || !storage.reserve(size))
+            {
+                lane_type::increment(lane.dropped_count);
+                return false;
+            }
+            const auto bytes = build_record<Format>(storage, args...);
+
+            if (!lane.ring.try_push(bytes) && !push_to_full_lane(lane, bytes))
+            {
+                return false;
+            }
+            lane_type::increment(lane.pushed_count);
+            log_->records_pushed.notify_all();
+            return true;
+        }
+
+        // waits for the messages logged by any process before the call
+        template <class Rep, class Period>
+        bool wait_till_all_popped_for(const std::chrono::duration<Rep, Period> &timeout) noexcept
+        {
+            const auto target = pushed_count();
+            const auto deadline = std::chrono::steady_clock::now() + timeout;
+
+            while (popped_count() < target)
+            {
+                if (!collector_alive())
+                {
+                    std::println("the collector is gone, {} messages left", target - popped_count());
+                    return false;
+                }
+                if (std::chrono::steady_clock::now() >= deadline)
+                {
+                    std::println("failed waiting for all messages being read, {} left", target - popped_count());
+                    return false;
+                }
+                std::this_thread::sleep_for(drain_poll_period);
+            }
+            return true;
+        }
+
+        // the process writing the records, not a child of any producer
+        unix::process_id_t collector_process_id() const noexcept
+        {
+            return collector_.process_id();
+        }
+
+        // messages that found their lane full
+        std::size_t blocked_count() const noexcept { return sum_of(&lane_type::blocked_count); }
+
+        // including the messages too large for a lane
+        std::size_t dropped_count() const noexcept { return sum_of(&lane_type::dropped_count); }
+
+        std::size_t pushed_count() const noexcept { return sum_of(&lane_type::pushed_count); }
+
+        std::size_t popped_count() const noexcept
+        {
+            return log_->popped_count.load(std::memory_order_acquire);
+        }
+
+        // threads holding a lane, the lanes of the exited ones get released by the collector
+        std::size_t producer_count() const noexcept
+        {
+            std::size_t count{0};
+
+            for (const auto &lane : log_->lanes)
+            {
+                count += lane.owner.load(std::memory_order_acquire) != 0 ? 1 : 0;
+            }
+            return count;
+        }
+
+    private:
+        static void register_fork_handler() noexcept
+        {
+            static std::once_flag registered;
+            std::call_once(registered, [] { ::pthread_atfork(nullptr, nullptr, &detail::forget_shared_lane); });
+        }
+
+        // the intermediate child exits right after forking the collector,
+        // which then gets adopted by init or the nearest subreaper
+        static std::expected<void, unix::error_code> start_collector(log_type &log, const collector_options &options,
+                                                                     unix::process_id_t creator) noexcept
+        {
+            // the children would write out the buffered output once more
+            std::fflush(stdout);
+            const auto intermediate = unix::create_process();
+
+            if (!intermediate)
+            {
+                return std::unexpected{intermediate.error()};
+            }
+            if (unix::is_child_process(intermediate.value()))
+            {
+                const auto collector_process = unix::create_process();
+
+                if (collector_process && unix::is_child_process(collector_process.value()))
+                {
+                    close_inherited_descriptors(options.text_descriptor);
+                    log.collector_process.store(unix::get_process_id(), std::memory_order_release);
+                    collector_type collector{log, options, creator};
+                    const auto collected = collector.run();
+                    std::fflush(stdout);
+                    _exit(collected ? EXIT_SUCCESS : EXIT_FAILURE);
+                }
+                _exit(collector_process ? EXIT_SUCCESS : EXIT_FAILURE);
+            }
+            const auto status = unix::wait_till_child_terminates(intermediate.value());
+
+            if (!status)
+            {
+                return std::unexpected{status.error()};
+            }
+            if (unix::terminated_abnormally(status.value()))
+            {
+                return std::unexpected{unix::error_code{ECHILD}};
+            }
+            const auto started = log.wait_for_state([](collector_state state)
+            {
+                return state != collector_state::starting;
+            }, start_timeout);
+
+            if (!started)
+            {
+                return std::unexpected{unix::error_code{ETIMEDOUT}};
+            }
+            if (log.state.load(std::memory_order_acquire) == collector_state::failed)
+            {
+                return std::unexpected{unix::error_code{log.collector_error.load(std::memory_order_relaxed)}};
+            }
+            return std::expected<void, unix::error_code>{};
+        }
+
+        // the collector outlives the creator otherwise, holding its pipes and sockets
+        // open, it keeps the standard streams and the descriptor of its text output
+        static void close_inherited_descriptors(int kept) noexcept
+        {
+            constexpr unsigned int first{STDERR_FILENO + 1};
+            constexpr unsigned int last{~0U};
+
+            if (kept < static_cast<int>(first))
+            {
+                ::close_range(first, last, 0);
+                return;
+            }
+            if (static_cast<unsigned int>(kept) > first)
+            {
+                ::close_range(first, static_cast<unsigned int>(kept) - 1, 0);
+            }
+            ::close_range(static_cast<unsigned int>(kept) + 1, last, 0);
+        }
+
+        // a killed collector never changes the state, its process gets probed as well
+        bool collector_alive() const noexcept
+        {
+            return !collector_.has_terminated();
+        }
+
+        bool collector_running() const noexcept
+        {
+            return log_->state.load(std::memory_order_acquire) == collector_state::running && collector_alive();
+        }
+
+        // the only path that may sleep, false when the message got dropped
+        bool push_to_full_lane(lane_type &lane, std::span<const std::byte> message) noexcept
+        {
+            switch (overflow_policy_)
+            {
+            case overflow_policy::block:
+                lane_type::increment(lane.blocked_count);
+
+                while (collector_running())
+                {
+                    // a lane with messages keeps the collector awake, no need to notify it
+                    const auto epoch = lane.space_freed.prepare_wait();
+
+                    if (lane.ring.try_push(message))
+                    {
+                        lane.space_freed.cancel_wait();
+                        return true;
+                    }
+                    lane.space_freed.wait_for(epoch, liveness_period);
+                }
+                lane_type::increment(lane.dropped_count);
+                return false;
+            case overflow_policy::drop_newest:
+                lane_type::increment(lane.dropped_count);
+                return false;
+            case overflow_policy::spill:
+                break;
+            }
+            return false;
+        }
+
+        // the cache spares the scan of the lanes but on the first log of the thread
+        std::optional<std::size_t> current_lane_index() noexcept
+        {
+            auto &cache = detail::current_shared_lane;
+
+            if (cache.log == log_)
+            {
+                return cache.lane_index;
+            }
+            const auto thread = unix::get_thread_id();
+            std::optional<std::size_t> found;
+
+            for (std::size_t index{0}; index < MaxProducerCount && !found; ++index)
+            {
+                if (log_->lanes[index].try_claim(thread))
+                {
+                    found = index;
+                }
+            }
+            if (found)
+            {
+                cache = detail::shared_lane_cache{log_, found.value()};
+            }
+            return found;
+        }
+
+        std::size_t sum_of(std::atomic<std::uint64_t> lane_type::*counter) const noexcept
+        {
+            std::size_t sum{0};
+
+            for (const auto &lane : log_->lanes)
+            {
+                sum += (lane.*counter).load(std::memory_order_relaxed);
+            }
+            return sum;
+        }
+    };
+} // namespace async
+
+#endif
+
+#endif // ASYNC_SHARED_LOGGER_HPP
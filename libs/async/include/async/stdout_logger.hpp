@@ -0,0 +1,75 @@
+#ifndef ASYNC_STDOUT_LOGGER_HPP
+#define ASYNC_STDOUT_LOGGER_HPP
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <expected>
+#include <string>
+#include <unistd.h>
+
+#include "core/string_literal.hpp"
+#include "unix/error_code.hpp"
+#include "unix/utility.hpp"
+
+#include "async/binary_reader.hpp"
+#include "async/record.hpp"
+
+namespace async
+{
+    // stands in for shared_logger where it is not available, with the same
+    // compile time checks, each message gets rendered by the calling thread the
+    // way the decoder renders the records, and written to stdout by a single write,
+    // so the lines of the processes never interleave and the length modifiers of
+    // the format never reach printf with arguments of other types
+    class stdout_logger
+    {
+        // longer messages get truncated
+        static constexpr std::size_t max_message_size{1'024};
+
+    public:
+        static std::expected<stdout_logger, unix::error_code> create() noexcept
+        {
+            return stdout_logger{};
+        }
+
+        // false when the message could not be built or written
+        template <core::string_literal Format, class... Args>
+        bool log(Args &&...args) noexcept
+        {
+            require_valid_format<Format, logged_type<Args>...>();
+            const auto &arguments = signature_of<logged_type<Args>...>.arguments;
+            static const decoded_format format{{arguments.begin(), arguments.end()}, std::string{Format.view()}};
+            record_storage storage;
+
+            if (!storage.reserve(record_size(args...)))
+            {
+                return false;
+            }
+            const auto record = read_record(build_record<Format>(storage, args...));
+            const auto message = render(decoded_record{record.timestamp, &format, record.arguments});
+
+            if (!message)
+            {
+                return false;
+            }
+            const auto size = std::min(message->size(), max_message_size);
+
+            while (true)
+            {
+                const auto ret = ::write(STDOUT_FILENO, message->data(), size);
+
+                if (!unix::operation_failed(static_cast<int>(ret)))
+                {
+                    return true;
+                }
+                if (errno != EINTR)
+                {
+                    return false;
+                }
+            }
+        }
+    };
+} // namespace async
+
+#endif // ASYNC_STDOUT_LOGGER_HPP
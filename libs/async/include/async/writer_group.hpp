@@ -0,0 +1,482 @@
+#ifndef ASYNC_WRITER_GROUP_HPP
+#define ASYNC_WRITER_GROUP_HPP
+
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <expected>
+#include <optional>
+#include <print>
+#include <span>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "lock_free/event_count.hpp"
+#include "unix/error_code.hpp"
+#include "unix/scheduling.hpp"
+
+#ifdef __linux__
+#include "unix/affinity.hpp"
+#include "unix/numa.hpp"
+#endif
+
+#include "async/argument_type.hpp"
+#include "async/binary_format.hpp"
+#include "async/file_sink.hpp"
+#include "async/format_string.hpp"
+#include "async/lane.hpp"
+#include "async/record.hpp"
+#include "async/segment_compressor.hpp"
+#include "async/segment_writer.hpp"
+
+namespace async
+{
+    // how a writer picks the next record among its lanes
+    enum class lane_order
+    {
+        // lane after lane, the records of a lane keep their order
+        arrival,
+        // the earliest front record first, costs a scan of the lanes per record
+        timestamp,
+    };
+
+    // where the writer threads run and allocate their buffers, applied by each
+    // writer before it opens its files, the writers stay unplaced elsewhere
+    struct writer_placement
+    {
+#ifdef __linux__ // see unix/affinity.hpp
+        // empty leaves the writers unpinned, unix::numa::cpus_of gives the cpus of a node
+        unix::cpu_set cpus{};
+        // the node the writers prefer to allocate from, none keeps the policy of the creator
+        std::optional<unix::numa::node_t> memory_node{};
+#endif
+    };
+
+    // writer w consumes the lanes w, w + WriterCount, w + 2 * WriterCount...
+    template <std::size_t LaneCapacity, std::size_t LaneCount, std::size_t WriterCount>
+    class writer_group
+    {
+        using lane_type = lane<LaneCapacity>;
+
+        // records taken from a lane before moving on to the next one
+        static constexpr std::size_t batch_size{256};
+        // checks of the lanes before an idle writer goes to sleep
+        static constexpr std::size_t idle_poll_count{64};
+
+        std::atomic<bool> stop_flag_{false};
+        std::span<lane_type, LaneCount> lanes_;
+        std::array<lock_free::event_count, WriterCount> events_;
+        std::string path_prefix_;
+        lane_order order_;
+        sink_options sink_options_;
+        rotation_options rotation_options_;
+        segment_compressor *compressor_;
+        writer_placement placement_;
+        std::atomic<std::uint64_t> pop_count_{0};
+        lock_free::event_count popped_;
+        // set by a writer that gave up on an I/O failure, its lanes are never drained again
+        std::array<std::atomic<bool>, WriterCount> failed_{};
+
+    public:
+        // each writer writes its own files, see segment_writer
+        explicit writer_group(std::span<lane_type, LaneCount> lanes, std::string path_prefix,
+                              lane_order order, const sink_options &sink_options,
+                              const rotation_options &rotation_options,
+                              segment_compressor *compressor,
+                              const writer_placement &placement = writer_placement{}) noexcept
+            : lanes_{lanes}, path_prefix_{std::move(path_prefix)}, order_{order},
+              sink_options_{sink_options}, rotation_options_{rotation_options}, compressor_{compressor},
+              placement_{placement} {}
+
+        static constexpr std::size_t writer_of(std::size_t lane_index) noexcept
+        {
+            return lane_index % WriterCount;
+        }
+
+        // returns once stopped, or once the output failed, the producers
+        // blocked on the lanes of the writer and the waiters for the
+        // popped count get woken up to observe the failure then
+        void start(std::size_t writer_id) noexcept
+        {
+            // tells the writers apart in top -H or a profiler
+            unix::name_current_thread("log_writer_" + std::to_string(writer_id));
+            place_current_thread(writer_id);
+
+            if (write_till_stopped(writer_id))
+            {
+                return;
+            }
+            failed_[writer_id].store(true, std::memory_order_release);
+
+            for (auto index = writer_id; index < LaneCount; index += WriterCount)
+            {
+                lanes_[index].space_freed.wake_all();
+            }
+            popped_.wake_all();
+        }
+
+        // called by a producer after a push, costs no syscall while the writer is busy
+        void notify(std::size_t lane_index) noexcept
+        {
+            events_[writer_of(lane_index)].notify_all();
+        }
+
+        void stop() noexcept
+        {
+            stop_flag_.store(true, std::memory_order_release);
+
+            for (auto &events : events_)
+            {
+                events.wake_all();
+            }
+        }
+
+        std::uint64_t popped_count() const noexcept
+        {
+            return pop_count_.load(std::memory_order_acquire);
+        }
+
+        // the records of the lane will never be written
+        bool writer_failed(std::size_t lane_index) const noexcept
+        {
+            return failed_[writer_of(lane_index)].load(std::memory_order_acquire);
+        }
+
+        bool any_writer_failed() const noexcept
+        {
+            for (const auto &failed : failed_)
+            {
+                if (failed.load(std::memory_order_acquire))
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // wakes up on every batch written by any of the writers and once any of them failed
+        void wait_for_popped_count_change(std::uint64_t popped_count) noexcept
+        {
+            const auto epoch = popped_.prepare_wait();
+
+            if (pop_count_.load(std::memory_order_acquire) != popped_count || any_writer_failed())
+            {
+                popped_.cancel_wait();
+                return;
+            }
+            popped_.wait(epoch);
+        }
+
+    private:
+        // a writer that cannot be placed still writes, wherever it runs
+        void place_current_thread([[maybe_unused]] std::size_t writer_id) const noexcept
+        {
+#ifdef __linux__
+            if (!placement_.cpus.empty())
+            {
+                const auto pinned = unix::pin_current_thread(placement_.cpus);
+
+                if (!pinned)
+                {
+                    std::println("[{}] failed to pin the writer due to: {}", writer_id,
+                                 unix::to_string(pinned.error()));
+                }
+            }
+            if (placement_.memory_node)
+            {
+                const auto node = placement_.memory_node.value();
+                const auto preferred = unix::numa::set_thread_memory_policy(unix::numa::memory_policy::preferred,
+                                                                            unix::numa::node_mask{}.add(node));
+
+                if (!preferred)
+                {
+                    std::println("[{}] failed to prefer the memory of node {} due to: {}", writer_id, node,
+                                 unix::to_string(preferred.error()));
+                }
+            }
+#endif
+        }
+
+        // false on a failure of the output
+        bool write_till_stopped(std::size_t writer_id) noexcept
+        {
+            segment_writer output{path_prefix_, writer_id, sink_options_, rotation_options_, compressor_};
+            const auto opened = output.open();
+
+            if (!opened)
+            {
+                std::println("[{}] failed to open {} due to: {}", writer_id, output.path(),
+                             unix::to_string(opened.error()));
+                return false;
+            }
+            auto &events = events_[writer_id];
+            std::vector<std::byte> spilled;
+
+            while (true)
+            {
+                // read before draining, the producers are done once it is set
+                const auto stopping = stop_flag_.load(std::memory_order_acquire);
+                const auto written = order_ == lane_order::timestamp ? drain_by_timestamp(writer_id, output, spilled)
+                                                                     : drain_by_arrival(writer_id, output, spilled);
+
+                if (!written)
+                {
+                    std::println("[{}] failed to write message due to: {}", writer_id,
+                                 unix::to_string(written.error()));
+                    return false;
+                }
+                if (written.value() != 0)
+                {
+                    pop_count_.fetch_add(written.value(), std::memory_order_release);
+                    popped_.notify_all();
+                }
+                else if (stopping)
+                {
+                    return flush(writer_id, output);
+                }
+                const auto now = std::chrono::steady_clock::now();
+                const auto flushed = output.flush_if_due(now);
+
+                if (!flushed)
+                {
+                    std::println("[{}] failed to flush messages due to: {}", writer_id,
+                                 unix::to_string(flushed.error()));
+                    return false;
+                }
+                if (written.value() != 0)
+                {
+                    const auto rotated = output.rotate_if_due(now);
+
+                    if (!rotated)
+                    {
+                        std::println("[{}] failed to rotate {} due to: {}", writer_id, output.path(),
+                                     unix::to_string(rotated.error()));
+                        return false;
+                    }
+                    continue;
+                }
+                // a record arriving soon is picked up without the producer paying for a wake up
+                if (poll_for_records(writer_id))
+                {
+                    continue;
+                }
+                const auto epoch = events.prepare_wait();
+
+                if (has_records(writer_id) || stop_flag_.load(std::memory_order_acquire))
+                {
+                    events.cancel_wait();
+                    continue;
+                }
+                // sleeps no longer than the buffered data may wait
+                const auto due = output.time_till_due(now);
+
+                if (due)
+                {
+                    events.wait_for(epoch, due.value());
+                    continue;
+                }
+                events.wait(epoch);
+            }
+        }
+
+        bool poll_for_records(std::size_t writer_id) const noexcept
+        {
+            for (std::size_t poll{0}; poll < idle_poll_count; ++poll)
+            {
+                if (has_records(writer_id))
+                {
+                    return true;
+                }
+                std::this_thread::yield();
+            }
+            return false;
+        }
+
+        bool has_records(std::size_t writer_id) const noexcept
+        {
+            for (auto index = writer_id; index < LaneCount; index += WriterCount)
+            {
+                const auto &lane = lanes_[index];
+
+                if (!lane.ring.empty() || lane.spilling.load(std::memory_order_acquire))
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        static std::expected<std::size_t, unix::error_code> drain_ring(lane_type &lane, segment_writer &output,
+                                                                       std::size_t limit) noexcept
+        {
+            std::size_t written{0};
+
+            for (; written < limit; ++written)
+            {
+                const auto record = lane.ring.front();
+
+                if (!record)
+                {
+                    break;
+                }
+                const auto record_written = write(output, record.value());
+
+                if (!record_written)
+                {
+                    return std::unexpected{record_written.error()};
+                }
+                lane.ring.pop();
+            }
+            return written;
+        }
+
+        // the records left in the ring precede the spilled ones
+        static std::expected<std::size_t, unix::error_code> drain_spilled(lane_type &lane, segment_writer &output,
+                                                                          std::vector<std::byte> &spilled) noexcept
+        {
+            if (!lane.spilling.load(std::memory_order_acquire))
+            {
+                return std::size_t{0};
+            }
+            const auto drained = drain_ring(lane, output, SIZE_MAX);
+
+            if (!drained)
+            {
+                return drained;
+            }
+            lane.take_overflow(spilled);
+            std::size_t written{drained.value()};
+            std::expected<void, unix::error_code> record_written;
+            const auto all_written = lane_type::for_each_spilled(spilled, [&](std::span<const std::byte> record)
+            {
+                record_written = write(output, record);
+                written += record_written ? 1 : 0;
+                return record_written.has_value();
+            });
+
+            if (!all_written)
+            {
+                return std::unexpected{record_written.error()};
+            }
+            return written;
+        }
+
+        std::expected<std::size_t, unix::error_code> drain_by_arrival(std::size_t writer_id, segment_writer &output,
+                                                                      std::vector<std::byte> &spilled) noexcept
+        {
+            std::size_t written{0};
+
+            for (auto index = writer_id; index < LaneCount; index += WriterCount)
+            {
+                auto &lane = lanes_[index];
+                const auto drained = drain_ring(lane, output, batch_size);
+
+                if (!drained)
+                {
+                    return drained;
+                }
+                const auto drained_spilled = drain_spilled(lane, output, spilled);
+
+                if (!drained_spilled)
+                {
+                    return drained_spilled;
+                }
+                if (drained.value() + drained_spilled.value() != 0)
+                {
+                    written += drained.value() + drained_spilled.value();
+                    lane.space_freed.notify_all();
+                }
+            }
+            return written;
+        }
+
+        // the spilled records are written first, out of the timestamp order
+        std::expected<std::size_t, unix::error_code> drain_by_timestamp(std::size_t writer_id, segment_writer &output,
+                                                                        std::vector<std::byte> &spilled) noexcept
+        {
+            std::size_t written{0};
+
+            for (auto index = writer_id; index < LaneCount; index += WriterCount)
+            {
+                const auto drained_spilled = drain_spilled(lanes_[index], output, spilled);
+
+                if (!drained_spilled)
+                {
+                    return drained_spilled;
+                }
+                written += drained_spilled.value();
+            }
+            for (std::size_t count{0}; count < batch_size; ++count, ++written)
+            {
+                lane_type *earliest{nullptr};
+                std::span<const std::byte> earliest_record;
+                binary::timestamp_t earliest_timestamp{0};
+
+                for (auto index = writer_id; index < LaneCount; index += WriterCount)
+                {
+                    const auto record = lanes_[index].ring.front();
+
+                    if (!record)
+                    {
+                        continue;
+                    }
+                    const auto timestamp = timestamp_of(record.value());
+
+                    if (earliest == nullptr || timestamp < earliest_timestamp)
+                    {
+                        earliest = &lanes_[index];
+                        earliest_record = record.value();
+                        earliest_timestamp = timestamp;
+                    }
+                }
+                if (earliest == nullptr)
+                {
+                    break;
+                }
+                const auto record_written = write(output, earliest_record);
+
+                if (!record_written)
+                {
+                    return std::unexpected{record_written.error()};
+                }
+                earliest->ring.pop();
+            }
+            if (written != 0)
+            {
+                for (auto index = writer_id; index < LaneCount; index += WriterCount)
+                {
+                    lanes_[index].space_freed.notify_all();
+                }
+            }
+            return written;
+        }
+
+        static std::expected<void, unix::error_code> write(segment_writer &output,
+                                                           std::span<const std::byte> record) noexcept
+        {
+            const auto [format, timestamp, arguments] = read_record(record);
+            return output.write(format, timestamp, arguments);
+        }
+
+        static bool flush(std::size_t writer_id, segment_writer &output) noexcept
+        {
+            const auto flushed = output.flush();
+
+            if (!flushed)
+            {
+                std::println("[{}] failed to flush messages due to: {}", writer_id,
+                             unix::to_string(flushed.error()));
+                return false;
+            }
+            return true;
+        }
+    };
+} // namespace async
+
+#endif // ASYNC_WRITER_GROUP_HPP
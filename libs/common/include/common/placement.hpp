@@ -0,0 +1,67 @@
+#ifndef COMMON_PLACEMENT_HPP
+#define COMMON_PLACEMENT_HPP
+
+#include <print>
+#include <span>
+#include <string>
+#include <string_view>
+
+#include "unix/error_code.hpp"
+
+#ifdef __linux__
+#include "unix/affinity.hpp"
+#endif
+
+namespace common
+{
+    // the value of the --<role>-cpus=<list> option, empty when absent
+    std::string_view find_cpu_option(std::span<char *const> args, std::string_view role) noexcept
+    {
+        const auto prefix = "--" + std::string{role} + "-cpus=";
+
+        for (const std::string_view arg : args)
+        {
+            if (arg.starts_with(prefix))
+            {
+                return arg.substr(prefix.size());
+            }
+        }
+        return std::string_view{};
+    }
+
+    // pins the calling process to the cpus of its role, e.g. --consumer-cpus=0-3,8,
+    // so roles can share a cache or get isolated cores, without the option
+    // the process keeps the inherited affinity
+    bool place_by_role(std::span<char *const> args, std::string_view role) noexcept
+    {
+        const auto option = find_cpu_option(args, role);
+
+        if (option.empty())
+        {
+            return true;
+        }
+#ifdef __linux__
+        const auto cpus = unix::cpu_set::parse(option);
+
+        if (!cpus || cpus.value().empty())
+        {
+            std::println("invalid cpu list for {}: {}", role.data(), std::string{option});
+            return false;
+        }
+        const auto pinned = unix::pin_current_process(cpus.value());
+
+        if (!pinned)
+        {
+            std::println("failed to pin {} to cpus {} due to: {}", role.data(), std::string{option},
+                         unix::to_string(pinned.error()).data());
+            return false;
+        }
+        return true;
+#else
+        std::println("cpu placement is not supported, ignoring the cpus of {}", role.data());
+        return true;
+#endif
+    }
+} // namespace common
+
+#endif // COMMON_PLACEMENT_HPP
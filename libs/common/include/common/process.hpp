@@ -1,7 +1,13 @@
 #ifndef COMMON_PROCESS_HPP
 #define COMMON_PROCESS_HPP
 
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
 #include <print>
+#include <span>
+#include <thread>
+#include <vector>
 
 #include "unix/ipc/system_v/group_notifier.hpp"
 #include "unix/process.hpp"
@@ -9,6 +15,20 @@
 
 namespace common
 {
+    void report_child_termination(unix::process_id_t child_id, int status) noexcept
+    {
+        std::println("child with process id: {} terminated", child_id);
+
+        if (WIFEXITED(status))
+        {
+            std::println("child exit status: {}", WEXITSTATUS(status));
+        }
+        else if (WIFSIGNALED(status))
+        {
+            psignal(WTERMSIG(status), "child exit signal");
+        }
+    }
+
     bool wait_till_all_children_termninate() noexcept
     {
         int status;
@@ -30,18 +50,240 @@ namespace common
                 std::println("all children terminated");
                 break;
             }
-            const auto child_id = child_terminated.value();
+            report_child_termination(child_terminated.value(), status);
+        }
+        return true;
+    }
 
-            std::println("child with process id: {} terminated", child_id);
+    namespace detail
+    {
+        enum class reaping
+        {
+            running,
+            all_terminated,
+            failed,
+        };
+
+        // the polling shared by the timed waits, reap takes the terminated children
+        // without blocking, returns false when some of them are still running
+        // after the timeout or reaping them failed
+        template <class Reap, class Rep, class Period>
+        bool poll_children_for(const Reap &reap, const std::chrono::duration<Rep, Period> &timeout) noexcept
+        {
+            constexpr std::chrono::milliseconds polling_interval{10};
+            const auto deadline = std::chrono::steady_clock::now() + timeout;
 
-            if (WIFEXITED(status))
+            while (true)
             {
-                std::println("child exit status: {}", WEXITSTATUS(status));
+                const auto reaped = reap();
+
+                if (reaped != reaping::running)
+                {
+                    return reaped == reaping::all_terminated;
+                }
+                if (std::chrono::steady_clock::now() >= deadline)
+                {
+                    std::println("children still running after the timeout");
+                    return false;
+                }
+                std::this_thread::sleep_for(polling_interval);
             }
-            else if (WIFSIGNALED(status))
+        }
+    } // namespace detail
+
+    // returns false when some children are still running after the timeout
+    template <class Rep, class Period>
+    bool wait_till_all_children_terminate_for(
+        const std::chrono::duration<Rep, Period> &timeout) noexcept
+    {
+        const auto reap = []()
+        {
+            int status;
+
+            while (true)
             {
-                psignal(WTERMSIG(status), "child exit signal");
+                const auto child_terminated = unix::try_waiting_for_child(&status);
+
+                if (!child_terminated)
+                {
+                    const auto error = child_terminated.error();
+
+                    if (error.code != ECHILD)
+                    {
+                        std::println("failed waiting for a child: {}",
+                                     unix::to_string(error).data());
+                        return detail::reaping::failed;
+                    }
+                    std::println("all children terminated");
+                    return detail::reaping::all_terminated;
+                }
+                if (child_terminated.value() == unix::no_child_terminated)
+                {
+                    return detail::reaping::running;
+                }
+                report_child_termination(child_terminated.value(), status);
+            }
+        };
+        return detail::poll_children_for(reap, timeout);
+    }
+
+    // reaps the given children that have already terminated without blocking and
+    // removes them from the list, the ones reaped elsewhere count as terminated,
+    // returns how many of them crashed or exited with a failure
+    std::size_t reap_terminated_children(std::vector<unix::process_id_t> &child_ids) noexcept
+    {
+        std::size_t abnormal_count{0};
+
+        std::erase_if(child_ids, [&abnormal_count](unix::process_id_t child_id)
+        {
+            int status;
+            const auto child_terminated = unix::try_waiting_for_child(child_id, &status);
+
+            if (!child_terminated)
+            {
+                if (child_terminated.error().code != ECHILD)
+                {
+                    std::println("failed waiting for child with process id: {} due to: {}", child_id,
+                                 unix::to_string(child_terminated.error()).data());
+                }
+                return true;
             }
+            if (child_terminated.value() == unix::no_child_terminated)
+            {
+                return false;
+            }
+            report_child_termination(child_id, status);
+
+            if (unix::terminated_abnormally(status))
+            {
+                abnormal_count++;
+            }
+            return true;
+        });
+        return abnormal_count;
+    }
+
+    // waits only for the given children, the others are left to their owners,
+    // the terminated ones get removed from the list, the abnormal terminations counted,
+    // returns false when some of them are still running after the timeout
+    template <class Rep, class Period>
+    bool wait_till_children_terminate_for(std::vector<unix::process_id_t> &child_ids,
+                                          std::size_t &abnormal_count,
+                                          const std::chrono::duration<Rep, Period> &timeout) noexcept
+    {
+        const auto reap = [&]()
+        {
+            abnormal_count += reap_terminated_children(child_ids);
+            return child_ids.empty() ? detail::reaping::all_terminated : detail::reaping::running;
+        };
+        return detail::poll_children_for(reap, timeout);
+    }
+
+    // blocks till each of the given children terminates, the ones reaped elsewhere
+    // count as terminated, the abnormal terminations get counted
+    bool wait_till_children_terminate(std::span<const unix::process_id_t> child_ids,
+                                      std::size_t &abnormal_count) noexcept
+    {
+        for (const auto child_id : child_ids)
+        {
+            const auto child_terminated = unix::wait_till_child_terminates(child_id);
+
+            if (!child_terminated)
+            {
+                if (child_terminated.error().code == ECHILD)
+                {
+                    continue;
+                }
+                std::println("failed waiting for child with process id: {} due to: {}", child_id,
+                             unix::to_string(child_terminated.error()).data());
+                return false;
+            }
+            report_child_termination(child_id, child_terminated.value());
+
+            if (unix::terminated_abnormally(child_terminated.value()))
+            {
+                abnormal_count++;
+            }
+        }
+        return true;
+    }
+
+    // asks the children to terminate, kills the ones still running after the grace period,
+    // waits only for the given children, being terminated is the expected outcome for them
+    template <class Rep, class Period>
+    bool terminate_children(std::span<const unix::process_id_t> child_ids,
+                            const std::chrono::duration<Rep, Period> &grace_period) noexcept
+    {
+        std::vector<unix::process_id_t> running{child_ids.begin(), child_ids.end()};
+        std::size_t abnormal_count{0};
+
+        for (const auto child_id : running)
+        {
+            // the child might have already terminated
+            unix::request_process_termination(child_id);
+        }
+        if (wait_till_children_terminate_for(running, abnormal_count, grace_period))
+        {
+            return true;
+        }
+        std::println("forcing children termination");
+
+        for (const auto child_id : running)
+        {
+            unix::force_process_termination(child_id);
+        }
+        return wait_till_children_terminate(running, abnormal_count);
+    }
+
+    // reaps the children that have already terminated without blocking,
+    // returns how many of them crashed or exited with a failure
+    std::size_t reap_terminated_children() noexcept
+    {
+        std::size_t abnormal_count{0};
+        int status;
+
+        while (true)
+        {
+            const auto child_terminated = unix::try_waiting_for_child(&status);
+
+            if (!child_terminated || child_terminated.value() == unix::no_child_terminated)
+            {
+                break;
+            }
+            report_child_termination(child_terminated.value(), status);
+
+            if (unix::terminated_abnormally(status))
+            {
+                abnormal_count++;
+            }
+        }
+        return abnormal_count;
+    }
+
+    // recovery once a child crashed or stalled, it never does its share of the protocol,
+    // so instead of letting the survivors wait for it forever, they get woken up to observe
+    // a shutdown request and terminate on their own, the ones which do not in time are killed,
+    // only the given children are waited for, the others are left to their owners,
+    // returns false unless all of them terminated on their own and successfully
+    template <class WakeSurvivors, class Rep, class Period>
+    bool shut_down_children(std::span<const unix::process_id_t> child_ids,
+                            const WakeSurvivors &wake_survivors,
+                            const std::chrono::duration<Rep, Period> &grace_period) noexcept
+    {
+        std::println("shutting down children");
+        wake_survivors();
+        std::vector<unix::process_id_t> running{child_ids.begin(), child_ids.end()};
+        std::size_t abnormal_count{0};
+
+        if (!wait_till_children_terminate_for(running, abnormal_count, grace_period))
+        {
+            terminate_children(running, grace_period);
+            return false;
+        }
+        if (abnormal_count != 0)
+        {
+            std::println("{} children terminated abnormally", abnormal_count);
+            return false;
         }
         return true;
     }
@@ -60,6 +302,21 @@ namespace common
         return true;
     }
 
+    bool wait_till_all_children_ready(const unix::ipc::system_v::group_notifier
+                                          &children_readiness_notifier,
+                                      const std::chrono::milliseconds &timeout) noexcept
+    {
+        const auto readiness_signaled = children_readiness_notifier.wait_for_all_for(timeout);
+
+        if (!readiness_signaled)
+        {
+            std::println("signal about all children being ready not received due to: {}",
+                         unix::to_string(readiness_signaled.error()).data());
+            return false;
+        }
+        return true;
+    }
+
     bool signal_readiness_to_parent(const unix::ipc::system_v::group_notifier
                                         &children_readiness_notifier) noexcept
     {
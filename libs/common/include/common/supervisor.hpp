@@ -0,0 +1,444 @@
+#ifndef COMMON_SUPERVISOR_HPP
+#define COMMON_SUPERVISOR_HPP
+
+#ifdef __linux__
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <expected>
+#include <limits>
+#include <optional>
+#include <print>
+#include <span>
+#include <sys/epoll.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+#include "unix/epoll.hpp"
+#include "unix/error_code.hpp"
+#include "unix/pidfd.hpp"
+#include "unix/process.hpp"
+#include "unix/signal_fd.hpp"
+
+#include "common/process.hpp"
+
+namespace common
+{
+    struct restart_policy
+    {
+        std::chrono::milliseconds initial_backoff{100};
+        std::chrono::milliseconds max_backoff{10'000};
+        // a worker running at least this long counts as healthy again,
+        // so its backoff and restart count start over
+        std::chrono::milliseconds stable_period{10'000};
+        // consecutive crashes tolerated before the worker is given up on
+        std::size_t max_restarts{5};
+    };
+
+    enum class worker_state
+    {
+        running,
+        waiting_for_restart,
+        finished,
+        failed
+    };
+
+    struct worker_record
+    {
+        std::optional<unix::pidfd> process;
+        worker_state state{worker_state::finished};
+        int last_status{0};
+        std::size_t restart_count{0};
+        std::chrono::milliseconds backoff{0};
+        std::chrono::steady_clock::time_point started_at, restart_at;
+    };
+
+    // forks the workers and watches all of them through a single epoll set,
+    // each child is referred to by a process descriptor that becomes readable
+    // once it terminates, so no call blocks on one particular child,
+    // SIGTERM and SIGINT sent to the supervisor are read from a signal descriptor
+    // and start the graceful shutdown instead of interrupting it asynchronously,
+    // the worker is called with its index in the child, its result is the exit status,
+    // crashed or failed workers get restarted after an exponential backoff,
+    // has to be created before any other thread, as only the calling thread
+    // gets the signals blocked
+    template <class Worker>
+    class supervisor
+    {
+        static constexpr std::size_t max_event_count{64};
+        static constexpr unix::epoll_key_t signal_key{std::numeric_limits<unix::epoll_key_t>::max()};
+
+    public:
+        explicit supervisor(unix::epoll &&events, unix::signal_fd &&signals,
+                            const unix::signal_set &previous_mask, Worker worker,
+                            const restart_policy &policy) noexcept
+            : events_{std::move(events)}, signals_{std::move(signals)},
+              previous_mask_{previous_mask}, worker_{std::move(worker)}, policy_{policy} {}
+
+        supervisor(const supervisor &other) = delete;
+        supervisor &operator=(const supervisor &other) = delete;
+
+        static std::expected<supervisor, unix::error_code> create(Worker worker,
+                                                                  const restart_policy &policy = {}) noexcept
+        {
+            const auto shutdown_signals = unix::signal_set{}.add(SIGTERM).add(SIGINT);
+            const auto previous_mask = unix::block_signals(shutdown_signals);
+
+            if (!previous_mask)
+            {
+                return std::unexpected{previous_mask.error()};
+            }
+            auto signals = unix::signal_fd::create(shutdown_signals);
+            auto events = unix::epoll::create();
+
+            if (!signals || !events)
+            {
+                unix::set_blocked_signals(previous_mask.value());
+                return std::unexpected{!signals ? signals.error() : events.error()};
+            }
+            const auto watched = events.value().add(signals.value().file_descriptor(), EPOLLIN, signal_key);
+
+            if (!watched)
+            {
+                unix::set_blocked_signals(previous_mask.value());
+                return std::unexpected{watched.error()};
+            }
+            return std::expected<supervisor, unix::error_code>{
+                std::in_place, std::move(events.value()), std::move(signals.value()),
+                previous_mask.value(), std::move(worker), policy};
+        }
+
+        // returns false when not all the workers got started
+        bool start(std::size_t worker_count) noexcept
+        {
+            assert(workers_.empty());
+            workers_.resize(worker_count);
+
+            for (std::size_t index{0}; index < worker_count; ++index)
+            {
+                workers_[index].backoff = policy_.initial_backoff;
+
+                if (!launch(index))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // supervises the workers till all of them finish or are given up on,
+        // or till a shutdown signal arrives, then shuts the rest down,
+        // returns true when every worker finished successfully
+        template <class Rep, class Period>
+        bool run(const std::chrono::duration<Rep, Period> &grace_period) noexcept
+        {
+            std::array<unix::epoll_event_t, max_event_count> events;
+
+            while (has_active_workers())
+            {
+                const auto ready = events_.wait(events, time_till_next_restart());
+
+                if (!ready)
+                {
+                    std::println("failed waiting for the workers due to: {}",
+                                 unix::to_string(ready.error()).data());
+                    shut_down(grace_period);
+                    return false;
+                }
+                for (std::size_t i{0}; i < ready.value(); ++i)
+                {
+                    const auto key = events[i].data.u64;
+
+                    if (key == signal_key)
+                    {
+                        if (shutdown_requested())
+                        {
+                            std::println("shutdown requested");
+                            shut_down(grace_period);
+                            return false;
+                        }
+                        continue;
+                    }
+                    handle_termination(static_cast<std::size_t>(key), true);
+                }
+                restart_due_workers();
+            }
+            return std::ranges::none_of(workers_, [](const auto &worker)
+                                        { return worker.state == worker_state::failed; });
+        }
+
+        // asks the running workers to terminate, kills the ones still running
+        // after the grace period, the pending restarts get cancelled,
+        // returns true when all of them terminated on their own
+        template <class Rep, class Period>
+        bool shut_down(const std::chrono::duration<Rep, Period> &grace_period) noexcept
+        {
+            std::println("shutting down workers");
+
+            for (auto &worker : workers_)
+            {
+                if (worker.state == worker_state::waiting_for_restart)
+                {
+                    worker.state = worker_state::finished;
+                }
+                else if (worker.state == worker_state::running)
+                {
+                    // the worker might have already terminated, its descriptor then
+                    // stays readable till it gets reaped below
+                    worker.process->request_termination();
+                }
+            }
+            const auto deadline = std::chrono::steady_clock::now() + grace_period;
+
+            if (wait_till_workers_terminate(deadline))
+            {
+                return true;
+            }
+            std::println("forcing workers termination");
+
+            for (auto &worker : workers_)
+            {
+                if (worker.state == worker_state::running)
+                {
+                    worker.process->force_termination();
+                }
+            }
+            wait_till_workers_terminate(std::chrono::steady_clock::time_point::max());
+            return false;
+        }
+
+        std::span<const worker_record> workers() const noexcept
+        {
+            return workers_;
+        }
+
+        ~supervisor() noexcept
+        {
+            assert(std::ranges::none_of(workers_, [](const auto &worker)
+                                        { return worker.state == worker_state::running; }));
+            unix::set_blocked_signals(previous_mask_);
+        }
+
+    private:
+        unix::epoll events_;
+        unix::signal_fd signals_;
+        unix::signal_set previous_mask_;
+        Worker worker_;
+        restart_policy policy_;
+        std::vector<worker_record> workers_;
+
+        bool launch(std::size_t index) noexcept
+        {
+            auto &worker = workers_[index];
+            const auto process_created = unix::create_process();
+
+            if (!process_created)
+            {
+                std::println("failed to create worker due to: {}",
+                             unix::to_string(process_created.error()).data());
+                worker.state = worker_state::failed;
+                return false;
+            }
+            if (unix::is_child_process(process_created.value()))
+            {
+                // the worker has to terminate on SIGTERM again
+                unix::set_blocked_signals(previous_mask_);
+                events_.close();
+                signals_.close();
+                _exit(worker_(index));
+            }
+            const auto pid = process_created.value();
+            auto opened = unix::pidfd::open(pid);
+
+            if (!opened)
+            {
+                std::println("failed to open descriptor of worker {} due to: {}", pid,
+                             unix::to_string(opened.error()).data());
+                unix::force_process_termination(pid);
+                unix::wait_till_child_terminates(pid);
+                worker.state = worker_state::failed;
+                return false;
+            }
+            const auto watched = events_.add(opened.value().file_descriptor(), EPOLLIN, index);
+
+            if (!watched)
+            {
+                std::println("failed to watch worker {} due to: {}", pid,
+                             unix::to_string(watched.error()).data());
+                opened.value().force_termination();
+                unix::wait_till_child_terminates(pid);
+                worker.state = worker_state::failed;
+                return false;
+            }
+            worker.process.emplace(std::move(opened.value()));
+            worker.state = worker_state::running;
+            worker.started_at = std::chrono::steady_clock::now();
+            return true;
+        }
+
+        // the descriptor became readable, so the worker already terminated
+        // and reaping it does not block
+        void handle_termination(std::size_t index, bool restart_allowed) noexcept
+        {
+            assert(index < workers_.size());
+            auto &worker = workers_[index];
+            assert(worker.state == worker_state::running);
+            const auto pid = worker.process->process_id();
+            events_.remove(worker.process->file_descriptor());
+            const auto terminated = unix::wait_till_child_terminates(pid);
+            worker.process.reset();
+
+            if (!terminated)
+            {
+                std::println("failed to reap worker {} due to: {}", pid,
+                             unix::to_string(terminated.error()).data());
+                worker.state = worker_state::failed;
+                return;
+            }
+            worker.last_status = terminated.value();
+            report_child_termination(pid, worker.last_status);
+
+            if (!unix::terminated_abnormally(worker.last_status) || !restart_allowed)
+            {
+                worker.state = worker_state::finished;
+                return;
+            }
+            const auto now = std::chrono::steady_clock::now();
+
+            if (now - worker.started_at >= policy_.stable_period)
+            {
+                worker.backoff = policy_.initial_backoff;
+                worker.restart_count = 0;
+            }
+            if (worker.restart_count == policy_.max_restarts)
+            {
+                std::println("worker {} gave up after {} restarts", index, worker.restart_count);
+                worker.state = worker_state::failed;
+                return;
+            }
+            std::println("restarting worker {} in {} ms", index, worker.backoff.count());
+            worker.state = worker_state::waiting_for_restart;
+            worker.restart_at = now + worker.backoff;
+            worker.backoff = std::min(worker.backoff * 2, policy_.max_backoff);
+            worker.restart_count++;
+        }
+
+        void restart_due_workers() noexcept
+        {
+            const auto now = std::chrono::steady_clock::now();
+
+            for (std::size_t index{0}; index < workers_.size(); ++index)
+            {
+                if (workers_[index].state == worker_state::waiting_for_restart &&
+                    workers_[index].restart_at <= now)
+                {
+                    launch(index);
+                }
+            }
+        }
+
+        // waits indefinitely while no restart is pending
+        std::chrono::milliseconds time_till_next_restart() const noexcept
+        {
+            std::optional<std::chrono::steady_clock::time_point> next;
+
+            for (const auto &worker : workers_)
+            {
+                if (worker.state == worker_state::waiting_for_restart)
+                {
+                    next = std::min(next.value_or(worker.restart_at), worker.restart_at);
+                }
+            }
+            if (!next)
+            {
+                return std::chrono::milliseconds{-1};
+            }
+            return time_till(next.value());
+        }
+
+        // rounded up, so the restart is never attempted before it is due
+        static std::chrono::milliseconds time_till(std::chrono::steady_clock::time_point deadline) noexcept
+        {
+            const auto remaining = deadline - std::chrono::steady_clock::now();
+            return std::max(std::chrono::ceil<std::chrono::milliseconds>(remaining),
+                            std::chrono::milliseconds{0});
+        }
+
+        bool has_active_workers() const noexcept
+        {
+            return std::ranges::any_of(workers_, [](const auto &worker)
+                                       { return worker.state == worker_state::running ||
+                                                worker.state == worker_state::waiting_for_restart; });
+        }
+
+        bool has_running_workers() const noexcept
+        {
+            return std::ranges::any_of(workers_, [](const auto &worker)
+                                       { return worker.state == worker_state::running; });
+        }
+
+        // drains the pending signals, true when any of them asks for a shutdown
+        bool shutdown_requested() noexcept
+        {
+            bool requested{false};
+
+            while (true)
+            {
+                const auto received = signals_.read();
+
+                if (!received || !received.value())
+                {
+                    return requested;
+                }
+                requested = true;
+            }
+        }
+
+        // returns false when some workers are still running after the deadline,
+        // further shutdown signals are drained, the shutdown is already underway
+        bool wait_till_workers_terminate(std::chrono::steady_clock::time_point deadline) noexcept
+        {
+            const bool indefinitely = deadline == std::chrono::steady_clock::time_point::max();
+            std::array<unix::epoll_event_t, max_event_count> events;
+
+            while (has_running_workers())
+            {
+                const auto timeout = indefinitely ? std::chrono::milliseconds{-1} : time_till(deadline);
+
+                if (!indefinitely && timeout.count() == 0)
+                {
+                    return false;
+                }
+                const auto ready = events_.wait(events, timeout);
+
+                if (!ready)
+                {
+                    std::println("failed waiting for the workers due to: {}",
+                                 unix::to_string(ready.error()).data());
+                    return false;
+                }
+                for (std::size_t i{0}; i < ready.value(); ++i)
+                {
+                    const auto key = events[i].data.u64;
+
+                    if (key == signal_key)
+                    {
+                        shutdown_requested();
+                        continue;
+                    }
+                    handle_termination(static_cast<std::size_t>(key), false);
+                }
+            }
+            return true;
+        }
+    };
+} // namespace common
+
+#endif
+
+#endif // COMMON_SUPERVISOR_HPP
@@ -0,0 +1,147 @@
+#ifndef COMMON_WORKER_POOL_HPP
+#define COMMON_WORKER_POOL_HPP
+
+#include <chrono>
+#include <climits>
+#include <cstddef>
+#include <cstdlib>
+#include <expected>
+#include <functional>
+#include <print>
+#include <span>
+#include <type_traits>
+#include <unistd.h>
+#include <vector>
+
+#include "unix/error_code.hpp"
+#include "unix/ipc/posix/pipe.hpp"
+#include "unix/process.hpp"
+
+#include "common/process.hpp"
+
+namespace common
+{
+    // workers forked once, while the parent is still small, and reused for
+    // many jobs, instead of forking a process per job,
+    // jobs and results travel through pipes shared by all the workers,
+    // records up to PIPE_BUF bytes are written atomically, so each job
+    // is read by exactly one worker, the results arrive in completion order
+    template <class Job, class Result>
+        requires std::is_trivially_copyable_v<Job> && std::is_trivially_copyable_v<Result> &&
+                 (sizeof(Job) <= PIPE_BUF) && (sizeof(Result) <= PIPE_BUF)
+    class worker_pool
+    {
+    public:
+        // the pipes have to outlive the pool
+        explicit worker_pool(unix::ipc::posix::pipe &jobs, unix::ipc::posix::pipe &results) noexcept
+            : jobs_{jobs}, results_{results} {}
+
+        worker_pool(const worker_pool &other) = delete;
+        worker_pool &operator=(const worker_pool &other) = delete;
+
+        // returns only in the parent, the workers terminate once the pool shuts down,
+        // returns false when not all the workers got created, the ones
+        // created by then get shut down and the pool is not usable anymore
+        template <class Handler>
+        bool start(std::size_t worker_count, Handler &&handle) noexcept
+        {
+            for (std::size_t i{0}; i < worker_count; ++i)
+            {
+                const auto process_created = unix::create_process();
+
+                if (!process_created)
+                {
+                    std::println("failed to create worker due to: {}",
+                                 unix::to_string(process_created.error()).data());
+                    // they have no job yet, so they terminate right away
+                    shut_down(start_failure_grace_period);
+                    return false;
+                }
+                if (unix::is_child_process(process_created.value()))
+                {
+                    _exit(work(handle) ? EXIT_SUCCESS : EXIT_FAILURE);
+                }
+                worker_ids_.push_back(process_created.value());
+            }
+            // end of file reaches the workers only once every write end is closed
+            jobs_.get().close_read_end();
+            results_.get().close_write_end();
+            return true;
+        }
+
+        std::expected<void, unix::error_code> submit(const Job &job) const noexcept
+        {
+            return jobs_.get().write(&job, sizeof(Job));
+        }
+
+        // blocks till some worker finishes a job
+        std::expected<Result, unix::error_code> receive() const noexcept
+        {
+            Result result;
+            const auto received = results_.get().read_exactly(&result, sizeof(Result));
+
+            if (!received)
+            {
+                return std::unexpected{received.error()};
+            }
+            return result;
+        }
+
+        // the workers finish the submitted jobs and terminate,
+        // the ones still running after the grace period get killed,
+        // other children of the caller are left alone, returns false
+        // unless every worker terminated on its own and successfully
+        template <class Rep, class Period>
+        bool shut_down(const std::chrono::duration<Rep, Period> &grace_period) noexcept
+        {
+            const auto stop_submitting = [this]()
+            {
+                if (jobs_.get().is_write_end_open())
+                {
+                    jobs_.get().close_write_end();
+                }
+            };
+            const auto all_terminated = shut_down_children(worker_ids_, stop_submitting, grace_period);
+            worker_ids_.clear();
+            return all_terminated;
+        }
+
+        std::span<const unix::process_id_t> worker_ids() const noexcept
+        {
+            return worker_ids_;
+        }
+
+    private:
+        static constexpr std::chrono::seconds start_failure_grace_period{1};
+
+        std::reference_wrapper<unix::ipc::posix::pipe> jobs_, results_;
+        std::vector<unix::process_id_t> worker_ids_;
+
+        template <class Handler>
+        bool work(Handler &handle) noexcept
+        {
+            jobs_.get().close_write_end();
+            results_.get().close_read_end();
+            Job job;
+
+            while (true)
+            {
+                const auto received = jobs_.get().read_exactly(&job, sizeof(Job));
+
+                if (!received)
+                {
+                    // the pool shut down
+                    return received.error().code == EPIPE;
+                }
+                const Result result = handle(job);
+
+                if (!results_.get().write(&result, sizeof(Result)))
+                {
+                    return false;
+                }
+            }
+        }
+    };
+} // namespace common
+
+#endif // COMMON_WORKER_POOL_HPP
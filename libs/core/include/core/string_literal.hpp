@@ -3,6 +3,7 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <string_view>
 
 
 namespace core
@@ -20,6 +21,17 @@ namespace core
         {
             return value;
         }
+
+        // without the terminating null character
+        constexpr std::size_t size() const noexcept
+        {
+            return Size - 1;
+        }
+
+        constexpr std::string_view view() const noexcept
+        {
+            return std::string_view{value, Size - 1};
+        }
     };
 }
 
@@ -0,0 +1,151 @@
+#ifndef CORE_TSC_CLOCK_HPP
+#define CORE_TSC_CLOCK_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#define CORE_HAS_TSC 1
+#else
+#define CORE_HAS_TSC 0
+#endif
+
+namespace core
+{
+    // stamps taken by reading the time stamp counter, a few cycles instead of
+    // the clock_gettime call, the ticks get turned into nanoseconds later on,
+    // wherever the time is not critical, without a counter the ticks are the
+    // CLOCK_MONOTONIC nanoseconds themselves
+    class tsc_clock
+    {
+    public:
+        using ticks_t = std::uint64_t;
+
+        // a reading of both clocks at the same instant
+        struct sample
+        {
+            ticks_t ticks;
+            std::int64_t monotonic;
+        };
+
+        static ticks_t now() noexcept
+        {
+#if CORE_HAS_TSC
+            return __rdtsc();
+#else
+            return static_cast<ticks_t>(monotonic_nanoseconds());
+#endif
+        }
+
+        // waits for the preceding instructions to complete,
+        // suits the end of a measured section
+        static ticks_t now_ordered() noexcept
+        {
+#if CORE_HAS_TSC
+            unsigned int processor;
+            return __rdtscp(&processor);
+#else
+            return now();
+#endif
+        }
+
+        static std::int64_t monotonic_nanoseconds() noexcept
+        {
+            timespec time;
+            clock_gettime(CLOCK_MONOTONIC, &time);
+            return static_cast<std::int64_t>(time.tv_sec) * 1'000'000'000 + time.tv_nsec;
+        }
+
+        // the counter ticks at the same rate on all the cores, whatever
+        // their frequency or sleep state, otherwise the stamps of
+        // different threads are not comparable
+        static bool is_invariant() noexcept
+        {
+#if CORE_HAS_TSC
+            unsigned int eax, ebx, ecx, edx;
+
+            if (__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) == 0)
+            {
+                return false;
+            }
+            return (edx & (1U << 8)) != 0;
+#else
+            return true;
+#endif
+        }
+
+        // the counter read right before and right after the clock, the
+        // narrowest of a few attempts, so a preemption does not skew it
+        static sample take_sample() noexcept
+        {
+            constexpr int attempt_count{8};
+            sample best{};
+            auto best_width = ~ticks_t{0};
+
+            for (int attempt{0}; attempt < attempt_count; ++attempt)
+            {
+                const auto before = now_ordered();
+                const auto monotonic = monotonic_nanoseconds();
+                const auto after = now_ordered();
+
+                if (after - before < best_width)
+                {
+                    best_width = after - before;
+                    best = sample{before + (after - before) / 2, monotonic};
+                }
+            }
+            return best;
+        }
+
+        // busy waits the period between two samples, the longer the
+        // period the more precise the rate
+        static tsc_clock calibrate(std::chrono::nanoseconds period = std::chrono::milliseconds{10}) noexcept
+        {
+#if CORE_HAS_TSC
+            const auto first = take_sample();
+
+            while (monotonic_nanoseconds() - first.monotonic < period.count())
+            {
+            }
+            const auto second = take_sample();
+            return tsc_clock{first, static_cast<double>(second.monotonic - first.monotonic) /
+                                        static_cast<double>(second.ticks - first.ticks)};
+#else
+            static_cast<void>(period);
+            return tsc_clock{take_sample(), 1.0};
+#endif
+        }
+
+        // calibrated once per process, on the first call
+        static const tsc_clock &process_clock() noexcept
+        {
+            static const auto clock = calibrate();
+            return clock;
+        }
+
+        double nanoseconds_per_tick() const noexcept { return nanoseconds_per_tick_; }
+
+        std::int64_t to_monotonic(ticks_t ticks) const noexcept
+        {
+            return reference_.monotonic + to_nanoseconds(static_cast<std::int64_t>(ticks - reference_.ticks));
+        }
+
+        // the ticks may be negative, the difference of two stamps in any order
+        std::int64_t to_nanoseconds(std::int64_t ticks) const noexcept
+        {
+            return static_cast<std::int64_t>(static_cast<double>(ticks) * nanoseconds_per_tick_);
+        }
+
+    private:
+        explicit tsc_clock(sample reference, double nanoseconds_per_tick) noexcept
+            : reference_{reference}, nanoseconds_per_tick_{nanoseconds_per_tick} {}
+
+        sample reference_;
+        double nanoseconds_per_tick_;
+    };
+} // namespace core
+
+#endif // CORE_TSC_CLOCK_HPP
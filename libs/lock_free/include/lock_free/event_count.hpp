@@ -0,0 +1,143 @@
+#ifndef LOCK_FREE_EVENT_COUNT_HPP
+#define LOCK_FREE_EVENT_COUNT_HPP
+
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <ctime>
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#include <algorithm>
+#include <thread>
+#endif
+
+namespace lock_free
+{
+    // lets a consumer sleep while there is nothing to consume, without the
+    // producers paying for a wake up unless the consumer actually sleeps:
+    // the consumer prepares the wait, checks its condition once more and
+    // only then waits, the producers publish their work before notifying,
+    // waits on a futex directly so that it can time out, the process shared
+    // one works from memory shared by several processes, elsewhere the
+    // waits fall back to std::atomic::wait, or to polling when they time
+    // out or cross processes
+    template <bool ProcessShared>
+    class basic_event_count
+    {
+        using epoch_type = std::uint32_t;
+
+        std::atomic<epoch_type> epoch_{0};
+        std::atomic<std::int32_t> waiter_count_{0};
+
+    public:
+        epoch_type prepare_wait() noexcept
+        {
+            waiter_count_.fetch_add(1, std::memory_order_seq_cst);
+            // pairs with the fence of the notifying producers
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            return epoch_.load(std::memory_order_seq_cst);
+        }
+
+        void cancel_wait() noexcept
+        {
+            waiter_count_.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        // returns right away when notified since the wait got prepared
+        void wait(epoch_type epoch) noexcept
+        {
+            while (epoch_.load(std::memory_order_acquire) == epoch)
+            {
+                futex_wait(epoch, nullptr);
+            }
+            waiter_count_.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        // false when the timeout expired before a notification
+        bool wait_for(epoch_type epoch, std::chrono::nanoseconds timeout) noexcept
+        {
+            const auto deadline = std::chrono::steady_clock::now() + timeout;
+            bool notified{true};
+
+            while (epoch_.load(std::memory_order_acquire) == epoch)
+            {
+                const auto left = deadline - std::chrono::steady_clock::now();
+
+                if (left <= std::chrono::nanoseconds::zero())
+                {
+                    notified = false;
+                    break;
+                }
+                const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(left);
+                const timespec relative{static_cast<std::time_t>(seconds.count()),
+                                        static_cast<long>((left - seconds).count())};
+                futex_wait(epoch, &relative);
+            }
+            waiter_count_.fetch_sub(1, std::memory_order_relaxed);
+            return notified;
+        }
+
+        // costs a fence and a load while nobody waits
+        void notify_all() noexcept
+        {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            if (waiter_count_.load(std::memory_order_relaxed) != 0)
+            {
+                wake_all();
+            }
+        }
+
+        // wakes up even the consumers that are about to wait
+        void wake_all() noexcept
+        {
+            epoch_.fetch_add(1, std::memory_order_seq_cst);
+#ifdef __linux__
+            ::syscall(SYS_futex, &epoch_, wake_operation, INT_MAX, nullptr, nullptr, 0);
+#else
+            epoch_.notify_all();
+#endif
+        }
+
+    private:
+        static_assert(sizeof(std::atomic<epoch_type>) == sizeof(epoch_type));
+
+#ifdef __linux__
+        // the private futexes skip the lookup of the shared mapping
+        static constexpr int wait_operation{ProcessShared ? FUTEX_WAIT : FUTEX_WAIT_PRIVATE};
+        static constexpr int wake_operation{ProcessShared ? FUTEX_WAKE : FUTEX_WAKE_PRIVATE};
+
+        // spurious wake ups, interruptions and timeouts are left to the callers
+        void futex_wait(epoch_type epoch, const timespec *timeout) noexcept
+        {
+            ::syscall(SYS_futex, &epoch_, wait_operation, epoch, timeout, nullptr, 0);
+        }
+#else
+        // how often a wait that cannot block on the atomic checks the epoch
+        static constexpr std::chrono::milliseconds poll_period{1};
+
+        // std::atomic::wait neither times out nor is guaranteed to be woken from another process
+        void futex_wait(epoch_type epoch, const timespec *timeout) noexcept
+        {
+            if (timeout == nullptr && !ProcessShared)
+            {
+                epoch_.wait(epoch, std::memory_order_acquire);
+                return;
+            }
+            const auto left = timeout == nullptr
+                                  ? std::chrono::nanoseconds{poll_period}
+                                  : std::chrono::seconds{timeout->tv_sec} + std::chrono::nanoseconds{timeout->tv_nsec};
+            std::this_thread::sleep_for(std::min<std::chrono::nanoseconds>(left, poll_period));
+        }
+#endif
+    };
+
+    using event_count = basic_event_count<false>;
+    using shared_event_count = basic_event_count<true>;
+} // namespace lock_free
+
+#endif // LOCK_FREE_EVENT_COUNT_HPP
@@ -3,6 +3,9 @@
 
 #include <array>
 #include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
 #include <expected>
 #include <span>
 #include <type_traits>
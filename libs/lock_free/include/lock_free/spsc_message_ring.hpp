@@ -0,0 +1,148 @@
+#ifndef LOCK_FREE_SPSC_MESSAGE_RING_HPP
+#define LOCK_FREE_SPSC_MESSAGE_RING_HPP
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <expected>
+#include <optional>
+#include <span>
+
+#include "core/error_code.hpp"
+
+namespace lock_free
+{
+    // variable sized messages between exactly one producer and one consumer,
+    // neither side needs a read-modify-write, each publishes its position
+    // with a single release store and caches the position of the other side,
+    // so the shared cache lines are touched only when the cached one runs out,
+    // every message is stored contiguously, the consumer reads it in place
+    template <std::size_t Capacity>
+        requires(std::has_single_bit(Capacity) && Capacity >= 64)
+    class spsc_message_ring
+    {
+        using header_type = std::uint64_t;
+        static constexpr std::size_t alignment{sizeof(header_type)};
+        // the rest of the ring till its end is skipped, the message continues from its start
+        static constexpr header_type wrap_marker{~header_type{0}};
+        static constexpr std::size_t cache_line_size{64};
+
+    public:
+        static constexpr std::size_t capacity() noexcept { return Capacity; }
+
+        // the largest message that fits regardless of where the ring wraps
+        static constexpr std::size_t max_message_size() noexcept
+        {
+            return (Capacity / 2) - sizeof(header_type);
+        }
+
+        // bytes taken by a message, including its header and the alignment
+        static constexpr std::size_t required_message_storage(std::size_t message_size) noexcept
+        {
+            return sizeof(header_type) + ((message_size + alignment - 1) & ~(alignment - 1));
+        }
+
+        // producer only, fails with not_enough_space when the consumer lags behind
+        std::expected<void, core::error_code> try_push(std::span<const std::byte> message) noexcept
+        {
+            assert(message.size() <= max_message_size());
+            const auto tail = tail_.load(std::memory_order_relaxed);
+            const auto storage = required_message_storage(message.size());
+            const auto offset = tail & (Capacity - 1);
+            const auto padding = (Capacity - offset) < storage ? (Capacity - offset) : std::size_t{0};
+
+            if ((tail + padding + storage) - cached_head_ > Capacity)
+            {
+                cached_head_ = head_.load(std::memory_order_acquire);
+
+                if ((tail + padding + storage) - cached_head_ > Capacity)
+                {
+                    return std::unexpected{core::error_code::not_enough_space};
+                }
+            }
+            if (padding != 0)
+            {
+                store_header(offset, wrap_marker);
+            }
+            const auto message_offset = (tail + padding) & (Capacity - 1);
+            store_header(message_offset, message.size());
+            std::memcpy(buffer_.data() + message_offset + sizeof(header_type), message.data(), message.size());
+            tail_.store(tail + padding + storage, std::memory_order_release);
+            return std::expected<void, core::error_code>{};
+        }
+
+        // consumer only, the message stays valid till it gets popped
+        std::optional<std::span<const std::byte>> front() noexcept
+        {
+            auto head = head_.load(std::memory_order_relaxed);
+
+            if (head == cached_tail_)
+            {
+                cached_tail_ = tail_.load(std::memory_order_acquire);
+
+                if (head == cached_tail_)
+                {
+                    return std::nullopt;
+                }
+            }
+            auto offset = head & (Capacity - 1);
+            auto size = load_header(offset);
+
+            if (size == wrap_marker)
+            {
+                // the producer wrote the message from the start in the same push
+                head += Capacity - offset;
+                head_.store(head, std::memory_order_relaxed);
+                offset = 0;
+                size = load_header(offset);
+            }
+            return std::span<const std::byte>{buffer_.data() + offset + sizeof(header_type),
+                                              static_cast<std::size_t>(size)};
+        }
+
+        // consumer only, releases the message returned by front
+        void pop() noexcept
+        {
+            const auto head = head_.load(std::memory_order_relaxed);
+            const auto size = load_header(head & (Capacity - 1));
+            assert(size != wrap_marker);
+            head_.store(head + required_message_storage(static_cast<std::size_t>(size)), std::memory_order_release);
+        }
+
+        bool empty() const noexcept
+        {
+            return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+        }
+
+        // bytes taken by the messages not popped yet
+        std::size_t used() const noexcept
+        {
+            return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+        }
+
+    private:
+        alignas(cache_line_size) std::atomic<std::size_t> head_{0};
+        std::size_t cached_tail_{0};
+        alignas(cache_line_size) std::atomic<std::size_t> tail_{0};
+        std::size_t cached_head_{0};
+        alignas(cache_line_size) std::array<std::byte, Capacity> buffer_;
+
+        void store_header(std::size_t offset, header_type header) noexcept
+        {
+            std::memcpy(buffer_.data() + offset, &header, sizeof(header_type));
+        }
+
+        header_type load_header(std::size_t offset) const noexcept
+        {
+            header_type header;
+            std::memcpy(&header, buffer_.data() + offset, sizeof(header_type));
+            return header;
+        }
+    };
+} // namespace lock_free
+
+#endif // LOCK_FREE_SPSC_MESSAGE_RING_HPP
@@ -0,0 +1,366 @@
+#ifndef SHM_ARENA_HPP
+#define SHM_ARENA_HPP
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <errno.h>
+#include <expected>
+#include <memory>
+#include <new>
+#include <string_view>
+#include <utility>
+
+#include "unix/error_code.hpp"
+#include "unix/sync/posix/mutex.hpp"
+
+#include "shm/directory.hpp"
+#include "shm/offset_ptr.hpp"
+#include "shm/scoped_lock.hpp"
+
+namespace shm
+{
+    // general purpose allocator placed at the start of a shared segment,
+    // small blocks are recycled through per size class free lists,
+    // the rest of the segment is handed out by bumping the top,
+    // all the links are offset pointers, so every process may map the segment
+    // at a different address
+    class arena
+    {
+        struct alignas(alignof(std::max_align_t)) block_header
+        {
+            std::size_t size; // usable bytes following the header
+        };
+
+        struct free_block
+        {
+            offset_ptr<free_block> next;
+        };
+
+    public:
+        static constexpr std::size_t alignment{alignof(std::max_align_t)};
+        // size classes of 16, 32, ..., 4096 bytes
+        static constexpr std::size_t min_block_size{16}, size_class_count{9},
+            max_small_block_size{min_block_size << (size_class_count - 1)},
+            directory_capacity{64};
+
+        arena(const arena &other) = delete;
+        arena &operator=(const arena &other) = delete;
+
+        // fails with EINVAL when the memory is misaligned or too small,
+        // or with the error of initializing the mutex
+        static std::expected<arena *, unix::error_code> construct_at(void *memory, std::size_t size) noexcept
+        {
+            if (reinterpret_cast<std::uintptr_t>(memory) % alignof(arena) != 0 ||
+                size < heap_offset() + sizeof(block_header) + min_block_size)
+            {
+                return std::unexpected{unix::error_code{EINVAL}};
+            }
+            auto *constructed = new (memory) arena{size};
+            const auto initialized = unix::sync::posix::mutex::construct_at(
+                &constructed->mutex_, unix::sync::posix::process_sharing::process_shared);
+
+            if (!initialized)
+            {
+                // the mutex got left default constructed, so the whole object can be destroyed
+                std::destroy_at(constructed);
+                return std::unexpected{initialized.error()};
+            }
+            return constructed;
+        }
+
+        // the segment has to be constructed by another process first,
+        // fails with EINVAL when there is no arena in the memory
+        static std::expected<arena *, unix::error_code> attach(void *memory) noexcept
+        {
+            auto *existing = static_cast<arena *>(memory);
+
+            if (existing->magic_ != magic)
+            {
+                return std::unexpected{unix::error_code{EINVAL}};
+            }
+            return existing;
+        }
+
+        // fails with ENOMEM when the segment is exhausted, or with the error of locking,
+        // alignments stricter than max_align_t are not supported
+        std::expected<void *, unix::error_code> allocate(std::size_t size,
+                                                         std::size_t requested_alignment = alignment) noexcept
+        {
+            assert(requested_alignment <= alignment);
+
+            if (requested_alignment > alignment)
+            {
+                return std::unexpected{unix::error_code{EINVAL}};
+            }
+            const auto block_size = to_block_size(std::max(size, min_block_size));
+            const guard locked{mutex_};
+
+            if (!locked)
+            {
+                return std::unexpected{locked.status().error()};
+            }
+            auto &free_list = free_list_of(block_size);
+
+            // large blocks are reused first fit, without splitting
+            for (auto *link = &free_list; *link; link = &(*link)->next)
+            {
+                auto *header = header_of(link->get());
+
+                if (header->size >= block_size)
+                {
+                    *link = (*link)->next;
+                    return payload_of(header);
+                }
+            }
+            if (top_ + sizeof(block_header) + block_size > size_)
+            {
+                return std::unexpected{unix::error_code{ENOMEM}};
+            }
+            auto *header = new (base() + top_) block_header{block_size};
+            top_ += sizeof(block_header) + block_size;
+            return payload_of(header);
+        }
+
+        void deallocate(void *ptr) noexcept
+        {
+            if (ptr == nullptr)
+            {
+                return;
+            }
+            assert(owns(ptr));
+            const guard locked{mutex_};
+
+            // leaks the block rather than touching the lists unlocked
+            if (!locked)
+            {
+                return;
+            }
+            auto &free_list = free_list_of(header_of(ptr)->size);
+            free_list = new (ptr) free_block{free_list};
+        }
+
+        // the types that may fail to construct provide a construct_at factory of their own
+        template <class T, class... Args>
+        std::expected<T *, unix::error_code> construct(Args &&...args) noexcept
+        {
+            const auto allocated = allocate(sizeof(T), alignof(T));
+
+            if (!allocated)
+            {
+                return std::unexpected{allocated.error()};
+            }
+            if constexpr (requires { T::construct_at(allocated.value(), std::forward<Args>(args)...); })
+            {
+                const auto constructed = T::construct_at(allocated.value(), std::forward<Args>(args)...);
+
+                if (!constructed)
+                {
+                    deallocate(allocated.value());
+                }
+                return constructed;
+            }
+            else
+            {
+                return new (allocated.value()) T(std::forward<Args>(args)...);
+            }
+        }
+
+        template <class T>
+        void destroy(T *object) noexcept
+        {
+            if (object != nullptr)
+            {
+                std::destroy_at(object);
+                deallocate(object);
+            }
+        }
+
+        // fails with EEXIST when the name is taken, ENOSPC when the directory is full
+        template <class T, class... Args>
+        std::expected<T *, unix::error_code> construct_named(std::string_view name, Args &&...args) noexcept
+        {
+            // constructed outside the lock, the object might allocate from the arena itself
+            const auto constructed = construct<T>(std::forward<Args>(args)...);
+
+            if (!constructed)
+            {
+                return constructed;
+            }
+            const auto inserted = [&]() -> std::expected<void, unix::error_code>
+            {
+                const guard locked{mutex_};
+
+                if (!locked)
+                {
+                    return locked.status();
+                }
+                return directory_.insert(name, constructed.value(), sizeof(T));
+            }();
+
+            if (!inserted)
+            {
+                destroy(constructed.value());
+                return std::unexpected{inserted.error()};
+            }
+            return constructed;
+        }
+
+        // fails with ENOENT
+        template <class T>
+        std::expected<T *, unix::error_code> find(std::string_view name) noexcept
+        {
+            const guard locked{mutex_};
+
+            if (!locked)
+            {
+                return std::unexpected{locked.status().error()};
+            }
+            const auto *entry = directory_.find(name);
+
+            if (entry == nullptr)
+            {
+                return std::unexpected{unix::error_code{ENOENT}};
+            }
+            assert(entry->size == sizeof(T));
+            return static_cast<T *>(entry->object.get());
+        }
+
+        // processes racing to create the same object agree on the first one registered
+        template <class T, class... Args>
+        std::expected<T *, unix::error_code> find_or_construct(std::string_view name, Args &&...args) noexcept
+        {
+            const auto found = find<T>(name);
+
+            if (found)
+            {
+                return found;
+            }
+            const auto constructed = construct_named<T>(name, std::forward<Args>(args)...);
+
+            if (!constructed && constructed.error().code == EEXIST)
+            {
+                return find<T>(name);
+            }
+            return constructed;
+        }
+
+        // fails with ENOENT
+        template <class T>
+        std::expected<void, unix::error_code> destroy_named(std::string_view name) noexcept
+        {
+            const auto erased = [&]() -> std::expected<T *, unix::error_code>
+            {
+                const guard locked{mutex_};
+
+                if (!locked)
+                {
+                    return std::unexpected{locked.status().error()};
+                }
+                return static_cast<T *>(directory_.erase(name));
+            }();
+
+            if (!erased)
+            {
+                return std::unexpected{erased.error()};
+            }
+            if (erased.value() == nullptr)
+            {
+                return std::unexpected{unix::error_code{ENOENT}};
+            }
+            destroy(erased.value());
+            return std::expected<void, unix::error_code>{};
+        }
+
+        bool owns(const void *ptr) const noexcept
+        {
+            const auto *byte = static_cast<const std::byte *>(ptr);
+            return byte >= base() + heap_offset() && byte < base() + top_;
+        }
+
+        std::size_t capacity() const noexcept
+        {
+            return size_;
+        }
+
+        // bytes taken from the top, including the freed blocks
+        std::size_t used() const noexcept
+        {
+            return top_;
+        }
+
+    private:
+        static constexpr std::uint64_t magic{0x73686d5f6172656e}; // "shm_aren"
+
+        // the bookkeeping is updated by single stores, so an owner that died
+        // while holding the lock can only leak the block it was handing out
+        using guard = scoped_lock;
+
+        std::uint64_t magic_{magic};
+        std::size_t size_;
+        std::size_t top_{heap_offset()};
+        // made process shared by construct_at
+        unix::sync::posix::mutex mutex_;
+        std::array<offset_ptr<free_block>, size_class_count + 1> free_lists_{}; // the last one for large blocks
+        directory<directory_capacity> directory_{};
+
+        explicit arena(std::size_t size) noexcept
+            : size_{size} {}
+
+        static constexpr std::size_t round_up(std::size_t size) noexcept
+        {
+            return (size + alignment - 1) & ~(alignment - 1);
+        }
+
+        static constexpr std::size_t heap_offset() noexcept;
+
+        static constexpr std::size_t size_class_of(std::size_t block_size) noexcept
+        {
+            return static_cast<std::size_t>(std::bit_width((block_size - 1) / min_block_size));
+        }
+
+        static constexpr std::size_t to_block_size(std::size_t size) noexcept
+        {
+            if (size > max_small_block_size)
+            {
+                return round_up(size);
+            }
+            return min_block_size << size_class_of(size);
+        }
+
+        offset_ptr<free_block> &free_list_of(std::size_t block_size) noexcept
+        {
+            return free_lists_[std::min(size_class_of(block_size), size_class_count)];
+        }
+
+        std::byte *base() noexcept
+        {
+            return reinterpret_cast<std::byte *>(this);
+        }
+
+        const std::byte *base() const noexcept
+        {
+            return reinterpret_cast<const std::byte *>(this);
+        }
+
+        static block_header *header_of(void *payload) noexcept
+        {
+            return static_cast<block_header *>(payload) - 1;
+        }
+
+        static void *payload_of(block_header *header) noexcept
+        {
+            return header + 1;
+        }
+    };
+
+    constexpr std::size_t arena::heap_offset() noexcept
+    {
+        return round_up(sizeof(arena));
+    }
+} // namespace shm
+
+#endif // SHM_ARENA_HPP
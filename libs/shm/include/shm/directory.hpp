@@ -0,0 +1,128 @@
+#ifndef SHM_DIRECTORY_HPP
+#define SHM_DIRECTORY_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <errno.h>
+#include <expected>
+#include <string_view>
+
+#include "unix/error_code.hpp"
+
+#include "shm/offset_ptr.hpp"
+
+namespace shm
+{
+    constexpr std::size_t max_object_name_length{31};
+
+    // the fields are valid only while the entry is used, the flag gets set once
+    // they are written, so a reader never sees a half written entry,
+    // not even the one of a process that crashed while inserting
+    struct directory_entry
+    {
+        std::array<char, max_object_name_length + 1> name{};
+        offset_ptr<void> object;
+        std::size_t size{0};
+        std::atomic<bool> used{false};
+
+        std::string_view get_name() const noexcept
+        {
+            return std::string_view{name.data()};
+        }
+
+        bool is_free() const noexcept
+        {
+            return !used.load(std::memory_order_acquire);
+        }
+
+        bool is_named(std::string_view searched) const noexcept
+        {
+            return !is_free() && get_name() == searched;
+        }
+    };
+
+    static_assert(std::atomic<bool>::is_always_lock_free, "the entries are shared by processes");
+
+    // objects registered by name, so processes attaching the segment can find them,
+    // the inserts and the erases have to be serialized by the owner of the directory,
+    // the lookups never see a partially inserted entry, but they have to be
+    // serialized with the erases too, an erased entry may get reused meanwhile
+    template <std::size_t Capacity>
+    class directory
+    {
+    public:
+        // fails with EEXIST, ENOSPC or ENAMETOOLONG
+        std::expected<void, unix::error_code> insert(std::string_view name, void *object,
+                                                     std::size_t size) noexcept
+        {
+            if (name.empty() || name.size() > max_object_name_length)
+            {
+                return std::unexpected{unix::error_code{ENAMETOOLONG}};
+            }
+            if (find(name))
+            {
+                return std::unexpected{unix::error_code{EEXIST}};
+            }
+            const auto free_entry = std::ranges::find_if(entries_, &directory_entry::is_free);
+
+            if (free_entry == entries_.end())
+            {
+                return std::unexpected{unix::error_code{ENOSPC}};
+            }
+            std::ranges::copy(name, free_entry->name.begin());
+            free_entry->name[name.size()] = '\0';
+            free_entry->object = object;
+            free_entry->size = size;
+            // publishes the fields written above
+            free_entry->used.store(true, std::memory_order_release);
+            return std::expected<void, unix::error_code>{};
+        }
+
+        const directory_entry *find(std::string_view name) const noexcept
+        {
+            const auto found = std::ranges::find_if(entries_, [name](const directory_entry &entry)
+            {
+                return entry.is_named(name);
+            });
+            return found == entries_.end() ? nullptr : &*found;
+        }
+
+        // returns the registered object, nullptr when there is none
+        void *erase(std::string_view name) noexcept
+        {
+            const auto found = std::ranges::find_if(entries_, [name](const directory_entry &entry)
+            {
+                return entry.is_named(name);
+            });
+
+            if (found == entries_.end())
+            {
+                return nullptr;
+            }
+            void *object = found->object.get();
+            // withdrawn before the fields get cleared
+            found->used.store(false, std::memory_order_release);
+            found->name = {};
+            found->object = nullptr;
+            found->size = 0;
+            return object;
+        }
+
+        std::size_t size() const noexcept
+        {
+            return entries_.size() - static_cast<std::size_t>(std::ranges::count_if(entries_, &directory_entry::is_free));
+        }
+
+        static constexpr std::size_t capacity() noexcept
+        {
+            return Capacity;
+        }
+
+    private:
+        std::array<directory_entry, Capacity> entries_{};
+    };
+} // namespace shm
+
+#endif // SHM_DIRECTORY_HPP
@@ -0,0 +1,184 @@
+#ifndef SHM_OFFSET_PTR_HPP
+#define SHM_OFFSET_PTR_HPP
+
+#include <compare>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+
+namespace shm
+{
+    // pointer stored as the distance from its own address, so it stays valid
+    // while both the pointer and the pointee live in the same segment,
+    // no matter at which address each process maps the segment,
+    // copying recomputes the distance, it must not be copied by memcpy
+    template <class T>
+    class offset_ptr
+    {
+        // a distance of one byte can not point to a properly aligned object
+        // other than a char, which would have to overlap the pointer itself
+        static constexpr std::ptrdiff_t null_offset{1};
+
+    public:
+        using element_type = T;
+        using value_type = std::remove_cv_t<T>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = T *;
+        using reference = std::add_lvalue_reference_t<T>;
+        using iterator_category = std::random_access_iterator_tag;
+
+        offset_ptr() noexcept = default;
+
+        offset_ptr(std::nullptr_t) noexcept {}
+
+        offset_ptr(T *ptr) noexcept
+            : offset_{to_offset(ptr)} {}
+
+        offset_ptr(const offset_ptr &other) noexcept
+            : offset_{to_offset(other.get())} {}
+
+        template <class U>
+            requires std::convertible_to<U *, T *>
+        offset_ptr(const offset_ptr<U> &other) noexcept
+            : offset_{to_offset(static_cast<T *>(other.get()))} {}
+
+        offset_ptr &operator=(const offset_ptr &other) noexcept
+        {
+            offset_ = to_offset(other.get());
+            return *this;
+        }
+
+        offset_ptr &operator=(T *ptr) noexcept
+        {
+            offset_ = to_offset(ptr);
+            return *this;
+        }
+
+        offset_ptr &operator=(std::nullptr_t) noexcept
+        {
+            offset_ = null_offset;
+            return *this;
+        }
+
+        T *get() const noexcept
+        {
+            if (offset_ == null_offset)
+            {
+                return nullptr;
+            }
+            return reinterpret_cast<T *>(address() + offset_);
+        }
+
+        reference operator*() const noexcept
+            requires(!std::is_void_v<T>)
+        {
+            return *get();
+        }
+
+        T *operator->() const noexcept
+        {
+            return get();
+        }
+
+        reference operator[](difference_type index) const noexcept
+            requires(!std::is_void_v<T>)
+        {
+            return get()[index];
+        }
+
+        explicit operator bool() const noexcept
+        {
+            return offset_ != null_offset;
+        }
+
+        offset_ptr &operator+=(difference_type count) noexcept
+            requires(!std::is_void_v<T>)
+        {
+            offset_ += count * static_cast<difference_type>(sizeof(T));
+            return *this;
+        }
+
+        offset_ptr &operator-=(difference_type count) noexcept
+            requires(!std::is_void_v<T>)
+        {
+            offset_ -= count * static_cast<difference_type>(sizeof(T));
+            return *this;
+        }
+
+        offset_ptr &operator++() noexcept
+        {
+            return *this += 1;
+        }
+
+        offset_ptr operator++(int) noexcept
+        {
+            auto previous = *this;
+            ++*this;
+            return previous;
+        }
+
+        offset_ptr &operator--() noexcept
+        {
+            return *this -= 1;
+        }
+
+        offset_ptr operator--(int) noexcept
+        {
+            auto previous = *this;
+            --*this;
+            return previous;
+        }
+
+        friend offset_ptr operator+(offset_ptr ptr, difference_type count) noexcept
+        {
+            return ptr += count;
+        }
+
+        friend offset_ptr operator-(offset_ptr ptr, difference_type count) noexcept
+        {
+            return ptr -= count;
+        }
+
+        friend difference_type operator-(const offset_ptr &lhs, const offset_ptr &rhs) noexcept
+        {
+            return lhs.get() - rhs.get();
+        }
+
+        friend bool operator==(const offset_ptr &lhs, const offset_ptr &rhs) noexcept
+        {
+            return lhs.get() == rhs.get();
+        }
+
+        friend bool operator==(const offset_ptr &lhs, std::nullptr_t) noexcept
+        {
+            return !lhs;
+        }
+
+        friend std::strong_ordering operator<=>(const offset_ptr &lhs, const offset_ptr &rhs) noexcept
+        {
+            return std::compare_three_way{}(lhs.get(), rhs.get());
+        }
+
+    private:
+        difference_type offset_{null_offset};
+
+        std::intptr_t address() const noexcept
+        {
+            return reinterpret_cast<std::intptr_t>(this);
+        }
+
+        difference_type to_offset(const volatile void *ptr) const noexcept
+        {
+            if (ptr == nullptr)
+            {
+                return null_offset;
+            }
+            return reinterpret_cast<std::intptr_t>(ptr) - address();
+        }
+    };
+} // namespace shm
+
+#endif // SHM_OFFSET_PTR_HPP
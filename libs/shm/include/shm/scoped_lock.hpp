@@ -0,0 +1,88 @@
+#ifndef SHM_SCOPED_LOCK_HPP
+#define SHM_SCOPED_LOCK_HPP
+
+#include <cassert>
+#include <errno.h>
+#include <expected>
+#include <utility>
+
+#include "unix/error_code.hpp"
+#include "unix/sync/posix/mutex.hpp"
+
+namespace shm
+{
+    // locks a robust mutex for the scope, when the owner died while holding it
+    // the repair gets called first, it returns whether the guarded state is
+    // well-formed again, only then the mutex is made consistent, an unrepaired
+    // mutex turns unusable once unlocked, every later lock fails with ENOTRECOVERABLE,
+    // the lock is released only when it was acquired
+    class scoped_lock
+    {
+    public:
+        // for state kept well-formed by single stores, nothing to repair
+        explicit scoped_lock(unix::sync::posix::mutex &mutex) noexcept
+            : scoped_lock{mutex, []() { return true; }} {}
+
+        template <class Repair>
+        scoped_lock(unix::sync::posix::mutex &mutex, Repair &&repair) noexcept
+            : mutex_{mutex}
+        {
+            const auto locked = mutex_.lock();
+
+            if (!locked)
+            {
+                status_ = std::unexpected{locked.error()};
+                return;
+            }
+            acquired_ = true;
+#ifndef __APPLE__
+            if (locked.value() == unix::sync::posix::lock_result::previous_owner_died)
+            {
+                if (!std::forward<Repair>(repair)())
+                {
+                    status_ = std::unexpected{unix::error_code{EOWNERDEAD}};
+                    return;
+                }
+                const auto consistent = mutex_.make_consistent();
+
+                if (!consistent)
+                {
+                    status_ = std::unexpected{consistent.error()};
+                }
+            }
+#endif
+        }
+
+        scoped_lock(const scoped_lock &other) = delete;
+        scoped_lock &operator=(const scoped_lock &other) = delete;
+
+        ~scoped_lock() noexcept
+        {
+            if (acquired_)
+            {
+                [[maybe_unused]] const auto unlocked = mutex_.unlock();
+                assert(unlocked);
+            }
+        }
+
+        // fails with the error of locking, or with EOWNERDEAD when the state
+        // left by a dead owner could not be repaired, the state must not be
+        // touched then
+        const std::expected<void, unix::error_code> &status() const noexcept
+        {
+            return status_;
+        }
+
+        explicit operator bool() const noexcept
+        {
+            return status_.has_value();
+        }
+
+    private:
+        unix::sync::posix::mutex &mutex_;
+        bool acquired_{false};
+        std::expected<void, unix::error_code> status_{};
+    };
+} // namespace shm
+
+#endif // SHM_SCOPED_LOCK_HPP
@@ -0,0 +1,126 @@
+#ifndef SHM_STRING_HPP
+#define SHM_STRING_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <expected>
+#include <functional>
+#include <string_view>
+
+#include "unix/error_code.hpp"
+
+#include "shm/arena.hpp"
+#include "shm/vector.hpp"
+
+namespace shm
+{
+    // null terminated once anything got assigned
+    class string
+    {
+    public:
+        using size_type = std::size_t;
+
+        explicit string(arena &owner) noexcept
+            : chars_{owner} {}
+
+        // fails with ENOMEM
+        static std::expected<string, unix::error_code> create(arena &owner, std::string_view text) noexcept
+        {
+            string created{owner};
+            const auto assigned = created.assign(text);
+
+            if (!assigned)
+            {
+                return std::unexpected{assigned.error()};
+            }
+            return created;
+        }
+
+        std::expected<void, unix::error_code> assign(std::string_view text) noexcept
+        {
+            chars_.clear();
+            return append(text);
+        }
+
+        std::expected<void, unix::error_code> append(std::string_view text) noexcept
+        {
+            const auto reserved = chars_.reserve(size() + text.size() + 1);
+
+            if (!reserved)
+            {
+                return reserved;
+            }
+            if (!chars_.empty())
+            {
+                chars_.pop_back();
+            }
+            for (const auto character : text)
+            {
+                chars_.push_back(character);
+            }
+            chars_.push_back('\0');
+            return std::expected<void, unix::error_code>{};
+        }
+
+        std::string_view view() const noexcept
+        {
+            return std::string_view{chars_.data(), size()};
+        }
+
+        operator std::string_view() const noexcept
+        {
+            return view();
+        }
+
+        const char *c_str() const noexcept
+        {
+            return chars_.empty() ? "" : chars_.data();
+        }
+
+        size_type size() const noexcept
+        {
+            return chars_.empty() ? 0 : chars_.size() - 1;
+        }
+
+        bool empty() const noexcept
+        {
+            return size() == 0;
+        }
+
+        void clear() noexcept
+        {
+            chars_.clear();
+        }
+
+        arena &get_arena() const noexcept
+        {
+            return chars_.get_arena();
+        }
+
+        friend bool operator==(const string &lhs, const string &rhs) noexcept
+        {
+            return lhs.view() == rhs.view();
+        }
+
+        friend bool operator==(const string &lhs, std::string_view rhs) noexcept
+        {
+            return lhs.view() == rhs;
+        }
+
+    private:
+        vector<char> chars_;
+    };
+
+    // lookups by std::string_view do not have to allocate a shm::string
+    struct string_hash
+    {
+        using is_transparent = void;
+
+        std::size_t operator()(std::string_view text) const noexcept
+        {
+            return std::hash<std::string_view>{}(text);
+        }
+    };
+} // namespace shm
+
+#endif // SHM_STRING_HPP
@@ -0,0 +1,94 @@
+#ifndef SHM_SYNCHRONIZED_HPP
+#define SHM_SYNCHRONIZED_HPP
+
+#include <expected>
+#include <memory>
+#include <type_traits>
+#include <new>
+#include <utility>
+
+#include "unix/error_code.hpp"
+#include "unix/sync/posix/mutex.hpp"
+#include "unix/sync/posix/process_sharing.hpp"
+
+#include "shm/scoped_lock.hpp"
+
+namespace shm
+{
+    // a container guarded by a robust process-shared mutex,
+    // tables built once before the readers start need no locking at all
+    template <class Value>
+    class synchronized
+    {
+    public:
+        synchronized(const synchronized &other) = delete;
+        synchronized &operator=(const synchronized &other) = delete;
+
+        // fails with the error of initializing the mutex, see arena::construct
+        template <class... Args>
+        static std::expected<synchronized *, unix::error_code> construct_at(void *address, Args &&...args) noexcept
+        {
+            auto *constructed = new (address) synchronized{std::forward<Args>(args)...};
+            const auto initialized = unix::sync::posix::mutex::construct_at(
+                &constructed->mutex_, unix::sync::posix::process_sharing::process_shared);
+
+            if (!initialized)
+            {
+                // the mutex got left default constructed, so the whole object can be destroyed
+                std::destroy_at(constructed);
+                return std::unexpected{initialized.error()};
+            }
+            return constructed;
+        }
+
+        // the guarded value must not escape the call, a value left behind by a
+        // process that died while holding the lock is never trusted, so once
+        // that happened every call fails, with EOWNERDEAD and ENOTRECOVERABLE after
+        template <class Function>
+        auto with_lock(Function &&function) noexcept
+        {
+            return with_lock(std::forward<Function>(function), [](Value &) { return false; });
+        }
+
+        // the repair gets the value left behind by a process that died while
+        // holding the lock and returns whether it is well-formed again, e.g.
+        // after clearing it, the function is called only then
+        template <class Function, class Repair>
+        auto with_lock(Function &&function, Repair &&repair) noexcept
+            -> std::expected<std::invoke_result_t<Function, Value &>, unix::error_code>
+        {
+            const scoped_lock locked{mutex_, [&]() { return std::forward<Repair>(repair)(value_); }};
+
+            if (!locked)
+            {
+                return std::unexpected{locked.status().error()};
+            }
+            if constexpr (std::is_void_v<std::invoke_result_t<Function, Value &>>)
+            {
+                std::forward<Function>(function)(value_);
+                return std::expected<void, unix::error_code>{};
+            }
+            else
+            {
+                return std::forward<Function>(function)(value_);
+            }
+        }
+
+        // access without locking, e.g. while no other process runs yet
+        Value &unsynchronized() noexcept
+        {
+            return value_;
+        }
+
+    private:
+        // made process shared by construct_at
+        unix::sync::posix::mutex mutex_;
+        Value value_;
+
+        template <class... Args>
+        explicit synchronized(Args &&...args) noexcept
+            : value_(std::forward<Args>(args)...) {}
+    };
+} // namespace shm
+
+#endif // SHM_SYNCHRONIZED_HPP
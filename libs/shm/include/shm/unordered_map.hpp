@@ -0,0 +1,348 @@
+#ifndef SHM_UNORDERED_MAP_HPP
+#define SHM_UNORDERED_MAP_HPP
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "unix/error_code.hpp"
+
+#include "shm/arena.hpp"
+#include "shm/offset_ptr.hpp"
+
+namespace shm
+{
+    // open addressing with linear probing, the slots live in one arena block,
+    // the hash has to give the same values in all the processes,
+    // i.e. they have to run the same binary,
+    // not synchronized, see synchronized.hpp
+    template <class Key, class Value, class Hash = std::hash<Key>, class KeyEqual = std::equal_to<>>
+    class unordered_map
+    {
+        enum class slot_state : std::uint8_t
+        {
+            empty,
+            occupied,
+            erased // keeps the probe sequences of the following keys intact
+        };
+
+    public:
+        using key_type = Key;
+        using mapped_type = Value;
+        using value_type = std::pair<const Key, Value>;
+        using size_type = std::size_t;
+
+    private:
+        struct slot
+        {
+            slot_state state{slot_state::empty};
+            union
+            {
+                value_type entry;
+            };
+
+            slot() noexcept {}
+            ~slot() noexcept {}
+        };
+
+        template <class Slot, class Entry>
+        class basic_iterator
+        {
+        public:
+            using value_type = unordered_map::value_type;
+            using difference_type = std::ptrdiff_t;
+
+            basic_iterator() noexcept = default;
+
+            basic_iterator(Slot *current, Slot *last) noexcept
+                : current_{current}, last_{last}
+            {
+                skip_free();
+            }
+
+            Entry &operator*() const noexcept
+            {
+                return current_->entry;
+            }
+
+            Entry *operator->() const noexcept
+            {
+                return &current_->entry;
+            }
+
+            basic_iterator &operator++() noexcept
+            {
+                ++current_;
+                skip_free();
+                return *this;
+            }
+
+            basic_iterator operator++(int) noexcept
+            {
+                auto previous = *this;
+                ++*this;
+                return previous;
+            }
+
+            friend bool operator==(const basic_iterator &lhs, const basic_iterator &rhs) noexcept
+            {
+                return lhs.current_ == rhs.current_;
+            }
+
+        private:
+            Slot *current_{nullptr}, *last_{nullptr};
+
+            void skip_free() noexcept
+            {
+                while (current_ != last_ && current_->state != slot_state::occupied)
+                {
+                    ++current_;
+                }
+            }
+        };
+
+    public:
+        using iterator = basic_iterator<slot, value_type>;
+        using const_iterator = basic_iterator<const slot, const value_type>;
+
+        explicit unordered_map(arena &owner) noexcept
+            : arena_{&owner} {}
+
+        unordered_map(const unordered_map &other) = delete;
+        unordered_map &operator=(const unordered_map &other) = delete;
+
+        ~unordered_map() noexcept
+        {
+            release(slots_.get(), capacity_);
+        }
+
+        // inserts the value constructed from the args unless the key is present,
+        // returns the value stored under the key, fails with ENOMEM
+        template <class... Args>
+        std::expected<Value *, unix::error_code> try_emplace(Key &&key, Args &&...args) noexcept
+        {
+            static_assert(std::is_nothrow_move_constructible_v<Key> && std::is_nothrow_move_constructible_v<Value>);
+
+            if (auto *found = find(key))
+            {
+                return found;
+            }
+            // erased slots count as taken, the rehash reclaims them
+            if ((taken_ + 1) * max_load_denominator > capacity_ * max_load_numerator)
+            {
+                const auto rehashed = rehash(std::max(2 * size_ * max_load_denominator / max_load_numerator,
+                                                      initial_capacity));
+
+                if (!rehashed)
+                {
+                    return std::unexpected{rehashed.error()};
+                }
+            }
+            auto &target = slots_[static_cast<std::ptrdiff_t>(free_slot_index(key))];
+
+            if (target.state == slot_state::empty)
+            {
+                ++taken_;
+            }
+            std::construct_at(&target.entry, std::piecewise_construct, std::forward_as_tuple(std::move(key)),
+                              std::forward_as_tuple(std::forward<Args>(args)...));
+            target.state = slot_state::occupied;
+            ++size_;
+            return &target.entry.second;
+        }
+
+        std::expected<Value *, unix::error_code> insert_or_assign(Key &&key, Value &&value) noexcept
+        {
+            if (auto *found = find(key))
+            {
+                *found = std::move(value);
+                return found;
+            }
+            return try_emplace(std::move(key), std::move(value));
+        }
+
+        // the lookup key may be of any type the hash and key equal accept
+        template <class Lookup>
+        Value *find(const Lookup &key) noexcept
+        {
+            auto *found = const_cast<slot *>(find_slot(key));
+            return found ? &found->entry.second : nullptr;
+        }
+
+        template <class Lookup>
+        const Value *find(const Lookup &key) const noexcept
+        {
+            const auto *found = find_slot(key);
+            return found ? &found->entry.second : nullptr;
+        }
+
+        template <class Lookup>
+        bool contains(const Lookup &key) const noexcept
+        {
+            return find_slot(key) != nullptr;
+        }
+
+        template <class Lookup>
+        bool erase(const Lookup &key) noexcept
+        {
+            auto *found = const_cast<slot *>(find_slot(key));
+
+            if (found == nullptr)
+            {
+                return false;
+            }
+            std::destroy_at(&found->entry);
+            found->state = slot_state::erased;
+            --size_;
+            return true;
+        }
+
+        iterator begin() noexcept
+        {
+            return iterator{slots_.get(), slots_.get() + capacity_};
+        }
+
+        iterator end() noexcept
+        {
+            return iterator{slots_.get() + capacity_, slots_.get() + capacity_};
+        }
+
+        const_iterator begin() const noexcept
+        {
+            return const_iterator{slots_.get(), slots_.get() + capacity_};
+        }
+
+        const_iterator end() const noexcept
+        {
+            return const_iterator{slots_.get() + capacity_, slots_.get() + capacity_};
+        }
+
+        size_type size() const noexcept
+        {
+            return size_;
+        }
+
+        bool empty() const noexcept
+        {
+            return size_ == 0;
+        }
+
+        // number of slots, a power of two
+        size_type capacity() const noexcept
+        {
+            return capacity_;
+        }
+
+        // makes room for the count of entries without rehashing, fails with ENOMEM
+        std::expected<void, unix::error_code> reserve(size_type count) noexcept
+        {
+            const auto required = std::bit_ceil(count * max_load_denominator / max_load_numerator + 1);
+
+            if (required <= capacity_)
+            {
+                return std::expected<void, unix::error_code>{};
+            }
+            return rehash(required);
+        }
+
+    private:
+        static constexpr size_type initial_capacity{16}, max_load_numerator{3}, max_load_denominator{4};
+
+        offset_ptr<arena> arena_;
+        offset_ptr<slot> slots_;
+        size_type capacity_{0}, size_{0}, taken_{0};
+
+        size_type home_index(const auto &key) const noexcept
+        {
+            return Hash{}(key) & (capacity_ - 1);
+        }
+
+        template <class Lookup>
+        const slot *find_slot(const Lookup &key) const noexcept
+        {
+            if (capacity_ == 0)
+            {
+                return nullptr;
+            }
+            for (auto index = home_index(key);; index = (index + 1) & (capacity_ - 1))
+            {
+                const auto &current = slots_[static_cast<std::ptrdiff_t>(index)];
+
+                if (current.state == slot_state::empty)
+                {
+                    return nullptr;
+                }
+                if (current.state == slot_state::occupied && KeyEqual{}(current.entry.first, key))
+                {
+                    return &current;
+                }
+            }
+        }
+
+        // the key must not be present, there has to be a free slot
+        size_type free_slot_index(const Key &key) const noexcept
+        {
+            auto index = home_index(key);
+
+            while (slots_[static_cast<std::ptrdiff_t>(index)].state == slot_state::occupied)
+            {
+                index = (index + 1) & (capacity_ - 1);
+            }
+            return index;
+        }
+
+        std::expected<void, unix::error_code> rehash(size_type capacity) noexcept
+        {
+            capacity = std::bit_ceil(capacity);
+            assert(capacity > size_);
+            const auto allocated = arena_->allocate(capacity * sizeof(slot), alignof(slot));
+
+            if (!allocated)
+            {
+                return std::unexpected{allocated.error()};
+            }
+            auto *old_slots = slots_.get();
+            const auto old_capacity = capacity_;
+            slots_ = static_cast<slot *>(allocated.value());
+            capacity_ = capacity;
+            taken_ = size_;
+            std::uninitialized_default_construct_n(slots_.get(), capacity_);
+
+            for (auto *current = old_slots; current != old_slots + old_capacity; ++current)
+            {
+                if (current->state == slot_state::occupied)
+                {
+                    auto &target = slots_[static_cast<std::ptrdiff_t>(free_slot_index(current->entry.first))];
+                    std::construct_at(&target.entry, std::move(const_cast<Key &>(current->entry.first)),
+                                      std::move(current->entry.second));
+                    target.state = slot_state::occupied;
+                }
+            }
+            release(old_slots, old_capacity);
+            return std::expected<void, unix::error_code>{};
+        }
+
+        void release(slot *slots, size_type capacity) noexcept
+        {
+            for (auto *current = slots; current != slots + capacity; ++current)
+            {
+                if (current->state == slot_state::occupied)
+                {
+                    std::destroy_at(&current->entry);
+                }
+                std::destroy_at(current);
+            }
+            arena_->deallocate(slots);
+        }
+    };
+} // namespace shm
+
+#endif // SHM_UNORDERED_MAP_HPP
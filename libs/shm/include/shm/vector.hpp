@@ -0,0 +1,218 @@
+#ifndef SHM_VECTOR_HPP
+#define SHM_VECTOR_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <expected>
+#include <memory>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+#include "unix/error_code.hpp"
+
+#include "shm/arena.hpp"
+#include "shm/offset_ptr.hpp"
+
+namespace shm
+{
+    // the vector has to live in the segment of its arena, e.g. created by
+    // arena::construct_named, the elements must not hold raw pointers
+    // into the segment, only offset pointers,
+    // not synchronized, see synchronized.hpp
+    template <class T>
+    class vector
+    {
+    public:
+        using value_type = T;
+        using size_type = std::size_t;
+        using iterator = T *;
+        using const_iterator = const T *;
+
+        explicit vector(arena &owner) noexcept
+            : arena_{&owner} {}
+
+        vector(const vector &other) = delete;
+        vector &operator=(const vector &other) = delete;
+
+        vector(vector &&other) noexcept
+            : arena_{other.arena_}, data_{other.data_}, size_{other.size_}, capacity_{other.capacity_}
+        {
+            other.data_ = nullptr;
+            other.size_ = other.capacity_ = 0;
+        }
+
+        vector &operator=(vector &&other) noexcept
+        {
+            assert(arena_ == other.arena_);
+            if (this != &other)
+            {
+                release();
+                data_ = other.data_;
+                size_ = other.size_;
+                capacity_ = other.capacity_;
+                other.data_ = nullptr;
+                other.size_ = other.capacity_ = 0;
+            }
+            return *this;
+        }
+
+        ~vector() noexcept
+        {
+            release();
+        }
+
+        // fails with ENOMEM, the elements stay untouched in that case
+        std::expected<void, unix::error_code> reserve(size_type capacity) noexcept
+        {
+            static_assert(std::is_nothrow_move_constructible_v<T>);
+
+            if (capacity <= capacity_)
+            {
+                return std::expected<void, unix::error_code>{};
+            }
+            const auto allocated = arena_->allocate(capacity * sizeof(T), alignof(T));
+
+            if (!allocated)
+            {
+                return std::unexpected{allocated.error()};
+            }
+            auto *data = static_cast<T *>(allocated.value());
+            std::uninitialized_move(begin(), end(), data);
+            std::destroy(begin(), end());
+            arena_->deallocate(data_.get());
+            data_ = data;
+            capacity_ = capacity;
+            return std::expected<void, unix::error_code>{};
+        }
+
+        template <class... Args>
+        std::expected<void, unix::error_code> emplace_back(Args &&...args) noexcept
+        {
+            if (size_ == capacity_)
+            {
+                const auto reserved = reserve(std::max(size_type{2} * capacity_, initial_capacity));
+
+                if (!reserved)
+                {
+                    return reserved;
+                }
+            }
+            std::construct_at(data_.get() + size_, std::forward<Args>(args)...);
+            ++size_;
+            return std::expected<void, unix::error_code>{};
+        }
+
+        std::expected<void, unix::error_code> push_back(const T &value) noexcept
+        {
+            return emplace_back(value);
+        }
+
+        std::expected<void, unix::error_code> push_back(T &&value) noexcept
+        {
+            return emplace_back(std::move(value));
+        }
+
+        void pop_back() noexcept
+        {
+            assert(!empty());
+            std::destroy_at(data_.get() + --size_);
+        }
+
+        void clear() noexcept
+        {
+            std::destroy(begin(), end());
+            size_ = 0;
+        }
+
+        T &operator[](size_type index) noexcept
+        {
+            assert(index < size_);
+            return data_[static_cast<std::ptrdiff_t>(index)];
+        }
+
+        const T &operator[](size_type index) const noexcept
+        {
+            assert(index < size_);
+            return data_[static_cast<std::ptrdiff_t>(index)];
+        }
+
+        T &back() noexcept
+        {
+            return (*this)[size_ - 1];
+        }
+
+        const T &back() const noexcept
+        {
+            return (*this)[size_ - 1];
+        }
+
+        T *data() noexcept
+        {
+            return data_.get();
+        }
+
+        const T *data() const noexcept
+        {
+            return data_.get();
+        }
+
+        iterator begin() noexcept
+        {
+            return data();
+        }
+
+        iterator end() noexcept
+        {
+            return data() + size_;
+        }
+
+        const_iterator begin() const noexcept
+        {
+            return data();
+        }
+
+        const_iterator end() const noexcept
+        {
+            return data() + size_;
+        }
+
+        size_type size() const noexcept
+        {
+            return size_;
+        }
+
+        size_type capacity() const noexcept
+        {
+            return capacity_;
+        }
+
+        bool empty() const noexcept
+        {
+            return size_ == 0;
+        }
+
+        arena &get_arena() const noexcept
+        {
+            return *arena_;
+        }
+
+    private:
+        static constexpr size_type initial_capacity{8};
+
+        offset_ptr<arena> arena_;
+        offset_ptr<T> data_;
+        size_type size_{0}, capacity_{0};
+
+        void release() noexcept
+        {
+            clear();
+            arena_->deallocate(data_.get());
+            data_ = nullptr;
+            capacity_ = 0;
+        }
+    };
+} // namespace shm
+
+#endif // SHM_VECTOR_HPP
@@ -0,0 +1,224 @@
+#ifndef UNIX_AFFINITY_HPP
+#define UNIX_AFFINITY_HPP
+
+#ifdef __linux__ // OSX offers only affinity hints through thread_policy_set
+
+#include <cassert>
+#include <charconv>
+#include <climits>
+#include <errno.h>
+#include <expected>
+#include <pthread.h>
+#include <sched.h>
+#include <string_view>
+#include <thread>
+
+#include "unix/error_code.hpp"
+#include "unix/process.hpp"
+#include "unix/utility.hpp"
+
+namespace unix
+{
+    using cpu_t = int;
+
+    class cpu_set
+    {
+    public:
+        cpu_set() noexcept
+        {
+            CPU_ZERO(&cpus_);
+        }
+
+        // a list of ranges as used by the kernel, e.g. "0-3,8,10-11",
+        // fails with EINVAL for the cpus beyond CPU_SETSIZE too
+        static std::expected<cpu_set, error_code> parse(std::string_view list) noexcept
+        {
+            cpu_set parsed;
+            const auto added = for_each_in_list(list, [&parsed](cpu_t cpu) { parsed.add(cpu); }, CPU_SETSIZE - 1);
+
+            if (!added)
+            {
+                return std::unexpected{added.error()};
+            }
+            return parsed;
+        }
+
+        // the cpus the calling thread may run on
+        static std::expected<cpu_set, error_code> of_current_thread() noexcept
+        {
+            cpu_set current;
+            const auto ret = pthread_getaffinity_np(pthread_self(), sizeof(cpu_set_t), &current.cpus_);
+
+            if (!unix::operation_successful(ret))
+            {
+                return std::unexpected{error_code{ret}};
+            }
+            return current;
+        }
+
+        cpu_set &add(cpu_t cpu) noexcept
+        {
+            assert(cpu >= 0 && cpu < CPU_SETSIZE);
+            CPU_SET(static_cast<std::size_t>(cpu), &cpus_);
+            return *this;
+        }
+
+        bool contains(cpu_t cpu) const noexcept
+        {
+            return cpu >= 0 && cpu < CPU_SETSIZE && CPU_ISSET(static_cast<std::size_t>(cpu), &cpus_);
+        }
+
+        int count() const noexcept
+        {
+            return CPU_COUNT(&cpus_);
+        }
+
+        bool empty() const noexcept
+        {
+            return count() == 0;
+        }
+
+        // returns the n-th cpu of the set, or the last one when there are fewer,
+        // so roles can be spread over whatever set is available
+        cpu_t nth(int index) const noexcept
+        {
+            assert(!empty());
+            cpu_t found{0};
+
+            for (cpu_t cpu{0}; cpu < CPU_SETSIZE && index >= 0; ++cpu)
+            {
+                if (contains(cpu))
+                {
+                    found = cpu;
+                    --index;
+                }
+            }
+            return found;
+        }
+
+        const cpu_set_t *native_handle() const noexcept
+        {
+            return &cpus_;
+        }
+
+        // calls the function with every id of a list of ranges, a trailing newline
+        // ends the list, fails with EINVAL before calling it for a malformed list
+        // or for an id beyond the max one
+        template <class Function>
+        static std::expected<void, error_code> for_each_in_list(std::string_view list, Function &&function,
+                                                                int max_id = INT_MAX) noexcept
+        {
+            const auto checked = visit_list(list, [](int, int) {}, max_id);
+
+            if (!checked)
+            {
+                return checked;
+            }
+            return visit_list(list, [&function](int first, int last)
+            {
+                for (auto id = first; id <= last; ++id)
+                {
+                    function(id);
+                }
+            }, max_id);
+        }
+
+    private:
+        cpu_set_t cpus_;
+
+        template <class Visitor>
+        static std::expected<void, error_code> visit_list(std::string_view list, Visitor &&visitor,
+                                                          int max_id) noexcept
+        {
+            while (!list.empty() && list.front() != '\n')
+            {
+                int first{0}, last{0};
+                const auto *end = list.data() + list.size();
+                auto parsed = std::from_chars(list.data(), end, first);
+
+                if (parsed.ec != std::errc{} || first < 0)
+                {
+                    return std::unexpected{error_code{EINVAL}};
+                }
+                last = first;
+
+                if (parsed.ptr != end && *parsed.ptr == '-')
+                {
+                    parsed = std::from_chars(parsed.ptr + 1, end, last);
+
+                    if (parsed.ec != std::errc{} || last < first)
+                    {
+                        return std::unexpected{error_code{EINVAL}};
+                    }
+                }
+                if (last > max_id)
+                {
+                    return std::unexpected{error_code{EINVAL}};
+                }
+                visitor(first, last);
+                list.remove_prefix(static_cast<std::size_t>(parsed.ptr - list.data()));
+
+                if (list.empty() || list.front() == '\n')
+                {
+                    break;
+                }
+                // a separator has to be followed by another range
+                if (list.front() != ',' || list.size() == 1 || list[1] == '\n')
+                {
+                    return std::unexpected{error_code{EINVAL}};
+                }
+                list.remove_prefix(1);
+            }
+            return std::expected<void, error_code>{};
+        }
+    };
+
+    // zero pins the calling process, children created afterwards inherit the set
+    std::expected<void, error_code> pin_process(process_id_t pid, const cpu_set &cpus) noexcept
+    {
+        const auto ret = sched_setaffinity(pid, sizeof(cpu_set_t), cpus.native_handle());
+
+        if (operation_failed(ret))
+        {
+            return std::unexpected{error_code{errno}};
+        }
+        return std::expected<void, error_code>{};
+    }
+
+    std::expected<void, error_code> pin_current_process(const cpu_set &cpus) noexcept
+    {
+        return pin_process(process_id_t{0}, cpus);
+    }
+
+    std::expected<void, error_code> pin_thread(std::thread &thread, const cpu_set &cpus) noexcept
+    {
+        const auto ret = pthread_setaffinity_np(thread.native_handle(), sizeof(cpu_set_t), cpus.native_handle());
+
+        if (!operation_successful(ret))
+        {
+            return std::unexpected{error_code{ret}};
+        }
+        return std::expected<void, error_code>{};
+    }
+
+    std::expected<void, error_code> pin_current_thread(const cpu_set &cpus) noexcept
+    {
+        const auto ret = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), cpus.native_handle());
+
+        if (!operation_successful(ret))
+        {
+            return std::unexpected{error_code{ret}};
+        }
+        return std::expected<void, error_code>{};
+    }
+
+    // the cpu might change right after the call unless the thread is pinned
+    cpu_t current_cpu() noexcept
+    {
+        return sched_getcpu();
+    }
+} // namespace unix
+
+#endif // __linux__
+
+#endif // UNIX_AFFINITY_HPP
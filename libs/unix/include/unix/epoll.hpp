@@ -0,0 +1,144 @@
+#ifndef UNIX_EPOLL_HPP
+#define UNIX_EPOLL_HPP
+
+#ifdef __linux__ // kqueue is the closest thing on OSX
+
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <errno.h>
+#include <expected>
+#include <span>
+#include <sys/epoll.h>
+#include <unistd.h>
+#include <utility>
+
+#include "unix/error_code.hpp"
+#include "unix/utility.hpp"
+
+namespace unix
+{
+    using epoll_event_t = epoll_event;
+    using epoll_key_t = std::uint64_t;
+
+    // waits for many descriptors at once, each reported with the key
+    // it got registered with, e.g. an index into the caller's table
+    class epoll
+    {
+        static constexpr file_descriptor_t closed_descriptor{-1};
+
+    public:
+        explicit epoll(file_descriptor_t fd) noexcept : fd_{fd} {}
+
+        epoll(const epoll &other) = delete;
+        epoll &operator=(const epoll &other) = delete;
+
+        epoll(epoll &&other) noexcept
+            : fd_{std::exchange(other.fd_, closed_descriptor)} {}
+
+        epoll &operator=(epoll &&other) noexcept = delete;
+
+        static std::expected<epoll, error_code> create() noexcept
+        {
+            const auto fd = ::epoll_create1(EPOLL_CLOEXEC);
+
+            if (operation_failed(fd))
+            {
+                return std::unexpected{error_code{errno}};
+            }
+            return std::expected<epoll, error_code>{std::in_place, fd};
+        }
+
+        std::expected<void, error_code> add(file_descriptor_t fd, std::uint32_t events, epoll_key_t key) const noexcept
+        {
+            return control(EPOLL_CTL_ADD, fd, events, key);
+        }
+
+        std::expected<void, error_code> modify(file_descriptor_t fd, std::uint32_t events, epoll_key_t key) const noexcept
+        {
+            return control(EPOLL_CTL_MOD, fd, events, key);
+        }
+
+        std::expected<void, error_code> remove(file_descriptor_t fd) const noexcept
+        {
+            return control(EPOLL_CTL_DEL, fd, 0, 0);
+        }
+
+        // returns the number of ready events, zero on timeout or when interrupted,
+        // a negative timeout waits indefinitely
+        std::expected<std::size_t, error_code> wait(std::span<epoll_event_t> events,
+                                                    const std::chrono::milliseconds &timeout) const noexcept
+        {
+            assert(is_open());
+            assert(!events.empty());
+            const auto ret = ::epoll_wait(fd_, events.data(), static_cast<int>(events.size()),
+                                          static_cast<int>(timeout.count()));
+
+            if (operation_failed(ret))
+            {
+                if (errno == EINTR)
+                {
+                    return std::size_t{0};
+                }
+                return std::unexpected{error_code{errno}};
+            }
+            return static_cast<std::size_t>(ret);
+        }
+
+        bool is_open() const noexcept
+        {
+            return fd_ != closed_descriptor;
+        }
+
+        file_descriptor_t file_descriptor() const noexcept
+        {
+            assert(is_open());
+            return fd_;
+        }
+
+        std::expected<void, error_code> close() noexcept
+        {
+            assert(is_open());
+            const auto ret = ::close(fd_);
+            fd_ = closed_descriptor;
+
+            if (operation_successful(ret))
+            {
+                return std::expected<void, error_code>{};
+            }
+            return std::unexpected{error_code{errno}};
+        }
+
+        ~epoll() noexcept
+        {
+            if (is_open())
+            {
+                close();
+            }
+        }
+
+    private:
+        file_descriptor_t fd_;
+
+        std::expected<void, error_code> control(int operation, file_descriptor_t fd,
+                                                std::uint32_t events, epoll_key_t key) const noexcept
+        {
+            assert(is_open());
+            epoll_event_t event{};
+            event.events = events;
+            event.data.u64 = key;
+            const auto ret = ::epoll_ctl(fd_, operation, fd, &event);
+
+            if (operation_failed(ret))
+            {
+                return std::unexpected{error_code{errno}};
+            }
+            return std::expected<void, error_code>{};
+        }
+    };
+} // namespace unix
+
+#endif
+
+#endif // UNIX_EPOLL_HPP
@@ -3,6 +3,7 @@
 
 #include "errno.h"
 #include <expected>
+#include <string.h>
 #include <string_view>
 
 
@@ -0,0 +1,206 @@
+#ifndef UNIX_FS_POSIX_FILE_HPP
+#define UNIX_FS_POSIX_FILE_HPP
+
+#include <cassert>
+#include <cstddef>
+#include <errno.h>
+#include <expected>
+#include <fcntl.h>
+#ifdef __linux__
+#include <linux/falloc.h>
+#endif
+#include <span>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+
+#include "unix/error_code.hpp"
+#include "unix/io_vector.hpp"
+#include "unix/fs/posix/file_open_flags_builder.hpp"
+#include "unix/utility.hpp"
+
+namespace unix::fs::posix
+{
+    class file
+    {
+        static constexpr file_descriptor_t closed_descriptor{-1};
+
+    public:
+        // find a way to make it private
+        explicit file(file_descriptor_t fd) noexcept : fd_{fd} {}
+
+        file(const file &other) = delete;
+        file &operator=(const file &other) = delete;
+
+        file(file &&other) noexcept
+            : fd_{std::exchange(other.fd_, closed_descriptor)} {}
+
+        file &operator=(file &&other) noexcept
+        {
+            if (this != &other)
+            {
+                if (is_open())
+                {
+                    close();
+                }
+                fd_ = std::exchange(other.fd_, closed_descriptor);
+            }
+            return *this;
+        }
+
+        // the mode is used only when the file gets created, the path has to be
+        // null terminated, so a std::string rather than a std::string_view
+        static std::expected<file, error_code> open(const std::string &path, open_flags_t flags,
+                                                    mode_t mode = mode_t{0}) noexcept
+        {
+            const auto fd = ::open(path.c_str(), flags, mode);
+
+            if (operation_failed(fd))
+            {
+                return std::unexpected{error_code{errno}};
+            }
+            return std::expected<file, error_code>{std::in_place, fd};
+        }
+
+        bool is_open() const noexcept
+        {
+            return fd_ != closed_descriptor;
+        }
+
+        file_descriptor_t file_descriptor() const noexcept
+        {
+            assert(is_open());
+            return fd_;
+        }
+
+        // writes all the bytes, resuming after short writes
+        std::expected<void, error_code> write(const void *data, std::size_t count) const noexcept
+        {
+            const auto vector = make_io_vector(data, count);
+            return writev(std::span<const io_vector_t>{&vector, 1});
+        }
+
+        // returns the number of bytes read, zero means the end of file
+        std::expected<std::size_t, error_code> read(void *data, std::size_t count) const noexcept
+        {
+            assert(is_open());
+
+            while (true)
+            {
+                const auto ret = ::read(fd_, data, count);
+
+                if (!operation_failed(ret))
+                {
+                    assert(static_cast<std::size_t>(ret) <= count);
+                    return static_cast<std::size_t>(ret);
+                }
+                if (errno != EINTR)
+                {
+                    return std::unexpected{error_code{errno}};
+                }
+            }
+        }
+
+        // gathers the vectors into the file in a single system call
+        // unless the kernel accepts only a part of them
+        std::expected<void, error_code> writev(std::span<const io_vector_t> vectors) const noexcept
+        {
+            assert(is_open());
+            return write_vectors(fd_, vectors);
+        }
+
+        // the positional counterpart of writev, the file offset stays untouched
+        std::expected<void, error_code> pwritev(std::span<const io_vector_t> vectors,
+                                                off_t offset) const noexcept
+        {
+            assert(is_open());
+            return write_vectors_at(fd_, vectors, offset);
+        }
+
+        std::expected<void, error_code> write_at(const void *data, std::size_t count,
+                                                 off_t offset) const noexcept
+        {
+            const auto vector = make_io_vector(data, count);
+            return pwritev(std::span<const io_vector_t>{&vector, 1}, offset);
+        }
+
+        // flushes the data and only the metadata needed to read it back
+        std::expected<void, error_code> data_sync() const noexcept
+        {
+            assert(is_open());
+#ifdef __APPLE__ // fdatasync is not declared on OSX
+            return call_once(::fsync(fd_));
+#else
+            return call_once(::fdatasync(fd_));
+#endif
+        }
+
+        // reserves the blocks up front, keeping the size makes the
+        // reservation invisible to the readers of the file,
+        // fails with EOPNOTSUPP where fallocate is not available
+        std::expected<void, error_code> allocate(off_t offset, off_t length,
+                                                 bool keep_size = true) const noexcept
+        {
+            assert(is_open());
+#ifdef __linux__
+            return call_once(::fallocate(fd_, keep_size ? FALLOC_FL_KEEP_SIZE : 0, offset, length));
+#else
+            static_cast<void>(offset);
+            static_cast<void>(length);
+            static_cast<void>(keep_size);
+            return std::unexpected{error_code{EOPNOTSUPP}};
+#endif
+        }
+
+        std::expected<void, error_code> truncate(off_t size) const noexcept
+        {
+            assert(is_open());
+            return call_once(::ftruncate(fd_, size));
+        }
+
+        // scatters the data into the vectors until they are filled or the end of file
+        // is reached, returns the number of bytes read
+        std::expected<std::size_t, error_code> readv(std::span<const io_vector_t> vectors) const noexcept
+        {
+            assert(is_open());
+            return read_vectors(fd_, vectors);
+        }
+
+        std::expected<void, error_code> close() noexcept
+        {
+            assert(is_open());
+            const auto ret = ::close(fd_);
+            fd_ = closed_descriptor;
+
+            if (operation_successful(ret))
+            {
+                return std::expected<void, error_code>{};
+            }
+            assert(operation_failed(ret));
+            return std::unexpected{error_code{errno}};
+        }
+
+        ~file() noexcept
+        {
+            if (is_open())
+            {
+                close();
+            }
+        }
+
+    private:
+        file_descriptor_t fd_;
+
+        static std::expected<void, error_code> call_once(int ret) noexcept
+        {
+            if (operation_failed(ret))
+            {
+                return std::unexpected{error_code{errno}};
+            }
+            return std::expected<void, error_code>{};
+        }
+    };
+} // namespace unix::fs::posix
+
+#endif // UNIX_FS_POSIX_FILE_HPP
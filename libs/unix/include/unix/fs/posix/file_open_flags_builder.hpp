@@ -0,0 +1,52 @@
+#ifndef UNIX_FS_POSIX_FILE_OPEN_FLAGS_BUILDER_HPP
+#define UNIX_FS_POSIX_FILE_OPEN_FLAGS_BUILDER_HPP
+
+#include <fcntl.h>
+
+#include "unix/ipc/posix/open_flags.hpp"
+#include "unix/ipc/posix/open_flags_builder.hpp"
+
+namespace unix::fs::posix
+{
+    using ipc::posix::access_mode;
+    using ipc::posix::open_flags_t;
+
+    class file_open_flags_builder : public ipc::posix::open_flags_builder<file_open_flags_builder>
+    {
+    public:
+        constexpr explicit file_open_flags_builder(access_mode access) noexcept
+        {
+            flags_ |= ipc::posix::to_open_flags(access);
+        }
+
+        constexpr file_open_flags_builder &truncate() noexcept
+        {
+            flags_ |= O_TRUNC;
+            return *this;
+        }
+
+        constexpr file_open_flags_builder &append() noexcept
+        {
+            flags_ |= O_APPEND;
+            return *this;
+        }
+
+#ifdef __linux__ // OSX bypasses the page cache with fcntl F_NOCACHE instead
+        // bypasses the page cache, the buffers, offsets and sizes
+        // of the transfers have to be aligned to the logical block size
+        constexpr file_open_flags_builder &direct() noexcept
+        {
+            flags_ |= O_DIRECT;
+            return *this;
+        }
+#endif
+
+        constexpr file_open_flags_builder &close_on_exec() noexcept
+        {
+            flags_ |= O_CLOEXEC;
+            return *this;
+        }
+    };
+} // namespace unix::fs::posix
+
+#endif // UNIX_FS_POSIX_FILE_OPEN_FLAGS_BUILDER_HPP
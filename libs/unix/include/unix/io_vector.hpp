@@ -0,0 +1,155 @@
+#ifndef UNIX_IO_VECTOR_HPP
+#define UNIX_IO_VECTOR_HPP
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <errno.h>
+#include <expected>
+#include <span>
+#include <sys/uio.h>
+
+#include "unix/error_code.hpp"
+#include "unix/utility.hpp"
+
+namespace unix
+{
+    using io_vector_t = iovec;
+
+    // the kernel accepts at most IOV_MAX vectors per call,
+    // longer spans are transferred in batches of this size
+    constexpr std::size_t io_vector_batch_size{64};
+
+    constexpr io_vector_t make_io_vector(const void *data, std::size_t size) noexcept
+    {
+        return io_vector_t{const_cast<void *>(data), size};
+    }
+
+    template <class Value>
+    constexpr io_vector_t make_io_vector(std::span<const Value> values) noexcept
+    {
+        return make_io_vector(values.data(), values.size_bytes());
+    }
+
+    constexpr std::size_t total_size(std::span<const io_vector_t> vectors) noexcept
+    {
+        std::size_t size{0};
+
+        for (const auto &vector : vectors)
+        {
+            size += vector.iov_len;
+        }
+        return size;
+    }
+
+    // calls the transfer until all the vectors are transferred or it reports
+    // the end of file, short transfers are resumed from the first byte not transferred,
+    // the passed vectors are never modified, returns the number of bytes transferred
+    template <class Transfer>
+    std::expected<std::size_t, error_code> transfer_vectors(std::span<const io_vector_t> vectors,
+                                                            Transfer transfer) noexcept
+    {
+        std::array<io_vector_t, io_vector_batch_size> batch;
+        std::size_t index{0}, offset{0}, transferred{0};
+
+        while (true)
+        {
+            // skip vectors with nothing left to transfer
+            while ((index < vectors.size()) && (offset == vectors[index].iov_len))
+            {
+                ++index;
+                offset = 0;
+            }
+            if (index == vectors.size())
+            {
+                return transferred;
+            }
+            const auto count = std::min(batch.size(), vectors.size() - index);
+            std::copy_n(vectors.begin() + index, count, batch.begin());
+            batch[0].iov_base = static_cast<std::byte *>(batch[0].iov_base) + offset;
+            batch[0].iov_len -= offset;
+
+            const auto ret = transfer(batch.data(), static_cast<int>(count));
+
+            if (operation_failed(ret))
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                return std::unexpected{error_code{errno}};
+            }
+            if (ret == 0)
+            {
+                return transferred;
+            }
+            auto remaining = static_cast<std::size_t>(ret);
+            transferred += remaining;
+
+            while (remaining > 0)
+            {
+                assert(index < vectors.size());
+                const auto left = vectors[index].iov_len - offset;
+
+                if (remaining < left)
+                {
+                    offset += remaining;
+                    break;
+                }
+                remaining -= left;
+                ++index;
+                offset = 0;
+            }
+        }
+    }
+
+    // writes all the vectors, resuming after short writes
+    std::expected<void, error_code> write_vectors(file_descriptor_t fd,
+                                                  std::span<const io_vector_t> vectors) noexcept
+    {
+        const auto written = transfer_vectors(
+            vectors, [fd](const io_vector_t *batch, int count)
+            { return ::writev(fd, batch, count); });
+
+        if (!written)
+        {
+            return std::unexpected{written.error()};
+        }
+        assert(written.value() == total_size(vectors));
+        return std::expected<void, error_code>{};
+    }
+
+    // writes all the vectors starting at the offset, the file offset stays untouched
+    std::expected<void, error_code> write_vectors_at(file_descriptor_t fd,
+                                                     std::span<const io_vector_t> vectors,
+                                                     off_t offset) noexcept
+    {
+        const auto written = transfer_vectors(
+            vectors, [fd, &offset](const io_vector_t *batch, int count)
+            {
+                const auto ret = ::pwritev(fd, batch, count, offset);
+                offset += operation_failed(ret) ? 0 : ret;
+                return ret;
+            });
+
+        if (!written)
+        {
+            return std::unexpected{written.error()};
+        }
+        assert(written.value() == total_size(vectors));
+        return std::expected<void, error_code>{};
+    }
+
+    // fills the vectors in order, stops early only at the end of file,
+    // returns the number of bytes read
+    std::expected<std::size_t, error_code> read_vectors(file_descriptor_t fd,
+                                                        std::span<const io_vector_t> vectors) noexcept
+    {
+        return transfer_vectors(
+            vectors, [fd](const io_vector_t *batch, int count)
+            { return ::readv(fd, batch, count); });
+    }
+}
+
+#endif // UNIX_IO_VECTOR_HPP
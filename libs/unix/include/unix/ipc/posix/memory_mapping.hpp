@@ -0,0 +1,247 @@
+#ifndef UNIX_IPC_POSIX_MEMORY_MAPPING_HPP
+#define UNIX_IPC_POSIX_MEMORY_MAPPING_HPP
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <errno.h>
+#include <expected>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <utility>
+
+#include "unix/error_code.hpp"
+#include "unix/utility.hpp"
+
+namespace unix::ipc::posix
+{
+    using protection_t = int;
+    using mapping_flags_t = int;
+
+    constexpr protection_t read_write_protection{PROT_READ | PROT_WRITE};
+
+    class mapping_flags_builder
+    {
+        mapping_flags_t flags_{MAP_SHARED};
+
+    public:
+        constexpr mapping_flags_builder &is_private() noexcept
+        {
+            flags_ = (flags_ & ~MAP_SHARED) | MAP_PRIVATE;
+            return *this;
+        }
+
+#ifndef __APPLE__
+        // pre-faults the whole mapping, so the first touch does not page fault
+        constexpr mapping_flags_builder &populate() noexcept
+        {
+            flags_ |= MAP_POPULATE;
+            return *this;
+        }
+
+        // backs the mapping with pages reserved in /proc/sys/vm/nr_hugepages,
+        // works only for anonymous mappings and files on hugetlbfs,
+        // shm_open segments live on tmpfs and need transparent huge pages instead
+        constexpr mapping_flags_builder &huge_pages() noexcept
+        {
+            flags_ |= MAP_HUGETLB;
+            return *this;
+        }
+
+        // selects a non-default huge page size, e.g. MAP_HUGE_1GB
+        constexpr mapping_flags_builder &huge_pages(mapping_flags_t size_flag) noexcept
+        {
+            flags_ |= MAP_HUGETLB | size_flag;
+            return *this;
+        }
+#endif
+
+        constexpr mapping_flags_t get() const noexcept
+        {
+            return flags_;
+        }
+    };
+
+    enum class memory_advice
+    {
+        normal,     // MADV_NORMAL
+        random,     // MADV_RANDOM
+        sequential, // MADV_SEQUENTIAL
+        will_need,  // MADV_WILLNEED
+        dont_need,  // MADV_DONTNEED
+#ifndef __APPLE__
+        huge_pages,    // MADV_HUGEPAGE, transparent huge pages
+        no_huge_pages, // MADV_NOHUGEPAGE
+#endif
+    };
+
+    constexpr int to_advice_flag(memory_advice advice) noexcept
+    {
+#ifndef __APPLE__
+        constexpr std::size_t advice_count = 7;
+        const auto advice_flags = std::array<int, advice_count>{
+            MADV_NORMAL, MADV_RANDOM, MADV_SEQUENTIAL, MADV_WILLNEED, MADV_DONTNEED,
+            MADV_HUGEPAGE, MADV_NOHUGEPAGE};
+#else
+        constexpr std::size_t advice_count = 5;
+        const auto advice_flags = std::array<int, advice_count>{
+            MADV_NORMAL, MADV_RANDOM, MADV_SEQUENTIAL, MADV_WILLNEED, MADV_DONTNEED};
+#endif
+        const auto advice_index = static_cast<std::size_t>(advice);
+        assert(advice_index < advice_count);
+        return advice_flags[advice_index];
+    }
+
+    std::size_t page_size() noexcept
+    {
+        static const auto size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+        return size;
+    }
+
+    // owns a mapped region, unmaps it when destroyed
+    class memory_mapping
+    {
+    public:
+        // find a way to make it private
+        explicit memory_mapping(void *address, std::size_t size) noexcept
+            : address_{address}, size_{size} {}
+
+        memory_mapping(const memory_mapping &other) = delete;
+        memory_mapping &operator=(const memory_mapping &other) = delete;
+
+        memory_mapping(memory_mapping &&other) noexcept
+            : address_{std::exchange(other.address_, nullptr)},
+              size_{std::exchange(other.size_, 0)} {}
+
+        memory_mapping &operator=(memory_mapping &&other) noexcept
+        {
+            if (this != &other)
+            {
+                reset();
+                address_ = std::exchange(other.address_, nullptr);
+                size_ = std::exchange(other.size_, 0);
+            }
+            return *this;
+        }
+
+        static std::expected<memory_mapping, error_code> create(file_descriptor_t fd, std::size_t size,
+                                                                protection_t protection, mapping_flags_t flags,
+                                                                off_t offset = off_t{0}) noexcept
+        {
+            assert(size > 0);
+            void *address = ::mmap(nullptr, size, protection, flags, fd, offset);
+
+            if (address == MAP_FAILED)
+            {
+                return std::unexpected{error_code{errno}};
+            }
+            return std::expected<memory_mapping, error_code>{std::in_place, address, size};
+        }
+
+        // memory not backed by any file, shared with children created afterwards
+        static std::expected<memory_mapping, error_code> create_anonymous(std::size_t size,
+                                                                          protection_t protection,
+                                                                          mapping_flags_t flags) noexcept
+        {
+            return create(file_descriptor_t{-1}, size, protection, flags | MAP_ANONYMOUS);
+        }
+
+        void *data() const noexcept
+        {
+            return address_;
+        }
+
+        std::size_t size() const noexcept
+        {
+            return size_;
+        }
+
+        explicit operator bool() const noexcept
+        {
+            return address_ != nullptr;
+        }
+
+        std::expected<void, error_code> advise(memory_advice advice) const noexcept
+        {
+            return advise(advice, 0, size_);
+        }
+
+        // the offset has to be page aligned
+        std::expected<void, error_code> advise(memory_advice advice, std::size_t offset,
+                                               std::size_t length) const noexcept
+        {
+            assert(address_);
+            assert(offset % page_size() == 0);
+            assert(offset + length <= size_);
+            const auto ret = ::madvise(static_cast<std::byte *>(address_) + offset, length,
+                                       to_advice_flag(advice));
+
+            if (operation_failed(ret))
+            {
+                return std::unexpected{error_code{errno}};
+            }
+            return std::expected<void, error_code>{};
+        }
+
+        // touches every page, so later accesses do not fault,
+        // an alternative to MAP_POPULATE where it is unavailable
+        void prefault() const noexcept
+        {
+            assert(address_);
+            auto *bytes = static_cast<volatile std::byte *>(address_);
+            const auto step = page_size();
+
+            for (std::size_t offset{0}; offset < size_; offset += step)
+            {
+                bytes[offset] = bytes[offset];
+            }
+        }
+
+        // keeps the pages resident, subject to RLIMIT_MEMLOCK
+        std::expected<void, error_code> lock() const noexcept
+        {
+            assert(address_);
+            const auto ret = ::mlock(address_, size_);
+
+            if (operation_failed(ret))
+            {
+                return std::unexpected{error_code{errno}};
+            }
+            return std::expected<void, error_code>{};
+        }
+
+        std::expected<void, error_code> unmap() noexcept
+        {
+            assert(address_);
+            const auto ret = ::munmap(address_, size_);
+            address_ = nullptr;
+            size_ = 0;
+
+            if (operation_failed(ret))
+            {
+                return std::unexpected{error_code{errno}};
+            }
+            return std::expected<void, error_code>{};
+        }
+
+        ~memory_mapping() noexcept
+        {
+            reset();
+        }
+
+    private:
+        void *address_;
+        std::size_t size_;
+
+        void reset() noexcept
+        {
+            if (address_)
+            {
+                const auto unmapped = unmap();
+                assert(unmapped);
+            }
+        }
+    };
+} // namespace unix::ipc::posix
+
+#endif // UNIX_IPC_POSIX_MEMORY_MAPPING_HPP
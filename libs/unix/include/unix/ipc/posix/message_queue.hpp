@@ -1,63 +1,312 @@
 #ifndef UNIX_IPC_POSIX_MESSAGE_QUEUE_HPP
 #define UNIX_IPC_POSIX_MESSAGE_QUEUE_HPP
 
+#include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <errno.h>
 #include <expected>
 #include <fcntl.h>
-// #include <mqueue.h> // not available on OSX
+#include <signal.h>
+#include <span>
 #include <string>
+#include <sys/stat.h>
+#include <time.h>
 
-#include "error_code.hpp"
-#include "utility.hpp"
-#include "unix/posix/open_flags.hpp"
-#include "posix/ipc/primitive.hpp"
+#ifndef __APPLE__ // not available on OSX
+#include <mqueue.h>
+#endif
+
+#include "unix/error_code.hpp"
+#include "unix/ipc/posix/open_flags.hpp"
+#include "unix/ipc/posix/primitive.hpp"
+#include "unix/ipc/posix/utility.hpp"
+#include "unix/utility.hpp"
 
 
 namespace unix::ipc::posix
 {
-    class message_queue : public ipc::primitive
+#ifndef __APPLE__
+    using message_priority_t = unsigned int;
+    using message_queue_attributes_t = mq_attr;
+
+    // messages are received in a decreasing priority order,
+    // messages with the same priority in the order they were sent
+    constexpr message_priority_t default_message_priority{0};
+
+    struct received_message
     {
+        std::size_t size{0};
+        message_priority_t priority{default_message_priority};
+    };
+
+    // the deadlines of the timed operations are measured by CLOCK_REALTIME
+    timespec to_timespec(const std::chrono::system_clock::time_point &deadline) noexcept
+    {
+        const auto since_epoch = deadline.time_since_epoch();
+        const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(since_epoch);
+        const auto nanoseconds =
+            std::chrono::duration_cast<std::chrono::nanoseconds>(since_epoch - seconds);
+        return timespec{static_cast<time_t>(seconds.count()),
+                        static_cast<long>(nanoseconds.count())};
+    }
+
+    class message_queue : public primitive
+    {
+        using handle_type = mqd_t;
+
     public:
-        explicit message_queue() noexcept = default;
+        // find a way to make it private
+        explicit message_queue(handle_type handle, std::string &&name) noexcept
+            : handle_{handle}, name_{std::move(name)} {}
 
+        // attributes are used only when the queue gets created,
+        // the limits are capped by /proc/sys/fs/mqueue/msg_max and msgsize_max
         static std::expected<posix::message_queue, error_code>
-        create(std::string name, open_flags_t flags) noexcept
+        create(std::string &&name, open_flags_t flags, mode_t mode,
+               message_queue_attributes_t *attributes) noexcept
         {
             assert(is_valid_pathname(name));
-            // mq_open(...)
-            return std::expected<posix::message_queue, error_code>{std::in_place};
+            const handle_type handle = ::mq_open(name.data(), flags, mode, attributes);
+
+            if (operation_failed(handle))
+            {
+                return std::unexpected{error_code{errno}};
+            }
+            return std::expected<posix::message_queue, error_code>{std::in_place, handle, std::move(name)};
+        }
+
+        static std::expected<posix::message_queue, error_code>
+        open_existing(std::string &&name, open_flags_t flags) noexcept
+        {
+            return create(std::move(name), flags, mode_t{0}, nullptr);
+        }
+
+        static std::expected<posix::message_queue, error_code>
+        create_exclusively(std::string &&name, open_flags_t flags, mode_t mode,
+                           long max_message_count, long max_message_size) noexcept
+        {
+            message_queue_attributes_t attributes{};
+            attributes.mq_maxmsg = max_message_count;
+            attributes.mq_msgsize = max_message_size;
+            return create(std::move(name), flags | O_CREAT | O_EXCL, mode, &attributes);
+        }
+
+        std::expected<message_queue_attributes_t, error_code> get_attributes() const noexcept
+        {
+            message_queue_attributes_t attributes;
+            const auto ret = ::mq_getattr(handle_, &attributes);
+
+            if (operation_failed(ret))
+            {
+                return std::unexpected{error_code{errno}};
+            }
+            return attributes;
+        }
+
+        // receive buffers have to be at least this large
+        std::expected<std::size_t, error_code> max_message_size() const noexcept
+        {
+            const auto attributes = get_attributes();
+
+            if (!attributes)
+            {
+                return std::unexpected{attributes.error()};
+            }
+            return static_cast<std::size_t>(attributes.value().mq_msgsize);
         }
 
-        std::expected<void, error_code> close() noexcept
+        // blocks while the queue is full, unless opened as non-blocking
+        std::expected<void, error_code> send(std::span<const char> message,
+                                             message_priority_t priority = default_message_priority) const noexcept
         {
-            // mq_close(...);
+            const auto ret = ::mq_send(handle_, message.data(), message.size(), priority);
+
+            if (operation_failed(ret))
+            {
+                return std::unexpected{error_code{errno}};
+            }
             return std::expected<void, error_code>{};
         }
 
-        std::expected<void, error_code> unlink() noexcept
+        // fails with ETIMEDOUT when the queue stays full till the deadline
+        std::expected<void, error_code> send_until(std::span<const char> message, message_priority_t priority,
+                                                   const std::chrono::system_clock::time_point &deadline) const noexcept
         {
-            // mq_unlink();
+            const auto timeout = to_timespec(deadline);
+            const auto ret = ::mq_timedsend(handle_, message.data(), message.size(), priority, &timeout);
+
+            if (operation_failed(ret))
+            {
+                return std::unexpected{error_code{errno}};
+            }
             return std::expected<void, error_code>{};
         }
 
-        std::expected<void, error_code> send(/*...*/) noexcept
+        template <class Rep, class Period>
+        std::expected<void, error_code> send_for(std::span<const char> message, message_priority_t priority,
+                                                 const std::chrono::duration<Rep, Period> &timeout) const noexcept
+        {
+            return send_until(message, priority, std::chrono::system_clock::now() + timeout);
+        }
+
+        // receives the oldest message with the highest priority,
+        // blocks while the queue is empty, unless opened as non-blocking
+        std::expected<received_message, error_code> receive(std::span<char> buffer) const noexcept
+        {
+            received_message message;
+            const auto ret = ::mq_receive(handle_, buffer.data(), buffer.size(), &message.priority);
+
+            if (operation_failed(ret))
+            {
+                return std::unexpected{error_code{errno}};
+            }
+            message.size = static_cast<std::size_t>(ret);
+            return message;
+        }
+
+        // fails with ETIMEDOUT when the queue stays empty till the deadline
+        std::expected<received_message, error_code>
+        receive_until(std::span<char> buffer,
+                      const std::chrono::system_clock::time_point &deadline) const noexcept
+        {
+            return receive_until(buffer, to_timespec(deadline));
+        }
+
+        template <class Rep, class Period>
+        std::expected<received_message, error_code>
+        receive_for(std::span<char> buffer, const std::chrono::duration<Rep, Period> &timeout) const noexcept
+        {
+            return receive_until(buffer, std::chrono::system_clock::now() + timeout);
+        }
+
+        // fails with EAGAIN when the queue is empty, without changing the blocking mode
+        std::expected<received_message, error_code> try_receive(std::span<char> buffer) const noexcept
+        {
+            // an expired deadline makes the call return immediately
+            const auto received = receive_until(buffer, timespec{0, 0});
+
+            if (!received && received.error().code == ETIMEDOUT)
+            {
+                return std::unexpected{error_code{EAGAIN}};
+            }
+            return received;
+        }
+
+        // waits for the first message, then drains the already queued ones without blocking
+        // until all the slots get filled, each slot has to fit max_message_size bytes,
+        // the i-th message is stored at buffer[i * slot_size], returns the number of messages received
+        std::expected<std::size_t, error_code> receive_batch(std::span<char> buffer, std::size_t slot_size,
+                                                             std::span<received_message> messages) const noexcept
+        {
+            assert(slot_size > 0);
+            const auto slot_count = std::min(messages.size(), buffer.size() / slot_size);
+            assert(slot_count > 0);
+            const auto first = receive(buffer.first(slot_size));
+
+            if (!first)
+            {
+                return std::unexpected{first.error()};
+            }
+            messages[0] = first.value();
+            std::size_t count{1};
+
+            for (; count < slot_count; ++count)
+            {
+                const auto next = try_receive(buffer.subspan(count * slot_size, slot_size));
+
+                if (!next)
+                {
+                    if (next.error().code == EAGAIN)
+                    {
+                        break;
+                    }
+                    return std::unexpected{next.error()};
+                }
+                messages[count] = next.value();
+            }
+            return count;
+        }
+
+        // registers the process to be notified once a message arrives into an empty queue,
+        // the registration is removed after each notification,
+        // only one process can be registered at a time
+        std::expected<void, error_code> notify(const sigevent &event) const noexcept
         {
-            // mq_send(...)
+            const auto ret = ::mq_notify(handle_, &event);
+
+            if (operation_failed(ret))
+            {
+                return std::unexpected{error_code{errno}};
+            }
             return std::expected<void, error_code>{};
         }
 
-        std::expected<void, error_code> receive(/*...*/) noexcept
+        std::expected<void, error_code> notify_by_signal(int signal) const noexcept
         {
-            // mq_receive(/...)
+            sigevent event{};
+            event.sigev_notify = SIGEV_SIGNAL;
+            event.sigev_signo = signal;
+            return notify(event);
+        }
+
+        std::expected<void, error_code> cancel_notification() const noexcept
+        {
+            const auto ret = ::mq_notify(handle_, nullptr);
+
+            if (operation_failed(ret))
+            {
+                return std::unexpected{error_code{errno}};
+            }
             return std::expected<void, error_code>{};
         }
 
-        std::expected<void, error_code> notify(/*...*/) noexcept
+        // on linux the queue descriptor is a file descriptor, it becomes readable
+        // when the queue is not empty, so it can be watched by poll or epoll
+        file_descriptor_t file_descriptor() const noexcept
         {
-            // mq_notify(...)
+            return handle_;
+        }
+
+        // removes the name, the queue is destroyed once all the processes close it
+        std::expected<void, error_code> unlink() const noexcept
+        {
+            const auto ret = ::mq_unlink(name_.data());
+
+            if (operation_failed(ret))
+            {
+                return std::unexpected{error_code{errno}};
+            }
             return std::expected<void, error_code>{};
         }
+
+        ~message_queue() noexcept
+        {
+            const auto ret = ::mq_close(handle_);
+            assert(operation_successful(ret));
+        }
+
+    private:
+        handle_type handle_;
+        std::string name_;
+
+        std::expected<received_message, error_code> receive_until(std::span<char> buffer,
+                                                                  const timespec &deadline) const noexcept
+        {
+            received_message message;
+            const auto ret = ::mq_timedreceive(handle_, buffer.data(), buffer.size(),
+                                               &message.priority, &deadline);
+
+            if (operation_failed(ret))
+            {
+                return std::unexpected{error_code{errno}};
+            }
+            message.size = static_cast<std::size_t>(ret);
+            return message;
+        }
     };
+#endif
 } // namespace unix::ipc::posix
 
 #endif // UNIX_IPC_POSIX_MESSAGE_QUEUE_HPP
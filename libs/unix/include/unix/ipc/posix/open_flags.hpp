@@ -1,13 +1,32 @@
 #ifndef UNIX_IPC_POSIX_OPEN_FLAGS_HPP
 #define UNIX_IPC_POSIX_OPEN_FLAGS_HPP
 
+#include <array>
 #include <cassert>
+#include <cstddef>
 #include <fcntl.h>
 
 namespace unix::ipc::posix
 {
     using open_flags_t = int;
     constexpr open_flags_t no_open_flags{0};
+
+    enum class access_mode
+    {
+        read_only,  // O_RDONLY
+        write_only, // O_WRONLY
+        read_write, // O_RDWR
+    };
+
+    constexpr open_flags_t to_open_flags(access_mode access) noexcept
+    {
+        constexpr std::size_t access_mode_count = 3;
+        const auto access_index = static_cast<std::size_t>(access);
+        assert(access_index < access_mode_count);
+        const auto access_flags = std::array<open_flags_t, access_mode_count>{
+            O_RDONLY, O_WRONLY, O_RDWR};
+        return access_flags[access_index];
+    }
 }
 
 #endif // UNIX_IPC_POSIX_OPEN_FLAGS_HPP
\ No newline at end of file
@@ -3,20 +3,31 @@
 
 #include <array>
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
 #include <errno.h>
 #include <expected>
+#include <fcntl.h>
+#include <limits>
+#include <span>
+#include <sys/uio.h>
 #include <unistd.h>
 
 #include "unix/error_code.hpp"
+#include "unix/io_vector.hpp"
 #include "unix/ipc/posix/primitive.hpp"
 #include "unix/utility.hpp"
 
 
 namespace unix::ipc::posix
 {
+#ifndef __APPLE__
+    using splice_flags_t = unsigned int;
+    constexpr splice_flags_t no_splice_flags{0};
+#endif
+
     class pipe : public primitive
     {
-        using file_descriptor_t = int;
         static constexpr std::size_t end_count = 2;
         static constexpr std::size_t read_end_index = 0;
         static constexpr std::size_t write_end_index = 1;
@@ -70,34 +81,210 @@ namespace unix::ipc::posix
             return is_end_open(write_end_index);
         }
 
-        std::expected<void, error_code> write(void *data, size_t count) const noexcept
+        file_descriptor_t read_end() const noexcept
+        {
+            assert(is_read_end_open());
+            return fds_[read_end_index];
+        }
+
+        file_descriptor_t write_end() const noexcept
         {
             assert(is_write_end_open());
-            const auto ret = ::write(fds_[write_end_index], data, count);
+            return fds_[write_end_index];
+        }
 
-            if (!unix::operation_failed(ret))
+        // writes all the bytes, the kernel may accept only a part of them at a time
+        // (e.g. when the pipe is nearly full or the call is interrupted)
+        std::expected<void, error_code> write(const void *data, std::size_t count) const noexcept
+        {
+            assert(is_write_end_open());
+            const auto *bytes = static_cast<const std::byte *>(data);
+
+            while (count > 0)
             {
-                assert(ret == count);
-                return std::expected<void, error_code>{};
+                const auto ret = ::write(fds_[write_end_index], bytes, count);
+
+                if (unix::operation_failed(ret))
+                {
+                    if (errno == EINTR)
+                    {
+                        continue;
+                    }
+                    return std::unexpected(error_code{errno});
+                }
+                assert(static_cast<std::size_t>(ret) <= count);
+                bytes += ret;
+                count -= static_cast<std::size_t>(ret);
             }
-            assert(unix::operation_failed(ret));
-            return std::unexpected(error_code{errno});
+            return std::expected<void, error_code>{};
         }
 
-        std::expected<void, error_code> read(void *data, size_t count) const noexcept
+        // returns the number of bytes read, zero means the write end got closed
+        std::expected<std::size_t, error_code> read(void *data, std::size_t count) const noexcept
         {
             assert(is_read_end_open());
-            const auto ret = ::read(fds_[read_end_index], data, count);
 
-            if (!unix::operation_failed(ret))
+            while (true)
             {
-                assert(ret <= count);
-                return std::expected<void, error_code>{};
+                const auto ret = ::read(fds_[read_end_index], data, count);
+
+                if (!unix::operation_failed(ret))
+                {
+                    assert(static_cast<std::size_t>(ret) <= count);
+                    return static_cast<std::size_t>(ret);
+                }
+                assert(unix::operation_failed(ret));
+
+                if (errno != EINTR)
+                {
+                    return std::unexpected{error_code{errno}};
+                }
             }
-            assert(unix::operation_failed(ret));
-            return std::unexpected{error_code{errno}};
         }
 
+        // reads until the buffer is filled,
+        // fails with EPIPE when the write end gets closed before that
+        std::expected<void, error_code> read_exactly(void *data, std::size_t count) const noexcept
+        {
+            auto *bytes = static_cast<std::byte *>(data);
+
+            while (count > 0)
+            {
+                const auto bytes_read = read(bytes, count);
+
+                if (!bytes_read)
+                {
+                    return std::unexpected{bytes_read.error()};
+                }
+                if (bytes_read.value() == std::size_t{0})
+                {
+                    return std::unexpected{error_code{EPIPE}};
+                }
+                bytes += bytes_read.value();
+                count -= bytes_read.value();
+            }
+            return std::expected<void, error_code>{};
+        }
+
+        // gathers the vectors into the pipe, resuming after short writes,
+        // writes up to PIPE_BUF bytes are atomic as a whole
+        std::expected<void, error_code> writev(std::span<const io_vector_t> vectors) const noexcept
+        {
+            assert(is_write_end_open());
+            return write_vectors(fds_[write_end_index], vectors);
+        }
+
+        // scatters the data into the vectors until they are filled or the write end
+        // gets closed, returns the number of bytes read
+        std::expected<std::size_t, error_code> readv(std::span<const io_vector_t> vectors) const noexcept
+        {
+            assert(is_read_end_open());
+            return read_vectors(fds_[read_end_index], vectors);
+        }
+
+#ifndef __APPLE__
+        // pipe buffer size in bytes, 64 KiB by default on linux
+        std::expected<std::size_t, error_code> capacity() const noexcept
+        {
+            const auto fd = is_write_end_open() ? fds_[write_end_index] : fds_[read_end_index];
+            const auto ret = fcntl(fd, F_GETPIPE_SZ);
+
+            if (unix::operation_failed(ret))
+            {
+                return std::unexpected{error_code{errno}};
+            }
+            return static_cast<std::size_t>(ret);
+        }
+
+        // the kernel rounds the capacity up to a power of two number of pages,
+        // unprivileged processes are limited by /proc/sys/fs/pipe-max-size,
+        // fails with EINVAL for capacities fcntl cannot take
+        std::expected<std::size_t, error_code> set_capacity(std::size_t capacity) const noexcept
+        {
+            if (capacity > static_cast<std::size_t>(std::numeric_limits<int>::max()))
+            {
+                return std::unexpected{error_code{EINVAL}};
+            }
+            const auto fd = is_write_end_open() ? fds_[write_end_index] : fds_[read_end_index];
+            const auto ret = fcntl(fd, F_SETPIPE_SZ, static_cast<int>(capacity));
+
+            if (unix::operation_failed(ret))
+            {
+                return std::unexpected{error_code{errno}};
+            }
+            assert(static_cast<std::size_t>(ret) >= capacity);
+            return static_cast<std::size_t>(ret);
+        }
+
+        // moves up to count bytes from a file descriptor into the pipe without
+        // copying them through the user space, returns the number of bytes moved
+        std::expected<std::size_t, error_code> splice_from(file_descriptor_t fd, loff_t *offset, std::size_t count,
+                                                           splice_flags_t flags = SPLICE_F_MOVE) const noexcept
+        {
+            assert(is_write_end_open());
+            return splice(fd, offset, fds_[write_end_index], nullptr, count, flags);
+        }
+
+        // moves up to count bytes from the pipe into a file descriptor without
+        // copying them through the user space, returns the number of bytes moved
+        std::expected<std::size_t, error_code> splice_to(file_descriptor_t fd, loff_t *offset, std::size_t count,
+                                                         splice_flags_t flags = SPLICE_F_MOVE) const noexcept
+        {
+            assert(is_read_end_open());
+            return splice(fds_[read_end_index], nullptr, fd, offset, count, flags);
+        }
+
+        // duplicates up to count bytes from this pipe into the other one
+        // without consuming them, returns the number of bytes duplicated
+        std::expected<std::size_t, error_code> tee(const pipe &other, std::size_t count,
+                                                   splice_flags_t flags = no_splice_flags) const noexcept
+        {
+            assert(is_read_end_open());
+            assert(other.is_write_end_open());
+
+            while (true)
+            {
+                const auto ret = ::tee(fds_[read_end_index], other.fds_[write_end_index], count, flags);
+
+                if (!unix::operation_failed(ret))
+                {
+                    return static_cast<std::size_t>(ret);
+                }
+                if (errno != EINTR)
+                {
+                    return std::unexpected{error_code{errno}};
+                }
+            }
+        }
+
+        // maps the user pages into the pipe instead of copying them,
+        // the memory must not be modified until the reader consumes it,
+        // with SPLICE_F_GIFT the pages are handed over to the kernel
+        std::expected<void, error_code> vmsplice(std::span<const io_vector_t> vectors,
+                                                 splice_flags_t flags = no_splice_flags) const noexcept
+        {
+            assert(is_write_end_open());
+            const auto fd = fds_[write_end_index];
+            const auto spliced = transfer_vectors(
+                vectors, [fd, flags](const io_vector_t *batch, int count)
+                { return ::vmsplice(fd, batch, static_cast<unsigned long>(count), flags); });
+
+            if (!spliced)
+            {
+                return std::unexpected{spliced.error()};
+            }
+            assert(spliced.value() == total_size(vectors));
+            return std::expected<void, error_code>{};
+        }
+
+        std::expected<void, error_code> vmsplice(const void *data, std::size_t count,
+                                                 splice_flags_t flags = no_splice_flags) const noexcept
+        {
+            const auto vector = make_io_vector(data, count);
+            return vmsplice(std::span<const io_vector_t>{&vector, 1}, flags);
+        }
+#endif
+
         std::expected<void, error_code> close_read_end() noexcept
         {
             return close_end(read_end_index);
@@ -123,7 +310,28 @@ namespace unix::ipc::posix
     private:
         file_descriptors_t fds_;
         uint8_t end_open_{0b11111111};
+
+#ifndef __APPLE__
+        static std::expected<std::size_t, error_code> splice(file_descriptor_t in_fd, loff_t *in_offset,
+                                                             file_descriptor_t out_fd, loff_t *out_offset,
+                                                             std::size_t count, splice_flags_t flags) noexcept
+        {
+            while (true)
+            {
+                const auto ret = ::splice(in_fd, in_offset, out_fd, out_offset, count, flags);
+
+                if (!unix::operation_failed(ret))
+                {
+                    return static_cast<std::size_t>(ret);
+                }
+                if (errno != EINTR)
+                {
+                    return std::unexpected{error_code{errno}};
+                }
+            }
+        }
+#endif
     };
 } // namespace unix::ipc::posix
 
-#endif // UNIX_IPC_POSIX_PIPE_HPP
\ No newline at end of file
+#endif // UNIX_IPC_POSIX_PIPE_HPP
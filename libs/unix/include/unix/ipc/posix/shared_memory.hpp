@@ -2,29 +2,153 @@
 #define UNIX_IPC_POSIX_SHARED_MEMORY_HPP
 
 #include <cassert>
+#include <cstddef>
+#include <errno.h>
 #include <expected>
+#include <fcntl.h>
 #include <string>
 #include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include "unix/error_code.hpp"
+#include "unix/ipc/posix/memory_mapping.hpp"
+#include "unix/ipc/posix/open_flags.hpp"
 #include "unix/ipc/posix/utility.hpp"
 #include "unix/ipc/posix/primitive.hpp"
+#include "unix/utility.hpp"
 
 
 namespace unix::ipc::posix
 {
-    class shared_memory : public ipc::primitive
+    class shared_memory : public primitive
     {
     public:
-        static std::expected<shared_memory, error_code> create(std::string name) noexcept
+        // find a way to make it private
+        explicit shared_memory(file_descriptor_t fd, std::string &&name) noexcept
+            : fd_{fd}, name_{std::move(name)} {}
+
+        static std::expected<shared_memory, error_code> create(std::string &&name, open_flags_t flags,
+                                                               mode_t mode) noexcept
         {
             assert(is_valid_pathname(name));
+            const auto fd = ::shm_open(name.data(), flags, mode);
+
+            if (operation_failed(fd))
+            {
+                return std::unexpected{error_code{errno}};
+            }
+            return std::expected<shared_memory, error_code>{std::in_place, fd, std::move(name)};
+        }
+
+        static std::expected<shared_memory, error_code> open_existing(std::string &&name) noexcept
+        {
+            return create(std::move(name), O_RDWR, mode_t{0});
+        }
+
+        static std::expected<shared_memory, error_code> create_if_absent(std::string &&name, mode_t mode) noexcept
+        {
+            return create(std::move(name), O_RDWR | O_CREAT, mode);
+        }
+
+        static std::expected<shared_memory, error_code> create_exclusively(std::string &&name, mode_t mode) noexcept
+        {
+            return create(std::move(name), O_RDWR | O_CREAT | O_EXCL, mode);
+        }
+
+        // a new segment is empty, it has to be resized before being mapped
+        std::expected<void, error_code> truncate(std::size_t size) const noexcept
+        {
+            const auto ret = ::ftruncate(fd_, static_cast<off_t>(size));
+
+            if (operation_failed(ret))
+            {
+                return std::unexpected{error_code{errno}};
+            }
+            return std::expected<void, error_code>{};
         }
 
-        std::expected<void, error_code> unlink() noexcept {
-            // shm_unlink
+        std::expected<std::size_t, error_code> size() const noexcept
+        {
+            struct stat info;
+            const auto ret = ::fstat(fd_, &info);
+
+            if (operation_failed(ret))
+            {
+                return std::unexpected{error_code{errno}};
+            }
+            return static_cast<std::size_t>(info.st_size);
+        }
+
+        // the mapping stays valid after the segment gets closed or unlinked
+        std::expected<memory_mapping, error_code> map(std::size_t size, protection_t protection,
+                                                      mapping_flags_t flags) const noexcept
+        {
+            return memory_mapping::create(fd_, size, protection, flags);
         }
+
+        std::expected<memory_mapping, error_code> map(std::size_t size) const noexcept
+        {
+            return map(size, read_write_protection, mapping_flags_builder{}.get());
+        }
+
+#ifndef __APPLE__
+        // maps the segment with all its pages pre-faulted, optionally backed by
+        // transparent huge pages, which requires shmem_enabled in
+        // /sys/kernel/mm/transparent_hugepage set to advise or always
+        std::expected<memory_mapping, error_code> map_populated(std::size_t size, bool huge_pages) const noexcept
+        {
+            if (!huge_pages)
+            {
+                return map(size, read_write_protection, mapping_flags_builder{}.populate().get());
+            }
+            auto mapped = map(size, read_write_protection, mapping_flags_builder{}.get());
+
+            if (!mapped)
+            {
+                return mapped;
+            }
+            // the advice has to precede the first touch, MAP_POPULATE would fault
+            // the pages in with the base page size already during the mmap
+            const auto advised = mapped.value().advise(memory_advice::huge_pages);
+
+            if (!advised)
+            {
+                return std::unexpected{advised.error()};
+            }
+            mapped.value().prefault();
+            return mapped;
+        }
+#endif
+
+        file_descriptor_t file_descriptor() const noexcept
+        {
+            return fd_;
+        }
+
+        // removes the name, the memory is released once the last mapping is gone
+        std::expected<void, error_code> unlink() const noexcept
+        {
+            const auto ret = ::shm_unlink(name_.data());
+
+            if (operation_successful(ret))
+            {
+                return std::expected<void, error_code>{};
+            }
+            assert(operation_failed(ret));
+            return std::unexpected{error_code{errno}};
+        }
+
+        ~shared_memory() noexcept
+        {
+            const auto ret = ::close(fd_);
+            assert(operation_successful(ret));
+        }
+
+    private:
+        file_descriptor_t fd_;
+        std::string name_;
     };
 }
 
-#endif // UNIX_IPC_POSIX_SHARED_MEMORY_HPP
\ No newline at end of file
+#endif // UNIX_IPC_POSIX_SHARED_MEMORY_HPP
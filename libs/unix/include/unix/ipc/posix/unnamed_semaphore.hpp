@@ -1,14 +1,18 @@
 #ifndef UNIX_IPC_POSIX_UNNAMED_SEMAPHORE_HPP
 #define UNIX_IPC_POSIX_UNNAMED_SEMAPHORE_HPP
 
+#include <cassert>
+#include <chrono>
 #include <cstdint>
 #include <errno.h>
 #include <expected>
+#include <new>
 
 #include "semaphore.h"
 
 #include "unix/error_code.hpp"
 #include "unix/ipc/posix/primitive.hpp"
+#include "unix/time.hpp"
 #include "unix/utility.hpp"
 
 
@@ -17,58 +21,91 @@ namespace unix::ipc::posix
     enum class shared_between : std::uint8_t
     {
         threads,
-        processes,
+        processes, // the semaphore has to be placed into memory shared by the processes
     };
 
+    using unnamed_semaphore_value_t = unsigned int;
+
+    // sem_t must not be copied, the semaphore is initialized in place by construct_at,
+    // which is the only way to get one, so a failed sem_init always gets reported,
+    // not available on OSX, where sem_init fails with ENOSYS
     class unnamed_semaphore : public primitive
     {
         using handle_type = sem_t;
 
     public:
-        // find a way to make it private
-        explicit unnamed_semaphore(const handle_type &handle) noexcept : handle_{handle} {}
-
-        static std::expected<unnamed_semaphore, error_code> create(shared_between shared, unsigned int init_value) noexcept
+        // it has to be destroyed by calling the destructor explicitly,
+        // by a single process once no other process uses it,
+        // on failure the destructor must not run
+        static std::expected<unnamed_semaphore *, error_code> construct_at(void *address,
+                                                                           shared_between shared,
+                                                                           unnamed_semaphore_value_t init_value) noexcept
         {
-            handle_type handle;
-            const auto ret = ::sem_init(&handle, static_cast<int>(shared), init_value);
+            assert(address);
+            assert(reinterpret_cast<std::uintptr_t>(address) % alignof(unnamed_semaphore) == 0);
+            auto *constructed = new (address) unnamed_semaphore{};
+            const auto ret = ::sem_init(&constructed->handle_, static_cast<int>(shared), init_value);
 
             if (unix::operation_successful(ret))
             {
-                return std::expected<unnamed_semaphore, error_code>{std::in_place, handle};
+                return constructed;
             }
             assert(unix::operation_failed(ret));
             return std::unexpected{error_code{errno}};
         }
 
+        // wait until the semaphore value > 0 and decrement it
         std::expected<void, error_code> wait() noexcept
         {
-            // wait until the semaphore value > 0 and decrement it
-            const auto ret = ::sem_wait(&handle_);
+            return to_expected(::sem_wait(&handle_));
+        }
 
-            if (unix::operation_successful(ret))
-            {
-                return std::expected<void, error_code>{};
-            }
-            assert(unix::operation_failed(ret));
-            return std::unexpected{error_code{errno}};
+        // fails with EAGAIN when the value is zero
+        std::expected<void, error_code> try_wait() noexcept
+        {
+            return to_expected(::sem_trywait(&handle_));
+        }
+
+        // fails with ETIMEDOUT, the timeout is measured by CLOCK_REALTIME
+        template <class Rep, class Period>
+        std::expected<void, error_code> wait_for(const std::chrono::duration<Rep, Period> &timeout) noexcept
+        {
+            const auto deadline = deadline_after(CLOCK_REALTIME, timeout);
+            return to_expected(::sem_timedwait(&handle_, &deadline));
         }
 
         std::expected<void, error_code> post() noexcept
         {
-            const auto ret = ::sem_post(&handle_);
+            return to_expected(::sem_post(&handle_));
+        }
+
+        // the value might change before the caller gets to use it
+        std::expected<int, error_code> get_value() noexcept
+        {
+            int value;
+            const auto ret = ::sem_getvalue(&handle_, &value);
 
             if (unix::operation_successful(ret))
             {
-                return std::expected<void, error_code>{};
+                return value;
             }
             assert(unix::operation_failed(ret));
             return std::unexpected{error_code{errno}};
         }
 
-        std::expected<void, error_code> destroy() noexcept {
+        ~unnamed_semaphore() noexcept
+        {
             const auto ret = ::sem_destroy(&handle_);
+            assert(unix::operation_successful(ret));
+        }
 
+    private:
+        handle_type handle_;
+
+        explicit unnamed_semaphore() noexcept = default;
+
+        static std::expected<void, error_code> to_expected(int ret) noexcept
+        {
             if (unix::operation_successful(ret))
             {
                 return std::expected<void, error_code>{};
@@ -76,10 +113,7 @@ namespace unix::ipc::posix
             assert(unix::operation_failed(ret));
             return std::unexpected{error_code{errno}};
         }
-
-    private:
-        handle_type handle_;
     };
 }
 
-#endif // UNIX_IPC_POSIX_UNNAMED_SEMAPHORE_HPP
\ No newline at end of file
+#endif // UNIX_IPC_POSIX_UNNAMED_SEMAPHORE_HPP
@@ -2,6 +2,7 @@
 #define UNIX_IPC_SYSTEM_V_GROUP_NOTIFIER_HPP
 
 #include <cassert>
+#include <chrono>
 #include <expected>
 
 #include "unix/error_code.hpp"
@@ -15,44 +16,77 @@ namespace unix::ipc::system_v
     public:
         explicit group_notifier(const semaphore_set &semaphores,
                                 semaphore_index_t semaphore_index,
-                                semaphore_value_t group_size) noexcept
+                                semaphore_value_t group_size,
+                                undo_policy policy = undo_policy::keep_changes) noexcept
             : semaphores_{semaphores}, index_{semaphore_index},
-              group_size_{group_size}
+              group_size_{group_size}, policy_{policy}
         {
             assert(group_size > 0);
             assert(semaphore_index < semaphores.count());
         }
 
+        // the same semaphore, e.g. undoing only the operations of the processes
+        // that own a share of it, while the others keep their changes
+        group_notifier with_undo_policy(undo_policy policy) const noexcept
+        {
+            return group_notifier{semaphores_, index_, group_size_, policy};
+        }
+
         std::expected<void, error_code> wait_for_one() const noexcept
         {
-            return semaphores_.decrease_value(index_, -1);
+            return semaphores_.decrease_value(index_, -1, policy_);
+        }
+
+        // the timed waits fail with EAGAIN once the timeout passes
+        template <class Rep, class Period>
+        std::expected<void, error_code> wait_for_one_for(const std::chrono::duration<Rep, Period> &timeout) const noexcept
+        {
+            return semaphores_.change_value_for(index_, -1, timeout, policy_);
+        }
+
+        template <class Clock, class Duration>
+        std::expected<void, error_code> wait_for_one_until(const std::chrono::time_point<Clock, Duration> &deadline) const noexcept
+        {
+            return wait_for_one_for(time_till(deadline));
         }
 
         std::expected<void, error_code> wait_for(semaphore_value_t count) const noexcept
         {
             assert(count > 0);
-            return semaphores_.decrease_value(index_, -count);
+            return semaphores_.decrease_value(index_, -count, policy_);
         }
 
         std::expected<void, error_code> wait_for_all() const noexcept
         {
-            return semaphores_.decrease_value(index_, -group_size_);
+            return semaphores_.decrease_value(index_, -group_size_, policy_);
+        }
+
+        template <class Rep, class Period>
+        std::expected<void, error_code> wait_for_all_for(const std::chrono::duration<Rep, Period> &timeout) const noexcept
+        {
+            return semaphores_.change_value_for(index_, -group_size_, timeout, policy_);
+        }
+
+        template <class Clock, class Duration>
+        std::expected<void, error_code> wait_for_all_until(const std::chrono::time_point<Clock, Duration> &deadline) const noexcept
+        {
+            return wait_for_all_for(time_till(deadline));
         }
 
         std::expected<void, error_code> notify_one() const noexcept
         {
-            return semaphores_.increase_value(index_, 1);
+            return semaphores_.increase_value(index_, 1, policy_);
         }
 
         std::expected<void, error_code> notify(semaphore_value_t count) const noexcept
         {
             assert(count > 0);
-            return semaphores_.increase_value(index_, count);
+            return semaphores_.increase_value(index_, count, policy_);
         }
 
         std::expected<void, error_code> notify_all() const noexcept
         {
-            return semaphores_.increase_value(index_, group_size_);
+            return semaphores_.increase_value(index_, group_size_, policy_);
         }
 
         std::expected<void, error_code> wait_till_none() const noexcept
@@ -60,15 +94,76 @@ namespace unix::ipc::system_v
             return semaphores_.change_value(index_, 0);
         }
 
+        template <class Rep, class Period>
+        std::expected<void, error_code> wait_till_none_for(const std::chrono::duration<Rep, Period> &timeout) const noexcept
+        {
+            return semaphores_.change_value_for(index_, 0, timeout);
+        }
+
+        template <class Clock, class Duration>
+        std::expected<void, error_code> wait_till_none_until(const std::chrono::time_point<Clock, Duration> &deadline) const noexcept
+        {
+            return wait_till_none_for(time_till(deadline));
+        }
+
+        // blocks till the value reaches at least count, without decreasing it
+        std::expected<void, error_code> wait_till_at_least(semaphore_value_t count) const noexcept
+        {
+            assert(count > 0);
+            auto transaction = semaphore_transaction<2>{}.decrease(index_, -count).increase(index_, count);
+            return semaphores_.execute(transaction);
+        }
+
+        template <class Rep, class Period>
+        std::expected<void, error_code> wait_till_at_least_for(semaphore_value_t count,
+                                                               const std::chrono::duration<Rep, Period> &timeout) const noexcept
+        {
+            assert(count > 0);
+            auto transaction = semaphore_transaction<2>{}.decrease(index_, -count).increase(index_, count);
+            return semaphores_.execute_for(transaction, timeout);
+        }
+
         std::expected<void, error_code> try_waiting_for_one() const noexcept
         {
-            return semaphores_.try_decreasing_value(index_, -1);
+            return semaphores_.try_decreasing_value(index_, -1, policy_);
+        }
+
+        // one semop instead of two, the notification takes effect only
+        // together with the wait, so it gets delayed while the wait blocks,
+        // both notifiers have to share the same semaphore set
+        std::expected<void, error_code> notify_one_and_wait_for_one(const group_notifier &waited) const noexcept
+        {
+            assert(semaphores_ == waited.semaphores_);
+            auto transaction = make_transaction().increase(index_, 1).decrease(waited.index_, -1);
+            return semaphores_.execute(transaction);
+        }
+
+        // on timeout neither the notification nor the wait takes effect
+        template <class Rep, class Period>
+        std::expected<void, error_code> notify_one_and_wait_for_one_for(const group_notifier &waited,
+                                                                        const std::chrono::duration<Rep, Period> &timeout) const noexcept
+        {
+            assert(semaphores_ == waited.semaphores_);
+            auto transaction = make_transaction().increase(index_, 1).decrease(waited.index_, -1);
+            return semaphores_.execute_for(transaction, timeout);
         }
 
     private:
         semaphore_set semaphores_;
         semaphore_index_t index_;
         semaphore_value_t group_size_;
+        undo_policy policy_;
+
+        semaphore_transaction<2> make_transaction() const noexcept
+        {
+            semaphore_transaction<2> transaction;
+
+            if (policy_ == undo_policy::undo_on_exit)
+            {
+                transaction.undo_on_exit();
+            }
+            return transaction;
+        }
     };
 } // namespace unix::ipc::system_v
 
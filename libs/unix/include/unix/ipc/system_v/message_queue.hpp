@@ -1,17 +1,304 @@
 #ifndef UNIX_IPC_SYSTEM_V_MESSAGE_QUEUE_HPP
 #define UNIX_IPC_SYSTEM_V_MESSAGE_QUEUE_HPP
 
+#include <algorithm>
+#include <array>
 #include <cassert>
+#include <cstddef>
+#include <errno.h>
 #include <expected>
+#include <span>
 #include <sys/msg.h>
 
+#include "unix/error_code.hpp"
+#include "unix/ipc/system_v/key.hpp"
 #include "unix/ipc/system_v/primitive.hpp"
+#include "unix/utility.hpp"
 
 
 namespace unix::ipc::system_v
 {
-    class message_queue : public ipc::primitive {
+    // positive types select logical channels within a single queue
+    using message_type_t = long;
+
+    // receiving by type:
+    // zero takes the oldest message of any type,
+    // a positive type takes the oldest message of exactly that type,
+    // a negative type takes the oldest message with the lowest type <= |type|
+    constexpr message_type_t any_message_type{0};
+
+    // layout expected by msgsnd and msgrcv
+    template <std::size_t Capacity>
+    struct message
+    {
+        message_type_t type{1};
+        std::array<char, Capacity> text;
+    };
+
+    class message_queue : public primitive
+    {
+        using handle_type = int;
+
+    public:
+        explicit message_queue(handle_type handle) noexcept
+            : handle_{handle} {}
+
+        static std::expected<message_queue, error_code> create(system_v::key_t key, int flags) noexcept
+        {
+            const handle_type handle = msgget(key, flags);
+
+            if (operation_failed(handle))
+            {
+                return std::unexpected{error_code{errno}};
+            }
+            return std::expected<message_queue, error_code>{std::in_place, handle};
+        }
+
+        static std::expected<message_queue, error_code> open_existing(system_v::key_t key) noexcept
+        {
+            assert(key > system_v::key_t{0});
+            return create(key, int{0});
+        }
+
+        static std::expected<message_queue, error_code> create_if_absent(system_v::key_t key, int permissions) noexcept
+        {
+            assert(key > system_v::key_t{0});
+            return create(key, IPC_CREAT | permissions);
+        }
+
+        static std::expected<message_queue, error_code> create_exclusively(system_v::key_t key, int permissions) noexcept
+        {
+            assert(key > system_v::key_t{0});
+            return create(key, IPC_CREAT | IPC_EXCL | permissions);
+        }
+
+        static std::expected<message_queue, error_code> create_private(int permissions) noexcept
+        {
+            return create(get_private_key(), permissions);
+        }
+
+        // blocks while the queue has not enough free bytes
+        template <std::size_t Capacity>
+        std::expected<void, error_code> send(const message<Capacity> &msg, std::size_t size) const noexcept
+        {
+            return send(msg, size, int{0});
+        }
+
+        // fails with EAGAIN when the queue is full
+        template <std::size_t Capacity>
+        std::expected<void, error_code> try_send(const message<Capacity> &msg, std::size_t size) const noexcept
+        {
+            return send(msg, size, IPC_NOWAIT);
+        }
+
+        // blocks till a message of the requested type arrives,
+        // returns the size of the received text
+        template <std::size_t Capacity>
+        std::expected<std::size_t, error_code> receive(message<Capacity> &msg,
+                                                       message_type_t type = any_message_type) const noexcept
+        {
+            return receive(msg, type, int{0});
+        }
+
+        // fails with ENOMSG when there is no message of the requested type
+        template <std::size_t Capacity>
+        std::expected<std::size_t, error_code> try_receive(message<Capacity> &msg,
+                                                           message_type_t type = any_message_type) const noexcept
+        {
+            return receive(msg, type, IPC_NOWAIT);
+        }
+
+        // waits for the first message of the requested type, then drains
+        // the already queued ones without blocking until all the slots get filled,
+        // returns the number of messages received
+        template <std::size_t Capacity, std::size_t Extent>
+        std::expected<std::size_t, error_code> receive_batch(std::span<message<Capacity>, Extent> messages,
+                                                             std::span<std::size_t> sizes,
+                                                             message_type_t type = any_message_type) const noexcept
+        {
+            const auto slot_count = std::min(messages.size(), sizes.size());
+            assert(slot_count > 0);
+            const auto first = receive(messages[0], type);
+
+            if (!first)
+            {
+                return std::unexpected{first.error()};
+            }
+            sizes[0] = first.value();
+            std::size_t count{1};
+
+            for (; count < slot_count; ++count)
+            {
+                const auto next = try_receive(messages[count], type);
+
+                if (!next)
+                {
+                    if (next.error().code == ENOMSG)
+                    {
+                        break;
+                    }
+                    return std::unexpected{next.error()};
+                }
+                sizes[count] = next.value();
+            }
+            return count;
+        }
+
+        std::expected<msqid_ds, error_code> get_info() const noexcept
+        {
+            msqid_ds info;
+            const auto ret = msgctl(handle_, IPC_STAT, &info);
+
+            if (operation_failed(ret))
+            {
+                return std::unexpected{error_code{errno}};
+            }
+            return info;
+        }
+
+        std::expected<std::size_t, error_code> message_count() const noexcept
+        {
+            const auto info = get_info();
+
+            if (!info)
+            {
+                return std::unexpected{info.error()};
+            }
+            return static_cast<std::size_t>(info.value().msg_qnum);
+        }
+
+        // maximum number of bytes the queue can hold, /proc/sys/kernel/msgmnb by default
+        std::expected<std::size_t, error_code> capacity() const noexcept
+        {
+            const auto info = get_info();
+
+            if (!info)
+            {
+                return std::unexpected{info.error()};
+            }
+            return static_cast<std::size_t>(info.value().msg_qbytes);
+        }
+
+        // raising the capacity above msgmnb requires CAP_SYS_RESOURCE
+        std::expected<void, error_code> set_capacity(std::size_t bytes) const noexcept
+        {
+            auto info = get_info();
+
+            if (!info)
+            {
+                return std::unexpected{info.error()};
+            }
+            info.value().msg_qbytes = static_cast<msglen_t>(bytes);
+            const auto ret = msgctl(handle_, IPC_SET, &info.value());
+
+            if (operation_failed(ret))
+            {
+                return std::unexpected{error_code{errno}};
+            }
+            return std::expected<void, error_code>{};
+        }
+
+        std::expected<void, error_code> remove() const noexcept
+        {
+            const auto ret = msgctl(handle_, IPC_RMID, nullptr);
+
+            if (operation_failed(ret))
+            {
+                return std::unexpected{error_code{errno}};
+            }
+            return std::expected<void, error_code>{};
+        }
+
+    private:
+        handle_type handle_;
+
+        template <std::size_t Capacity>
+        std::expected<void, error_code> send(const message<Capacity> &msg, std::size_t size, int flags) const noexcept
+        {
+            assert(msg.type > any_message_type);
+            assert(size <= Capacity);
+
+            while (true)
+            {
+                const auto ret = msgsnd(handle_, &msg, size, flags);
+
+                if (!operation_failed(ret))
+                {
+                    return std::expected<void, error_code>{};
+                }
+                if (errno != EINTR)
+                {
+                    return std::unexpected{error_code{errno}};
+                }
+            }
+        }
+
+        template <std::size_t Capacity>
+        std::expected<std::size_t, error_code> receive(message<Capacity> &msg, message_type_t type,
+                                                       int flags) const noexcept
+        {
+            while (true)
+            {
+                const auto ret = msgrcv(handle_, &msg, Capacity, type, flags);
+
+                if (!operation_failed(ret))
+                {
+                    return static_cast<std::size_t>(ret);
+                }
+                if (errno != EINTR)
+                {
+                    return std::unexpected{error_code{errno}};
+                }
+            }
+        }
+    };
+
+    // logical channel multiplexed over a shared queue by its message type,
+    // e.g. one channel per consumer
+    template <std::size_t Capacity>
+    class message_channel
+    {
+    public:
+        explicit message_channel(const message_queue &queue, message_type_t type) noexcept
+            : queue_{queue}, type_{type}
+        {
+            assert(type > any_message_type);
+        }
+
+        std::expected<void, error_code> send(std::span<const char> text) const noexcept
+        {
+            assert(text.size() <= Capacity);
+            message<Capacity> msg;
+            msg.type = type_;
+            std::copy_n(text.data(), text.size(), msg.text.data());
+            return queue_.send(msg, text.size());
+        }
+
+        // returns the size of the copied text, the texts longer
+        // than the given span get truncated the way MSG_NOERROR does
+        std::expected<std::size_t, error_code> receive(std::span<char> text) const noexcept
+        {
+            message<Capacity> msg;
+            const auto received = queue_.receive(msg, type_);
+
+            if (!received)
+            {
+                return std::unexpected{received.error()};
+            }
+            const auto size = std::min(received.value(), text.size());
+            std::copy_n(msg.text.data(), size, text.data());
+            return size;
+        }
+
+        message_type_t type() const noexcept
+        {
+            return type_;
+        }
+
+    private:
+        message_queue queue_;
+        message_type_t type_;
     };
 }
 
-#endif // UNIX_IPC_SYSTEM_V_MESSAGE_QUEUE_HPP
\ No newline at end of file
+#endif // UNIX_IPC_SYSTEM_V_MESSAGE_QUEUE_HPP
@@ -1,11 +1,16 @@
 #ifndef UNIX_IPC_SYSTEM_V_SEMAPHORE_HPP
 #define UNIX_IPC_SYSTEM_V_SEMAPHORE_HPP
 
+#include <algorithm>
 #include <array>
 #include <cassert>
+#include <chrono>
+#include <errno.h>
 #include <expected>
 #include <sys/sem.h>
 #include <span>
+#include <thread>
+#include <time.h>
 
 #include "unix/ipc/system_v/primitive.hpp"
 #include "unix/ipc/system_v/key.hpp"
@@ -17,6 +22,106 @@ namespace unix::ipc::system_v
     using semaphore_value_t = int;
     using semaphore_index_t = semaphore_value_t;
 
+    // semtimedop takes a relative timeout, negative durations are treated as expired
+    template <class Rep, class Period>
+    timespec to_timespec(const std::chrono::duration<Rep, Period> &timeout) noexcept
+    {
+        const auto nanoseconds = std::max(std::chrono::duration_cast<std::chrono::nanoseconds>(timeout),
+                                          std::chrono::nanoseconds::zero());
+        const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(nanoseconds);
+        return timespec{static_cast<time_t>(seconds.count()),
+                        static_cast<long>((nanoseconds - seconds).count())};
+    }
+
+    template <class Clock, class Duration>
+    typename Clock::duration time_till(const std::chrono::time_point<Clock, Duration> &deadline) noexcept
+    {
+        return deadline - Clock::now();
+    }
+
+    // with undo_on_exit the kernel reverts the operations of a process once it
+    // terminates, even when it crashes, meant for ownership-style operations
+    // e.g. taking a token and giving it back, where the take should not outlive
+    // the taker, a process that only notifies or only waits should keep its changes
+    enum class undo_policy
+    {
+        keep_changes,
+        undo_on_exit // SEM_UNDO
+    };
+
+    constexpr short to_operation_flags(undo_policy policy) noexcept
+    {
+        return policy == undo_policy::undo_on_exit ? SEM_UNDO : 0;
+    }
+
+    // composes operations on semaphores of a single set, which are then
+    // applied atomically by one semop, either all of them or none
+    template <std::size_t Capacity>
+    class semaphore_transaction
+    {
+    public:
+        constexpr semaphore_transaction &change(semaphore_index_t sem_index, semaphore_value_t change) noexcept
+        {
+            assert(sem_index >= 0);
+            assert(size_ < Capacity);
+            auto &op = ops_[size_++];
+            op.sem_num = static_cast<unsigned short>(sem_index);
+            op.sem_op = static_cast<short>(change);
+            op.sem_flg = flags_;
+            return *this;
+        }
+
+        constexpr semaphore_transaction &increase(semaphore_index_t sem_index, semaphore_value_t increment) noexcept
+        {
+            assert(increment > 0);
+            return change(sem_index, increment);
+        }
+
+        constexpr semaphore_transaction &decrease(semaphore_index_t sem_index, semaphore_value_t decrement) noexcept
+        {
+            assert(decrement < 0);
+            return change(sem_index, decrement);
+        }
+
+        constexpr semaphore_transaction &wait_till_zero(semaphore_index_t sem_index) noexcept
+        {
+            return change(sem_index, 0);
+        }
+
+        // the whole transaction fails with EAGAIN instead of blocking
+        constexpr semaphore_transaction &no_wait() noexcept
+        {
+            return add_flags(IPC_NOWAIT);
+        }
+
+        constexpr semaphore_transaction &undo_on_exit() noexcept
+        {
+            return add_flags(SEM_UNDO);
+        }
+
+        constexpr std::span<sembuf> operations() noexcept
+        {
+            return std::span{ops_.data(), size_};
+        }
+
+    private:
+        std::array<sembuf, Capacity> ops_{};
+        std::size_t size_{0};
+        short flags_{0};
+
+        // applies to the operations added before and after
+        constexpr semaphore_transaction &add_flags(short flags) noexcept
+        {
+            flags_ |= flags;
+
+            for (std::size_t i{0}; i < size_; ++i)
+            {
+                ops_[i].sem_flg |= flags;
+            }
+            return *this;
+        }
+    };
+
     class semaphore_set : public primitive
     {
         using handle_type = int;
@@ -133,12 +238,12 @@ namespace unix::ipc::system_v
         std::expected<void, error_code> get_value(semaphore_index_t sem_index, semaphore_value_t &current_value) const noexcept
         {
             assert(sem_index >= int{0});
-            union semun arg;
-            const auto ret = semctl(handle_, sem_index, GETVAL, arg);
+            // the value is returned by semctl itself
+            const auto ret = semctl(handle_, sem_index, GETVAL);
 
             if (!operation_failed(ret))
             {
-                current_value = arg.val;
+                current_value = ret;
                 return std::expected<void, error_code>{};
             }
             return std::unexpected{error_code{errno}};
@@ -168,6 +273,12 @@ namespace unix::ipc::system_v
             return count_;
         }
 
+        // same underlying kernel object
+        bool operator==(const semaphore_set &other) const noexcept
+        {
+            return handle_ == other.handle_;
+        }
+
         std::expected<void, error_code> change_values(const std::span<sembuf> &ops) const noexcept
         {
             assert(ops.size() > 0);
@@ -181,28 +292,66 @@ namespace unix::ipc::system_v
             return std::expected<void, error_code>{};
         }
 
-#ifndef __APPLE__
+        template <std::size_t Capacity>
+        std::expected<void, error_code> execute(semaphore_transaction<Capacity> &transaction) const noexcept
+        {
+            return change_values(transaction.operations());
+        }
+
+        // fails with EAGAIN when the operations could not be applied before the timeout
         std::expected<void, error_code> change_values(const std::span<sembuf> &ops, const timespec &timeout) const noexcept
         {
             assert(ops.size() > 0);
-
-            const auto ret = ::semtimedop(handle_, ops.data(), ops.size(), timeout);
+#ifndef __APPLE__
+            const auto ret = ::semtimedop(handle_, ops.data(), ops.size(), &timeout);
 
             if (operation_failed(ret))
             {
                 return std::unexpected{error_code{errno}};
             }
             return std::expected<void, error_code>{};
-        }
+#else
+            // semtimedop is not available on OSX, the operations are retried without blocking instead
+            constexpr std::chrono::milliseconds retry_interval{1};
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{timeout.tv_sec} +
+                                  std::chrono::nanoseconds{timeout.tv_nsec};
+
+            for (auto &op : ops)
+            {
+                op.sem_flg |= IPC_NOWAIT;
+            }
+            while (true)
+            {
+                const auto ret = ::semop(handle_, ops.data(), ops.size());
+
+                if (!operation_failed(ret))
+                {
+                    return std::expected<void, error_code>{};
+                }
+                if (errno != EAGAIN || std::chrono::steady_clock::now() >= deadline)
+                {
+                    return std::unexpected{error_code{errno}};
+                }
+                std::this_thread::sleep_for(retry_interval);
+            }
 #endif
+        }
 
-        std::expected<void, error_code> change_value(semaphore_index_t sem_index, semaphore_value_t change) const noexcept
+        template <std::size_t Capacity, class Rep, class Period>
+        std::expected<void, error_code> execute_for(semaphore_transaction<Capacity> &transaction,
+                                                    const std::chrono::duration<Rep, Period> &timeout) const noexcept
+        {
+            return change_values(transaction.operations(), to_timespec(timeout));
+        }
+
+        std::expected<void, error_code> change_value(semaphore_index_t sem_index, semaphore_value_t change,
+                                                     undo_policy policy = undo_policy::keep_changes) const noexcept
         {
             assert(sem_index >= 0 && sem_index < count_);
             sembuf args;
             args.sem_num = sem_index;
             args.sem_op = change;
-            args.sem_flg = 0;
+            args.sem_flg = to_operation_flags(policy);
 
             const auto ret = semop(handle_, &args, 1);
 
@@ -213,27 +362,43 @@ namespace unix::ipc::system_v
             return std::expected<void, error_code>{};
         }
 
-        std::expected<void, error_code> increase_value(semaphore_index_t sem_index, semaphore_value_t increment) const noexcept
+        template <class Rep, class Period>
+        std::expected<void, error_code> change_value_for(semaphore_index_t sem_index, semaphore_value_t change,
+                                                         const std::chrono::duration<Rep, Period> &timeout,
+                                                         undo_policy policy = undo_policy::keep_changes) const noexcept
+        {
+            assert(sem_index >= 0 && sem_index < count_);
+            sembuf args;
+            args.sem_num = sem_index;
+            args.sem_op = change;
+            args.sem_flg = to_operation_flags(policy);
+            return change_values(std::span{&args, 1}, to_timespec(timeout));
+        }
+
+        std::expected<void, error_code> increase_value(semaphore_index_t sem_index, semaphore_value_t increment,
+                                                       undo_policy policy = undo_policy::keep_changes) const noexcept
         {
             assert(sem_index >= 0 && sem_index < count_);
             assert(increment > 0);
-            return change_value(sem_index, increment);
+            return change_value(sem_index, increment, policy);
         }
 
-        std::expected<void, error_code> decrease_value(semaphore_index_t sem_index, semaphore_value_t decrement) const noexcept
+        std::expected<void, error_code> decrease_value(semaphore_index_t sem_index, semaphore_value_t decrement,
+                                                       undo_policy policy = undo_policy::keep_changes) const noexcept
         {
             assert(sem_index >= 0 && sem_index < count_);
             assert(decrement < 0);
-            return change_value(sem_index, decrement);
+            return change_value(sem_index, decrement, policy);
         }
 
-        std::expected<void, error_code> try_changing_value(semaphore_index_t sem_index, semaphore_value_t change) const noexcept
+        std::expected<void, error_code> try_changing_value(semaphore_index_t sem_index, semaphore_value_t change,
+                                                           undo_policy policy = undo_policy::keep_changes) const noexcept
         {
             assert(sem_index >= 0 && sem_index < count_);
             sembuf args;
             args.sem_num = sem_index;
             args.sem_op = change;
-            args.sem_flg = IPC_NOWAIT;
+            args.sem_flg = IPC_NOWAIT | to_operation_flags(policy);
 
             const auto ret = semop(handle_, &args, 1);
 
@@ -244,18 +409,20 @@ namespace unix::ipc::system_v
             return std::expected<void, error_code>{};
         }
 
-        std::expected<void, error_code> try_increasing_value(semaphore_index_t sem_index, semaphore_value_t increment) const noexcept
+        std::expected<void, error_code> try_increasing_value(semaphore_index_t sem_index, semaphore_value_t increment,
+                                                             undo_policy policy = undo_policy::keep_changes) const noexcept
         {
             assert(sem_index >= 0 && sem_index < count_);
             assert(increment > 0);
-            return try_changing_value(sem_index, increment);
+            return try_changing_value(sem_index, increment, policy);
         }
 
-        std::expected<void, error_code> try_decreasing_value(semaphore_index_t sem_index, semaphore_value_t decrement) const noexcept
+        std::expected<void, error_code> try_decreasing_value(semaphore_index_t sem_index, semaphore_value_t decrement,
+                                                             undo_policy policy = undo_policy::keep_changes) const noexcept
         {
             assert(sem_index >= 0 && sem_index < count_);
             assert(decrement < 0);
-            return try_changing_value(sem_index, decrement);
+            return try_changing_value(sem_index, decrement, policy);
         }
 
         std::expected<void, error_code> remove() const noexcept
@@ -2,6 +2,8 @@
 #define UNIX_IPC_SYSTEM_V_SHARED_MEMORY_HPP
 
 #include <cassert>
+#include <cstddef>
+#include <errno.h>
 #include <expected>
 #include <sys/shm.h>
 #include <memory>
@@ -80,6 +82,19 @@ namespace unix::ipc::system_v
             return attach(nullptr, flags);
         }
 
+        // the size requested at creation, e.g. to bind the attached memory to nodes
+        std::expected<std::size_t, error_code> size() const noexcept
+        {
+            shmid_ds info;
+            const auto ret = shmctl(handle_, IPC_STAT, &info);
+
+            if (operation_failed(ret))
+            {
+                return std::unexpected{error_code{errno}};
+            }
+            return static_cast<std::size_t>(info.shm_segsz);
+        }
+
         std::expected<void, error_code> remove() const noexcept
         {
             const auto ret = shmctl(handle_, IPC_RMID, nullptr);
@@ -0,0 +1,238 @@
+#ifndef UNIX_NUMA_HPP
+#define UNIX_NUMA_HPP
+
+#ifdef __linux__ // OSX does not expose the memory topology
+
+#include <array>
+#include <cassert>
+#include <climits>
+#include <cstddef>
+#include <errno.h>
+#include <expected>
+#include <fcntl.h>
+#include <linux/mempolicy.h>
+#include <string>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "unix/affinity.hpp"
+#include "unix/error_code.hpp"
+#include "unix/fs/posix/file.hpp"
+#include "unix/utility.hpp"
+
+// the system calls are used directly, so libnuma is not required
+namespace unix::numa
+{
+    using node_t = int;
+
+    constexpr std::size_t max_node_count{1'024};
+
+    // the kernel reads the mask as an array of unsigned longs
+    class node_mask
+    {
+        static constexpr std::size_t bits_per_word{sizeof(unsigned long) * CHAR_BIT};
+
+    public:
+        constexpr node_mask &add(node_t node) noexcept
+        {
+            assert(node >= 0 && static_cast<std::size_t>(node) < max_node_count);
+            const auto index = static_cast<std::size_t>(node);
+            words_[index / bits_per_word] |= 1UL << (index % bits_per_word);
+            return *this;
+        }
+
+        constexpr bool contains(node_t node) const noexcept
+        {
+            const auto index = static_cast<std::size_t>(node);
+            return node >= 0 && index < max_node_count &&
+                   (words_[index / bits_per_word] & (1UL << (index % bits_per_word))) != 0;
+        }
+
+        constexpr bool empty() const noexcept
+        {
+            for (const auto word : words_)
+            {
+                if (word != 0)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        const unsigned long *data() const noexcept
+        {
+            return words_.data();
+        }
+
+        static constexpr unsigned long max_node() noexcept
+        {
+            return max_node_count;
+        }
+
+    private:
+        std::array<unsigned long, max_node_count / bits_per_word> words_{};
+    };
+
+    enum class memory_policy
+    {
+        default_policy, // MPOL_DEFAULT, the policy of the thread, by default the node touching first
+        preferred,      // MPOL_PREFERRED, the first node of the mask, falling back to the others
+        bind,           // MPOL_BIND, only the nodes of the mask, fails when they are exhausted
+        interleave,     // MPOL_INTERLEAVE, pages spread round robin over the mask
+        local           // MPOL_LOCAL, the node of the cpu allocating
+    };
+
+    constexpr int to_policy_mode(memory_policy policy) noexcept
+    {
+        constexpr std::array<int, 5> modes{MPOL_DEFAULT, MPOL_PREFERRED, MPOL_BIND, MPOL_INTERLEAVE, MPOL_LOCAL};
+        return modes[static_cast<std::size_t>(policy)];
+    }
+
+    enum class page_migration
+    {
+        leave_placed, // applies only to pages touched afterwards
+        move_placed   // MPOL_MF_MOVE, migrates the pages already placed elsewhere
+    };
+
+    // the range has to be page aligned, e.g. a whole mapping or an attached segment,
+    // for shared memory the policy belongs to the segment, so setting it once
+    // before any process touches the pages is enough
+    std::expected<void, error_code> bind_memory(void *address, std::size_t size, memory_policy policy,
+                                                const node_mask &nodes,
+                                                page_migration migration = page_migration::leave_placed) noexcept
+    {
+        const auto flags = migration == page_migration::move_placed ? MPOL_MF_MOVE : 0;
+        const auto has_nodes = policy != memory_policy::default_policy && policy != memory_policy::local;
+        const auto ret = syscall(SYS_mbind, address, size, to_policy_mode(policy),
+                                 has_nodes ? nodes.data() : nullptr, has_nodes ? node_mask::max_node() : 0UL,
+                                 static_cast<unsigned>(flags));
+
+        if (operation_failed(static_cast<int>(ret)))
+        {
+            return std::unexpected{error_code{errno}};
+        }
+        return std::expected<void, error_code>{};
+    }
+
+    // applies to the later allocations of the calling thread,
+    // inherited by the threads and processes it creates afterwards
+    std::expected<void, error_code> set_thread_memory_policy(memory_policy policy, const node_mask &nodes) noexcept
+    {
+        const auto has_nodes = policy != memory_policy::default_policy && policy != memory_policy::local;
+        const auto ret = syscall(SYS_set_mempolicy, to_policy_mode(policy), has_nodes ? nodes.data() : nullptr,
+                                 has_nodes ? node_mask::max_node() : 0UL);
+
+        if (operation_failed(static_cast<int>(ret)))
+        {
+            return std::unexpected{error_code{errno}};
+        }
+        return std::expected<void, error_code>{};
+    }
+
+    // the node of the cpu the calling thread runs on
+    std::expected<node_t, error_code> current_node() noexcept
+    {
+        unsigned cpu{0}, node{0};
+        const auto ret = syscall(SYS_getcpu, &cpu, &node, nullptr);
+
+        if (operation_failed(static_cast<int>(ret)))
+        {
+            return std::unexpected{error_code{errno}};
+        }
+        return static_cast<node_t>(node);
+    }
+
+    // the node holding the page of the address, the page has to be touched already,
+    // fails with ENOENT otherwise
+    std::expected<node_t, error_code> node_of(const void *address) noexcept
+    {
+        const void *pages[1]{address};
+        int status[1]{-1};
+        const auto ret = syscall(SYS_move_pages, 0, 1UL, pages, nullptr, status, 0);
+
+        if (operation_failed(static_cast<int>(ret)))
+        {
+            return std::unexpected{error_code{errno}};
+        }
+        if (status[0] < 0)
+        {
+            return std::unexpected{error_code{-status[0]}};
+        }
+        return static_cast<node_t>(status[0]);
+    }
+
+    namespace detail
+    {
+        inline std::expected<std::string, error_code> read_sysfs(const std::string &path) noexcept
+        {
+            const auto opened = fs::posix::file::open(path, O_RDONLY);
+
+            if (!opened)
+            {
+                return std::unexpected{opened.error()};
+            }
+            std::string content(256, '\0');
+            const auto bytes_read = opened.value().read(content.data(), content.size());
+
+            if (!bytes_read)
+            {
+                return std::unexpected{bytes_read.error()};
+            }
+            content.resize(bytes_read.value());
+            return content;
+        }
+    } // namespace detail
+
+    std::expected<node_mask, error_code> online_nodes() noexcept
+    {
+        const auto list = detail::read_sysfs("/sys/devices/system/node/online");
+
+        if (!list)
+        {
+            return std::unexpected{list.error()};
+        }
+        node_mask nodes;
+        const auto parsed = cpu_set::for_each_in_list(list.value(), [&nodes](node_t node) { nodes.add(node); },
+                                                      static_cast<int>(max_node_count) - 1);
+
+        if (!parsed)
+        {
+            return std::unexpected{parsed.error()};
+        }
+        return nodes;
+    }
+
+    std::expected<cpu_set, error_code> cpus_of(node_t node) noexcept
+    {
+        const auto list = detail::read_sysfs("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+
+        if (!list)
+        {
+            return std::unexpected{list.error()};
+        }
+        return cpu_set::parse(list.value());
+    }
+
+    // pins the calling thread to the cpus of the node and prefers its memory
+    std::expected<void, error_code> run_on_node(node_t node) noexcept
+    {
+        const auto cpus = cpus_of(node);
+
+        if (!cpus)
+        {
+            return std::unexpected{cpus.error()};
+        }
+        const auto pinned = pin_current_thread(cpus.value());
+
+        if (!pinned)
+        {
+            return pinned;
+        }
+        return set_thread_memory_policy(memory_policy::preferred, node_mask{}.add(node));
+    }
+} // namespace unix::numa
+
+#endif // __linux__
+
+#endif // UNIX_NUMA_HPP
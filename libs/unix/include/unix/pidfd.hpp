@@ -0,0 +1,140 @@
+#ifndef UNIX_PIDFD_HPP
+#define UNIX_PIDFD_HPP
+
+#ifdef __linux__ // process descriptors exist only on Linux 5.3+
+
+#include <cassert>
+#include <errno.h>
+#include <expected>
+#include <poll.h>
+#include <signal.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <utility>
+
+#include "unix/error_code.hpp"
+#include "unix/process.hpp"
+#include "unix/signal.hpp"
+#include "unix/utility.hpp"
+
+namespace unix
+{
+    // refers to the process itself, not to its id, so signals never reach
+    // an unrelated process that reused the id, becomes readable once the
+    // process terminates, which lets epoll watch many children at once
+    class pidfd
+    {
+        static constexpr file_descriptor_t closed_descriptor{-1};
+
+    public:
+        explicit pidfd(file_descriptor_t fd, process_id_t pid) noexcept
+            : fd_{fd}, pid_{pid} {}
+
+        pidfd(const pidfd &other) = delete;
+        pidfd &operator=(const pidfd &other) = delete;
+
+        pidfd(pidfd &&other) noexcept
+            : fd_{std::exchange(other.fd_, closed_descriptor)}, pid_{other.pid_} {}
+
+        pidfd &operator=(pidfd &&other) noexcept
+        {
+            if (this != &other)
+            {
+                if (is_open())
+                {
+                    close();
+                }
+                fd_ = std::exchange(other.fd_, closed_descriptor);
+                pid_ = other.pid_;
+            }
+            return *this;
+        }
+
+        static std::expected<pidfd, error_code> open(process_id_t pid) noexcept
+        {
+            const auto fd = static_cast<file_descriptor_t>(::syscall(SYS_pidfd_open, pid, 0));
+
+            if (operation_failed(fd))
+            {
+                return std::unexpected{error_code{errno}};
+            }
+            return std::expected<pidfd, error_code>{std::in_place, fd, pid};
+        }
+
+        // fails with ESRCH once the process terminated
+        std::expected<void, error_code> send_signal(signal_t signal) const noexcept
+        {
+            assert(is_open());
+            const auto ret = ::syscall(SYS_pidfd_send_signal, fd_, signal, nullptr, 0);
+
+            if (operation_failed(static_cast<int>(ret)))
+            {
+                return std::unexpected{error_code{errno}};
+            }
+            return std::expected<void, error_code>{};
+        }
+
+        std::expected<void, error_code> request_termination() const noexcept
+        {
+            return send_signal(SIGTERM);
+        }
+
+        std::expected<void, error_code> force_termination() const noexcept
+        {
+            return send_signal(SIGKILL);
+        }
+
+        // unlike probing the id, tells a zombie from a running process
+        bool has_terminated() const noexcept
+        {
+            assert(is_open());
+            pollfd descriptor{fd_, POLLIN, 0};
+            return ::poll(&descriptor, 1, 0) > 0;
+        }
+
+        bool is_open() const noexcept
+        {
+            return fd_ != closed_descriptor;
+        }
+
+        file_descriptor_t file_descriptor() const noexcept
+        {
+            assert(is_open());
+            return fd_;
+        }
+
+        process_id_t process_id() const noexcept
+        {
+            return pid_;
+        }
+
+        std::expected<void, error_code> close() noexcept
+        {
+            assert(is_open());
+            const auto ret = ::close(fd_);
+            fd_ = closed_descriptor;
+
+            if (operation_successful(ret))
+            {
+                return std::expected<void, error_code>{};
+            }
+            return std::unexpected{error_code{errno}};
+        }
+
+        ~pidfd() noexcept
+        {
+            if (is_open())
+            {
+                close();
+            }
+        }
+
+    private:
+        file_descriptor_t fd_;
+        process_id_t pid_;
+    };
+} // namespace unix
+
+#endif
+
+#endif // UNIX_PIDFD_HPP
@@ -2,8 +2,10 @@
 #define UNIX_PROCESS_HPP
 
 #include <chrono>
+#include <cstdlib>
 #include <expected>
 #include <errno.h>
+#include <signal.h>
 #include <unistd.h>
 #include <sys/wait.h>
 
@@ -35,6 +37,20 @@ namespace unix
         return getpid();
     }
 
+#ifdef __linux__ // the thread ids of OSX cannot be passed to kill
+    // unique across all the processes, unlike std::thread::id
+    process_id_t get_thread_id() noexcept
+    {
+        return gettid();
+    }
+#endif
+
+    // the process or thread may belong to another user
+    bool process_exists(process_id_t pid) noexcept
+    {
+        return ::kill(pid, 0) == 0 || errno == EPERM;
+    }
+
     process_id_t get_parent_process_id() noexcept
     {
         return getppid();
@@ -51,6 +67,58 @@ namespace unix
         return std::expected<process_id_t, error_code>{child_id};
     }
 
+    // waits for the particular child, returns its status
+    std::expected<int, error_code> wait_till_child_terminates(process_id_t pid) noexcept
+    {
+        int status;
+
+        while (true)
+        {
+            const auto ret = waitpid(pid, &status, 0);
+
+            if (!operation_failed(ret))
+            {
+                return status;
+            }
+            if (errno != EINTR)
+            {
+                return std::unexpected{error_code{errno}};
+            }
+        }
+    }
+
+    // returned while all the children are still running
+    constexpr process_id_t no_child_terminated{0};
+
+    std::expected<process_id_t, error_code> try_waiting_for_child(int *status) noexcept
+    {
+        const auto child_id = waitpid(process_id_t{-1}, status, WNOHANG);
+
+        if (unix::operation_failed(child_id))
+        {
+            return std::unexpected{error_code{errno}};
+        }
+        return std::expected<process_id_t, error_code>{child_id};
+    }
+
+    // the particular child only, returns no_child_terminated while it is still running
+    std::expected<process_id_t, error_code> try_waiting_for_child(process_id_t pid, int *status) noexcept
+    {
+        const auto child_id = waitpid(pid, status, WNOHANG);
+
+        if (unix::operation_failed(child_id))
+        {
+            return std::unexpected{error_code{errno}};
+        }
+        return std::expected<process_id_t, error_code>{child_id};
+    }
+
+    // killed by a signal or exited with a non-zero status
+    constexpr bool terminated_abnormally(int status) noexcept
+    {
+        return !WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS;
+    }
+
     std::expected<void, std::chrono::seconds> sleep(const std::chrono::seconds &amount) noexcept
     {
         using seconds_t = unsigned int;
@@ -0,0 +1,153 @@
+#ifndef UNIX_SCHEDULING_HPP
+#define UNIX_SCHEDULING_HPP
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <errno.h>
+#include <expected>
+#include <pthread.h>
+#include <sched.h>
+#include <string_view>
+#include <sys/resource.h>
+#include <thread>
+
+#include "unix/error_code.hpp"
+#include "unix/process.hpp"
+#include "unix/utility.hpp"
+
+namespace unix
+{
+    enum class scheduling_policy
+    {
+        other,       // SCHED_OTHER, time sharing, prioritized by niceness
+        fifo,        // SCHED_FIFO, real time, runs till it blocks or yields
+        round_robin, // SCHED_RR, real time, time sliced among equal priorities
+#ifdef __linux__
+        batch, // SCHED_BATCH, cpu bound work, preempted less eagerly
+        idle,  // SCHED_IDLE, runs only when nothing else does
+#endif
+    };
+
+    constexpr int to_policy_flag(scheduling_policy policy) noexcept
+    {
+#ifdef __linux__
+        constexpr std::array<int, 5> flags{SCHED_OTHER, SCHED_FIFO, SCHED_RR, SCHED_BATCH, SCHED_IDLE};
+#else
+        constexpr std::array<int, 3> flags{SCHED_OTHER, SCHED_FIFO, SCHED_RR};
+#endif
+        return flags[static_cast<std::size_t>(policy)];
+    }
+
+    // the real time policies take 1 - 99 on linux, the others only 0,
+    // raising the priority requires CAP_SYS_NICE or RLIMIT_RTPRIO
+    using scheduling_priority_t = int;
+
+    std::expected<void, error_code> set_thread_scheduling(std::thread &thread, scheduling_policy policy,
+                                                          scheduling_priority_t priority) noexcept
+    {
+        const sched_param param{.sched_priority = priority};
+        const auto ret = pthread_setschedparam(thread.native_handle(), to_policy_flag(policy), &param);
+
+        if (!operation_successful(ret))
+        {
+            return std::unexpected{error_code{ret}};
+        }
+        return std::expected<void, error_code>{};
+    }
+
+    std::expected<void, error_code> set_current_thread_scheduling(scheduling_policy policy,
+                                                                  scheduling_priority_t priority) noexcept
+    {
+        const sched_param param{.sched_priority = priority};
+        const auto ret = pthread_setschedparam(pthread_self(), to_policy_flag(policy), &param);
+
+        if (!operation_successful(ret))
+        {
+            return std::unexpected{error_code{ret}};
+        }
+        return std::expected<void, error_code>{};
+    }
+
+#ifdef __linux__
+    // zero sets the calling process, children created afterwards inherit it
+    std::expected<void, error_code> set_process_scheduling(process_id_t pid, scheduling_policy policy,
+                                                           scheduling_priority_t priority) noexcept
+    {
+        const sched_param param{.sched_priority = priority};
+        const auto ret = sched_setscheduler(pid, to_policy_flag(policy), &param);
+
+        if (operation_failed(ret))
+        {
+            return std::unexpected{error_code{errno}};
+        }
+        return std::expected<void, error_code>{};
+    }
+#endif
+
+    // -20 (the most favorable) - 19, lowering it requires CAP_SYS_NICE,
+    // only affects scheduling_policy::other and batch
+    using niceness_t = int;
+
+    std::expected<void, error_code> set_niceness(process_id_t pid, niceness_t niceness) noexcept
+    {
+        const auto ret = setpriority(PRIO_PROCESS, static_cast<id_t>(pid), niceness);
+
+        if (operation_failed(ret))
+        {
+            return std::unexpected{error_code{errno}};
+        }
+        return std::expected<void, error_code>{};
+    }
+
+    std::expected<niceness_t, error_code> get_niceness(process_id_t pid) noexcept
+    {
+        // -1 is a valid niceness, only errno tells the failure apart
+        errno = 0;
+        const auto niceness = getpriority(PRIO_PROCESS, static_cast<id_t>(pid));
+
+        if (niceness == -1 && errno != 0)
+        {
+            return std::unexpected{error_code{errno}};
+        }
+        return niceness;
+    }
+
+    // names longer than 15 characters get truncated, shown e.g. by top -H
+    constexpr std::size_t max_thread_name_length{15};
+
+#ifdef __linux__
+    std::expected<void, error_code> name_thread(std::thread &thread, std::string_view name) noexcept
+    {
+        std::array<char, max_thread_name_length + 1> truncated{};
+        std::copy_n(name.data(), std::min(name.size(), max_thread_name_length), truncated.data());
+        const auto ret = pthread_setname_np(thread.native_handle(), truncated.data());
+
+        if (!operation_successful(ret))
+        {
+            return std::unexpected{error_code{ret}};
+        }
+        return std::expected<void, error_code>{};
+    }
+#endif
+
+    std::expected<void, error_code> name_current_thread(std::string_view name) noexcept
+    {
+        std::array<char, max_thread_name_length + 1> truncated{};
+        std::copy_n(name.data(), std::min(name.size(), max_thread_name_length), truncated.data());
+#ifdef __APPLE__ // only the calling thread can be named
+        const auto ret = pthread_setname_np(truncated.data());
+#else
+        const auto ret = pthread_setname_np(pthread_self(), truncated.data());
+#endif
+
+        if (!operation_successful(ret))
+        {
+            return std::unexpected{error_code{ret}};
+        }
+        return std::expected<void, error_code>{};
+    }
+} // namespace unix
+
+#endif // UNIX_SCHEDULING_HPP
@@ -0,0 +1,176 @@
+#ifndef UNIX_SIGNAL_FD_HPP
+#define UNIX_SIGNAL_FD_HPP
+
+#ifdef __linux__
+
+#include <cassert>
+#include <cstddef>
+#include <errno.h>
+#include <expected>
+#include <optional>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/signalfd.h>
+#include <unistd.h>
+#include <utility>
+
+#include "unix/error_code.hpp"
+#include "unix/signal.hpp"
+#include "unix/utility.hpp"
+
+namespace unix
+{
+    class signal_set
+    {
+    public:
+        signal_set() noexcept
+        {
+            sigemptyset(&signals_);
+        }
+
+        signal_set &add(signal_t signal) noexcept
+        {
+            sigaddset(&signals_, signal);
+            return *this;
+        }
+
+        bool contains(signal_t signal) const noexcept
+        {
+            return sigismember(&signals_, signal) == 1;
+        }
+
+        const sigset_t &native_handle() const noexcept
+        {
+            return signals_;
+        }
+
+        sigset_t &native_handle() noexcept
+        {
+            return signals_;
+        }
+
+    private:
+        sigset_t signals_;
+    };
+
+    // the blocked signals stay pending till they are read from a signal_fd,
+    // returns the previous mask of the calling thread, forked children inherit it
+    std::expected<signal_set, error_code> block_signals(const signal_set &signals) noexcept
+    {
+        signal_set previous;
+        const auto ret = pthread_sigmask(SIG_BLOCK, &signals.native_handle(), &previous.native_handle());
+
+        if (!operation_successful(ret))
+        {
+            return std::unexpected{error_code{ret}};
+        }
+        return previous;
+    }
+
+    std::expected<void, error_code> set_blocked_signals(const signal_set &signals) noexcept
+    {
+        const auto ret = pthread_sigmask(SIG_SETMASK, &signals.native_handle(), nullptr);
+
+        if (!operation_successful(ret))
+        {
+            return std::unexpected{error_code{ret}};
+        }
+        return std::expected<void, error_code>{};
+    }
+
+    // delivers the blocked signals as reads instead of running handlers
+    // asynchronously, so they can be waited for together with other descriptors
+    class signal_fd
+    {
+        static constexpr file_descriptor_t closed_descriptor{-1};
+
+    public:
+        explicit signal_fd(file_descriptor_t fd) noexcept : fd_{fd} {}
+
+        signal_fd(const signal_fd &other) = delete;
+        signal_fd &operator=(const signal_fd &other) = delete;
+
+        signal_fd(signal_fd &&other) noexcept
+            : fd_{std::exchange(other.fd_, closed_descriptor)} {}
+
+        signal_fd &operator=(signal_fd &&other) noexcept = delete;
+
+        // the signals have to be blocked first, otherwise they get their default action
+        static std::expected<signal_fd, error_code> create(const signal_set &signals) noexcept
+        {
+            const auto fd = ::signalfd(closed_descriptor, &signals.native_handle(),
+                                       SFD_NONBLOCK | SFD_CLOEXEC);
+
+            if (operation_failed(fd))
+            {
+                return std::unexpected{error_code{errno}};
+            }
+            return std::expected<signal_fd, error_code>{std::in_place, fd};
+        }
+
+        // returns nullopt when no signal is pending
+        std::expected<std::optional<signal_t>, error_code> read() const noexcept
+        {
+            assert(is_open());
+            signalfd_siginfo info;
+
+            while (true)
+            {
+                const auto ret = ::read(fd_, &info, sizeof(info));
+
+                if (!operation_failed(static_cast<int>(ret)))
+                {
+                    assert(static_cast<std::size_t>(ret) == sizeof(info));
+                    return static_cast<signal_t>(info.ssi_signo);
+                }
+                if (errno == EAGAIN)
+                {
+                    return std::nullopt;
+                }
+                if (errno != EINTR)
+                {
+                    return std::unexpected{error_code{errno}};
+                }
+            }
+        }
+
+        bool is_open() const noexcept
+        {
+            return fd_ != closed_descriptor;
+        }
+
+        file_descriptor_t file_descriptor() const noexcept
+        {
+            assert(is_open());
+            return fd_;
+        }
+
+        std::expected<void, error_code> close() noexcept
+        {
+            assert(is_open());
+            const auto ret = ::close(fd_);
+            fd_ = closed_descriptor;
+
+            if (operation_successful(ret))
+            {
+                return std::expected<void, error_code>{};
+            }
+            return std::unexpected{error_code{errno}};
+        }
+
+        ~signal_fd() noexcept
+        {
+            if (is_open())
+            {
+                close();
+            }
+        }
+
+    private:
+        file_descriptor_t fd_;
+    };
+} // namespace unix
+
+#endif
+
+#endif // UNIX_SIGNAL_FD_HPP
@@ -0,0 +1,90 @@
+#ifndef UNIX_SPAWN_HPP
+#define UNIX_SPAWN_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdlib>
+#include <errno.h>
+#include <expected>
+#include <signal.h>
+#include <span>
+#include <spawn.h>
+#include <string_view>
+#include <type_traits>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+#include "unix/error_code.hpp"
+#include "unix/process.hpp"
+#include "unix/utility.hpp"
+
+extern char **environ;
+
+namespace unix
+{
+    // fork copies the page tables of the parent, which gets slow with its memory,
+    // these start a program without copying them, the argument list has to end
+    // with nullptr, the child inherits the environment
+    std::expected<process_id_t, error_code> spawn(std::string_view path, std::span<char *const> args) noexcept
+    {
+        process_id_t pid;
+        const auto ret = ::posix_spawn(&pid, path.data(), nullptr, nullptr, args.data(), environ);
+
+        if (!operation_successful(ret))
+        {
+            return std::unexpected{error_code{ret}};
+        }
+        return pid;
+    }
+
+    // looks the program up in PATH
+    std::expected<process_id_t, error_code> spawn_searching_path(std::string_view file,
+                                                                 std::span<char *const> args) noexcept
+    {
+        process_id_t pid;
+        const auto ret = ::posix_spawnp(&pid, file.data(), nullptr, nullptr, args.data(), environ);
+
+        if (!operation_successful(ret))
+        {
+            return std::unexpected{error_code{ret}};
+        }
+        return pid;
+    }
+
+#ifdef __linux__
+    namespace detail
+    {
+        template <class Function>
+        int run_in_shared_memory(void *function) noexcept
+        {
+            return (*static_cast<Function *>(function))();
+        }
+    } // namespace detail
+
+    // the child runs in the memory of the parent, which stays suspended until
+    // the child calls exec or terminates, so the function may only prepare
+    // the exec, e.g. redirect descriptors, anything it changes is seen by the parent,
+    // the value it returns becomes the exit status when exec is not reached
+    template <class Function>
+    std::expected<process_id_t, error_code> create_process_sharing_memory(Function &&function) noexcept
+    {
+        // the parent is suspended, so the child can borrow a part of its stack
+        constexpr std::size_t stack_size{64 * 1'024};
+        alignas(16) std::array<std::byte, stack_size> stack;
+        const auto pid = ::clone(&detail::run_in_shared_memory<std::remove_reference_t<Function>>,
+                                 stack.data() + stack.size(), CLONE_VM | CLONE_VFORK | SIGCHLD,
+                                 static_cast<void *>(&function));
+
+        if (operation_failed(pid))
+        {
+            return std::unexpected{error_code{errno}};
+        }
+        return pid;
+    }
+#endif
+} // namespace unix
+
+#endif // UNIX_SPAWN_HPP
@@ -0,0 +1,181 @@
+#ifndef UNIX_SYNC_POSIX_CONDITION_VARIABLE_HPP
+#define UNIX_SYNC_POSIX_CONDITION_VARIABLE_HPP
+
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <errno.h>
+#include <expected>
+#include <memory>
+#include <new>
+#include <pthread.h>
+#include <time.h>
+
+#include "unix/error_code.hpp"
+#include "unix/sync/posix/mutex.hpp"
+#include "unix/sync/posix/process_sharing.hpp"
+#include "unix/time.hpp"
+#include "unix/utility.hpp"
+
+namespace unix::sync::posix
+{
+    // the waits report the lock_result of reacquiring the mutex,
+    // previous_owner_died has to be handled just as after mutex::lock
+    class condition_variable
+    {
+    public:
+        condition_variable(const condition_variable &other) = delete;
+        condition_variable &operator=(const condition_variable &other) = delete;
+
+        // the attributes select the clock of the timed waits, so unlike the mutex
+        // even the process private one can fail to initialize and gets allocated
+        static std::expected<std::unique_ptr<condition_variable>, error_code> create(
+            process_sharing sharing = process_sharing::process_private) noexcept
+        {
+            auto created = std::unique_ptr<condition_variable>{new (std::nothrow) condition_variable{uninitialized}};
+
+            if (!created)
+            {
+                return std::unexpected{error_code{ENOMEM}};
+            }
+            const auto ret = initialize(created->handle_, sharing);
+
+            if (!unix::operation_successful(ret))
+            {
+                // the failed initialization leaves the handle unspecified, the
+                // statically initialized one is safe to destroy by the unique_ptr
+                created->handle_ = PTHREAD_COND_INITIALIZER;
+                return std::unexpected{error_code{ret}};
+            }
+            return created;
+        }
+
+        // constructs the condition variable at the address, e.g. inside a shared memory
+        // segment, it has to be destroyed by calling the destructor explicitly, on failure
+        // a statically initialized one is left at the address, see mutex::construct_at
+        static std::expected<condition_variable *, error_code> construct_at(void *address,
+                                                                            process_sharing sharing) noexcept
+        {
+            assert(address);
+            assert(reinterpret_cast<std::uintptr_t>(address) % alignof(condition_variable) == 0);
+            auto *constructed = new (address) condition_variable{uninitialized};
+            const auto ret = initialize(constructed->handle_, sharing);
+
+            if (unix::operation_successful(ret))
+            {
+                return constructed;
+            }
+            constructed->handle_ = PTHREAD_COND_INITIALIZER;
+            return std::unexpected{error_code{ret}};
+        }
+
+        // the mutex has to be locked by the caller, spurious wake ups are possible
+        std::expected<lock_result, error_code> wait(mutex &locked) noexcept
+        {
+            return mutex::to_lock_result(pthread_cond_wait(&handle_, &locked.handle_));
+        }
+
+        template <class Predicate>
+        std::expected<lock_result, error_code> wait(mutex &locked, Predicate predicate) noexcept
+        {
+            auto result = lock_result::acquired;
+
+            while (!predicate())
+            {
+                const auto woken_up = wait(locked);
+
+                if (!woken_up)
+                {
+                    return woken_up;
+                }
+                if (woken_up.value() == lock_result::previous_owner_died)
+                {
+                    result = lock_result::previous_owner_died;
+                }
+            }
+            return result;
+        }
+
+        // fails with ETIMEDOUT, the mutex is reacquired also in that case,
+        // on linux the timeout is measured by CLOCK_MONOTONIC
+        template <class Rep, class Period>
+        std::expected<lock_result, error_code> wait_for(mutex &locked,
+                                                        const std::chrono::duration<Rep, Period> &timeout) noexcept
+        {
+            const auto deadline = deadline_after(clock, timeout);
+            return mutex::to_lock_result(pthread_cond_timedwait(&handle_, &locked.handle_, &deadline));
+        }
+
+        std::expected<void, error_code> notify_one() noexcept
+        {
+            return to_expected(pthread_cond_signal(&handle_));
+        }
+
+        std::expected<void, error_code> notify_all() noexcept
+        {
+            return to_expected(pthread_cond_broadcast(&handle_));
+        }
+
+        pthread_cond_t *native_handle() noexcept
+        {
+            return &handle_;
+        }
+
+        ~condition_variable() noexcept
+        {
+            const auto ret = pthread_cond_destroy(&handle_);
+            assert(unix::operation_successful(ret));
+        }
+
+    private:
+#ifdef __APPLE__ // pthread_condattr_setclock is not available on OSX
+        static constexpr clockid_t clock{CLOCK_REALTIME};
+#else
+        static constexpr clockid_t clock{CLOCK_MONOTONIC};
+#endif
+
+        pthread_cond_t handle_ = PTHREAD_COND_INITIALIZER;
+
+        struct uninitialized_t
+        {
+        };
+        static constexpr uninitialized_t uninitialized{};
+
+        explicit condition_variable(uninitialized_t) noexcept {}
+
+        static int initialize(pthread_cond_t &handle, process_sharing sharing) noexcept
+        {
+            pthread_condattr_t attributes;
+            auto ret = pthread_condattr_init(&attributes);
+
+            if (!unix::operation_successful(ret))
+            {
+                return ret;
+            }
+            ret = pthread_condattr_setpshared(&attributes, to_pshared(sharing));
+#ifndef __APPLE__
+            if (unix::operation_successful(ret))
+            {
+                ret = pthread_condattr_setclock(&attributes, clock);
+            }
+#endif
+            if (unix::operation_successful(ret))
+            {
+                ret = pthread_cond_init(&handle, &attributes);
+            }
+            pthread_condattr_destroy(&attributes);
+            return ret;
+        }
+
+        static std::expected<void, error_code> to_expected(int ret) noexcept
+        {
+            if (unix::operation_successful(ret))
+            {
+                return std::expected<void, error_code>{};
+            }
+            return std::unexpected{error_code{ret}};
+        }
+    };
+} // namespace unix::sync::posix
+
+#endif // UNIX_SYNC_POSIX_CONDITION_VARIABLE_HPP
@@ -2,47 +2,103 @@
 #define UNIX_SYNC_POSIX_MUTEX_HPP
 
 #include <cassert>
+#include <chrono>
+#include <cstdint>
 #include <errno.h>
 #include <expected>
+#include <new>
 #include <pthread.h>
+#include <time.h>
 
 #include "unix/error_code.hpp"
+#include "unix/sync/posix/process_sharing.hpp"
+#include "unix/time.hpp"
 #include "unix/utility.hpp"
 
 namespace unix::sync::posix
 {
+    enum class lock_result
+    {
+        acquired,
+        // the owner terminated while holding the lock, it is acquired anyway,
+        // but the protected state might be inconsistent, once repaired
+        // make_consistent has to be called before unlocking, otherwise
+        // the mutex becomes permanently unusable
+        previous_owner_died
+    };
+
+    // pthread objects must not be copied or moved, they are initialized in place,
+    // in pthread the return value is zero on success
+    // on failure it is set directly to the error code, errno is not set
     class mutex
     {
     public:
-        // find a way to make it private
-        explicit mutex(const pthread_mutex_t &handle) noexcept : handle_{handle} {}
+        // default attributes, usable only by the threads of a single process
+        mutex() noexcept = default;
+
+        mutex(const mutex &other) = delete;
+        mutex &operator=(const mutex &other) = delete;
 
         static std::expected<posix::mutex, error_code> create() noexcept
         {
-            pthread_mutex_t handle;
-            const auto ret = pthread_mutex_init(&handle, nullptr);
+            return std::expected<posix::mutex, error_code>{std::in_place};
+        }
+
+        // constructs the mutex at the address, e.g. inside a shared memory segment,
+        // it has to be destroyed by calling the destructor explicitly, process shared
+        // mutexes are also robust, so a crashed owner does not block the others forever,
+        // a default constructed member of a struct placed into shared memory gets
+        // replaced this way by the factory of the struct, on failure a default
+        // constructed mutex is left at the address, so the destructor may still run
+        static std::expected<posix::mutex *, error_code> construct_at(void *address,
+                                                                      process_sharing sharing) noexcept
+        {
+            assert(address);
+            assert(reinterpret_cast<std::uintptr_t>(address) % alignof(mutex) == 0);
+            auto *constructed = new (address) mutex{uninitialized};
+            const auto ret = initialize(constructed->handle_, sharing);
 
-            // in pthread the return value is zero on success
-            // on failure it is set directly to the error code, errno is not set
             if (unix::operation_successful(ret))
             {
-                return std::expected<posix::mutex, error_code>{std::in_place, handle};
+                return constructed;
             }
-            assert(!unix::operation_successful(ret));
-            return std::unexpected{error_code{ret}};;
+            // the failed initialization leaves the handle unspecified
+            constructed->handle_ = PTHREAD_MUTEX_INITIALIZER;
+            return std::unexpected{error_code{ret}};
         }
 
-        std::expected<void, error_code> lock() noexcept
+        std::expected<lock_result, error_code> lock() noexcept
         {
-            const auto ret = pthread_mutex_lock(&handle_);
+            return to_lock_result(pthread_mutex_lock(&handle_));
+        }
+
+        // fails with EBUSY when the mutex is held
+        std::expected<lock_result, error_code> try_lock() noexcept
+        {
+            return to_lock_result(pthread_mutex_trylock(&handle_));
+        }
+
+#ifndef __APPLE__
+        // fails with ETIMEDOUT, the timeout is measured by CLOCK_REALTIME
+        template <class Rep, class Period>
+        std::expected<lock_result, error_code> lock_for(const std::chrono::duration<Rep, Period> &timeout) noexcept
+        {
+            const auto deadline = deadline_after(CLOCK_REALTIME, timeout);
+            return to_lock_result(pthread_mutex_timedlock(&handle_, &deadline));
+        }
+
+        // marks the state protected by a mutex of a dead owner as repaired
+        std::expected<void, error_code> make_consistent() noexcept
+        {
+            const auto ret = pthread_mutex_consistent(&handle_);
 
             if (unix::operation_successful(ret))
             {
                 return std::expected<void, error_code>{};
             }
-            assert(!unix::operation_successful(ret));
             return std::unexpected{error_code{ret}};
         }
+#endif
 
         std::expected<void, error_code> unlock() noexcept
         {
@@ -56,6 +112,11 @@ namespace unix::sync::posix
             return std::unexpected{error_code{ret}};
         }
 
+        pthread_mutex_t *native_handle() noexcept
+        {
+            return &handle_;
+        }
+
         ~mutex() noexcept
         {
             const auto ret = pthread_mutex_destroy(&handle_);
@@ -63,8 +124,56 @@ namespace unix::sync::posix
         }
 
     private:
-        pthread_mutex_t handle_;
+        pthread_mutex_t handle_ = PTHREAD_MUTEX_INITIALIZER;
+
+        struct uninitialized_t
+        {
+        };
+        static constexpr uninitialized_t uninitialized{};
+
+        explicit mutex(uninitialized_t) noexcept {}
+
+        static int initialize(pthread_mutex_t &handle, process_sharing sharing) noexcept
+        {
+            pthread_mutexattr_t attributes;
+            auto ret = pthread_mutexattr_init(&attributes);
+
+            if (!unix::operation_successful(ret))
+            {
+                return ret;
+            }
+            ret = pthread_mutexattr_setpshared(&attributes, to_pshared(sharing));
+#ifndef __APPLE__ // robust mutexes are not available on OSX
+            if (unix::operation_successful(ret) && sharing == process_sharing::process_shared)
+            {
+                ret = pthread_mutexattr_setrobust(&attributes, PTHREAD_MUTEX_ROBUST);
+            }
+#endif
+            if (unix::operation_successful(ret))
+            {
+                ret = pthread_mutex_init(&handle, &attributes);
+            }
+            pthread_mutexattr_destroy(&attributes);
+            return ret;
+        }
+
+        static std::expected<lock_result, error_code> to_lock_result(int ret) noexcept
+        {
+            if (unix::operation_successful(ret))
+            {
+                return lock_result::acquired;
+            }
+#ifndef __APPLE__
+            if (ret == EOWNERDEAD)
+            {
+                return lock_result::previous_owner_died;
+            }
+#endif
+            return std::unexpected{error_code{ret}};
+        }
+
+        friend class condition_variable;
     };
 } // namespace unix::sync::posix
 
-#endif // UNIX_SYNC_POSIX_MUTEX_HPP
\ No newline at end of file
+#endif // UNIX_SYNC_POSIX_MUTEX_HPP
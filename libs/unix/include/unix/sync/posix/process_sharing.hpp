@@ -0,0 +1,22 @@
+#ifndef UNIX_SYNC_POSIX_PROCESS_SHARING_HPP
+#define UNIX_SYNC_POSIX_PROCESS_SHARING_HPP
+
+#include <pthread.h>
+
+namespace unix::sync::posix
+{
+    // shared objects have to be placed into memory mapped by all the processes using them
+    enum class process_sharing
+    {
+        process_private, // PTHREAD_PROCESS_PRIVATE
+        process_shared   // PTHREAD_PROCESS_SHARED
+    };
+
+    constexpr int to_pshared(process_sharing sharing) noexcept
+    {
+        return sharing == process_sharing::process_shared ? PTHREAD_PROCESS_SHARED
+                                                          : PTHREAD_PROCESS_PRIVATE;
+    }
+} // namespace unix::sync::posix
+
+#endif // UNIX_SYNC_POSIX_PROCESS_SHARING_HPP
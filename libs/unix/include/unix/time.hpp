@@ -0,0 +1,26 @@
+#ifndef UNIX_TIME_HPP
+#define UNIX_TIME_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <time.h>
+
+namespace unix
+{
+    // absolute timeouts of the pthread and semaphore waits are measured by a clock
+    // chosen at initialization, CLOCK_REALTIME unless stated otherwise
+    template <class Rep, class Period>
+    timespec deadline_after(clockid_t clock, const std::chrono::duration<Rep, Period> &timeout) noexcept
+    {
+        constexpr std::int64_t nanoseconds_per_second{1'000'000'000};
+        timespec deadline;
+        clock_gettime(clock, &deadline);
+        const auto nanoseconds =
+            std::chrono::duration_cast<std::chrono::nanoseconds>(timeout).count() + deadline.tv_nsec;
+        deadline.tv_sec += static_cast<time_t>(nanoseconds / nanoseconds_per_second);
+        deadline.tv_nsec = static_cast<long>(nanoseconds % nanoseconds_per_second);
+        return deadline;
+    }
+} // namespace unix
+
+#endif // UNIX_TIME_HPP
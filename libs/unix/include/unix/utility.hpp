@@ -5,6 +5,8 @@
 
 namespace unix
 {
+    using file_descriptor_t = int;
+
     constexpr bool operation_successful(int ret)
     {
         return ret == 0;
@@ -0,0 +1,33 @@
+#ifndef ASYNC_TESTS_READ_FILE_HPP
+#define ASYNC_TESTS_READ_FILE_HPP
+
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace async_tests
+{
+    // the whole file, empty when it cannot be opened
+    inline std::vector<std::byte> read_all(const std::string &path)
+    {
+        std::vector<std::byte> bytes;
+        auto *file = std::fopen(path.c_str(), "rb");
+
+        if (file == nullptr)
+        {
+            return bytes;
+        }
+        std::byte chunk[4'096];
+
+        for (auto read = std::fread(chunk, 1, sizeof(chunk), file); read != 0;
+             read = std::fread(chunk, 1, sizeof(chunk), file))
+        {
+            bytes.insert(bytes.end(), chunk, chunk + read);
+        }
+        std::fclose(file);
+        return bytes;
+    }
+} // namespace async_tests
+
+#endif // ASYNC_TESTS_READ_FILE_HPP
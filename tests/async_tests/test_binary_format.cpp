@@ -0,0 +1,384 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <errno.h>
+#include <expected>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unistd.h>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "unix/error_code.hpp"
+#include "unix/fs/posix/file.hpp"
+
+#include "async/argument_type.hpp"
+#include "async/binary_reader.hpp"
+#include "async/binary_writer.hpp"
+#include "async/file_sink.hpp"
+#include "async/format_string.hpp"
+#include "async/message_buffer.hpp"
+
+namespace
+{
+    struct point
+    {
+        int x;
+        int y;
+    };
+}
+
+template <>
+struct async::argument_traits<point>
+{
+    static constexpr std::string_view name{"point"};
+
+    static std::size_t size(const point &) noexcept
+    {
+        return 2 * sizeof(int);
+    }
+
+    static void encode(const point &value, std::span<std::byte> bytes) noexcept
+    {
+        std::memcpy(bytes.data(), &value.x, sizeof(int));
+        std::memcpy(bytes.data() + sizeof(int), &value.y, sizeof(int));
+    }
+
+    static void decode(std::span<const std::byte> bytes, std::string &output) noexcept
+    {
+        int x, y;
+        std::memcpy(&x, bytes.data(), sizeof(int));
+        std::memcpy(&y, bytes.data() + sizeof(int), sizeof(int));
+        output += "(" + std::to_string(x) + ", " + std::to_string(y) + ")";
+    }
+};
+
+namespace
+{
+    template <class... Args>
+    std::vector<std::byte> serialize(const Args &...args)
+    {
+        std::vector<std::byte> bytes;
+        async::binary::encoder output{bytes};
+        (output.put(args), ...);
+        return bytes;
+    }
+
+    // the way the logger serializes the arguments
+    template <class... Args>
+    std::vector<std::byte> serialize_arguments(const Args &...args)
+    {
+        std::vector<std::byte> bytes((std::size_t{0} + ... + async::encoded_size(args)));
+        async::input_message_buffer message{bytes};
+        async::fill_buffer(message, args...);
+        EXPECT_TRUE(message.full());
+        return bytes;
+    }
+
+    // a file with one format and one record, the way a corrupted or hostile writer could have left it
+    std::vector<std::byte> forge_file(std::span<const async::argument_descriptor> descriptors, std::string_view text,
+                                      std::span<const std::byte> arguments)
+    {
+        std::vector<std::byte> bytes;
+        async::binary::encoder output{bytes};
+        async::binary::encode_header(output, async::binary::file_header{0, 0, 1.0});
+        async::binary::encode_format(output, 1, async::format_signature{descriptors},
+                                     std::span<const char>{text.data(), text.size()});
+        async::binary::encode_record(output, 1, 0, arguments);
+        return bytes;
+    }
+
+    std::expected<std::string, unix::error_code> render_forged(std::span<const std::byte> bytes)
+    {
+        auto opened = async::binary_reader::open(bytes);
+
+        if (!opened)
+        {
+            return std::unexpected{opened.error()};
+        }
+        const auto record = opened.value().next();
+
+        if (!record)
+        {
+            return std::unexpected{record.error()};
+        }
+        EXPECT_TRUE(record.value());
+        return record.value() ? async::render(*record.value()) : std::unexpected{unix::error_code{ENODATA}};
+    }
+
+    // a temporary file written by the binary writer and read back whole
+    class BinaryFormatTest : public testing::Test
+    {
+    protected:
+        void SetUp() override
+        {
+            fd_ = mkstemp(path_.data());
+            ASSERT_NE(fd_, -1);
+            file_.emplace(fd_);
+        }
+
+        void TearDown() override
+        {
+            unlink(path_.c_str());
+        }
+
+        std::vector<std::byte> contents() const
+        {
+            std::vector<std::byte> bytes(static_cast<std::size_t>(lseek(fd_, 0, SEEK_END)));
+            EXPECT_EQ(pread(fd_, bytes.data(), bytes.size(), 0), static_cast<ssize_t>(bytes.size()));
+            return bytes;
+        }
+
+        std::string path_{"/tmp/binary_format_XXXXXX"};
+        int fd_{-1};
+        std::optional<unix::fs::posix::file> file_;
+    };
+}
+
+TEST_F(BinaryFormatTest, WritesEachFormatOnce)
+{
+    const auto &first_format = async::log_format_of<"%zu: %d%% of %5.2f, %c\n", std::size_t, int, double, char>;
+    const auto &second_format = async::log_format_of<"%*d|%hhu|%llx\n", int, int, std::uint8_t, unsigned long long>;
+    {
+        auto sink = async::file_sink::create(*file_, async::sink_options{});
+        ASSERT_TRUE(sink);
+        async::binary_writer writer{sink.value()};
+        const auto first = serialize(std::size_t{7}, -42, 3.14159, 'x');
+        const auto second = serialize(6, 42, std::uint8_t{255}, 0xbeefULL);
+
+        ASSERT_TRUE(writer.write(first_format, 1, first));
+        ASSERT_TRUE(writer.write(second_format, 2, second));
+        ASSERT_TRUE(writer.write(second_format, 3, second));
+        EXPECT_EQ(writer.format_count(), 2);
+    }
+    const auto bytes = contents();
+    auto opened = async::binary_reader::open(bytes);
+    ASSERT_TRUE(opened);
+    auto &reader = opened.value();
+
+    // the header ties the ticks to the wall clock
+    const auto &header = reader.header();
+    EXPECT_GT(header.nanoseconds_per_tick, 0.0);
+    EXPECT_EQ(reader.to_system_time(header.tick_reference), header.system_reference);
+    const auto second_later =
+        header.tick_reference + static_cast<async::binary::timestamp_t>(1e9 / header.nanoseconds_per_tick);
+    EXPECT_NEAR(reader.to_system_time(second_later), header.system_reference + 1'000'000'000, 10);
+
+    const auto first = reader.next();
+    ASSERT_TRUE(first && first.value());
+    EXPECT_EQ(first.value()->timestamp, 1);
+    const auto first_rendered = async::render(*first.value());
+    ASSERT_TRUE(first_rendered);
+    EXPECT_EQ(first_rendered.value(), "7: -42% of  3.14, x\n");
+
+    for (const auto timestamp : {2, 3})
+    {
+        const auto next = reader.next();
+        ASSERT_TRUE(next && next.value());
+        EXPECT_EQ(next.value()->timestamp, timestamp);
+        const auto rendered = async::render(*next.value());
+        ASSERT_TRUE(rendered);
+        EXPECT_EQ(rendered.value(), "    42|255|beef\n");
+    }
+    const auto end = reader.next();
+    ASSERT_TRUE(end);
+    EXPECT_FALSE(end.value());
+}
+
+TEST_F(BinaryFormatTest, RendersAllArgumentTypes)
+{
+    const auto *pointer = reinterpret_cast<const void *>(0x1000);
+    {
+        auto sink = async::file_sink::create(*file_, async::sink_options{});
+        ASSERT_TRUE(sink);
+        async::binary_writer writer{sink.value()};
+        const auto arguments = serialize(-7L, std::int16_t{-3}, 9U, 2.5F, 'x', true, pointer);
+        const auto &format = async::log_format_of<"%ld %hd %u %.1f %c %d %p\n", long, std::int16_t, unsigned,
+                                                  float, char, bool, const void *>;
+        ASSERT_TRUE(writer.write(format, 1, arguments));
+    }
+    const auto bytes = contents();
+    auto opened = async::binary_reader::open(bytes);
+    ASSERT_TRUE(opened);
+    const auto record = opened.value().next();
+    ASSERT_TRUE(record && record.value());
+    const auto rendered = async::render(*record.value());
+    ASSERT_TRUE(rendered);
+    EXPECT_EQ(rendered.value(), "-7 -3 9 2.5 x 1 0x1000\n");
+}
+
+TEST_F(BinaryFormatTest, RendersTheWidthsOfAnyIntegerType)
+{
+    {
+        auto sink = async::file_sink::create(*file_, async::sink_options{});
+        ASSERT_TRUE(sink);
+        async::binary_writer writer{sink.value()};
+        const auto arguments = serialize(std::size_t{5}, 42, -4, 2U, 3.14159);
+        const auto &format = async::log_format_of<"%*d|%*.*f\n", std::size_t, int, int, unsigned, double>;
+        ASSERT_TRUE(writer.write(format, 1, arguments));
+    }
+    const auto bytes = contents();
+    auto opened = async::binary_reader::open(bytes);
+    ASSERT_TRUE(opened);
+    const auto record = opened.value().next();
+    ASSERT_TRUE(record && record.value());
+    const auto rendered = async::render(*record.value());
+    ASSERT_TRUE(rendered);
+    EXPECT_EQ(rendered.value(), "   42|3.14\n");
+}
+
+TEST_F(BinaryFormatTest, RendersStringsAndCustomArguments)
+{
+    const std::string long_text(1'000, 'a');
+    {
+        auto sink = async::file_sink::create(*file_, async::sink_options{});
+        ASSERT_TRUE(sink);
+        async::binary_writer writer{sink.value()};
+        const char *article{"the"};
+        const auto strings = serialize_arguments(std::string{"fox"}, std::string_view{"jumps over"}, article,
+                                                 std::string_view{}, 7);
+        const auto &strings_format =
+            async::log_format_of<"[%5s|%-6.5s|%.1s|%s] %d\n", std::string, std::string_view, const char *,
+                                 std::string_view, int>;
+        ASSERT_TRUE(writer.write(strings_format, 1, strings));
+
+        const auto custom = serialize_arguments(point{3, -4}, long_text.c_str());
+        ASSERT_TRUE(writer.write(async::log_format_of<"%s %s", point, const char *>, 2, custom));
+    }
+    const auto bytes = contents();
+    auto opened = async::binary_reader::open(bytes);
+    ASSERT_TRUE(opened);
+    auto &reader = opened.value();
+
+    const auto strings = reader.next();
+    ASSERT_TRUE(strings && strings.value());
+    const auto strings_rendered = async::render(*strings.value());
+    ASSERT_TRUE(strings_rendered);
+    EXPECT_EQ(strings_rendered.value(), "[  fox|jumps |t|] 7\n");
+
+    const auto custom = reader.next();
+    ASSERT_TRUE(custom && custom.value());
+    // the decoder may not know the custom type
+    const auto unknown = async::render(*custom.value());
+    ASSERT_TRUE(unknown);
+    EXPECT_EQ(unknown.value(), "<point> " + long_text);
+
+    const auto known = async::render(*custom.value(), async::argument_decoders{}.add<point>());
+    ASSERT_TRUE(known);
+    EXPECT_EQ(known.value(), "(3, -4) " + long_text);
+}
+
+TEST(MessageBufferTest, ReadsTheFieldsWithTheirOwnSize)
+{
+    const auto bytes = serialize(std::uint8_t{7}, std::int16_t{-2}, 1.5);
+    async::output_message_buffer message;
+    message.reset(bytes);
+    EXPECT_EQ(message.read<std::uint8_t>(), 7);
+    EXPECT_EQ(message.read<std::int16_t>(), -2);
+    EXPECT_EQ(message.read<double>(), 1.5);
+    EXPECT_TRUE(message.all_read());
+}
+
+TEST_F(BinaryFormatTest, RejectsCorruptedFiles)
+{
+    {
+        auto sink = async::file_sink::create(*file_, async::sink_options{});
+        ASSERT_TRUE(sink);
+        async::binary_writer writer{sink.value()};
+        const auto arguments = serialize(1);
+        ASSERT_TRUE(writer.write(async::log_format_of<"%d\n", int>, 1, arguments));
+    }
+    auto bytes = contents();
+    auto truncated = std::span<const std::byte>{bytes}.first(bytes.size() - 1);
+    auto opened = async::binary_reader::open(truncated);
+    ASSERT_TRUE(opened);
+    EXPECT_FALSE(opened.value().next());
+
+    // an integer rendered as a string
+    opened = async::binary_reader::open(bytes);
+    ASSERT_TRUE(opened);
+    const auto record = opened.value().next();
+    ASSERT_TRUE(record && record.value());
+    auto format = *record.value()->format;
+    format.text = "%s\n";
+    auto mismatched = *record.value();
+    mismatched.format = &format;
+    EXPECT_FALSE(async::render(mismatched));
+
+    bytes[0] = std::byte{'X'};
+    EXPECT_FALSE(async::binary_reader::open(bytes));
+}
+
+TEST(BinaryReaderTest, RejectsForgedConversions)
+{
+    const async::argument_descriptor integer{async::argument_type::signed_integer, sizeof(int)};
+    const auto arguments = serialize(42);
+
+    EXPECT_EQ(render_forged(forge_file({&integer, 1}, "%5d\n", arguments)).value(), "   42\n");
+    // only flags, digits, precision and length modifiers may precede the conversion
+    for (const auto text : {"%nd", "%5$d", "%'d", "%n", "%hhhd", "%.5.5d", "%"})
+    {
+        const auto rendered = render_forged(forge_file({&integer, 1}, text, arguments));
+        ASSERT_FALSE(rendered) << text;
+        EXPECT_EQ(rendered.error().code, EBADMSG) << text;
+    }
+}
+
+TEST(BinaryReaderTest, RejectsForgedArguments)
+{
+    const async::argument_descriptor floating{async::argument_type::floating_point, sizeof(double)};
+    const async::argument_descriptor string{async::argument_type::string, 0};
+    const async::argument_descriptor integer{async::argument_type::signed_integer, sizeof(int)};
+
+    // the conversions have to match the types
+    const auto rendered_double = render_forged(forge_file({&floating, 1}, "%d", serialize(2.5)));
+    ASSERT_FALSE(rendered_double);
+    EXPECT_EQ(rendered_double.error().code, EBADMSG);
+    const auto text = serialize(async::argument_length_t{2}, 'a', 'b');
+    EXPECT_EQ(render_forged(forge_file({&string, 1}, "%s", text)).value(), "ab");
+    EXPECT_FALSE(render_forged(forge_file({&string, 1}, "%c", text)));
+    EXPECT_FALSE(render_forged(forge_file({&integer, 1}, "%*d", serialize(1))));
+
+    // the arguments have to fit the record, without any bytes left over
+    EXPECT_FALSE(render_forged(forge_file({&integer, 1}, "%d", serialize(std::int16_t{1}))));
+    EXPECT_FALSE(render_forged(forge_file({&integer, 1}, "%d", serialize(1, 2))));
+    EXPECT_FALSE(render_forged(forge_file({&string, 1}, "%s", serialize(async::argument_length_t{100}, 'a'))));
+}
+
+TEST(BinaryReaderTest, RejectsForgedSizes)
+{
+    // none of these sizes gets written by the logger, nor loaded by the decoder
+    for (const auto descriptor : {async::argument_descriptor{async::argument_type::signed_integer, 3},
+                                  async::argument_descriptor{async::argument_type::unsigned_integer, 16},
+                                  async::argument_descriptor{async::argument_type::floating_point, 2},
+                                  async::argument_descriptor{async::argument_type::pointer, 1},
+                                  async::argument_descriptor{async::argument_type::string, 4},
+                                  async::argument_descriptor{static_cast<async::argument_type>(42), 4}})
+    {
+        const std::vector<std::byte> arguments(32);
+        const auto rendered = render_forged(forge_file({&descriptor, 1}, "%d", arguments));
+        ASSERT_FALSE(rendered);
+        EXPECT_EQ(rendered.error().code, EBADMSG);
+    }
+}
+
+// the logger rejects these at compile time
+static_assert(async::check_format<int, double>("%d %5.2f%%\n") == async::format_check::ok);
+static_assert(async::check_format<int, int, char>("%*d %c") == async::format_check::ok);
+static_assert(async::check_format<std::size_t, int>("%*d") == async::format_check::ok);
+static_assert(async::check_format<char, int>("%*d") == async::format_check::mismatched_argument);
+static_assert(async::check_format<bool, int>("%.*d") == async::format_check::mismatched_argument);
+static_assert(async::check_format<int>("%d %d") == async::format_check::too_few_arguments);
+static_assert(async::check_format<int, int>("%d") == async::format_check::too_many_arguments);
+static_assert(async::check_format<double>("%d") == async::format_check::mismatched_argument);
+static_assert(async::check_format<int>("%p") == async::format_check::mismatched_argument);
+static_assert(async::check_format<std::string_view, point>("%-8s|%s") == async::format_check::ok);
+static_assert(async::check_format<int>("%s") == async::format_check::mismatched_argument);
+static_assert(async::check_format<const char *>("%p") == async::format_check::mismatched_argument);
+static_assert(async::check_format<point>("%d") == async::format_check::mismatched_argument);
+static_assert(async::check_format<int>("%n") == async::format_check::unsupported_conversion);
+static_assert(async::check_format<int>("%l") == async::format_check::incomplete_conversion);
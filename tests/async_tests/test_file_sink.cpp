@@ -0,0 +1,168 @@
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <optional>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "unix/fs/posix/file.hpp"
+#include "unix/fs/posix/file_open_flags_builder.hpp"
+
+#include "async/file_sink.hpp"
+
+using namespace std::literals::chrono_literals;
+
+namespace
+{
+    std::vector<std::byte> pattern(std::size_t size, std::size_t seed = 0)
+    {
+        std::vector<std::byte> bytes(size);
+
+        for (std::size_t index{0}; index < size; ++index)
+        {
+            bytes[index] = static_cast<std::byte>((index + seed) % 251);
+        }
+        return bytes;
+    }
+
+    class FileSinkTest : public testing::Test
+    {
+    protected:
+        void TearDown() override
+        {
+            file_.reset();
+            unlink(path_.c_str());
+        }
+
+        bool open(bool direct)
+        {
+            const auto fd = mkstemp(path_.data());
+
+            if (fd == -1)
+            {
+                return false;
+            }
+            close(fd);
+            auto flags = unix::fs::posix::file_open_flags_builder{unix::fs::posix::access_mode::read_write}
+                             .truncate()
+                             .close_on_exec();
+
+            if (direct)
+            {
+#ifdef __linux__
+                flags.direct();
+#else
+                return false;
+#endif
+            }
+            const auto opened = ::open(path_.c_str(), flags.get());
+
+            if (opened == -1)
+            {
+                return false;
+            }
+            file_.emplace(opened);
+            return true;
+        }
+
+        std::vector<std::byte> contents() const
+        {
+            struct stat status;
+            EXPECT_EQ(stat(path_.c_str(), &status), 0);
+            std::vector<std::byte> bytes(static_cast<std::size_t>(status.st_size));
+            const auto fd = ::open(path_.c_str(), O_RDONLY);
+            EXPECT_EQ(pread(fd, bytes.data(), bytes.size(), 0), static_cast<ssize_t>(bytes.size()));
+            close(fd);
+            return bytes;
+        }
+
+        std::string path_{"./file_sink_XXXXXX"};
+        std::optional<unix::fs::posix::file> file_;
+    };
+}
+
+TEST_F(FileSinkTest, WritesOnceTheBufferFills)
+{
+    ASSERT_TRUE(open(false));
+    const auto bytes = pattern(5'000);
+    auto sink = async::file_sink::create(*file_, async::sink_options{.buffer_size = 4'096});
+    ASSERT_TRUE(sink);
+
+    ASSERT_TRUE(sink.value().append(std::span{bytes}.first(3'000)));
+    EXPECT_TRUE(contents().empty());
+    ASSERT_TRUE(sink.value().append(std::span{bytes}.subspan(3'000)));
+    EXPECT_EQ(contents().size(), 4'096);
+    EXPECT_EQ(sink.value().write_count(), 1);
+
+    ASSERT_TRUE(sink.value().flush());
+    EXPECT_EQ(contents(), bytes);
+    EXPECT_EQ(sink.value().write_count(), 2);
+    EXPECT_EQ(sink.value().size(), bytes.size());
+}
+
+TEST_F(FileSinkTest, FlushesOnceTheIntervalExpires)
+{
+    ASSERT_TRUE(open(false));
+    const auto bytes = pattern(100);
+    auto sink = async::file_sink::create(*file_, async::sink_options{.flush_interval = 20ms});
+    ASSERT_TRUE(sink);
+    EXPECT_FALSE(sink.value().time_till_due(std::chrono::steady_clock::now()));
+
+    ASSERT_TRUE(sink.value().append(bytes));
+    const auto now = std::chrono::steady_clock::now();
+    const auto due = sink.value().time_till_due(now);
+    ASSERT_TRUE(due);
+    EXPECT_LE(due.value(), 20ms);
+
+    ASSERT_TRUE(sink.value().flush_if_due(now));
+    EXPECT_TRUE(contents().empty());
+    ASSERT_TRUE(sink.value().flush_if_due(now + 20ms));
+    EXPECT_EQ(contents(), bytes);
+    EXPECT_FALSE(sink.value().pending());
+}
+
+TEST_F(FileSinkTest, SyncsAfterEveryBatch)
+{
+    ASSERT_TRUE(open(false));
+    const auto bytes = pattern(10'000);
+    auto sink = async::file_sink::create(*file_, async::sink_options{.buffer_size = 4'096,
+                                                                      .sync = async::sync_policy::per_batch,
+                                                                      .preallocation_size = 1'024 * 1'024});
+    ASSERT_TRUE(sink);
+    ASSERT_TRUE(sink.value().append(bytes));
+    ASSERT_TRUE(sink.value().flush());
+    EXPECT_EQ(sink.value().write_count(), 3);
+    EXPECT_EQ(sink.value().sync_count(), 3);
+    // the reservation keeps the size of the file
+    EXPECT_EQ(contents(), bytes);
+}
+
+TEST_F(FileSinkTest, DirectIoKeepsTheRealSize)
+{
+    if (!open(true))
+    {
+        GTEST_SKIP() << "the file system does not support direct io";
+    }
+    const auto first = pattern(5'000);
+    const auto second = pattern(4'000, 7);
+    auto expected = first;
+    expected.insert(expected.end(), second.begin(), second.end());
+    {
+        auto sink = async::file_sink::create(*file_, async::sink_options{.buffer_size = 8'192, .direct_io = true});
+        ASSERT_TRUE(sink);
+
+        ASSERT_TRUE(sink.value().append(first));
+        ASSERT_TRUE(sink.value().flush());
+        EXPECT_EQ(contents(), first);
+
+        // the partial block gets written again together with the new bytes
+        ASSERT_TRUE(sink.value().append(second));
+        ASSERT_TRUE(sink.value().flush());
+        EXPECT_EQ(contents(), expected);
+    }
+    EXPECT_EQ(contents(), expected);
+}
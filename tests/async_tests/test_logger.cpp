@@ -0,0 +1,437 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <optional>
+#include <sched.h>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "async/binary_reader.hpp"
+#include "async/logger.hpp"
+#include "unix/affinity.hpp"
+
+#include "read_file.hpp"
+
+namespace
+{
+    constexpr std::size_t lane_capacity{256};
+    constexpr std::size_t producer_count{4};
+    constexpr std::size_t message_count{20'000};
+
+    using async_tests::read_all;
+
+    // the lanes are tiny so the producers overrun the writer all the time
+    class LoggerTest : public testing::TestWithParam<async::overflow_policy>
+    {
+    protected:
+        void SetUp() override
+        {
+            ASSERT_NE(mkdtemp(directory_.data()), nullptr);
+        }
+
+        void TearDown() override
+        {
+            std::remove(path().c_str());
+            rmdir(directory_.c_str());
+        }
+
+        std::string prefix() const { return directory_ + "/log"; }
+
+        std::string path() const { return prefix() + ".0.alog"; }
+
+        std::string directory_{"/tmp/async_logger_XXXXXX"};
+    };
+}
+
+TEST_P(LoggerTest, KeepsTheOrderOfEachProducer)
+{
+    std::size_t logged{0}, dropped{0};
+    {
+        auto created = async::logger<1, lane_capacity>::create(prefix(),
+                                                               async::logger_options{.overflow = GetParam()});
+        ASSERT_TRUE(created);
+        auto &logger = created.value();
+        std::vector<std::size_t> logged_by_producer(producer_count);
+        {
+            std::vector<std::jthread> producers;
+
+            for (std::size_t producer{0}; producer < producer_count; ++producer)
+            {
+                producers.emplace_back([&, producer]
+                {
+                    for (std::size_t index{0}; index < message_count; ++index)
+                    {
+                        logged_by_producer[producer] += logger.log<"%zu %zu\n">(producer, index) ? 1 : 0;
+                    }
+                });
+            }
+        }
+        for (const auto count : logged_by_producer)
+        {
+            logged += count;
+        }
+        ASSERT_TRUE(logger.wait_till_all_popped());
+        EXPECT_EQ(logger.producer_count(), producer_count);
+        EXPECT_EQ(logger.pushed_count(), logged);
+        EXPECT_EQ(logger.popped_count(), logged);
+        dropped = logger.dropped_count();
+        EXPECT_EQ(logged + dropped, producer_count * message_count);
+
+        if (GetParam() != async::overflow_policy::drop_newest)
+        {
+            EXPECT_EQ(dropped, 0);
+        }
+        if (GetParam() != async::overflow_policy::spill)
+        {
+            EXPECT_EQ(logger.spilled_count(), 0);
+        }
+    }
+    const auto bytes = read_all(path());
+    auto opened = async::binary_reader::open(bytes);
+    ASSERT_TRUE(opened);
+    auto &reader = opened.value();
+    std::vector<std::int64_t> last_index(producer_count, -1);
+    std::size_t read{0};
+
+    for (auto next = reader.next(); next && next.value(); next = reader.next())
+    {
+        const auto rendered = async::render(*next.value());
+        ASSERT_TRUE(rendered);
+        std::size_t producer, index;
+        ASSERT_EQ(std::sscanf(rendered.value().c_str(), "%zu %zu", &producer, &index), 2);
+        ASSERT_LT(producer, producer_count);
+        // dropping leaves gaps but never reorders
+        ASSERT_GT(static_cast<std::int64_t>(index), last_index[producer]);
+
+        if (GetParam() != async::overflow_policy::drop_newest)
+        {
+            ASSERT_EQ(static_cast<std::int64_t>(index), last_index[producer] + 1);
+        }
+        last_index[producer] = static_cast<std::int64_t>(index);
+        ++read;
+    }
+    EXPECT_EQ(read, logged);
+}
+
+INSTANTIATE_TEST_SUITE_P(OverflowPolicies, LoggerTest,
+                         testing::Values(async::overflow_policy::block,
+                                         async::overflow_policy::drop_newest,
+                                         async::overflow_policy::spill));
+
+TEST(LoggerStringTest, CopiesTheStringsIntoTheRecords)
+{
+    std::string directory{"/tmp/async_strings_XXXXXX"};
+    ASSERT_NE(mkdtemp(directory.data()), nullptr);
+    const std::string long_text(300, 'x');
+    {
+        auto created = async::logger<1, 16'384>::create(directory + "/log");
+        ASSERT_TRUE(created);
+        auto &logger = created.value();
+        {
+            // gone before the writer gets to the record
+            std::string temporary{"short lived"};
+            ASSERT_TRUE(logger.log<"%s|%s|%s\n">(temporary, std::string_view{"view"}, "literal"));
+            temporary.assign(temporary.size(), '-');
+        }
+        // beyond the inline storage of the producer
+        ASSERT_TRUE(logger.log<"%zu %s\n">(long_text.size(), long_text));
+        // beyond a lane
+        EXPECT_FALSE(logger.log<"%s\n">(std::string(10'000, 'y')));
+        EXPECT_EQ(logger.dropped_count(), 1);
+    }
+    const auto bytes = read_all(directory + "/log.0.alog");
+    auto opened = async::binary_reader::open(bytes);
+    ASSERT_TRUE(opened);
+    std::vector<std::string> rendered;
+
+    for (auto next = opened.value().next(); next && next.value(); next = opened.value().next())
+    {
+        rendered.push_back(async::render(*next.value()).value());
+    }
+    ASSERT_EQ(rendered.size(), 2);
+    EXPECT_EQ(rendered[0], "short lived|view|literal\n");
+    EXPECT_EQ(rendered[1], "300 " + long_text + "\n");
+    std::filesystem::remove_all(directory);
+}
+
+TEST(LoggerLaneTest, ReusesTheLanesOfTheExitedThreads)
+{
+    std::string directory{"/tmp/async_lanes_XXXXXX"};
+    ASSERT_NE(mkdtemp(directory.data()), nullptr);
+    constexpr std::size_t max_producer_count{4};
+    constexpr std::size_t thread_count{max_producer_count * 4};
+    {
+        auto created = async::logger<1, 16'384, max_producer_count>::create(directory + "/log");
+        ASSERT_TRUE(created);
+        auto &logger = created.value();
+        auto other = async::logger<1, 16'384, max_producer_count>::create(directory + "/other");
+        ASSERT_TRUE(other);
+
+        // one after the other, each one gives its lane back on exit
+        for (std::size_t thread{0}; thread < thread_count; ++thread)
+        {
+            std::jthread{[&, thread] { EXPECT_TRUE(logger.log<"%zu\n">(thread)); }}.join();
+        }
+        // switching to another logger gives the lane back too
+        for (std::size_t thread{0}; thread < max_producer_count * 2; ++thread)
+        {
+            ASSERT_TRUE(logger.log<"main %zu\n">(thread));
+            ASSERT_TRUE(other.value().log<"main %zu\n">(thread));
+        }
+        EXPECT_EQ(logger.producer_count(), thread_count + max_producer_count * 2);
+        ASSERT_TRUE(logger.wait_till_all_popped());
+        EXPECT_EQ(logger.popped_count(), thread_count + max_producer_count * 2);
+        EXPECT_EQ(logger.dropped_count(), 0);
+    }
+    const auto bytes = read_all(directory + "/log.0.alog");
+    auto opened = async::binary_reader::open(bytes);
+    ASSERT_TRUE(opened);
+    std::vector<std::string> rendered;
+
+    for (auto next = opened.value().next(); next && next.value(); next = opened.value().next())
+    {
+        rendered.push_back(async::render(*next.value()).value());
+    }
+    ASSERT_EQ(rendered.size(), thread_count + max_producer_count * 2);
+
+    for (std::size_t thread{0}; thread < thread_count; ++thread)
+    {
+        EXPECT_EQ(rendered[thread], std::to_string(thread) + "\n");
+    }
+    std::filesystem::remove_all(directory);
+}
+
+#ifdef __linux__ // see async::writer_placement
+TEST(LoggerPlacementTest, PinsTheWriterThreads)
+{
+    std::string directory{"/tmp/async_placement_XXXXXX"};
+    ASSERT_NE(mkdtemp(directory.data()), nullptr);
+    const auto allowed = unix::cpu_set::of_current_thread();
+    ASSERT_TRUE(allowed);
+    const auto cpu = allowed.value().nth(allowed.value().count() - 1);
+    {
+        const async::logger_options options{.placement = async::writer_placement{.cpus = unix::cpu_set{}.add(cpu)}};
+        auto created = async::logger<1, 16'384>::create(directory + "/log", options);
+        ASSERT_TRUE(created);
+        // the writer got placed before it wrote the record
+        ASSERT_TRUE(created.value().log<"%d\n">(1));
+        ASSERT_TRUE(created.value().wait_till_all_popped());
+        std::size_t writer_count{0};
+
+        for (const auto &task : std::filesystem::directory_iterator{"/proc/self/task"})
+        {
+            const auto bytes = read_all(task.path().string() + "/comm");
+
+            if (std::string_view{reinterpret_cast<const char *>(bytes.data()), bytes.size()} != "log_writer_0\n")
+            {
+                continue;
+            }
+            ++writer_count;
+            cpu_set_t cpus;
+            ASSERT_EQ(sched_getaffinity(std::stoi(task.path().filename().string()), sizeof(cpus), &cpus), 0);
+            EXPECT_EQ(CPU_COUNT(&cpus), 1);
+            EXPECT_TRUE(CPU_ISSET(cpu, &cpus));
+        }
+        EXPECT_EQ(writer_count, 1);
+    }
+    std::filesystem::remove_all(directory);
+}
+#endif
+
+TEST(LoggerFailureTest, DropsInsteadOfBlockingOnceTheWriterFailed)
+{
+    auto created = async::logger<1, lane_capacity>::create("/nonexistent_directory/log");
+    ASSERT_TRUE(created);
+    auto &logger = created.value();
+    std::size_t logged{0};
+
+    // far more than the lane holds, the writer never drains it
+    for (std::size_t index{0}; index < message_count; ++index)
+    {
+        logged += logger.log<"%zu\n">(index) ? 1 : 0;
+    }
+    EXPECT_LT(logged, message_count);
+    EXPECT_EQ(logged + logger.dropped_count(), message_count);
+    EXPECT_FALSE(logger.wait_till_all_popped());
+    EXPECT_FALSE(logger.wait_till_all_popped_for(std::chrono::seconds{10}));
+    EXPECT_EQ(logger.popped_count(), 0);
+}
+
+TEST(LoggerFailureTest, DropsInsteadOfSpillingOnceTheWriterFailed)
+{
+    const async::logger_options options{.overflow = async::overflow_policy::spill};
+    auto created = async::logger<1, lane_capacity>::create("/nonexistent_directory/log", options);
+    ASSERT_TRUE(created);
+    auto &logger = created.value();
+    ASSERT_TRUE(logger.log<"%d\n">(0));
+    // returns once the writer failed
+    ASSERT_FALSE(logger.wait_till_all_popped());
+    std::size_t logged{0};
+
+    for (std::size_t index{0}; index < message_count; ++index)
+    {
+        logged += logger.log<"%zu\n">(index) ? 1 : 0;
+    }
+    EXPECT_LT(logged, message_count);
+    EXPECT_EQ(logger.spilled_count(), 0);
+    EXPECT_EQ(logged + logger.dropped_count(), message_count);
+}
+
+TEST(LaneTest, SpillsNoMoreThanTheLimit)
+{
+    async::lane<lane_capacity> lane;
+    const std::vector<std::byte> message(10);
+    constexpr std::size_t max_size{5 * (sizeof(std::size_t) + 10) + 1};
+    std::size_t spilled{0};
+
+    while (lane.spill(message, max_size))
+    {
+        ++spilled;
+    }
+    EXPECT_EQ(spilled, 5);
+    EXPECT_EQ(lane.spilled_count, 5);
+    std::vector<std::byte> records;
+    lane.take_overflow(records);
+    // the writer empties the overflow, it takes records again
+    EXPECT_TRUE(lane.spill(message, max_size));
+}
+
+TEST(LoggerRotationTest, CompressesTheFinishedSegmentsAndKeepsTheNewest)
+{
+    if (std::system("command -v gzip > /dev/null") != 0)
+    {
+        GTEST_SKIP() << "gzip is not installed";
+    }
+    std::string directory{"/tmp/async_rotation_XXXXXX"};
+    ASSERT_NE(mkdtemp(directory.data()), nullptr);
+    constexpr std::size_t retained_count{3};
+    {
+        const async::logger_options options{
+            .sink = async::sink_options{.buffer_size = 16 * 1'024},
+            .rotation = async::rotation_options{.max_segment_size = 32 * 1'024,
+                                                .compress_command = "gzip",
+                                                .max_segment_count = retained_count}};
+        auto created = async::logger<1, 16'384>::create(directory + "/log", options);
+        ASSERT_TRUE(created);
+
+        for (std::size_t index{0}; index < message_count; ++index)
+        {
+            ASSERT_TRUE(created.value().log<"%zu\n">(index));
+        }
+    }
+    std::size_t compressed{0}, plain{0};
+    std::string active;
+
+    for (const auto &entry : std::filesystem::directory_iterator{directory})
+    {
+        const auto name = entry.path().filename().string();
+
+        if (name.ends_with(".alog.gz"))
+        {
+            ++compressed;
+        }
+        else if (name.ends_with(".alog"))
+        {
+            ++plain;
+            active = entry.path().string();
+        }
+    }
+    EXPECT_EQ(compressed, retained_count);
+    // the segment written last is left as it is, unless the run ended right after a rotation
+    ASSERT_LE(plain, 1);
+
+    if (plain == 0)
+    {
+        std::filesystem::remove_all(directory);
+        return;
+    }
+    const auto bytes = read_all(active);
+    auto opened = async::binary_reader::open(bytes);
+    ASSERT_TRUE(opened);
+    const auto last = [&]
+    {
+        std::optional<std::string> rendered;
+
+        for (auto next = opened.value().next(); next && next.value(); next = opened.value().next())
+        {
+            rendered = async::render(*next.value()).value();
+        }
+        return rendered;
+    }();
+    ASSERT_TRUE(last);
+    EXPECT_EQ(last.value(), std::to_string(message_count - 1) + "\n");
+    std::filesystem::remove_all(directory);
+}
+
+TEST(LoggerRotationTest, ContinuesAfterTheSegmentsOfTheEarlierRuns)
+{
+    std::string directory{"/tmp/async_restart_XXXXXX"};
+    ASSERT_NE(mkdtemp(directory.data()), nullptr);
+    const auto run = [&](std::string_view text, std::size_t retained_count)
+    {
+        const async::logger_options options{
+            .sink = async::sink_options{.buffer_size = 16 * 1'024},
+            .rotation = async::rotation_options{.max_segment_size = 32 * 1'024, .max_segment_count = retained_count}};
+        auto created = async::logger<1, 16'384>::create(directory + "/log", options);
+        ASSERT_TRUE(created);
+
+        for (std::size_t index{0}; index < message_count; ++index)
+        {
+            ASSERT_TRUE(created.value().log<"%s %zu\n">(text, index));
+        }
+    };
+    const auto first_records = [&]()
+    {
+        std::vector<std::string> firsts;
+
+        for (const auto &entry : std::filesystem::directory_iterator{directory})
+        {
+            const auto bytes = read_all(entry.path().string());
+            auto opened = async::binary_reader::open(bytes);
+
+            if (!opened)
+            {
+                ADD_FAILURE() << entry.path() << " is not a log file";
+                continue;
+            }
+            const auto next = opened.value().next();
+
+            // no segment is left without records
+            if (!next || !next.value())
+            {
+                ADD_FAILURE() << entry.path() << " holds no record";
+                continue;
+            }
+            firsts.push_back(async::render(*next.value()).value());
+        }
+        return firsts;
+    };
+    run("first", 100);
+    const auto first_run = first_records();
+    ASSERT_GT(first_run.size(), 2);
+    run("second", 100);
+    const auto both_runs = first_records();
+    EXPECT_GT(std::ranges::count_if(both_runs, [](const auto &record) { return record.starts_with("second "); }), 1);
+    // nothing of the first run got overwritten
+    EXPECT_EQ(std::ranges::count_if(both_runs, [](const auto &record) { return record.starts_with("first "); }),
+              first_run.size());
+    EXPECT_TRUE(std::ranges::find(both_runs, "first 0\n") != both_runs.end());
+    // the retention covers the earlier runs too
+    run("third", 2);
+    // the two finished segments kept, and the one written last unless the run ended right after a rotation
+    const auto after_retention = first_records();
+    EXPECT_GE(after_retention.size(), 2);
+    EXPECT_LE(after_retention.size(), 3);
+    EXPECT_EQ(std::ranges::count_if(after_retention, [](const auto &record) { return record.starts_with("third "); }),
+              after_retention.size());
+    std::filesystem::remove_all(directory);
+}
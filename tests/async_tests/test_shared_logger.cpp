@@ -0,0 +1,202 @@
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <filesystem>
+#include <signal.h>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "async/binary_reader.hpp"
+#include "async/shared_logger.hpp"
+#include "unix/process.hpp"
+
+#include "read_file.hpp"
+
+#ifdef __linux__ // see async/shared_logger.hpp
+namespace
+{
+    constexpr std::size_t lane_capacity{1'024};
+    constexpr std::size_t process_count{4};
+    constexpr std::size_t thread_count{2};
+    constexpr std::size_t message_count{10'000};
+
+    using logger_type = async::shared_logger<lane_capacity>;
+
+    using async_tests::read_all;
+
+    // the children log from a few threads each and exit without touching the logger
+    void fork_producers(logger_type &logger, std::size_t count)
+    {
+        for (std::size_t process{0}; process < process_count; ++process)
+        {
+            const auto child = unix::create_process();
+            ASSERT_TRUE(child);
+
+            if (unix::is_child_process(child.value()))
+            {
+                std::vector<std::jthread> threads;
+
+                for (std::size_t thread{0}; thread < thread_count; ++thread)
+                {
+                    threads.emplace_back([&logger, count, producer = process * thread_count + thread]
+                    {
+                        const std::string name{"producer"};
+
+                        for (std::size_t index{0}; index < count; ++index)
+                        {
+                            logger.log<"%s %zu %zu\n">(name, producer, index);
+                        }
+                    });
+                }
+                threads.clear();
+                _exit(EXIT_SUCCESS);
+            }
+        }
+        for (std::size_t process{0}; process < process_count; ++process)
+        {
+            int status;
+            ASSERT_TRUE(unix::wait_till_child_terminates(&status));
+            ASSERT_FALSE(unix::terminated_abnormally(status));
+        }
+    }
+
+    class SharedLoggerTest : public testing::Test
+    {
+    protected:
+        void SetUp() override
+        {
+            ASSERT_NE(mkdtemp(directory_.data()), nullptr);
+        }
+
+        void TearDown() override
+        {
+            std::filesystem::remove_all(directory_);
+        }
+
+        std::string directory_{"/tmp/async_shared_logger_XXXXXX"};
+    };
+}
+
+TEST_F(SharedLoggerTest, CollectsTheRecordsOfAllTheProcesses)
+{
+    const auto prefix = directory_ + "/log";
+    constexpr std::size_t producer_count{process_count * thread_count};
+    {
+        auto created = logger_type::create(async::shared_logger_options{.collector = {.path_prefix = prefix}});
+        ASSERT_TRUE(created);
+        auto &logger = created.value();
+        fork_producers(logger, message_count);
+        // the lanes of the exited children are free again
+        ASSERT_TRUE(logger.log<"%s %zu %zu\n">("creator", producer_count, std::size_t{0}));
+        ASSERT_TRUE(logger.wait_till_all_popped_for(std::chrono::seconds{10}));
+        EXPECT_EQ(logger.pushed_count(), producer_count * message_count + 1);
+        EXPECT_EQ(logger.popped_count(), logger.pushed_count());
+        EXPECT_EQ(logger.dropped_count(), 0);
+    }
+    const auto bytes = read_all(prefix + ".0.alog");
+    auto opened = async::binary_reader::open(bytes);
+    ASSERT_TRUE(opened);
+    auto &reader = opened.value();
+    std::vector<std::int64_t> last_index(producer_count + 1, -1);
+    std::size_t read{0};
+
+    for (auto next = reader.next(); next && next.value(); next = reader.next())
+    {
+        const auto rendered = async::render(*next.value());
+        ASSERT_TRUE(rendered);
+        char name[16];
+        std::size_t producer, index;
+        ASSERT_EQ(std::sscanf(rendered.value().c_str(), "%15s %zu %zu", name, &producer, &index), 3);
+        ASSERT_LE(producer, producer_count);
+        EXPECT_STREQ(name, producer == producer_count ? "creator" : "producer");
+        ASSERT_EQ(static_cast<std::int64_t>(index), last_index[producer] + 1);
+        last_index[producer] = static_cast<std::int64_t>(index);
+        ++read;
+    }
+    EXPECT_EQ(read, producer_count * message_count + 1);
+}
+
+TEST_F(SharedLoggerTest, RendersTheTextIntoTheDescriptor)
+{
+    const auto path = directory_ + "/log.txt";
+    const auto descriptor = ::open(path.c_str(), O_CREAT | O_WRONLY | O_TRUNC, 0644);
+    ASSERT_NE(descriptor, -1);
+    {
+        auto created = logger_type::create(async::shared_logger_options{.collector = {.text_descriptor = descriptor}});
+        ASSERT_TRUE(created);
+        auto &logger = created.value();
+        ASSERT_TRUE(logger.log<"first %d\n">(1));
+        ASSERT_TRUE(logger.wait_till_all_popped_for(std::chrono::seconds{10}));
+        fork_producers(logger, 1);
+        ASSERT_TRUE(logger.log<"last %.1f\n">(2.5));
+    }
+    ::close(descriptor);
+    const auto bytes = read_all(path);
+    const std::string text{reinterpret_cast<const char *>(bytes.data()), bytes.size()};
+    EXPECT_TRUE(text.starts_with("first 1\n"));
+    EXPECT_TRUE(text.ends_with("last 2.5\n"));
+
+    for (std::size_t producer{0}; producer < process_count * thread_count; ++producer)
+    {
+        EXPECT_NE(text.find("producer " + std::to_string(producer) + " 0\n"), std::string::npos);
+    }
+}
+
+TEST_F(SharedLoggerTest, ReportsTheFailuresOfTheCollector)
+{
+    const auto missing = logger_type::create(
+        async::shared_logger_options{.collector = {.path_prefix = directory_ + "/missing/log"}});
+    ASSERT_FALSE(missing);
+    EXPECT_EQ(missing.error().code, ENOENT);
+
+    const auto spilling = logger_type::create(async::shared_logger_options{.overflow = async::overflow_policy::spill});
+    ASSERT_FALSE(spilling);
+    EXPECT_EQ(spilling.error().code, EINVAL);
+}
+
+TEST_F(SharedLoggerTest, StopsBlockingOnceTheCollectorGotKilled)
+{
+    const auto path = directory_ + "/log.txt";
+    const auto descriptor = ::open(path.c_str(), O_CREAT | O_WRONLY | O_TRUNC, 0644);
+    ASSERT_NE(descriptor, -1);
+    {
+        auto created = logger_type::create(async::shared_logger_options{.collector = {.text_descriptor = descriptor}});
+        ASSERT_TRUE(created);
+        auto &logger = created.value();
+        ASSERT_EQ(::kill(logger.collector_process_id(), SIGKILL), 0);
+        // the lane fills up, then the blocked message gets dropped instead of waiting forever
+        std::size_t logged{0};
+
+        while (logger.log<"%zu\n">(logged))
+        {
+            ++logged;
+        }
+        EXPECT_LE(logged, lane_capacity);
+        EXPECT_EQ(logger.dropped_count(), 1);
+        EXPECT_FALSE(logger.wait_till_all_popped_for(std::chrono::seconds{10}));
+    }
+    ::close(descriptor);
+}
+
+TEST_F(SharedLoggerTest, ClosesTheDescriptorsOfTheCreatorInTheCollector)
+{
+    int ends[2];
+    ASSERT_EQ(::pipe2(ends, O_NONBLOCK), 0);
+    {
+        auto created = logger_type::create();
+        ASSERT_TRUE(created);
+        ::close(ends[1]);
+        // end of file, the collector holds no copy of the write end
+        char byte;
+        EXPECT_EQ(::read(ends[0], &byte, 1), 0);
+    }
+    ::close(ends[0]);
+}
+#endif
@@ -0,0 +1,61 @@
+#include <cstdint>
+#include <string>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include "async/stdout_logger.hpp"
+
+namespace
+{
+    // runs the logging with stdout redirected into a pipe, returns what got written
+    template <class Log>
+    std::string capture_stdout(Log log)
+    {
+        int descriptors[2];
+        EXPECT_EQ(::pipe(descriptors), 0);
+        const auto saved = ::dup(STDOUT_FILENO);
+        ::dup2(descriptors[1], STDOUT_FILENO);
+        ::close(descriptors[1]);
+
+        log();
+
+        ::dup2(saved, STDOUT_FILENO);
+        ::close(saved);
+        std::string output;
+        char buffer[4'096];
+
+        for (auto count = ::read(descriptors[0], buffer, sizeof(buffer)); count > 0;
+             count = ::read(descriptors[0], buffer, sizeof(buffer)))
+        {
+            output.append(buffer, static_cast<std::size_t>(count));
+        }
+        ::close(descriptors[0]);
+        return output;
+    }
+} // namespace
+
+TEST(StdoutLoggerTest, RendersTheArgumentsByTheirLoggedTypes)
+{
+    auto logger = async::stdout_logger::create();
+    ASSERT_TRUE(logger);
+
+    const auto output = capture_stdout(
+        [&]()
+        {
+            // the length modifiers do not match the arguments, they must not reach printf as they are
+            EXPECT_TRUE((logger->log<"%hhd %ld %s %c %.2f\n">(std::int64_t{-300}, std::uint8_t{7}, "text", 'x', 1.5f)));
+            EXPECT_TRUE((logger->log<"%*d|%%\n">(4, 12)));
+        });
+    EXPECT_EQ(output, "-300 7 text x 1.50\n  12|%\n");
+}
+
+TEST(StdoutLoggerTest, TruncatesTheLongMessages)
+{
+    auto logger = async::stdout_logger::create();
+    ASSERT_TRUE(logger);
+    const std::string text(4'096, 'a');
+
+    const auto output = capture_stdout([&]() { EXPECT_TRUE((logger->log<"%s">(text.c_str()))); });
+    EXPECT_EQ(output.size(), 1'024u);
+}
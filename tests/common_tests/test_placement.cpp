@@ -0,0 +1,101 @@
+#include <array>
+#include <cstdlib>
+#include <sched.h>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include "unix/process.hpp"
+
+#include "common/placement.hpp"
+
+namespace
+{
+    // argv as main gets it
+    template <std::size_t Count>
+    std::span<char *const> arguments_of(std::array<std::string, Count> &args, std::array<char *, Count> &argv)
+    {
+        for (std::size_t index{0}; index < Count; ++index)
+        {
+            argv[index] = args[index].data();
+        }
+        return argv;
+    }
+} // namespace
+
+TEST(PlacementTest, FindsTheCpusOfTheRole)
+{
+    std::array<std::string, 4> args{"app", "--producer-cpus=0-1", "--consumer-cpus=2,4", "--verbose"};
+    std::array<char *, 4> argv;
+    const auto parsed = arguments_of(args, argv);
+
+    EXPECT_EQ(common::find_cpu_option(parsed, "producer"), "0-1");
+    EXPECT_EQ(common::find_cpu_option(parsed, "consumer"), "2,4");
+    EXPECT_TRUE(common::find_cpu_option(parsed, "parent").empty());
+}
+
+TEST(PlacementTest, MatchesTheWholeOptionName)
+{
+    std::array<std::string, 4> args{"app", "--consumer-cpus", "--consumer-cpus-extra=1", "consumer-cpus=3"};
+    std::array<char *, 4> argv;
+    const auto parsed = arguments_of(args, argv);
+
+    EXPECT_TRUE(common::find_cpu_option(parsed, "consumer").empty());
+    EXPECT_TRUE(common::find_cpu_option(parsed, "cons").empty());
+}
+
+TEST(PlacementTest, TakesTheFirstOccurrence)
+{
+    std::array<std::string, 3> args{"--parent-cpus=1", "--parent-cpus=2", "--parent-cpus="};
+    std::array<char *, 3> argv;
+    EXPECT_EQ(common::find_cpu_option(arguments_of(args, argv), "parent"), "1");
+}
+
+TEST(PlacementTest, KeepsTheAffinityWithoutTheOption)
+{
+    // an empty list counts as no option
+    std::array<std::string, 3> args{"app", "--producer-cpus=0", "--consumer-cpus="};
+    std::array<char *, 3> argv;
+    EXPECT_TRUE(common::place_by_role(arguments_of(args, argv), "consumer"));
+}
+
+#ifdef __linux__ // see common/placement.hpp
+TEST(PlacementTest, RejectsInvalidCpuLists)
+{
+    for (const std::string list : {"a", "3-1", "1,", "-1", "99999"})
+    {
+        std::array<std::string, 1> args{"--consumer-cpus=" + list};
+        std::array<char *, 1> argv;
+        EXPECT_FALSE(common::place_by_role(arguments_of(args, argv), "consumer")) << list;
+    }
+}
+
+TEST(PlacementTest, PinsTheProcessToTheCpusOfTheRole)
+{
+    const auto child = unix::create_process();
+    ASSERT_TRUE(child);
+
+    // the affinity stays with the process, so the child gets pinned
+    if (unix::is_child_process(child.value()))
+    {
+        const auto cpu = std::to_string(sched_getcpu());
+        std::array<std::string, 1> args{"--consumer-cpus=" + cpu};
+        std::array<char *, 1> argv;
+
+        if (!common::place_by_role(arguments_of(args, argv), "consumer"))
+        {
+            _exit(EXIT_FAILURE);
+        }
+        cpu_set_t pinned;
+        const auto ret = sched_getaffinity(0, sizeof(pinned), &pinned);
+        _exit(ret == 0 && CPU_COUNT(&pinned) == 1 && CPU_ISSET(std::stoi(cpu), &pinned) ? EXIT_SUCCESS
+                                                                                         : EXIT_FAILURE);
+    }
+    const auto status = unix::wait_till_child_terminates(child.value());
+    ASSERT_TRUE(status);
+    EXPECT_FALSE(unix::terminated_abnormally(status.value()));
+}
+#endif
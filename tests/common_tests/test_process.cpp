@@ -0,0 +1,198 @@
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstddef>
+#include <cstdlib>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "common/process.hpp"
+
+namespace
+{
+    using namespace std::chrono_literals;
+
+    constexpr std::chrono::milliseconds grace_period{100};
+
+    // the children block reading the wake pipe, closing its write end wakes them all,
+    // they report being ready through the other pipe
+    class ProcessTest : public testing::Test
+    {
+    protected:
+        void SetUp() override
+        {
+            ASSERT_EQ(::pipe(wake_), 0);
+            ASSERT_EQ(::pipe(ready_), 0);
+        }
+
+        void TearDown() override
+        {
+            wake_children();
+            ::close(wake_[0]);
+            ::close(ready_[0]);
+            ::close(ready_[1]);
+        }
+
+        // the child exits with the given status once woken, or never when ignoring the wake
+        std::vector<unix::process_id_t> start_children(std::size_t count, int exit_status,
+                                                       bool ignores_termination = false,
+                                                       bool ignores_wake = false)
+        {
+            std::vector<unix::process_id_t> child_ids;
+
+            for (std::size_t child{0}; child < count; ++child)
+            {
+                const auto created = unix::create_process();
+
+                if (!created)
+                {
+                    ADD_FAILURE() << unix::to_string(created.error());
+                    break;
+                }
+                if (created.value() == 0)
+                {
+                    ::close(wake_[1]);
+
+                    if (ignores_termination)
+                    {
+                        std::signal(SIGTERM, SIG_IGN);
+                    }
+                    const char ready{1};
+                    (void)::write(ready_[1], &ready, sizeof(ready));
+                    char ignored;
+
+                    while (ignores_wake || ::read(wake_[0], &ignored, sizeof(ignored)) > 0)
+                    {
+                        ::pause();
+                    }
+                    ::_exit(exit_status);
+                }
+                child_ids.push_back(created.value());
+            }
+            // the signal dispositions are in place once all of them are ready
+            for (std::size_t child{0}; child < child_ids.size(); ++child)
+            {
+                char ready;
+                EXPECT_EQ(::read(ready_[0], &ready, sizeof(ready)), 1);
+            }
+            return child_ids;
+        }
+
+        void wake_children() noexcept
+        {
+            if (wake_[1] != -1)
+            {
+                ::close(wake_[1]);
+                wake_[1] = -1;
+            }
+        }
+
+        static bool was_reaped(unix::process_id_t child_id) noexcept
+        {
+            int status;
+            return ::waitpid(child_id, &status, WNOHANG) == -1 && errno == ECHILD;
+        }
+
+    private:
+        int wake_[2]{-1, -1};
+        int ready_[2]{-1, -1};
+    };
+} // namespace
+
+TEST_F(ProcessTest, TerminateChildrenKillsTheOnesIgnoringTheRequest)
+{
+    auto child_ids = start_children(1, EXIT_SUCCESS, true, true);
+    const auto cooperative_ids = start_children(1, EXIT_SUCCESS, false, true);
+    child_ids.insert(child_ids.end(), cooperative_ids.begin(), cooperative_ids.end());
+    ASSERT_EQ(child_ids.size(), 2);
+    const auto started = std::chrono::steady_clock::now();
+
+    EXPECT_TRUE(common::terminate_children(child_ids, grace_period));
+    // the one ignoring the request outlived the grace period
+    EXPECT_GE(std::chrono::steady_clock::now() - started, grace_period);
+
+    for (const auto child_id : child_ids)
+    {
+        EXPECT_TRUE(was_reaped(child_id));
+    }
+}
+
+TEST_F(ProcessTest, ShutDownChildrenSucceedsOnceTheWokenChildrenExit)
+{
+    const auto child_ids = start_children(3, EXIT_SUCCESS);
+    ASSERT_EQ(child_ids.size(), 3);
+
+    EXPECT_TRUE(common::shut_down_children(child_ids, [this]() { wake_children(); }, 5s));
+
+    for (const auto child_id : child_ids)
+    {
+        EXPECT_TRUE(was_reaped(child_id));
+    }
+}
+
+TEST_F(ProcessTest, ShutDownChildrenReportsTheAbnormalTerminations)
+{
+    auto child_ids = start_children(2, EXIT_SUCCESS);
+    const auto failing_ids = start_children(1, EXIT_FAILURE);
+    child_ids.insert(child_ids.end(), failing_ids.begin(), failing_ids.end());
+    ASSERT_EQ(child_ids.size(), 3);
+
+    EXPECT_FALSE(common::shut_down_children(child_ids, [this]() { wake_children(); }, 5s));
+
+    for (const auto child_id : child_ids)
+    {
+        EXPECT_TRUE(was_reaped(child_id));
+    }
+}
+
+TEST_F(ProcessTest, ShutDownChildrenEscalatesToKillingTheStuckOnes)
+{
+    auto child_ids = start_children(1, EXIT_SUCCESS);
+    const auto stuck_ids = start_children(1, EXIT_SUCCESS, true, true);
+    child_ids.insert(child_ids.end(), stuck_ids.begin(), stuck_ids.end());
+    ASSERT_EQ(child_ids.size(), 2);
+    const auto started = std::chrono::steady_clock::now();
+
+    EXPECT_FALSE(common::shut_down_children(child_ids, [this]() { wake_children(); }, grace_period));
+    // one grace period to terminate on their own, another after the termination request
+    EXPECT_GE(std::chrono::steady_clock::now() - started, 2 * grace_period);
+
+    for (const auto child_id : child_ids)
+    {
+        EXPECT_TRUE(was_reaped(child_id));
+    }
+}
+
+TEST_F(ProcessTest, TimedWaitKeepsTheRunningChildren)
+{
+    auto child_ids = start_children(2, EXIT_SUCCESS);
+    ASSERT_EQ(child_ids.size(), 2);
+    std::size_t abnormal_count{0};
+
+    EXPECT_FALSE(common::wait_till_children_terminate_for(child_ids, abnormal_count, 20ms));
+    EXPECT_EQ(child_ids.size(), 2);
+
+    wake_children();
+    EXPECT_TRUE(common::wait_till_children_terminate_for(child_ids, abnormal_count, 5s));
+    EXPECT_TRUE(child_ids.empty());
+    EXPECT_EQ(abnormal_count, 0);
+}
+
+TEST_F(ProcessTest, TimedWaitForAllChildrenReturnsOnceNoneIsLeft)
+{
+    const auto child_ids = start_children(2, EXIT_FAILURE);
+    ASSERT_EQ(child_ids.size(), 2);
+
+    EXPECT_FALSE(common::wait_till_all_children_terminate_for(20ms));
+
+    wake_children();
+    EXPECT_TRUE(common::wait_till_all_children_terminate_for(5s));
+
+    for (const auto child_id : child_ids)
+    {
+        EXPECT_TRUE(was_reaped(child_id));
+    }
+}
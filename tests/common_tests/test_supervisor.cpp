@@ -0,0 +1,184 @@
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <csignal>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include "common/supervisor.hpp"
+
+namespace
+{
+    constexpr std::size_t max_worker_count{256};
+    constexpr std::chrono::seconds grace_period{5};
+
+    // counters seen by the forked workers and the test alike
+    struct shared_counters
+    {
+        std::atomic<int> attempts[max_worker_count];
+        std::atomic<int> ready;
+    };
+
+    class SupervisorTest : public testing::Test
+    {
+    protected:
+        void SetUp() override
+        {
+            void *memory = mmap(nullptr, sizeof(shared_counters), PROT_READ | PROT_WRITE,
+                                MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+            ASSERT_NE(memory, MAP_FAILED);
+            counters_ = new (memory) shared_counters{};
+        }
+
+        void TearDown() override
+        {
+            munmap(counters_, sizeof(shared_counters));
+        }
+
+        void wait_till_ready(int count) const
+        {
+            while (counters_->ready.load() < count)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds{1});
+            }
+        }
+
+        shared_counters *counters_{nullptr};
+    };
+
+    constexpr common::restart_policy fast_restarts{std::chrono::milliseconds{10},
+                                                   std::chrono::milliseconds{40},
+                                                   std::chrono::seconds{10}, 3};
+}
+
+TEST_F(SupervisorTest, WatchesHundredsOfWorkersTillTheyFinish)
+{
+    auto created = common::supervisor<int (*)(std::size_t)>::create(
+        [](std::size_t) { return EXIT_SUCCESS; });
+    ASSERT_TRUE(created);
+    auto &supervisor = created.value();
+
+    ASSERT_TRUE(supervisor.start(200));
+    EXPECT_TRUE(supervisor.run(grace_period));
+
+    ASSERT_EQ(supervisor.workers().size(), 200);
+    for (const auto &worker : supervisor.workers())
+    {
+        EXPECT_EQ(worker.state, common::worker_state::finished);
+        EXPECT_EQ(worker.restart_count, 0);
+    }
+}
+
+TEST_F(SupervisorTest, RestartsCrashedWorkersWithBackoff)
+{
+    auto *counters = counters_;
+    const auto crash_twice = [counters](std::size_t index)
+    {
+        const auto attempt = counters->attempts[index].fetch_add(1);
+
+        if (attempt == 0)
+        {
+            raise(SIGKILL);
+        }
+        return attempt == 1 ? EXIT_FAILURE : EXIT_SUCCESS;
+    };
+    auto created = common::supervisor<decltype(crash_twice)>::create(crash_twice, fast_restarts);
+    ASSERT_TRUE(created);
+    auto &supervisor = created.value();
+    const auto started = std::chrono::steady_clock::now();
+
+    ASSERT_TRUE(supervisor.start(4));
+    EXPECT_TRUE(supervisor.run(grace_period));
+
+    // the first restart waits 10 ms, the second one twice as long
+    EXPECT_GE(std::chrono::steady_clock::now() - started, std::chrono::milliseconds{30});
+    for (std::size_t index{0}; index < 4; ++index)
+    {
+        const auto &worker = supervisor.workers()[index];
+        EXPECT_EQ(worker.state, common::worker_state::finished);
+        EXPECT_EQ(worker.restart_count, 2);
+        EXPECT_EQ(counters_->attempts[index].load(), 3);
+    }
+}
+
+TEST_F(SupervisorTest, GivesUpOnWorkersFailingRepeatedly)
+{
+    auto created = common::supervisor<int (*)(std::size_t)>::create(
+        [](std::size_t index) { return index == 0 ? EXIT_FAILURE : EXIT_SUCCESS; }, fast_restarts);
+    ASSERT_TRUE(created);
+    auto &supervisor = created.value();
+
+    ASSERT_TRUE(supervisor.start(2));
+    EXPECT_FALSE(supervisor.run(grace_period));
+
+    const auto &failing = supervisor.workers()[0];
+    EXPECT_EQ(failing.state, common::worker_state::failed);
+    EXPECT_EQ(failing.restart_count, fast_restarts.max_restarts);
+    EXPECT_TRUE(WIFEXITED(failing.last_status));
+    EXPECT_EQ(supervisor.workers()[1].state, common::worker_state::finished);
+}
+
+TEST_F(SupervisorTest, ShutdownSignalTerminatesTheWorkers)
+{
+    auto *counters = counters_;
+    const auto wait_for_termination = [counters](std::size_t)
+    {
+        counters->ready.fetch_add(1);
+
+        while (true)
+        {
+            pause();
+        }
+        return EXIT_SUCCESS;
+    };
+    auto created = common::supervisor<decltype(wait_for_termination)>::create(wait_for_termination);
+    ASSERT_TRUE(created);
+    auto &supervisor = created.value();
+
+    ASSERT_TRUE(supervisor.start(16));
+    wait_till_ready(16);
+    // blocked by the supervisor, so it stays pending for its signal descriptor
+    ASSERT_EQ(raise(SIGTERM), 0);
+    EXPECT_FALSE(supervisor.run(grace_period));
+
+    for (const auto &worker : supervisor.workers())
+    {
+        EXPECT_EQ(worker.state, common::worker_state::finished);
+        EXPECT_TRUE(WIFSIGNALED(worker.last_status));
+        EXPECT_EQ(WTERMSIG(worker.last_status), SIGTERM);
+    }
+}
+
+TEST_F(SupervisorTest, KillsWorkersIgnoringTerminationAfterGracePeriod)
+{
+    auto *counters = counters_;
+    const auto ignore_termination = [counters](std::size_t)
+    {
+        signal(SIGTERM, SIG_IGN);
+        counters->ready.fetch_add(1);
+
+        while (true)
+        {
+            pause();
+        }
+        return EXIT_SUCCESS;
+    };
+    auto created = common::supervisor<decltype(ignore_termination)>::create(ignore_termination);
+    ASSERT_TRUE(created);
+    auto &supervisor = created.value();
+
+    ASSERT_TRUE(supervisor.start(8));
+    wait_till_ready(8);
+    EXPECT_FALSE(supervisor.shut_down(std::chrono::milliseconds{50}));
+
+    for (const auto &worker : supervisor.workers())
+    {
+        EXPECT_EQ(worker.state, common::worker_state::finished);
+        EXPECT_TRUE(WIFSIGNALED(worker.last_status));
+        EXPECT_EQ(WTERMSIG(worker.last_status), SIGKILL);
+    }
+}
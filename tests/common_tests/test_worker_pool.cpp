@@ -0,0 +1,106 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "unix/ipc/posix/pipe.hpp"
+#include "unix/process.hpp"
+
+#include "common/worker_pool.hpp"
+
+namespace
+{
+    constexpr std::size_t worker_count{4};
+    constexpr std::chrono::seconds grace_period{5};
+    // makes the worker receiving it exit with a failure
+    constexpr int failing_job{-1};
+
+    int increment(int job) noexcept
+    {
+        if (job == failing_job)
+        {
+            _exit(EXIT_FAILURE);
+        }
+        return job + 1;
+    }
+}
+
+TEST(WorkerPoolTest, ReturnsTheResultOfEachSubmittedJob)
+{
+    constexpr int job_count{64};
+    auto jobs = unix::ipc::posix::pipe::create();
+    auto results = unix::ipc::posix::pipe::create();
+    ASSERT_TRUE(jobs && results);
+    common::worker_pool<int, int> pool{jobs.value(), results.value()};
+    ASSERT_TRUE(pool.start(worker_count, increment));
+    ASSERT_EQ(pool.worker_ids().size(), worker_count);
+
+    for (int job{0}; job < job_count; ++job)
+    {
+        ASSERT_TRUE(pool.submit(job));
+    }
+    std::vector<int> received;
+
+    for (int job{0}; job < job_count; ++job)
+    {
+        const auto result = pool.receive();
+        ASSERT_TRUE(result);
+        received.push_back(result.value());
+    }
+    // the results arrive in completion order
+    std::ranges::sort(received);
+
+    for (int job{0}; job < job_count; ++job)
+    {
+        EXPECT_EQ(received[job], increment(job));
+    }
+    EXPECT_TRUE(pool.shut_down(grace_period));
+    EXPECT_TRUE(pool.worker_ids().empty());
+}
+
+TEST(WorkerPoolTest, LeavesTheOtherChildrenAlone)
+{
+    const auto other = unix::create_process();
+    ASSERT_TRUE(other);
+
+    if (unix::is_child_process(other.value()))
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds{200});
+        _exit(EXIT_SUCCESS);
+    }
+    auto jobs = unix::ipc::posix::pipe::create();
+    auto results = unix::ipc::posix::pipe::create();
+    ASSERT_TRUE(jobs && results);
+    common::worker_pool<int, int> pool{jobs.value(), results.value()};
+    ASSERT_TRUE(pool.start(worker_count, increment));
+
+    for (int job{0}; job < 8; ++job)
+    {
+        ASSERT_TRUE(pool.submit(job));
+    }
+    for (int job{0}; job < 8; ++job)
+    {
+        ASSERT_TRUE(pool.receive());
+    }
+    ASSERT_TRUE(pool.shut_down(grace_period));
+    // still running or at least not reaped by the pool
+    const auto status = unix::wait_till_child_terminates(other.value());
+    ASSERT_TRUE(status);
+    EXPECT_FALSE(unix::terminated_abnormally(status.value()));
+}
+
+TEST(WorkerPoolTest, ReportsAWorkerExitingWithAFailure)
+{
+    auto jobs = unix::ipc::posix::pipe::create();
+    auto results = unix::ipc::posix::pipe::create();
+    ASSERT_TRUE(jobs && results);
+    common::worker_pool<int, int> pool{jobs.value(), results.value()};
+    ASSERT_TRUE(pool.start(worker_count, increment));
+    ASSERT_TRUE(pool.submit(failing_job));
+    EXPECT_FALSE(pool.shut_down(grace_period));
+    EXPECT_TRUE(pool.worker_ids().empty());
+}
@@ -0,0 +1,100 @@
+#include <array>
+#include <optional>
+#include <utility>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <unistd.h>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "unix/ipc/system_v/group_notifier.hpp"
+#include "unix/ipc/system_v/semaphore_set.hpp"
+#include "unix/permissions_builder.hpp"
+#include "unix/process.hpp"
+
+#include "buffering/role/parent.hpp"
+
+namespace
+{
+    constexpr std::size_t producer_count{3};
+
+    // the producers take their token the way buffering::occupation::producer does,
+    // the crashing one exits while holding it, so the kernel gives it back
+    std::vector<unix::process_id_t> start_producers(const unix::ipc::system_v::group_notifier &producers_notifier,
+                                                    const unix::ipc::system_v::group_notifier &started_notifier,
+                                                    std::size_t crashing_producer)
+    {
+        const auto producer_token_notifier =
+            producers_notifier.with_undo_policy(unix::ipc::system_v::undo_policy::undo_on_exit);
+        std::vector<unix::process_id_t> producer_ids;
+
+        for (std::size_t producer{0}; producer < producer_count; ++producer)
+        {
+            const auto created = unix::create_process();
+
+            if (!created)
+            {
+                break;
+            }
+            if (unix::is_child_process(created.value()))
+            {
+                if (!producer_token_notifier.wait_for_one() || !started_notifier.notify_one())
+                {
+                    _exit(EXIT_FAILURE);
+                }
+                if (producer == crashing_producer)
+                {
+                    _exit(EXIT_FAILURE);
+                }
+                _exit(producer_token_notifier.notify_one() ? EXIT_SUCCESS : EXIT_FAILURE);
+            }
+            producer_ids.push_back(created.value());
+        }
+        return producer_ids;
+    }
+
+    class ProductionTest : public testing::TestWithParam<std::size_t>
+    {
+    protected:
+        void SetUp() override
+        {
+            constexpr auto perms = unix::permissions_builder{}.owner_can_read().owner_can_write().get();
+            auto created = unix::ipc::system_v::semaphore_set::create_private(2, perms);
+            ASSERT_TRUE(created);
+            semaphores_.emplace(std::move(created.value()));
+            std::array<unsigned short, 2> init_values{0, 0};
+            ASSERT_TRUE(semaphores_->set_values(init_values));
+        }
+
+        void TearDown() override
+        {
+            if (semaphores_)
+            {
+                semaphores_->remove();
+            }
+        }
+
+        std::optional<unix::ipc::system_v::semaphore_set> semaphores_;
+    };
+}
+
+// the parameter is the producer exiting early, producer_count for none
+TEST_P(ProductionTest, ReportsTheProducersExitingEarly)
+{
+    const auto producers_notifier = unix::ipc::system_v::group_notifier{*semaphores_, 0, producer_count};
+    const auto started_notifier = unix::ipc::system_v::group_notifier{*semaphores_, 1, producer_count};
+    const auto producer_ids = start_producers(producers_notifier, started_notifier, GetParam());
+    ASSERT_EQ(producer_ids.size(), producer_count);
+    ASSERT_TRUE(producers_notifier.notify_all());
+    // otherwise the tokens could be taken back before the producers got them
+    ASSERT_TRUE(started_notifier.wait_for_all());
+    const std::atomic<std::int32_t> produced_message_count{0};
+
+    const auto completed = buffering::role::wait_till_production_complete(producers_notifier,
+                                                                          produced_message_count, producer_ids);
+    EXPECT_EQ(completed, GetParam() == producer_count);
+}
+
+INSTANTIATE_TEST_SUITE_P(Producers, ProductionTest, testing::Values(0, 2, producer_count));
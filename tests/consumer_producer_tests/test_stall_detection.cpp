@@ -0,0 +1,112 @@
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <expected>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "unix/error_code.hpp"
+
+#include "buffering/stall_detection.hpp"
+
+namespace
+{
+    using namespace std::chrono_literals;
+
+    using wait_result = std::expected<void, unix::error_code>;
+
+    constexpr std::chrono::milliseconds stall_limit{50};
+    constexpr std::chrono::milliseconds wait_time{5};
+
+    wait_result timed_out() noexcept
+    {
+        std::this_thread::sleep_for(wait_time);
+        return std::unexpected{unix::error_code{EAGAIN}};
+    }
+} // namespace
+
+TEST(StallDetectionTest, ReturnsOnceTheWaitSucceeds)
+{
+    std::atomic<std::int32_t> progress{0};
+    int call_count{0};
+    const auto wait = [&](std::chrono::milliseconds) { return ++call_count < 3 ? timed_out() : wait_result{}; };
+
+    EXPECT_TRUE(buffering::wait_while_progressing(wait, progress, []() { return true; }, stall_limit));
+    EXPECT_EQ(call_count, 3);
+}
+
+TEST(StallDetectionTest, KeepsWaitingBeyondTheTimeoutWhileProgressing)
+{
+    std::atomic<std::int32_t> progress{0};
+    const auto started = std::chrono::steady_clock::now();
+    const auto wait = [&](std::chrono::milliseconds)
+    {
+        if (std::chrono::steady_clock::now() - started >= 4 * stall_limit)
+        {
+            return wait_result{};
+        }
+        progress.fetch_add(1, std::memory_order_relaxed);
+        return timed_out();
+    };
+
+    EXPECT_TRUE(buffering::wait_while_progressing(wait, progress, []() { return true; }, stall_limit));
+}
+
+TEST(StallDetectionTest, FailsOnceTheProgressStalls)
+{
+    std::atomic<std::int32_t> progress{0};
+    const auto started = std::chrono::steady_clock::now();
+    const auto wait = [&](std::chrono::milliseconds)
+    {
+        // progresses for a while, then stalls
+        if (std::chrono::steady_clock::now() - started < 2 * stall_limit)
+        {
+            progress.fetch_add(1, std::memory_order_relaxed);
+        }
+        return timed_out();
+    };
+
+    EXPECT_FALSE(buffering::wait_while_progressing(wait, progress, []() { return true; }, stall_limit));
+    EXPECT_GE(std::chrono::steady_clock::now() - started, 3 * stall_limit);
+}
+
+TEST(StallDetectionTest, FailsOnceTheHealthCheckFails)
+{
+    std::atomic<std::int32_t> progress{0};
+    int check_count{0};
+    const auto wait = [&](std::chrono::milliseconds)
+    {
+        progress.fetch_add(1, std::memory_order_relaxed);
+        return timed_out();
+    };
+
+    EXPECT_FALSE(buffering::wait_while_progressing(wait, progress, [&]() { return ++check_count < 3; }, stall_limit));
+    EXPECT_EQ(check_count, 3);
+}
+
+TEST(StallDetectionTest, FailsOnTheErrorsOtherThanTheTimeout)
+{
+    std::atomic<std::int32_t> progress{0};
+    const auto wait = [](std::chrono::milliseconds) -> wait_result
+    {
+        return std::unexpected{unix::error_code{EIDRM}};
+    };
+
+    EXPECT_FALSE(buffering::wait_while_progressing(wait, progress));
+}
+
+TEST(StallDetectionTest, WaitsForTheHealthCheckInterval)
+{
+    std::atomic<std::int32_t> progress{0};
+    std::chrono::milliseconds requested{0};
+    const auto wait = [&](std::chrono::milliseconds interval)
+    {
+        requested = interval;
+        return wait_result{};
+    };
+
+    EXPECT_TRUE(buffering::wait_while_progressing(wait, progress));
+    EXPECT_EQ(requested, buffering::health_check_interval);
+}
@@ -0,0 +1,43 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "core/tsc_clock.hpp"
+
+using namespace std::literals::chrono_literals;
+
+namespace
+{
+    // generous, the tests may get preempted at any point
+    constexpr std::int64_t tolerance{2'000'000};
+}
+
+TEST(TscClockTest, FollowsTheMonotonicClock)
+{
+    const auto &clock = core::tsc_clock::process_clock();
+    ASSERT_GT(clock.nanoseconds_per_tick(), 0.0);
+
+    for (const auto pause : {0ms, 20ms, 100ms})
+    {
+        std::this_thread::sleep_for(pause);
+        const auto sample = core::tsc_clock::take_sample();
+        EXPECT_LT(std::llabs(clock.to_monotonic(sample.ticks) - sample.monotonic), tolerance);
+    }
+}
+
+TEST(TscClockTest, MeasuresDurations)
+{
+    const auto &clock = core::tsc_clock::process_clock();
+    const auto start = core::tsc_clock::now();
+    std::this_thread::sleep_for(50ms);
+    const auto end = core::tsc_clock::now_ordered();
+    ASSERT_GT(end, start);
+
+    const auto elapsed = clock.to_nanoseconds(static_cast<std::int64_t>(end - start));
+    EXPECT_GE(elapsed, 50'000'000 - tolerance);
+    EXPECT_LT(elapsed, 50'000'000 + 50 * tolerance);
+    EXPECT_EQ(clock.to_nanoseconds(-static_cast<std::int64_t>(end - start)), -elapsed);
+}
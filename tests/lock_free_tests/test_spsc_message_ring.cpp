@@ -0,0 +1,106 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "core/error_code.hpp"
+#include "lock_free/spsc_message_ring.hpp"
+
+namespace
+{
+    std::span<const std::byte> bytes_of(std::string_view text) noexcept
+    {
+        return std::as_bytes(std::span<const char>{text.data(), text.size()});
+    }
+
+    std::string_view text_of(std::span<const std::byte> bytes) noexcept
+    {
+        return std::string_view{reinterpret_cast<const char *>(bytes.data()), bytes.size()};
+    }
+}
+
+TEST(SpscMessageRing, PushesAndPopsInOrderAcrossTheWrap)
+{
+    lock_free::spsc_message_ring<128> ring;
+    constexpr std::string_view messages[]{"pineapple", "apple", "pie", "", "a rather long message"};
+
+    // the messages of uneven sizes wrap at different offsets on each round
+    for (std::size_t round{0}; round < 50; ++round)
+    {
+        for (const auto message : messages)
+        {
+            ASSERT_TRUE(ring.try_push(bytes_of(message)));
+            const auto front = ring.front();
+            ASSERT_TRUE(front);
+            EXPECT_EQ(text_of(front.value()), message);
+            ring.pop();
+        }
+        EXPECT_TRUE(ring.empty());
+        EXPECT_FALSE(ring.front());
+    }
+}
+
+TEST(SpscMessageRing, FailsWhenFull)
+{
+    lock_free::spsc_message_ring<64> ring;
+    constexpr std::string_view message{"12345678"};
+    static_assert(decltype(ring)::required_message_storage(message.size()) == 16);
+
+    for (std::size_t index{0}; index < 4; ++index)
+    {
+        ASSERT_TRUE(ring.try_push(bytes_of(message)));
+    }
+    EXPECT_EQ(ring.used(), 64);
+    const auto pushed = ring.try_push(bytes_of(message));
+    ASSERT_FALSE(pushed);
+    EXPECT_EQ(pushed.error(), core::error_code::not_enough_space);
+
+    ring.pop();
+    EXPECT_TRUE(ring.try_push(bytes_of(message)));
+}
+
+TEST(SpscMessageRing, HandsOverMessagesBetweenThreads)
+{
+    constexpr std::uint64_t message_count{1'000'000};
+    lock_free::spsc_message_ring<1'024> ring;
+
+    std::thread producer{[&ring]
+    {
+        for (std::uint64_t index{0}; index < message_count; ++index)
+        {
+            // the size varies with the index to move the wrap around
+            const std::uint64_t message[]{index, index, index};
+            const auto bytes = std::as_bytes(std::span{message}).first(sizeof(std::uint64_t) * (1 + index % 3));
+
+            while (!ring.try_push(bytes))
+            {
+                std::this_thread::yield();
+            }
+        }
+    }};
+    std::uint64_t expected{0};
+
+    while (expected < message_count)
+    {
+        const auto front = ring.front();
+
+        if (!front)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        ASSERT_EQ(front.value().size(), sizeof(std::uint64_t) * (1 + expected % 3));
+        std::uint64_t value;
+        std::memcpy(&value, front.value().data(), sizeof(value));
+        ASSERT_EQ(value, expected);
+        ring.pop();
+        ++expected;
+    }
+    producer.join();
+    EXPECT_TRUE(ring.empty());
+}
@@ -0,0 +1,120 @@
+#include <cstddef>
+#include <optional>
+#include <string_view>
+
+#include <gtest/gtest.h>
+
+#include "unix/ipc/system_v/shared_memory.hpp"
+
+#include "shm/arena.hpp"
+#include "shm/offset_ptr.hpp"
+
+namespace
+{
+    constexpr std::size_t segment_size{64 * 1'024};
+
+    struct node
+    {
+        int value;
+        shm::offset_ptr<node> next;
+    };
+
+    // the same segment attached twice, at two different addresses
+    class ArenaTest : public testing::Test
+    {
+    protected:
+        void SetUp() override
+        {
+            auto created = unix::ipc::system_v::shared_memory::create_private(segment_size, 0600);
+            ASSERT_TRUE(created);
+            segment_.emplace(created.value());
+            auto first = segment_->attach_anywhere(0);
+            auto second = segment_->attach_anywhere(0);
+            ASSERT_TRUE(first && second);
+            first_mapping_ = std::move(first.value());
+            second_mapping_ = std::move(second.value());
+            ASSERT_NE(first_mapping_.get(), second_mapping_.get());
+        }
+
+        void TearDown() override
+        {
+            first_mapping_.reset();
+            second_mapping_.reset();
+            if (segment_)
+            {
+                segment_->remove();
+            }
+        }
+
+        std::optional<unix::ipc::system_v::shared_memory> segment_;
+        unix::ipc::system_v::shared_memory_ptr_t first_mapping_, second_mapping_;
+    };
+}
+
+TEST(OffsetPtr, TestNullAndArithmetic)
+{
+    int values[4]{1, 2, 3, 4};
+    shm::offset_ptr<int> ptr;
+    ASSERT_FALSE(ptr);
+    ASSERT_TRUE(ptr == nullptr);
+    ptr = values;
+    ASSERT_EQ(*ptr, 1);
+    ASSERT_EQ(ptr[3], 4);
+    ASSERT_EQ(*(ptr + 2), 3);
+    shm::offset_ptr<int> copy{ptr};
+    ++copy;
+    ASSERT_EQ(*copy, 2);
+    ASSERT_EQ(copy - ptr, 1);
+    ASSERT_TRUE(ptr < copy);
+}
+
+TEST_F(ArenaTest, TestAllocationsAreReusedBySizeClass)
+{
+    auto *arena = shm::arena::construct_at(first_mapping_.get(), segment_size).value();
+    auto *small = arena->allocate(20).value();
+    const auto used = arena->used();
+    arena->deallocate(small);
+    ASSERT_EQ(arena->allocate(30).value(), small);
+    ASSERT_EQ(arena->used(), used);
+
+    auto *large = arena->allocate(10'000).value();
+    arena->deallocate(large);
+    ASSERT_EQ(arena->allocate(9'000).value(), large);
+    ASSERT_FALSE(arena->allocate(segment_size));
+    ASSERT_EQ(arena->allocate(segment_size).error().code, ENOMEM);
+}
+
+TEST_F(ArenaTest, TestLinksSurviveDifferentMappingAddresses)
+{
+    auto *arena = shm::arena::construct_at(first_mapping_.get(), segment_size).value();
+    auto *head = arena->construct_named<node>("list", node{1, nullptr}).value();
+    head->next = arena->construct<node>(node{2, nullptr}).value();
+
+    auto *attached = shm::arena::attach(second_mapping_.get()).value();
+    auto *found = attached->find<node>("list").value();
+    ASSERT_NE(static_cast<void *>(found), static_cast<void *>(head));
+    ASSERT_EQ(found->value, 1);
+    ASSERT_EQ(found->next->value, 2);
+    ASSERT_TRUE(attached->owns(found->next.get()));
+}
+
+TEST_F(ArenaTest, TestNamedObjects)
+{
+    auto *arena = shm::arena::construct_at(first_mapping_.get(), segment_size).value();
+    ASSERT_EQ(arena->find<int>("counter").error().code, ENOENT);
+    auto *counter = arena->find_or_construct<int>("counter", 7).value();
+    ASSERT_EQ(arena->find_or_construct<int>("counter", 8).value(), counter);
+    ASSERT_EQ(*counter, 7);
+    ASSERT_EQ(arena->construct_named<int>("counter", 9).error().code, EEXIST);
+    ASSERT_EQ(arena->construct_named<int>(std::string_view{"a name longer than thirty one characters"}).error().code,
+              ENAMETOOLONG);
+    ASSERT_TRUE(arena->destroy_named<int>("counter"));
+    ASSERT_FALSE(arena->destroy_named<int>("counter"));
+}
+
+TEST(Arena, TestRejectsForeignMemory)
+{
+    alignas(shm::arena) std::byte memory[128]{};
+    ASSERT_FALSE(shm::arena::attach(memory));
+    ASSERT_FALSE(shm::arena::construct_at(memory, sizeof(memory)));
+}
@@ -0,0 +1,218 @@
+#include <cerrno>
+#include <cstddef>
+#include <cstdlib>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include "unix/ipc/system_v/shared_memory.hpp"
+#include "unix/process.hpp"
+
+#include "shm/arena.hpp"
+#include "shm/string.hpp"
+#include "shm/synchronized.hpp"
+#include "shm/unordered_map.hpp"
+#include "shm/vector.hpp"
+
+namespace
+{
+    constexpr std::size_t segment_size{1'024 * 1'024};
+
+    using lookup_table = shm::unordered_map<shm::string, shm::vector<int>, shm::string_hash>;
+
+    // the same segment attached twice, at two different addresses
+    class ContainersTest : public testing::Test
+    {
+    protected:
+        void SetUp() override
+        {
+            auto created = unix::ipc::system_v::shared_memory::create_private(segment_size, 0600);
+            ASSERT_TRUE(created);
+            segment_.emplace(created.value());
+            auto first = segment_->attach_anywhere(0);
+            auto second = segment_->attach_anywhere(0);
+            ASSERT_TRUE(first && second);
+            first_mapping_ = std::move(first.value());
+            second_mapping_ = std::move(second.value());
+            arena_ = shm::arena::construct_at(first_mapping_.get(), segment_size).value();
+            attached_ = shm::arena::attach(second_mapping_.get()).value();
+        }
+
+        void TearDown() override
+        {
+            first_mapping_.reset();
+            second_mapping_.reset();
+            if (segment_)
+            {
+                segment_->remove();
+            }
+        }
+
+        std::optional<unix::ipc::system_v::shared_memory> segment_;
+        unix::ipc::system_v::shared_memory_ptr_t first_mapping_, second_mapping_;
+        shm::arena *arena_{nullptr}, *attached_{nullptr};
+    };
+}
+
+TEST_F(ContainersTest, TestVectorGrowsAndKeepsElements)
+{
+    auto *numbers = arena_->construct_named<shm::vector<int>>("numbers", *arena_).value();
+
+    for (int i{0}; i < 1'000; ++i)
+    {
+        ASSERT_TRUE(numbers->push_back(i));
+    }
+    auto *seen = attached_->find<shm::vector<int>>("numbers").value();
+    ASSERT_EQ(seen->size(), 1'000);
+
+    for (int i{0}; i < 1'000; ++i)
+    {
+        ASSERT_EQ((*seen)[static_cast<std::size_t>(i)], i);
+    }
+    numbers->pop_back();
+    ASSERT_EQ(seen->back(), 998);
+}
+
+TEST_F(ContainersTest, TestString)
+{
+    auto *text = arena_->construct_named<shm::string>("text", *arena_).value();
+    ASSERT_TRUE(text->empty());
+    ASSERT_STREQ(text->c_str(), "");
+    ASSERT_TRUE(text->assign("shared"));
+    ASSERT_TRUE(text->append(" memory"));
+    auto *seen = attached_->find<shm::string>("text").value();
+    ASSERT_EQ(seen->view(), "shared memory");
+    ASSERT_STREQ(seen->c_str(), "shared memory");
+}
+
+TEST_F(ContainersTest, TestMapLookupsThroughAnotherMapping)
+{
+    constexpr int key_count{500};
+    auto *table = arena_->construct_named<lookup_table>("table", *arena_).value();
+
+    for (int i{0}; i < key_count; ++i)
+    {
+        auto key = shm::string::create(*arena_, "key" + std::to_string(i)).value();
+        auto *values = table->try_emplace(std::move(key), *arena_).value();
+        ASSERT_TRUE(values->push_back(i));
+        ASSERT_TRUE(values->push_back(-i));
+    }
+    ASSERT_EQ(table->size(), key_count);
+
+    const auto *seen = attached_->find<lookup_table>("table").value();
+
+    for (int i{0}; i < key_count; ++i)
+    {
+        const auto *values = seen->find(std::string_view{"key" + std::to_string(i)});
+        ASSERT_NE(values, nullptr);
+        ASSERT_EQ((*values)[0], i);
+        ASSERT_EQ((*values)[1], -i);
+    }
+    ASSERT_FALSE(seen->contains(std::string_view{"missing"}));
+
+    std::size_t visited{0};
+    for (const auto &[key, values] : *seen)
+    {
+        ASSERT_TRUE(key.view().starts_with("key"));
+        ASSERT_EQ(values.size(), 2);
+        ++visited;
+    }
+    ASSERT_EQ(visited, key_count);
+}
+
+TEST_F(ContainersTest, TestMapEraseAndReinsert)
+{
+    shm::unordered_map<int, int> map{*arena_};
+
+    for (int round{0}; round < 10; ++round)
+    {
+        for (int i{0}; i < 100; ++i)
+        {
+            ASSERT_EQ(*map.try_emplace(int{i}, i + round).value(), i + round);
+        }
+        for (int i{0}; i < 100; i += 2)
+        {
+            ASSERT_TRUE(map.erase(i));
+        }
+        ASSERT_EQ(map.size(), 50);
+        ASSERT_FALSE(map.contains(0));
+        ASSERT_TRUE(map.contains(1));
+        ASSERT_EQ(*map.find(1), 1 + round);
+
+        for (int i{1}; i < 100; i += 2)
+        {
+            ASSERT_TRUE(map.erase(i));
+        }
+        ASSERT_TRUE(map.empty());
+    }
+    // tombstones get reclaimed instead of growing the table
+    ASSERT_LE(map.capacity(), 512);
+    ASSERT_EQ(*map.insert_or_assign(7, 1).value(), 1);
+    ASSERT_EQ(*map.insert_or_assign(7, 2).value(), 2);
+}
+
+TEST_F(ContainersTest, TestSynchronizedAccess)
+{
+    using counters = shm::synchronized<shm::unordered_map<int, int>>;
+    auto *shared = arena_->construct_named<counters>("counters", *arena_).value();
+    auto *seen = attached_->find<counters>("counters").value();
+    ASSERT_TRUE(shared->with_lock([](auto &map) { return map.try_emplace(1, 41); }));
+    const auto value = seen->with_lock([](auto &map) { return ++*map.find(1); });
+    ASSERT_TRUE(value);
+    ASSERT_EQ(value.value(), 42);
+}
+
+TEST_F(ContainersTest, TestSynchronizedRepairsWhatADeadOwnerLeft)
+{
+    using counters = shm::synchronized<shm::unordered_map<int, int>>;
+    auto *shared = arena_->construct_named<counters>("counters", *arena_).value();
+    ASSERT_TRUE(shared->with_lock([](auto &map) { return map.try_emplace(1, 41); }));
+    const auto child = unix::create_process();
+    ASSERT_TRUE(child);
+
+    if (unix::is_child_process(child.value()))
+    {
+        // dies in the middle of an update
+        const auto died = shared->with_lock([](auto &) { _exit(EXIT_SUCCESS); });
+        _exit(died ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+    ASSERT_TRUE(unix::wait_till_child_terminates(child.value()));
+    auto repaired = false;
+    const auto size = shared->with_lock([](auto &map) { return map.size(); }, [&](auto &map)
+    {
+        map.erase(1);
+        repaired = true;
+        return true;
+    });
+    ASSERT_TRUE(size);
+    EXPECT_EQ(size.value(), 0);
+    EXPECT_TRUE(repaired);
+    // repaired once, the mutex is consistent again
+    ASSERT_TRUE(shared->with_lock([](auto &map) { return map.try_emplace(2, 2); }));
+}
+
+TEST_F(ContainersTest, TestSynchronizedDistrustsWhatADeadOwnerLeft)
+{
+    using counters = shm::synchronized<shm::unordered_map<int, int>>;
+    auto *shared = arena_->construct_named<counters>("counters", *arena_).value();
+    const auto child = unix::create_process();
+    ASSERT_TRUE(child);
+
+    if (unix::is_child_process(child.value()))
+    {
+        const auto died = shared->with_lock([](auto &) { _exit(EXIT_SUCCESS); });
+        _exit(died ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+    ASSERT_TRUE(unix::wait_till_child_terminates(child.value()));
+    auto called = false;
+    const auto first = shared->with_lock([&](auto &) { called = true; });
+    ASSERT_FALSE(first);
+    EXPECT_EQ(first.error().code, EOWNERDEAD);
+    const auto second = shared->with_lock([&](auto &) { called = true; });
+    ASSERT_FALSE(second);
+    EXPECT_EQ(second.error().code, ENOTRECOVERABLE);
+    EXPECT_FALSE(called);
+}
@@ -0,0 +1,97 @@
+#include <cerrno>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "unix/affinity.hpp"
+
+#ifdef __linux__ // see unix/affinity.hpp
+namespace
+{
+    std::vector<int> ids_of(std::string_view list)
+    {
+        std::vector<int> ids;
+        const auto parsed = unix::cpu_set::for_each_in_list(list, [&ids](int id) { ids.push_back(id); });
+        EXPECT_TRUE(parsed) << list;
+        return ids;
+    }
+}
+
+TEST(CpuListTest, ExpandsTheRanges)
+{
+    EXPECT_EQ(ids_of("0-3,8,10-11"), (std::vector<int>{0, 1, 2, 3, 8, 10, 11}));
+    EXPECT_EQ(ids_of("5"), (std::vector<int>{5}));
+    EXPECT_EQ(ids_of("2-2"), (std::vector<int>{2}));
+    EXPECT_TRUE(ids_of("").empty());
+}
+
+TEST(CpuListTest, StopsAtTheTrailingNewline)
+{
+    // the way sysfs prints the lists
+    EXPECT_EQ(ids_of("0-1,4\n"), (std::vector<int>{0, 1, 4}));
+    EXPECT_TRUE(ids_of("\n").empty());
+}
+
+TEST(CpuListTest, RejectsMalformedLists)
+{
+    for (const auto list : {"-1", "3-1", "1-", "1,", "1,\n", ",1", "1,,2", "1-2-3", "a", "1 2", "0--1", "1;2"})
+    {
+        std::size_t called{0};
+        const auto parsed = unix::cpu_set::for_each_in_list(list, [&called](int) { ++called; });
+        ASSERT_FALSE(parsed) << list;
+        EXPECT_EQ(parsed.error().code, EINVAL) << list;
+        // nothing gets added from a list that fails
+        EXPECT_EQ(called, 0) << list;
+    }
+}
+
+TEST(CpuListTest, RejectsTheIdsBeyondTheMax)
+{
+    EXPECT_TRUE(unix::cpu_set::for_each_in_list("0-7", [](int) {}, 7));
+    EXPECT_FALSE(unix::cpu_set::for_each_in_list("0-8", [](int) {}, 7));
+
+    const auto beyond = unix::cpu_set::parse(std::to_string(CPU_SETSIZE));
+    ASSERT_FALSE(beyond);
+    EXPECT_EQ(beyond.error().code, EINVAL);
+}
+
+TEST(CpuSetTest, ParsesTheListOfTheKernel)
+{
+    const auto parsed = unix::cpu_set::parse("1-2,6\n");
+    ASSERT_TRUE(parsed);
+    const auto &cpus = parsed.value();
+    EXPECT_EQ(cpus.count(), 3);
+    EXPECT_FALSE(cpus.contains(0));
+    EXPECT_TRUE(cpus.contains(1));
+    EXPECT_TRUE(cpus.contains(6));
+    EXPECT_FALSE(cpus.contains(-1));
+    EXPECT_FALSE(cpus.contains(CPU_SETSIZE));
+}
+
+TEST(CpuSetTest, PicksTheNthCpuOrTheLastOne)
+{
+    const auto cpus = unix::cpu_set{}.add(2).add(5).add(9);
+    EXPECT_EQ(cpus.nth(0), 2);
+    EXPECT_EQ(cpus.nth(1), 5);
+    EXPECT_EQ(cpus.nth(2), 9);
+    // fewer cpus than roles
+    EXPECT_EQ(cpus.nth(3), 9);
+    EXPECT_EQ(cpus.nth(100), 9);
+}
+
+TEST(CpuSetTest, PinsTheCurrentThread)
+{
+    const auto allowed = unix::cpu_set::of_current_thread();
+    ASSERT_TRUE(allowed);
+    const auto cpu = allowed.value().nth(0);
+    ASSERT_TRUE(unix::pin_current_thread(unix::cpu_set{}.add(cpu)));
+    const auto pinned = unix::cpu_set::of_current_thread();
+    ASSERT_TRUE(pinned);
+    EXPECT_EQ(pinned.value().count(), 1);
+    EXPECT_TRUE(pinned.value().contains(cpu));
+    EXPECT_EQ(unix::current_cpu(), cpu);
+    ASSERT_TRUE(unix::pin_current_thread(allowed.value()));
+}
+#endif
@@ -0,0 +1,138 @@
+#include <cerrno>
+#include <chrono>
+#include <expected>
+#include <optional>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "unix/ipc/system_v/group_notifier.hpp"
+
+namespace
+{
+    namespace system_v = unix::ipc::system_v;
+
+    using namespace std::chrono_literals;
+
+    // long enough for a blocked semop to have taken effect if it was going to
+    constexpr auto settle_time{50ms};
+    constexpr system_v::semaphore_value_t group_size{3};
+
+    // a written and a read notifier sharing a private set, the way
+    // a producer and a consumer hand over the slots of a buffer
+    class GroupNotifierTest : public testing::Test
+    {
+    protected:
+        void SetUp() override
+        {
+            auto created = system_v::semaphore_set::create_private(2, 0600);
+            ASSERT_TRUE(created) << unix::to_string(created.error());
+            semaphores_.emplace(created.value());
+            written_.emplace(semaphores_.value(), 0, group_size);
+            read_.emplace(semaphores_.value(), 1, group_size);
+        }
+
+        void TearDown() override
+        {
+            if (semaphores_)
+            {
+                EXPECT_TRUE(semaphores_->remove());
+            }
+        }
+
+        const system_v::group_notifier &written() const noexcept { return written_.value(); }
+        const system_v::group_notifier &read() const noexcept { return read_.value(); }
+
+        system_v::semaphore_value_t value_of(system_v::semaphore_index_t index) const noexcept
+        {
+            system_v::semaphore_value_t value{-1};
+            EXPECT_TRUE(semaphores_->get_value(index, value));
+            return value;
+        }
+
+    private:
+        std::optional<system_v::semaphore_set> semaphores_;
+        std::optional<system_v::group_notifier> written_;
+        std::optional<system_v::group_notifier> read_;
+    };
+} // namespace
+
+TEST_F(GroupNotifierTest, HoldsBackTheNotificationWhileTheWaitBlocks)
+{
+    std::expected<void, unix::error_code> handed_over;
+    std::thread producer{[&]() { handed_over = written().notify_one_and_wait_for_one(read()); }};
+    std::this_thread::sleep_for(settle_time);
+    EXPECT_EQ(value_of(0), 0);
+
+    ASSERT_TRUE(read().notify_one());
+    producer.join();
+    ASSERT_TRUE(handed_over);
+    EXPECT_EQ(value_of(0), 1);
+    EXPECT_EQ(value_of(1), 0);
+}
+
+TEST_F(GroupNotifierTest, TimedHandOverAppliesNeitherOperationOnTimeout)
+{
+    const auto handed_over = written().notify_one_and_wait_for_one_for(read(), 20ms);
+    ASSERT_FALSE(handed_over);
+    EXPECT_EQ(handed_over.error().code, EAGAIN);
+    EXPECT_EQ(value_of(0), 0);
+    EXPECT_EQ(value_of(1), 0);
+}
+
+TEST_F(GroupNotifierTest, WaitsTillAtLeastWithoutTakingTheValue)
+{
+    ASSERT_TRUE(written().notify(2));
+    ASSERT_TRUE(written().wait_till_at_least(2));
+    EXPECT_EQ(value_of(0), 2);
+
+    const auto short_of_one = written().wait_till_at_least_for(3, 20ms);
+    ASSERT_FALSE(short_of_one);
+    EXPECT_EQ(short_of_one.error().code, EAGAIN);
+    EXPECT_EQ(value_of(0), 2);
+
+    std::expected<void, unix::error_code> reached;
+    std::thread waiter{[&]() { reached = written().wait_till_at_least(group_size); }};
+    std::this_thread::sleep_for(settle_time);
+    ASSERT_TRUE(written().notify_one());
+    waiter.join();
+    ASSERT_TRUE(reached);
+    EXPECT_EQ(value_of(0), group_size);
+}
+
+TEST_F(GroupNotifierTest, TimedWaitsFailWithEagainOnceTheTimeoutPasses)
+{
+    const auto expect_timeout = [](const std::expected<void, unix::error_code> &waited)
+    {
+        ASSERT_FALSE(waited);
+        EXPECT_EQ(waited.error().code, EAGAIN);
+    };
+    expect_timeout(written().wait_for_one_for(20ms));
+    expect_timeout(written().wait_for_one_until(std::chrono::steady_clock::now() + 20ms));
+    // a passed deadline does not block at all
+    expect_timeout(written().wait_for_one_until(std::chrono::steady_clock::now() - 1s));
+
+    ASSERT_TRUE(written().notify(group_size - 1));
+    expect_timeout(written().wait_for_all_for(20ms));
+    expect_timeout(written().wait_for_all_until(std::chrono::steady_clock::now() + 20ms));
+    expect_timeout(written().wait_till_none_for(20ms));
+    expect_timeout(written().wait_till_none_until(std::chrono::steady_clock::now() + 20ms));
+    // the timed out waits took nothing
+    EXPECT_EQ(value_of(0), group_size - 1);
+}
+
+TEST_F(GroupNotifierTest, TimedWaitsReturnOnceNotified)
+{
+    ASSERT_TRUE(written().notify_all());
+    ASSERT_TRUE(written().wait_for_all_for(1s));
+
+    std::expected<void, unix::error_code> woken;
+    std::thread waiter{[&]() { woken = written().wait_for_one_until(std::chrono::steady_clock::now() + 10s); }};
+    std::this_thread::sleep_for(settle_time);
+    ASSERT_TRUE(written().notify_one());
+    waiter.join();
+    ASSERT_TRUE(woken);
+
+    ASSERT_TRUE(written().wait_till_none_for(1s));
+    EXPECT_EQ(value_of(0), 0);
+}
@@ -0,0 +1,215 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdlib>
+#include <fcntl.h>
+#include <string>
+#include <sys/uio.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "unix/fs/posix/file.hpp"
+#include "unix/io_vector.hpp"
+
+namespace
+{
+    // the vectors of the chunks, each one of its own size, some of them empty
+    std::vector<unix::io_vector_t> vectors_of(std::vector<std::string> &chunks)
+    {
+        std::vector<unix::io_vector_t> vectors;
+
+        for (auto &chunk : chunks)
+        {
+            vectors.push_back(unix::make_io_vector(chunk.data(), chunk.size()));
+        }
+        return vectors;
+    }
+
+    std::vector<std::string> make_chunks(std::size_t count)
+    {
+        std::vector<std::string> chunks;
+
+        for (std::size_t index{0}; index < count; ++index)
+        {
+            chunks.emplace_back(index % 5 == 0 ? 0 : index % 13 + 1, static_cast<char>('a' + index % 26));
+        }
+        return chunks;
+    }
+
+    std::string joined(const std::vector<std::string> &chunks)
+    {
+        std::string all;
+
+        for (const auto &chunk : chunks)
+        {
+            all += chunk;
+        }
+        return all;
+    }
+
+    // collects at most max_size bytes per call, the way a short write would
+    class capped_sink
+    {
+    public:
+        explicit capped_sink(std::size_t max_size) noexcept : max_size_{max_size} {}
+
+        ssize_t operator()(const unix::io_vector_t *batch, int count)
+        {
+            max_count_ = std::max(max_count_, count);
+            ++calls_;
+            std::size_t left{max_size_};
+
+            for (int index{0}; index < count && left > 0; ++index)
+            {
+                const auto size = std::min(left, batch[index].iov_len);
+                bytes_.append(static_cast<const char *>(batch[index].iov_base), size);
+                left -= size;
+            }
+            return static_cast<ssize_t>(max_size_ - left);
+        }
+
+        const std::string &bytes() const noexcept { return bytes_; }
+
+        int max_count() const noexcept { return max_count_; }
+
+        std::size_t calls() const noexcept { return calls_; }
+
+    private:
+        std::size_t max_size_;
+        std::string bytes_;
+        int max_count_{0};
+        std::size_t calls_{0};
+    };
+}
+
+TEST(IoVectorTest, TransfersInBatchesOfAtMostSixtyFourVectors)
+{
+    auto chunks = make_chunks(200);
+    const auto vectors = vectors_of(chunks);
+    capped_sink sink{SIZE_MAX};
+    const auto transferred = unix::transfer_vectors(vectors, std::ref(sink));
+    ASSERT_TRUE(transferred);
+    EXPECT_EQ(transferred.value(), unix::total_size(vectors));
+    EXPECT_EQ(sink.bytes(), joined(chunks));
+    EXPECT_EQ(sink.max_count(), static_cast<int>(unix::io_vector_batch_size));
+    EXPECT_EQ(sink.calls(), (200 + unix::io_vector_batch_size - 1) / unix::io_vector_batch_size);
+}
+
+TEST(IoVectorTest, ResumesInTheMiddleOfAVector)
+{
+    for (const std::size_t cap : {1, 3, 7, 64})
+    {
+        auto chunks = make_chunks(150);
+        const auto vectors = vectors_of(chunks);
+        capped_sink sink{cap};
+        const auto transferred = unix::transfer_vectors(vectors, std::ref(sink));
+        ASSERT_TRUE(transferred);
+        EXPECT_EQ(transferred.value(), unix::total_size(vectors));
+        EXPECT_EQ(sink.bytes(), joined(chunks)) << cap;
+        // the passed vectors are left as they were
+        EXPECT_EQ(vectors_of(chunks).front().iov_len, vectors.front().iov_len);
+    }
+}
+
+TEST(IoVectorTest, SkipsTheEmptyVectors)
+{
+    std::vector<std::string> chunks(100);
+    const auto vectors = vectors_of(chunks);
+    capped_sink sink{SIZE_MAX};
+    const auto transferred = unix::transfer_vectors(vectors, std::ref(sink));
+    ASSERT_TRUE(transferred);
+    EXPECT_EQ(transferred.value(), 0);
+    // nothing to transfer, no call
+    EXPECT_EQ(sink.calls(), 0);
+
+    chunks.back() = "last";
+    const auto last = unix::transfer_vectors(vectors_of(chunks), std::ref(sink));
+    ASSERT_TRUE(last);
+    EXPECT_EQ(last.value(), 4);
+    EXPECT_EQ(sink.bytes(), "last");
+}
+
+TEST(IoVectorTest, RetriesTheInterruptedTransfersAndReportsTheFailures)
+{
+    std::string chunk{"data"};
+    const auto vector = unix::make_io_vector(chunk.data(), chunk.size());
+    int calls{0};
+    const auto interrupted = unix::transfer_vectors({&vector, 1}, [&calls](const unix::io_vector_t *batch, int)
+    {
+        if (++calls == 1)
+        {
+            errno = EINTR;
+            return ssize_t{-1};
+        }
+        return static_cast<ssize_t>(batch[0].iov_len);
+    });
+    ASSERT_TRUE(interrupted);
+    EXPECT_EQ(interrupted.value(), chunk.size());
+
+    const auto failed = unix::transfer_vectors({&vector, 1}, [](const unix::io_vector_t *, int)
+    {
+        errno = EBADF;
+        return ssize_t{-1};
+    });
+    ASSERT_FALSE(failed);
+    EXPECT_EQ(failed.error().code, EBADF);
+}
+
+#ifdef __linux__ // F_SETPIPE_SZ
+TEST(IoVectorTest, ReadsAndWritesThroughASmallPipe)
+{
+    int ends[2];
+    ASSERT_EQ(::pipe(ends), 0);
+    // far less than written, the reads and writes come back short
+    ASSERT_NE(::fcntl(ends[1], F_SETPIPE_SZ, 4'096), -1);
+
+    auto written_chunks = make_chunks(300);
+    for (auto &chunk : written_chunks)
+    {
+        chunk.append(97, chunk.empty() ? 'z' : chunk.front());
+    }
+    const auto expected = joined(written_chunks);
+    std::thread writer{[&]
+    {
+        EXPECT_TRUE(unix::write_vectors(ends[1], vectors_of(written_chunks)));
+        ::close(ends[1]);
+    }};
+    // other boundaries than the written ones, and more room than written
+    std::vector<std::string> read_chunks;
+
+    for (std::size_t index{0}; index < 250; ++index)
+    {
+        read_chunks.emplace_back(index % 7 == 0 ? 0 : 211, '\0');
+    }
+    const auto read_vectors = vectors_of(read_chunks);
+    const auto read = unix::read_vectors(ends[0], read_vectors);
+    writer.join();
+    ::close(ends[0]);
+    ASSERT_TRUE(read);
+    // stops at the end of file
+    ASSERT_EQ(read.value(), expected.size());
+    EXPECT_EQ(joined(read_chunks).substr(0, expected.size()), expected);
+}
+#endif
+
+TEST(FileTest, OpensAPathCutOutOfALongerString)
+{
+    char name[]{"/tmp/unix_io_vector_XXXXXX"};
+    const auto fd = ::mkstemp(name);
+    ASSERT_NE(fd, -1);
+    ::close(fd);
+    // a view of the path would not end where the path does
+    const std::string text{std::string{name} + "-suffix"};
+    const auto opened = unix::fs::posix::file::open(text.substr(0, text.size() - 7), O_RDWR);
+    ASSERT_TRUE(opened);
+
+    std::vector<std::string> chunks{"ab", "", "cde"};
+    ASSERT_TRUE(opened.value().pwritev(vectors_of(chunks), 3));
+    std::string read(8, '\0');
+    ASSERT_EQ(::pread(opened.value().file_descriptor(), read.data(), read.size(), 0), 8);
+    EXPECT_EQ(read, std::string("\0\0\0abcde", 8));
+    ::unlink(name);
+}
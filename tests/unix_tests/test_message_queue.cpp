@@ -0,0 +1,157 @@
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <string_view>
+
+#include <gtest/gtest.h>
+
+#include "unix/ipc/system_v/message_queue.hpp"
+
+namespace
+{
+    namespace system_v = unix::ipc::system_v;
+
+    constexpr std::size_t text_capacity{32};
+
+    using message_type = system_v::message<text_capacity>;
+    using channel_type = system_v::message_channel<text_capacity>;
+
+    // the private queues outlive the process unless removed
+    class MessageQueueTest : public testing::Test
+    {
+    protected:
+        void SetUp() override
+        {
+            auto created = system_v::message_queue::create_private(0600);
+            ASSERT_TRUE(created) << unix::to_string(created.error());
+            queue_.emplace(created.value());
+        }
+
+        void TearDown() override
+        {
+            if (queue_)
+            {
+                EXPECT_TRUE(queue_->remove());
+            }
+        }
+
+        const system_v::message_queue &queue() const noexcept { return queue_.value(); }
+
+    private:
+        std::optional<system_v::message_queue> queue_;
+    };
+
+    void send_text(const system_v::message_queue &queue, system_v::message_type_t type, std::string_view text)
+    {
+        message_type msg;
+        msg.type = type;
+        std::copy(text.begin(), text.end(), msg.text.begin());
+        ASSERT_TRUE(queue.send(msg, text.size()));
+    }
+
+    std::string_view text_of(const message_type &msg, std::size_t size) noexcept
+    {
+        return std::string_view{msg.text.data(), size};
+    }
+} // namespace
+
+TEST_F(MessageQueueTest, ChannelsTakeOnlyTheMessagesOfTheirType)
+{
+    const channel_type first{queue(), 1};
+    const channel_type second{queue(), 2};
+    ASSERT_TRUE(first.send(std::string_view{"first"}));
+    ASSERT_TRUE(second.send(std::string_view{"second"}));
+    ASSERT_TRUE(first.send(std::string_view{"third"}));
+
+    std::array<char, text_capacity> text;
+    const auto received = second.receive(text);
+    ASSERT_TRUE(received);
+    EXPECT_EQ((std::string_view{text.data(), received.value()}), "second");
+
+    // the messages of the other type stay queued in their order
+    for (const auto expected : {std::string_view{"first"}, std::string_view{"third"}})
+    {
+        const auto next = first.receive(text);
+        ASSERT_TRUE(next);
+        EXPECT_EQ((std::string_view{text.data(), next.value()}), expected);
+    }
+    message_type msg;
+    const auto empty = queue().try_receive(msg);
+    ASSERT_FALSE(empty);
+    EXPECT_EQ(empty.error().code, ENOMSG);
+}
+
+TEST_F(MessageQueueTest, NegativeTypesTakeTheLowestTypeFirst)
+{
+    send_text(queue(), 3, "three");
+    send_text(queue(), 1, "one");
+    send_text(queue(), 5, "five");
+
+    message_type msg;
+
+    for (const auto expected : {std::string_view{"one"}, std::string_view{"three"}})
+    {
+        const auto received = queue().try_receive(msg, -3);
+        ASSERT_TRUE(received);
+        EXPECT_EQ(text_of(msg, received.value()), expected);
+    }
+    const auto beyond = queue().try_receive(msg, -3);
+    ASSERT_FALSE(beyond);
+    EXPECT_EQ(beyond.error().code, ENOMSG);
+}
+
+TEST_F(MessageQueueTest, ChannelsTruncateTheTextsTheSpanCannotHold)
+{
+    const channel_type channel{queue(), 1};
+    ASSERT_TRUE(channel.send(std::string_view{"truncated"}));
+
+    std::array<char, 4> text;
+    const auto received = channel.receive(text);
+    ASSERT_TRUE(received);
+    EXPECT_EQ(received.value(), text.size());
+    EXPECT_EQ((std::string_view{text.data(), received.value()}), "trun");
+}
+
+TEST_F(MessageQueueTest, BatchesDrainOnlyTheQueuedMessages)
+{
+    for (const auto text : {"a", "bb", "ccc"})
+    {
+        send_text(queue(), 1, text);
+    }
+    std::array<message_type, 2> messages;
+    std::array<std::size_t, 2> sizes;
+
+    // the slots limit the batch
+    const auto full = queue().receive_batch(std::span{messages}, std::span{sizes});
+    ASSERT_TRUE(full);
+    ASSERT_EQ(full.value(), 2);
+    EXPECT_EQ(text_of(messages[0], sizes[0]), "a");
+    EXPECT_EQ(text_of(messages[1], sizes[1]), "bb");
+
+    // the rest does not fill the slots, the batch does not wait for more
+    const auto partial = queue().receive_batch(std::span{messages}, std::span{sizes});
+    ASSERT_TRUE(partial);
+    ASSERT_EQ(partial.value(), 1);
+    EXPECT_EQ(text_of(messages[0], sizes[0]), "ccc");
+}
+
+TEST_F(MessageQueueTest, TheCapacityLimitsTheQueuedBytes)
+{
+    ASSERT_TRUE(queue().set_capacity(text_capacity));
+    const auto capacity = queue().capacity();
+    ASSERT_TRUE(capacity);
+    EXPECT_EQ(capacity.value(), text_capacity);
+
+    message_type msg;
+    ASSERT_TRUE(queue().try_send(msg, text_capacity));
+    const auto full = queue().try_send(msg, 1);
+    ASSERT_FALSE(full);
+    EXPECT_EQ(full.error().code, EAGAIN);
+
+    const auto count = queue().message_count();
+    ASSERT_TRUE(count);
+    EXPECT_EQ(count.value(), 1);
+}
@@ -0,0 +1,68 @@
+#include <cerrno>
+#include <chrono>
+#include <memory>
+#include <cstdlib>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include "unix/ipc/posix/memory_mapping.hpp"
+#include "unix/process.hpp"
+#include "unix/sync/posix/condition_variable.hpp"
+#include "unix/sync/posix/mutex.hpp"
+
+using namespace std::literals::chrono_literals;
+
+#ifndef __APPLE__
+TEST(MutexTest, ReportsTheOwnerDyingWhileHoldingTheLock)
+{
+    using unix::sync::posix::lock_result;
+    auto memory = unix::ipc::posix::memory_mapping::create_anonymous(
+        sizeof(unix::sync::posix::mutex), unix::ipc::posix::read_write_protection,
+        unix::ipc::posix::mapping_flags_builder{}.get());
+    ASSERT_TRUE(memory);
+    auto constructed = unix::sync::posix::mutex::construct_at(memory->data(),
+                                                              unix::sync::posix::process_sharing::process_shared);
+    ASSERT_TRUE(constructed);
+    auto &mutex = *constructed.value();
+
+    const auto child = unix::create_process();
+    ASSERT_TRUE(child);
+
+    if (unix::is_child_process(child.value()))
+    {
+        const auto locked = mutex.lock();
+        _exit(locked && locked.value() == lock_result::acquired ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+    const auto status = unix::wait_till_child_terminates(child.value());
+    ASSERT_TRUE(status);
+    ASSERT_FALSE(unix::terminated_abnormally(status.value()));
+
+    const auto locked = mutex.lock();
+    ASSERT_TRUE(locked);
+    EXPECT_EQ(locked.value(), lock_result::previous_owner_died);
+    ASSERT_TRUE(mutex.make_consistent());
+    ASSERT_TRUE(mutex.unlock());
+
+    const auto relocked = mutex.lock();
+    ASSERT_TRUE(relocked);
+    EXPECT_EQ(relocked.value(), lock_result::acquired);
+    ASSERT_TRUE(mutex.unlock());
+    std::destroy_at(&mutex);
+}
+#endif
+
+TEST(ConditionVariableTest, TimesOutWithTheMutexReacquired)
+{
+    auto mutex = unix::sync::posix::mutex::create();
+    ASSERT_TRUE(mutex);
+    auto created = unix::sync::posix::condition_variable::create();
+    ASSERT_TRUE(created);
+    auto &condition = *created.value();
+
+    ASSERT_TRUE(mutex->lock());
+    const auto waited = condition.wait_for(mutex.value(), 10ms);
+    ASSERT_FALSE(waited);
+    EXPECT_EQ(waited.error().code, ETIMEDOUT);
+    ASSERT_TRUE(mutex->unlock());
+}
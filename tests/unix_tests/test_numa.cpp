@@ -0,0 +1,49 @@
+#include <gtest/gtest.h>
+
+#include "unix/numa.hpp"
+
+#ifdef __linux__ // see unix/numa.hpp
+TEST(NodeMaskTest, SetsTheBitsOfTheNodes)
+{
+    constexpr auto bits_per_word = sizeof(unsigned long) * CHAR_BIT;
+    unix::numa::node_mask nodes;
+    EXPECT_TRUE(nodes.empty());
+
+    nodes.add(0).add(3).add(static_cast<unix::numa::node_t>(bits_per_word) + 1);
+    EXPECT_FALSE(nodes.empty());
+    EXPECT_TRUE(nodes.contains(0));
+    EXPECT_TRUE(nodes.contains(3));
+    EXPECT_FALSE(nodes.contains(1));
+    EXPECT_TRUE(nodes.contains(static_cast<unix::numa::node_t>(bits_per_word) + 1));
+    EXPECT_FALSE(nodes.contains(-1));
+    EXPECT_FALSE(nodes.contains(static_cast<unix::numa::node_t>(unix::numa::max_node_count)));
+    // the layout the kernel reads
+    EXPECT_EQ(nodes.data()[0], 0b1001UL);
+    EXPECT_EQ(nodes.data()[1], 0b10UL);
+}
+
+TEST(NodeMaskTest, IsUsableAtCompileTime)
+{
+    constexpr auto nodes = unix::numa::node_mask{}.add(2);
+    static_assert(nodes.contains(2) && !nodes.contains(1) && !nodes.empty());
+    EXPECT_EQ(unix::numa::node_mask::max_node(), unix::numa::max_node_count);
+}
+
+TEST(NumaTest, ReadsTheTopology)
+{
+    const auto nodes = unix::numa::online_nodes();
+
+    if (!nodes)
+    {
+        GTEST_SKIP() << "no numa topology in sysfs";
+    }
+    ASSERT_TRUE(nodes.value().contains(0));
+    const auto cpus = unix::numa::cpus_of(0);
+    ASSERT_TRUE(cpus);
+    EXPECT_FALSE(cpus.value().empty());
+
+    const auto node = unix::numa::current_node();
+    ASSERT_TRUE(node);
+    EXPECT_TRUE(nodes.value().contains(node.value()));
+}
+#endif
@@ -0,0 +1,54 @@
+#include <cerrno>
+#include <cstddef>
+#include <fstream>
+#include <limits>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include "unix/ipc/posix/memory_mapping.hpp"
+#include "unix/ipc/posix/pipe.hpp"
+
+#ifndef __APPLE__
+TEST(PipeTest, RoundsTheCapacityUpToAPowerOfTwoPages)
+{
+    auto created = unix::ipc::posix::pipe::create();
+    ASSERT_TRUE(created);
+    const auto page = unix::ipc::posix::page_size();
+
+    const auto single = created.value().set_capacity(page);
+    ASSERT_TRUE(single);
+    EXPECT_EQ(single.value(), page);
+
+    // three pages and a byte take four pages
+    const auto rounded = created.value().set_capacity(3 * page + 1);
+    ASSERT_TRUE(rounded);
+    EXPECT_EQ(rounded.value(), 4 * page);
+
+    const auto current = created.value().capacity();
+    ASSERT_TRUE(current);
+    EXPECT_EQ(current.value(), 4 * page);
+}
+
+TEST(PipeTest, RejectsCapacitiesBeyondTheLimits)
+{
+    auto created = unix::ipc::posix::pipe::create();
+    ASSERT_TRUE(created);
+    const auto too_large = static_cast<std::size_t>(std::numeric_limits<int>::max()) + 1;
+    const auto rejected = created.value().set_capacity(too_large);
+    ASSERT_FALSE(rejected);
+    EXPECT_EQ(rejected.error().code, EINVAL);
+
+    // root may go beyond the limit
+    if (geteuid() == 0)
+    {
+        GTEST_SKIP() << "the limit does not apply to privileged processes";
+    }
+    std::size_t max_size{0};
+    std::ifstream{"/proc/sys/fs/pipe-max-size"} >> max_size;
+    ASSERT_GT(max_size, 0);
+    const auto beyond = created.value().set_capacity(max_size + 1);
+    ASSERT_FALSE(beyond);
+    EXPECT_EQ(beyond.error().code, EPERM);
+}
+#endif
@@ -0,0 +1,156 @@
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <expected>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unistd.h>
+#include <utility>
+
+#include <gtest/gtest.h>
+
+#include "unix/ipc/posix/message_queue.hpp"
+
+using namespace std::literals::chrono_literals;
+
+#ifndef __APPLE__ // see unix/ipc/posix/message_queue.hpp
+namespace
+{
+    namespace posix = unix::ipc::posix;
+
+    constexpr long max_message_count{8};
+    constexpr std::size_t max_message_size{64};
+
+    using message_buffer = std::array<char, max_message_size>;
+
+    // each test creates a queue of its own and unlinks it right away, so none is
+    // left behind by a failed test, the queue cannot be moved, it is returned by elision
+    std::expected<posix::message_queue, unix::error_code> create_queue() noexcept
+    {
+        return posix::message_queue::create_exclusively(
+            "/unix_tests_" + std::to_string(getpid()), posix::to_open_flags(posix::access_mode::read_write), 0600,
+            max_message_count, static_cast<long>(max_message_size));
+    }
+
+    void send(const posix::message_queue &queue, std::string_view text, posix::message_priority_t priority)
+    {
+        ASSERT_TRUE(queue.send(std::span{text.data(), text.size()}, priority));
+    }
+
+    std::string_view text_of(const message_buffer &buffer, const posix::received_message &message) noexcept
+    {
+        return std::string_view{buffer.data(), message.size};
+    }
+} // namespace
+
+TEST(PosixMessageQueueTest, ReceivesTheHighestPriorityFirst)
+{
+    auto created = create_queue();
+    ASSERT_TRUE(created) << unix::to_string(created.error());
+    ASSERT_TRUE(created->unlink());
+    const auto &queue = created.value();
+    send(queue, "low", 1);
+    send(queue, "high", 7);
+    send(queue, "first default", posix::default_message_priority);
+    send(queue, "second high", 7);
+    send(queue, "second default", posix::default_message_priority);
+
+    const std::array<std::pair<std::string_view, posix::message_priority_t>, 5> expected{{
+        {"high", 7},
+        {"second high", 7},
+        {"low", 1},
+        {"first default", posix::default_message_priority},
+        {"second default", posix::default_message_priority},
+    }};
+    message_buffer buffer;
+
+    for (const auto &[text, priority] : expected)
+    {
+        const auto received = queue.receive(buffer);
+        ASSERT_TRUE(received);
+        EXPECT_EQ(text_of(buffer, received.value()), text);
+        EXPECT_EQ(received->priority, priority);
+    }
+}
+
+TEST(PosixMessageQueueTest, TryReceiveFailsWithEagainWhenEmpty)
+{
+    auto created = create_queue();
+    ASSERT_TRUE(created) << unix::to_string(created.error());
+    ASSERT_TRUE(created->unlink());
+    const auto &queue = created.value();
+    message_buffer buffer;
+    const auto empty = queue.try_receive(buffer);
+    ASSERT_FALSE(empty);
+    EXPECT_EQ(empty.error().code, EAGAIN);
+
+    send(queue, "queued", posix::default_message_priority);
+    const auto received = queue.try_receive(buffer);
+    ASSERT_TRUE(received);
+    EXPECT_EQ(text_of(buffer, received.value()), "queued");
+}
+
+TEST(PosixMessageQueueTest, TimedReceiveFailsWithEtimedoutWhenEmpty)
+{
+    auto created = create_queue();
+    ASSERT_TRUE(created) << unix::to_string(created.error());
+    ASSERT_TRUE(created->unlink());
+    const auto &queue = created.value();
+    message_buffer buffer;
+    const auto started = std::chrono::steady_clock::now();
+    const auto until = queue.receive_until(buffer, std::chrono::system_clock::now() + 20ms);
+    ASSERT_FALSE(until);
+    EXPECT_EQ(until.error().code, ETIMEDOUT);
+    EXPECT_GE(std::chrono::steady_clock::now() - started, 20ms);
+
+    const auto within = queue.receive_for(buffer, 20ms);
+    ASSERT_FALSE(within);
+    EXPECT_EQ(within.error().code, ETIMEDOUT);
+
+    send(queue, "queued", posix::default_message_priority);
+    EXPECT_TRUE(queue.receive_for(buffer, 1s));
+}
+
+TEST(PosixMessageQueueTest, BatchesDrainOnlyTheQueuedMessages)
+{
+    auto created = create_queue();
+    ASSERT_TRUE(created) << unix::to_string(created.error());
+    ASSERT_TRUE(created->unlink());
+    const auto &queue = created.value();
+
+    for (const auto text : {"a", "bb", "ccc"})
+    {
+        send(queue, text, posix::default_message_priority);
+    }
+    std::array<char, 2 * max_message_size> buffer;
+    std::array<posix::received_message, 2> messages;
+
+    // the slots limit the batch
+    const auto full = queue.receive_batch(buffer, max_message_size, messages);
+    ASSERT_TRUE(full);
+    ASSERT_EQ(full.value(), 2);
+    EXPECT_EQ((std::string_view{buffer.data(), messages[0].size}), "a");
+    EXPECT_EQ((std::string_view{buffer.data() + max_message_size, messages[1].size}), "bb");
+
+    // the rest does not fill the slots, the batch does not wait for more
+    const auto partial = queue.receive_batch(buffer, max_message_size, messages);
+    ASSERT_TRUE(partial);
+    ASSERT_EQ(partial.value(), 1);
+    EXPECT_EQ((std::string_view{buffer.data(), messages[0].size}), "ccc");
+}
+
+TEST(PosixMessageQueueTest, RejectsBuffersSmallerThanTheMessageSize)
+{
+    auto created = create_queue();
+    ASSERT_TRUE(created) << unix::to_string(created.error());
+    ASSERT_TRUE(created->unlink());
+    const auto &queue = created.value();
+    send(queue, "queued", posix::default_message_priority);
+    std::array<char, max_message_size - 1> buffer;
+    const auto received = queue.try_receive(buffer);
+    ASSERT_FALSE(received);
+    EXPECT_EQ(received.error().code, EMSGSIZE);
+}
+#endif
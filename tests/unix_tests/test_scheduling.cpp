@@ -0,0 +1,132 @@
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <limits>
+#include <pthread.h>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include "unix/process.hpp"
+#include "unix/scheduling.hpp"
+
+namespace
+{
+    std::string name_of(pthread_t thread)
+    {
+        std::array<char, unix::max_thread_name_length + 1> name{};
+        EXPECT_EQ(pthread_getname_np(thread, name.data(), name.size()), 0);
+        return std::string{name.data()};
+    }
+
+    // the niceness changes stay with the process, so they are made by a child
+    template <class Check>
+    void expect_in_child(const Check &check)
+    {
+        const auto child = unix::create_process();
+        ASSERT_TRUE(child);
+
+        if (unix::is_child_process(child.value()))
+        {
+            _exit(check() ? EXIT_SUCCESS : EXIT_FAILURE);
+        }
+        const auto status = unix::wait_till_child_terminates(child.value());
+        ASSERT_TRUE(status);
+        EXPECT_FALSE(unix::terminated_abnormally(status.value()));
+    }
+} // namespace
+
+TEST(NicenessTest, ReadsBackTheRaisedNiceness)
+{
+    expect_in_child(
+        []()
+        {
+            const auto initial = unix::get_niceness(0);
+
+            if (!initial || initial.value() == 19)
+            {
+                return false;
+            }
+            const auto raised = initial.value() + 1;
+
+            if (!unix::set_niceness(0, raised))
+            {
+                return false;
+            }
+            const auto current = unix::get_niceness(0);
+            return current && current.value() == raised;
+        });
+}
+
+TEST(NicenessTest, TellsTheNegativeNicenessApartFromAFailure)
+{
+    const auto missing = unix::get_niceness(std::numeric_limits<unix::process_id_t>::max());
+    ASSERT_FALSE(missing);
+    EXPECT_EQ(missing.error().code, ESRCH);
+
+    if (geteuid() != 0)
+    {
+        GTEST_SKIP() << "lowering the niceness requires CAP_SYS_NICE";
+    }
+    expect_in_child(
+        []()
+        {
+            // -1 is also what getpriority returns on failure
+            if (!unix::set_niceness(0, -1))
+            {
+                return false;
+            }
+            const auto current = unix::get_niceness(0);
+            return current && current.value() == -1;
+        });
+}
+
+TEST(NicenessTest, LoweringRequiresThePrivilege)
+{
+    if (geteuid() == 0)
+    {
+        GTEST_SKIP() << "the limit does not apply to privileged processes";
+    }
+    expect_in_child(
+        []()
+        {
+            const auto initial = unix::get_niceness(0);
+
+            if (!initial)
+            {
+                return false;
+            }
+            const auto lowered = unix::set_niceness(0, initial.value() - 1);
+            return !lowered && (lowered.error().code == EACCES || lowered.error().code == EPERM);
+        });
+}
+
+#ifdef __linux__ // pthread_getname_np takes any thread only on linux
+TEST(ThreadNameTest, NamesTheCurrentThread)
+{
+    std::string name;
+    std::thread named{[&name]()
+                      {
+                          EXPECT_TRUE(unix::name_current_thread("worker_1"));
+                          name = name_of(pthread_self());
+                      }};
+    named.join();
+    EXPECT_EQ(name, "worker_1");
+}
+
+TEST(ThreadNameTest, NamesAnotherThreadTruncated)
+{
+    std::atomic<bool> named{false};
+    std::thread thread{[&named]() { named.wait(false); }};
+
+    ASSERT_TRUE(unix::name_thread(thread, "a_rather_long_thread_name"));
+    EXPECT_EQ(name_of(thread.native_handle()), std::string{"a_rather_long_thread_name"}.substr(0, 15));
+
+    named = true;
+    named.notify_one();
+    thread.join();
+}
+#endif
@@ -0,0 +1,101 @@
+#include <cerrno>
+#include <chrono>
+#include <expected>
+#include <optional>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "unix/ipc/system_v/semaphore_set.hpp"
+
+namespace
+{
+    namespace system_v = unix::ipc::system_v;
+
+    using namespace std::chrono_literals;
+
+    // long enough for a blocked semop to have taken effect if it was going to
+    constexpr auto settle_time{50ms};
+
+    // the private sets outlive the process unless removed
+    class SemaphoreTransactionTest : public testing::Test
+    {
+    protected:
+        void SetUp() override
+        {
+            auto created = system_v::semaphore_set::create_private(2, 0600);
+            ASSERT_TRUE(created) << unix::to_string(created.error());
+            semaphores_.emplace(created.value());
+        }
+
+        void TearDown() override
+        {
+            if (semaphores_)
+            {
+                EXPECT_TRUE(semaphores_->remove());
+            }
+        }
+
+        const system_v::semaphore_set &semaphores() const noexcept { return semaphores_.value(); }
+
+        system_v::semaphore_value_t value_of(system_v::semaphore_index_t index) const noexcept
+        {
+            system_v::semaphore_value_t value{-1};
+            EXPECT_TRUE(semaphores().get_value(index, value));
+            return value;
+        }
+
+    private:
+        std::optional<system_v::semaphore_set> semaphores_;
+    };
+} // namespace
+
+TEST_F(SemaphoreTransactionTest, HoldsBackTheIncreaseWhileTheDecreaseBlocks)
+{
+    std::expected<void, unix::error_code> executed;
+    std::thread executor{[&]()
+                         {
+                             auto transaction = system_v::semaphore_transaction<2>{}.increase(0, 1).decrease(1, -1);
+                             executed = semaphores().execute(transaction);
+                         }};
+    std::this_thread::sleep_for(settle_time);
+    EXPECT_EQ(value_of(0), 0);
+
+    ASSERT_TRUE(semaphores().increase_value(1, 1));
+    executor.join();
+    ASSERT_TRUE(executed);
+    EXPECT_EQ(value_of(0), 1);
+    EXPECT_EQ(value_of(1), 0);
+}
+
+TEST_F(SemaphoreTransactionTest, AppliesNothingWhenItWouldBlock)
+{
+    auto transaction = system_v::semaphore_transaction<2>{}.increase(0, 1).decrease(1, -1).no_wait();
+    const auto executed = semaphores().execute(transaction);
+    ASSERT_FALSE(executed);
+    EXPECT_EQ(executed.error().code, EAGAIN);
+    EXPECT_EQ(value_of(0), 0);
+}
+
+TEST_F(SemaphoreTransactionTest, AppliesNothingOnTimeout)
+{
+    auto transaction = system_v::semaphore_transaction<2>{}.increase(0, 1).decrease(1, -1);
+    const auto executed = semaphores().execute_for(transaction, 20ms);
+    ASSERT_FALSE(executed);
+    EXPECT_EQ(executed.error().code, EAGAIN);
+    EXPECT_EQ(value_of(0), 0);
+    EXPECT_EQ(value_of(1), 0);
+}
+
+TEST_F(SemaphoreTransactionTest, WaitsTillZeroTogetherWithTheOtherOperations)
+{
+    ASSERT_TRUE(semaphores().set_value(1, 1));
+    auto blocked = system_v::semaphore_transaction<2>{}.wait_till_zero(1).increase(0, 1).no_wait();
+    ASSERT_FALSE(semaphores().execute(blocked));
+    EXPECT_EQ(value_of(0), 0);
+
+    ASSERT_TRUE(semaphores().decrease_value(1, -1));
+    auto passing = system_v::semaphore_transaction<2>{}.wait_till_zero(1).increase(0, 1).no_wait();
+    ASSERT_TRUE(semaphores().execute(passing));
+    EXPECT_EQ(value_of(0), 1);
+}
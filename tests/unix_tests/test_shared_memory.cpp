@@ -0,0 +1,161 @@
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include "unix/ipc/posix/memory_mapping.hpp"
+#include "unix/ipc/posix/shared_memory.hpp"
+#include "unix/process.hpp"
+
+namespace
+{
+    constexpr std::uint8_t parent_byte{0x5a};
+    constexpr std::uint8_t child_byte{0xa5};
+
+    // unique per run, the segments outlive a crashed test
+    std::string segment_name(const char *test)
+    {
+        return std::string{"/unix_tests_"} + test + "_" + std::to_string(unix::get_process_id());
+    }
+
+    // the child sees the bytes of the parent and answers in the last page
+    void check_in_child(std::string name, std::size_t size)
+    {
+        const auto child = unix::create_process();
+        ASSERT_TRUE(child);
+
+        if (unix::is_child_process(child.value()))
+        {
+            const auto opened = unix::ipc::posix::shared_memory::open_existing(std::move(name));
+
+            if (!opened || opened.value().size().value_or(0) != size)
+            {
+                _exit(EXIT_FAILURE);
+            }
+            auto mapped = opened.value().map(size);
+
+            if (!mapped)
+            {
+                _exit(EXIT_FAILURE);
+            }
+            auto *bytes = static_cast<std::uint8_t *>(mapped.value().data());
+
+            for (std::size_t index{0}; index < size / 2; ++index)
+            {
+                if (bytes[index] != parent_byte)
+                {
+                    _exit(EXIT_FAILURE);
+                }
+            }
+            std::memset(bytes + size / 2, child_byte, size / 2);
+            _exit(EXIT_SUCCESS);
+        }
+        int status;
+        ASSERT_TRUE(unix::wait_till_child_terminates(&status));
+        ASSERT_FALSE(unix::terminated_abnormally(status));
+        ASSERT_EQ(WEXITSTATUS(status), EXIT_SUCCESS);
+    }
+}
+
+TEST(SharedMemoryTest, SharesTheSegmentWithAForkedChild)
+{
+    const auto name = segment_name("shares");
+    const auto size = 4 * unix::ipc::posix::page_size();
+    const auto created = unix::ipc::posix::shared_memory::create_exclusively(std::string{name}, 0600);
+    ASSERT_TRUE(created);
+    const auto &segment = created.value();
+    // a new segment is empty
+    ASSERT_EQ(segment.size().value(), 0);
+    ASSERT_TRUE(segment.truncate(size));
+    ASSERT_EQ(segment.size().value(), size);
+
+    const auto again = unix::ipc::posix::shared_memory::create_exclusively(std::string{name}, 0600);
+    ASSERT_FALSE(again);
+    EXPECT_EQ(again.error().code, EEXIST);
+
+#ifndef __APPLE__
+    auto mapped = segment.map_populated(size, false);
+#else
+    auto mapped = segment.map(size);
+#endif
+    ASSERT_TRUE(mapped);
+    ASSERT_EQ(mapped.value().size(), size);
+    auto *bytes = static_cast<std::uint8_t *>(mapped.value().data());
+    std::memset(bytes, parent_byte, size / 2);
+    check_in_child(name, size);
+
+    for (std::size_t index{size / 2}; index < size; ++index)
+    {
+        ASSERT_EQ(bytes[index], child_byte);
+    }
+    // the name goes, the mapping stays
+    ASSERT_TRUE(segment.unlink());
+    const auto reopened = unix::ipc::posix::shared_memory::open_existing(std::string{name});
+    ASSERT_FALSE(reopened);
+    EXPECT_EQ(reopened.error().code, ENOENT);
+    EXPECT_EQ(bytes[0], parent_byte);
+    EXPECT_EQ(bytes[size - 1], child_byte);
+
+    const auto unlinked_again = segment.unlink();
+    ASSERT_FALSE(unlinked_again);
+    EXPECT_EQ(unlinked_again.error().code, ENOENT);
+}
+
+#ifndef __APPLE__
+TEST(SharedMemoryTest, MapsTheSegmentOnTransparentHugePages)
+{
+    const auto name = segment_name("huge");
+    // a whole huge page on x86-64
+    const std::size_t size{2 * 1'024 * 1'024};
+    const auto created = unix::ipc::posix::shared_memory::create_exclusively(std::string{name}, 0600);
+    ASSERT_TRUE(created);
+    const auto &segment = created.value();
+    ASSERT_TRUE(segment.unlink());
+    ASSERT_TRUE(segment.truncate(size));
+    auto mapped = segment.map_populated(size, true);
+
+    if (!mapped && mapped.error().code == EINVAL)
+    {
+        GTEST_SKIP() << "no transparent huge pages for shared memory";
+    }
+    ASSERT_TRUE(mapped);
+    // prefaulted and writable
+    auto *bytes = static_cast<std::uint8_t *>(mapped.value().data());
+    bytes[size - 1] = child_byte;
+    EXPECT_EQ(bytes[size - 1], child_byte);
+    EXPECT_TRUE(mapped.value().unmap());
+    EXPECT_FALSE(mapped.value());
+}
+#endif
+
+TEST(MemoryMappingTest, SharesTheAnonymousMemoryWithTheChildren)
+{
+    auto mapped = unix::ipc::posix::memory_mapping::create_anonymous(
+        unix::ipc::posix::page_size(), unix::ipc::posix::read_write_protection,
+        unix::ipc::posix::mapping_flags_builder{}.get());
+    ASSERT_TRUE(mapped);
+    auto *value = static_cast<volatile int *>(mapped.value().data());
+    *value = 1;
+    const auto child = unix::create_process();
+    ASSERT_TRUE(child);
+
+    if (unix::is_child_process(child.value()))
+    {
+        *value = *value + 1;
+        _exit(EXIT_SUCCESS);
+    }
+    int status;
+    ASSERT_TRUE(unix::wait_till_child_terminates(&status));
+    EXPECT_EQ(*value, 2);
+
+    // moving hands the region over, the moved from mapping is empty
+    auto moved = std::move(mapped.value());
+    EXPECT_FALSE(mapped.value());
+    EXPECT_TRUE(moved);
+    EXPECT_EQ(moved.size(), unix::ipc::posix::page_size());
+}
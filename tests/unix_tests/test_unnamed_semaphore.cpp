@@ -0,0 +1,98 @@
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <expected>
+#include <memory>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include "unix/ipc/posix/memory_mapping.hpp"
+#include "unix/ipc/posix/unnamed_semaphore.hpp"
+#include "unix/process.hpp"
+
+using namespace std::literals::chrono_literals;
+
+#ifndef __APPLE__ // see unix/ipc/posix/unnamed_semaphore.hpp
+namespace
+{
+    using unix::ipc::posix::shared_between;
+    using unix::ipc::posix::unnamed_semaphore;
+
+    std::expected<unix::ipc::posix::memory_mapping, unix::error_code> map_shared(std::size_t size) noexcept
+    {
+        return unix::ipc::posix::memory_mapping::create_anonymous(size, unix::ipc::posix::read_write_protection,
+                                                                  unix::ipc::posix::mapping_flags_builder{}.get());
+    }
+} // namespace
+
+TEST(UnnamedSemaphoreTest, TryWaitFailsWithEagainAtZero)
+{
+    auto memory = map_shared(sizeof(unnamed_semaphore));
+    ASSERT_TRUE(memory);
+    auto constructed = unnamed_semaphore::construct_at(memory->data(), shared_between::threads, 0);
+    ASSERT_TRUE(constructed);
+    auto &semaphore = *constructed.value();
+
+    const auto empty = semaphore.try_wait();
+    ASSERT_FALSE(empty);
+    EXPECT_EQ(empty.error().code, EAGAIN);
+
+    ASSERT_TRUE(semaphore.post());
+    EXPECT_TRUE(semaphore.try_wait());
+    const auto value = semaphore.get_value();
+    ASSERT_TRUE(value);
+    EXPECT_EQ(value.value(), 0);
+    std::destroy_at(&semaphore);
+}
+
+TEST(UnnamedSemaphoreTest, WaitForTimesOutWithoutTakingTheValue)
+{
+    auto memory = map_shared(sizeof(unnamed_semaphore));
+    ASSERT_TRUE(memory);
+    auto constructed = unnamed_semaphore::construct_at(memory->data(), shared_between::threads, 0);
+    ASSERT_TRUE(constructed);
+    auto &semaphore = *constructed.value();
+
+    const auto started = std::chrono::steady_clock::now();
+    const auto timed_out = semaphore.wait_for(20ms);
+    ASSERT_FALSE(timed_out);
+    EXPECT_EQ(timed_out.error().code, ETIMEDOUT);
+    EXPECT_GE(std::chrono::steady_clock::now() - started, 20ms);
+
+    ASSERT_TRUE(semaphore.post());
+    EXPECT_TRUE(semaphore.wait_for(1s));
+    std::destroy_at(&semaphore);
+}
+
+TEST(UnnamedSemaphoreTest, HandsOverBetweenProcessesInSharedMemory)
+{
+    auto memory = map_shared(2 * sizeof(unnamed_semaphore));
+    ASSERT_TRUE(memory);
+    auto *bytes = static_cast<std::byte *>(memory->data());
+    auto request = unnamed_semaphore::construct_at(bytes, shared_between::processes, 0);
+    ASSERT_TRUE(request);
+    auto reply = unnamed_semaphore::construct_at(bytes + sizeof(unnamed_semaphore), shared_between::processes, 0);
+    ASSERT_TRUE(reply);
+
+    const auto child = unix::create_process();
+    ASSERT_TRUE(child);
+
+    if (unix::is_child_process(child.value()))
+    {
+        const auto requested = request.value()->wait_for(10s);
+        _exit(requested && reply.value()->post() ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+    // the child is blocked till the request
+    EXPECT_FALSE(reply.value()->wait_for(20ms));
+    ASSERT_TRUE(request.value()->post());
+    EXPECT_TRUE(reply.value()->wait_for(10s));
+
+    const auto status = unix::wait_till_child_terminates(child.value());
+    ASSERT_TRUE(status);
+    EXPECT_FALSE(unix::terminated_abnormally(status.value()));
+    std::destroy_at(request.value());
+    std::destroy_at(reply.value());
+}
+#endif
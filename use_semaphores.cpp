@@ -1,10 +1,12 @@
 #include <algorithm>
 #include <cassert>
+#include <cstddef>
 #include <iterator>
 #include <print>
 #include <pthread.h>
 #include <semaphore.h>
 #include <unistd.h>
+#include <vector>
 
 #include "unix/sync/posix/mutex.hpp"
 #include "unix/ipc/posix/named_semaphore.hpp"
@@ -111,9 +113,22 @@ int main(int, char **)
 
     using namespace unix::ipc;
 
-    const auto created = posix::unnamed_semaphore::create(posix::shared_between::threads, 1);
-    assert(!created);
-    std::println("failed to create unnamed semaphore due to: {}", unix::to_string(created.error()).data());
+    alignas(posix::unnamed_semaphore) std::byte semaphore_storage[sizeof(posix::unnamed_semaphore)];
+    const auto created = posix::unnamed_semaphore::construct_at(semaphore_storage, posix::shared_between::threads, 1);
+
+    if (created)
+    {
+        auto *semaphore = created.value();
+        assert(semaphore->try_wait());
+        assert(!semaphore->try_wait());
+        assert(semaphore->post());
+        assert(semaphore->get_value().value() == 1);
+        semaphore->~unnamed_semaphore();
+    }
+    else
+    {
+        std::println("failed to create unnamed semaphore due to: {}", unix::to_string(created.error()).data());
+    }
 
     auto mutex_created = unix::sync::posix::mutex::create();
     assert(mutex_created.has_value());